@@ -0,0 +1,846 @@
+/* Copyright (c) <2003-2016> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#include "benchmark_stdafx.h"
+#include "BenchmarkScenes.h"
+
+#define BENCHMARK_GRAVITY				-10.0f
+#define BENCHMARK_DEBRIS_COUNT			600
+#define BENCHMARK_RAYS_PER_FRAME		4096
+#define BENCHMARK_SHAPE_QUERIES			1024
+#define BENCHMARK_SHAPE_CONTACTS		4
+#define BENCHMARK_TERRAIN_SIZE			1024
+#define BENCHMARK_TERRAIN_RAYS			256
+#define BENCHMARK_ISLAND_SIDE			12
+#define BENCHMARK_ISLAND_LAYERS			7
+#define BENCHMARK_SPHERES_SIDE			10
+#define BENCHMARK_SPHERES_LAYERS		10
+#define BENCHMARK_TILED_TERRAIN_SIZE	65536
+#define BENCHMARK_TILED_TERRAIN_TILE	128
+#define BENCHMARK_TILED_TERRAIN_CACHE	128
+
+
+// all scenes use the same seed so that every run simulates the same bodies
+class BenchmarkRandom
+{
+	public:
+	BenchmarkRandom (unsigned seed = 0x12345678)
+		:m_seed(seed)
+	{
+	}
+
+	dFloat Get (dFloat minValue, dFloat maxValue)
+	{
+		m_seed = m_seed * 1664525u + 1013904223u;
+		dFloat t = dFloat (m_seed >> 8) / dFloat (1 << 24);
+		return minValue + (maxValue - minValue) * t;
+	}
+
+	unsigned m_seed;
+};
+
+
+static void ApplyGravity (const NewtonBody* const body, dFloat timestep, int threadIndex)
+{
+	dFloat Ixx;
+	dFloat Iyy;
+	dFloat Izz;
+	dFloat mass;
+
+	NewtonBodyGetMass (body, &mass, &Ixx, &Iyy, &Izz);
+	dVector force (0.0f, mass * BENCHMARK_GRAVITY, 0.0f, 0.0f);
+	NewtonBodySetForce (body, &force[0]);
+}
+
+// the engine api has no hinge, this is a minimal user joint version of the custom joint library hinge
+// with a velocity motor on the free axis, a zero target speed makes the motor act as joint friction
+class BenchmarkHinge
+{
+	public:
+	static void Create (NewtonWorld* const world, const dVector& pivot, const dVector& pin, NewtonBody* const child, NewtonBody* const parent, dFloat targetOmega, dFloat maxTorque)
+	{
+		dMatrix matrix0;
+		dMatrix matrix1;
+		dMatrix pinAndPivot (dGrammSchmidt (pin));
+		pinAndPivot.m_posit = pivot;
+		pinAndPivot.m_posit.m_w = 1.0f;
+		NewtonBodyGetMatrix (child, &matrix0[0][0]);
+		NewtonBodyGetMatrix (parent, &matrix1[0][0]);
+
+		BenchmarkHinge* const hinge = new BenchmarkHinge;
+		hinge->m_localMatrix0 = pinAndPivot * matrix0.Inverse();
+		hinge->m_localMatrix1 = pinAndPivot * matrix1.Inverse();
+		hinge->m_targetOmega = targetOmega;
+		hinge->m_maxTorque = maxTorque;
+
+		NewtonJoint* const joint = NewtonConstraintCreateUserJoint (world, 6, SubmitConstraints, child, parent);
+		NewtonJointSetUserData (joint, hinge);
+		NewtonJointSetDestructor (joint, Destroy);
+	}
+
+	private:
+	static void Destroy (const NewtonJoint* const joint)
+	{
+		delete (BenchmarkHinge*) NewtonJointGetUserData (joint);
+	}
+
+	static dFloat CalculateAngle (const dVector& planeDir, const dVector& cosDir, const dVector& sinDir)
+	{
+		const dFloat cosAngle = planeDir.DotProduct3 (cosDir);
+		const dFloat sinAngle = sinDir.DotProduct3 (planeDir.CrossProduct (cosDir));
+		return dAtan2 (sinAngle, cosAngle);
+	}
+
+	static void SubmitConstraints (const NewtonJoint* const joint, dFloat timestep, int threadIndex)
+	{
+		dMatrix body0Matrix;
+		dMatrix body1Matrix;
+		dVector omega0 (0.0f);
+		dVector omega1 (0.0f);
+		const BenchmarkHinge* const hinge = (BenchmarkHinge*) NewtonJointGetUserData (joint);
+		NewtonBody* const body0 = NewtonJointGetBody0 (joint);
+		NewtonBody* const body1 = NewtonJointGetBody1 (joint);
+		NewtonBodyGetMatrix (body0, &body0Matrix[0][0]);
+		NewtonBodyGetMatrix (body1, &body1Matrix[0][0]);
+		NewtonBodyGetOmega (body0, &omega0[0]);
+		NewtonBodyGetOmega (body1, &omega1[0]);
+
+		const dMatrix matrix0 (hinge->m_localMatrix0 * body0Matrix);
+		const dMatrix matrix1 (hinge->m_localMatrix1 * body1Matrix);
+
+		NewtonUserJointAddLinearRow (joint, &matrix0.m_posit[0], &matrix1.m_posit[0], &matrix1.m_front[0]);
+		NewtonUserJointAddLinearRow (joint, &matrix0.m_posit[0], &matrix1.m_posit[0], &matrix1.m_up[0]);
+		NewtonUserJointAddLinearRow (joint, &matrix0.m_posit[0], &matrix1.m_posit[0], &matrix1.m_right[0]);
+		NewtonUserJointAddAngularRow (joint, CalculateAngle (matrix0.m_front, matrix1.m_front, matrix1.m_up), &matrix1.m_up[0]);
+		NewtonUserJointAddAngularRow (joint, CalculateAngle (matrix0.m_front, matrix1.m_front, matrix1.m_right), &matrix1.m_right[0]);
+
+		const dFloat omega = matrix0.m_front.DotProduct3 (omega0 - omega1);
+		NewtonUserJointAddAngularRow (joint, 0.0f, &matrix0.m_front[0]);
+		NewtonUserJointSetRowAcceleration (joint, (hinge->m_targetOmega - omega) / timestep);
+		NewtonUserJointSetRowMinimumFriction (joint, -hinge->m_maxTorque);
+		NewtonUserJointSetRowMaximumFriction (joint, hinge->m_maxTorque);
+	}
+
+	dMatrix m_localMatrix0;
+	dMatrix m_localMatrix1;
+	dFloat m_targetOmega;
+	dFloat m_maxTorque;
+};
+
+
+static NewtonBody* CreateRigidBody (NewtonWorld* const world, NewtonCollision* const shape, const dMatrix& matrix, dFloat mass)
+{
+	NewtonBody* const body = NewtonCreateDynamicBody (world, shape, &matrix[0][0]);
+	if (mass > 0.0f) {
+		NewtonBodySetMassProperties (body, mass, shape);
+		NewtonBodySetForceAndTorqueCallback (body, ApplyGravity);
+	}
+	return body;
+}
+
+static void CreateFloor (NewtonWorld* const world, dFloat size)
+{
+	NewtonCollision* const shape = NewtonCreateBox (world, size, 1.0f, size, 0, NULL);
+	dMatrix matrix (dGetIdentityMatrix());
+	matrix.m_posit.m_y = -0.5f;
+	CreateRigidBody (world, shape, matrix, 0.0f);
+	NewtonDestroyCollision (shape);
+}
+
+static dFloat TerrainElevation (dFloat x, dFloat z)
+{
+	return 2.0f * dSin (x * 0.15f) * dCos (z * 0.13f) + 0.5f * dSin (x * 0.5f + z * 0.3f);
+}
+
+static NewtonCollision* CreateDebrisShape (NewtonWorld* const world, BenchmarkRandom& random, int index)
+{
+	switch (index % 5)
+	{
+		case 0:
+			return NewtonCreateBox (world, random.Get (0.4f, 1.0f), random.Get (0.4f, 1.0f), random.Get (0.4f, 1.0f), 0, NULL);
+		case 1:
+			return NewtonCreateSphere (world, random.Get (0.2f, 0.5f), 0, NULL);
+		case 2:
+			return NewtonCreateCapsule (world, 0.25f, 0.25f, random.Get (0.6f, 1.2f), 0, NULL);
+		case 3:
+			return NewtonCreateCylinder (world, 0.3f, 0.3f, random.Get (0.4f, 1.0f), 0, NULL);
+		default:
+		{
+			dFloat cloud[16][3];
+			for (int i = 0; i < 16; i ++) {
+				cloud[i][0] = random.Get (-0.5f, 0.5f);
+				cloud[i][1] = random.Get (-0.5f, 0.5f);
+				cloud[i][2] = random.Get (-0.5f, 0.5f);
+			}
+			return NewtonCreateConvexHull (world, 16, &cloud[0][0], 3 * sizeof (dFloat), 0.01f, 0, NULL);
+		}
+	}
+}
+
+// drops layers of mixed convex shapes in a square column centered at the origin
+static void DropDebris (NewtonWorld* const world, int count, dFloat base)
+{
+	BenchmarkRandom random;
+	const int side = 10;
+	const dFloat spacing = 1.5f;
+	for (int i = 0; i < count; i ++) {
+		const int layer = i / (side * side);
+		const int row = (i / side) % side;
+		const int column = i % side;
+
+		dMatrix matrix (dPitchMatrix (random.Get (0.0f, dPi)) * dYawMatrix (random.Get (0.0f, dPi)));
+		matrix.m_posit = dVector ((column - side / 2) * spacing, base + layer * spacing, (row - side / 2) * spacing, 1.0f);
+
+		NewtonCollision* const shape = CreateDebrisShape (world, random, i);
+		CreateRigidBody (world, shape, matrix, 1.0f);
+		NewtonDestroyCollision (shape);
+	}
+}
+
+
+// jenga towers and a box pyramid, long contact chains stress the solver
+static BenchmarkScene* CreateStackingScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+
+	const dVector plankSize (0.8f, 0.5f, 2.4f, 0.0f);
+	NewtonCollision* const plank = NewtonCreateBox (world, plankSize.m_x, plankSize.m_y, plankSize.m_z, 0, NULL);
+	for (int i = 0; i < 3; i ++) {
+		for (int j = 0; j < 3; j ++) {
+			const dVector origin ((i - 1) * 6.0f, 0.0f, (j - 1) * 6.0f, 1.0f);
+			for (int layer = 0; layer < 12; layer ++) {
+				const dMatrix rotation ((layer & 1) ? dYawMatrix (dPi * 0.5f) : dGetIdentityMatrix());
+				for (int k = 0; k < 3; k ++) {
+					dMatrix matrix (rotation);
+					matrix.m_posit = origin + rotation.RotateVector (dVector ((k - 1) * plankSize.m_x, 0.0f, 0.0f, 0.0f));
+					matrix.m_posit.m_y = plankSize.m_y * (layer + 0.5f) + 0.001f * layer;
+					matrix.m_posit.m_w = 1.0f;
+					CreateRigidBody (world, plank, matrix, 1.0f);
+				}
+			}
+		}
+	}
+	NewtonDestroyCollision (plank);
+
+	const int pyramidBase = 16;
+	NewtonCollision* const box = NewtonCreateBox (world, 1.0f, 1.0f, 1.0f, 0, NULL);
+	for (int row = 0; row < pyramidBase; row ++) {
+		for (int k = 0; k < pyramidBase - row; k ++) {
+			dMatrix matrix (dGetIdentityMatrix());
+			matrix.m_posit = dVector ((k - (pyramidBase - row - 1) * 0.5f) * 1.01f, row + 0.5f + 0.001f * row, 20.0f, 1.0f);
+			CreateRigidBody (world, box, matrix, 1.0f);
+		}
+	}
+	NewtonDestroyCollision (box);
+
+	return new BenchmarkScene (world);
+}
+
+
+static NewtonBody* AddRagdollBone (NewtonWorld* const world, NewtonCollision* const shape, const dMatrix& origin, const dVector& posit, dFloat mass)
+{
+	dMatrix matrix (origin);
+	matrix.m_posit = origin.TransformVector (posit);
+	return CreateRigidBody (world, shape, matrix, mass);
+}
+
+static void AddRagdollBall (NewtonWorld* const world, const dMatrix& origin, const dVector& pivot, const dVector& pin, NewtonBody* const child, NewtonBody* const parent, dFloat cone)
+{
+	const dVector globalPivot (origin.TransformVector (pivot));
+	const dVector globalPin (origin.RotateVector (pin));
+	NewtonJoint* const joint = NewtonConstraintCreateBall (world, &globalPivot[0], child, parent);
+	NewtonBallSetConeLimits (joint, &globalPin[0], cone, cone * 0.5f);
+}
+
+static void AddRagdollHinge (NewtonWorld* const world, const dMatrix& origin, const dVector& pivot, NewtonBody* const child, NewtonBody* const parent)
+{
+	const dVector globalPivot (origin.TransformVector (pivot));
+	const dVector globalPin (origin.RotateVector (dVector (0.0f, 0.0f, 1.0f, 0.0f)));
+	BenchmarkHinge::Create (world, globalPivot, globalPin, child, parent, 0.0f, 20.0f);
+}
+
+// ragdolls are built lying on their back along the x axis
+static void CreateRagdoll (NewtonWorld* const world, const dMatrix& origin, NewtonCollision** const shapes)
+{
+	NewtonBody* const torso = AddRagdollBone (world, shapes[0], origin, dVector (0.0f, 0.0f, 0.0f, 1.0f), 20.0f);
+	NewtonBody* const head = AddRagdollBone (world, shapes[1], origin, dVector (-0.42f, 0.0f, 0.0f, 1.0f), 4.0f);
+	NewtonBody* const pelvis = AddRagdollBone (world, shapes[2], origin, dVector (0.42f, 0.0f, 0.0f, 1.0f), 10.0f);
+	AddRagdollBall (world, origin, dVector (-0.28f, 0.0f, 0.0f, 1.0f), dVector (-1.0f, 0.0f, 0.0f, 0.0f), head, torso, 0.5f);
+	AddRagdollBall (world, origin, dVector (0.28f, 0.0f, 0.0f, 1.0f), dVector (1.0f, 0.0f, 0.0f, 0.0f), pelvis, torso, 0.3f);
+
+	for (int side = -1; side <= 1; side += 2) {
+		const dFloat legZ = 0.11f * side;
+		NewtonBody* const thigh = AddRagdollBone (world, shapes[3], origin, dVector (0.85f, 0.0f, legZ, 1.0f), 6.0f);
+		NewtonBody* const calf = AddRagdollBone (world, shapes[3], origin, dVector (1.35f, 0.0f, legZ, 1.0f), 4.0f);
+		AddRagdollBall (world, origin, dVector (0.6f, 0.0f, legZ, 1.0f), dVector (1.0f, 0.0f, 0.0f, 0.0f), thigh, pelvis, 0.8f);
+		AddRagdollHinge (world, origin, dVector (1.1f, 0.0f, legZ, 1.0f), calf, thigh);
+
+		const dFloat armZ = 0.32f * side;
+		NewtonBody* const upperArm = AddRagdollBone (world, shapes[4], origin, dVector (0.0f, 0.0f, armZ, 1.0f), 3.0f);
+		NewtonBody* const foreArm = AddRagdollBone (world, shapes[4], origin, dVector (0.4f, 0.0f, armZ, 1.0f), 2.0f);
+		AddRagdollBall (world, origin, dVector (-0.2f, 0.0f, armZ, 1.0f), dVector (1.0f, 0.0f, 0.0f, 0.0f), upperArm, torso, 1.0f);
+		AddRagdollHinge (world, origin, dVector (0.2f, 0.0f, armZ, 1.0f), foreArm, upperArm);
+	}
+}
+
+// a pile of jointed bodies, many small islands merging into large ones
+static BenchmarkScene* CreateRagdollScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+
+	NewtonCollision* shapes[5];
+	shapes[0] = NewtonCreateBox (world, 0.5f, 0.25f, 0.4f, 0, NULL);
+	shapes[1] = NewtonCreateSphere (world, 0.13f, 0, NULL);
+	shapes[2] = NewtonCreateBox (world, 0.3f, 0.2f, 0.35f, 0, NULL);
+	shapes[3] = NewtonCreateCapsule (world, 0.07f, 0.07f, 0.46f, 0, NULL);
+	shapes[4] = NewtonCreateCapsule (world, 0.05f, 0.05f, 0.36f, 0, NULL);
+
+	BenchmarkRandom random;
+	for (int layer = 0; layer < 3; layer ++) {
+		for (int i = 0; i < 4; i ++) {
+			for (int j = 0; j < 4; j ++) {
+				dMatrix origin (dYawMatrix (random.Get (-0.3f, 0.3f)));
+				origin.m_posit = dVector (i * 0.8f - 1.2f, 0.5f + layer * 0.6f, j * 1.0f - 1.5f, 1.0f);
+				CreateRagdoll (world, origin, shapes);
+			}
+		}
+	}
+
+	for (int i = 0; i < 5; i ++) {
+		NewtonDestroyCollision (shapes[i]);
+	}
+	return new BenchmarkScene (world);
+}
+
+
+// a height field terrain with debris falling on it
+static BenchmarkScene* CreateHeightFieldScene (NewtonWorld* const world)
+{
+	const int size = 128;
+	const dFloat cellSize = 1.0f;
+	dFloat* const elevation = new dFloat[size * size];
+	char* const attributes = new char[size * size];
+	memset (attributes, 0, size * size * sizeof (char));
+
+	const dFloat offset = -0.5f * cellSize * (size - 1);
+	for (int z = 0; z < size; z ++) {
+		for (int x = 0; x < size; x ++) {
+			elevation[z * size + x] = TerrainElevation (offset + x * cellSize, offset + z * cellSize);
+		}
+	}
+
+	NewtonCollision* const heightField = NewtonCreateHeightFieldCollision (world, size, size, 1, 0, elevation, attributes, 1.0f, cellSize, cellSize, 0);
+	dMatrix matrix (dGetIdentityMatrix());
+	matrix.m_posit = dVector (offset, 0.0f, offset, 1.0f);
+	CreateRigidBody (world, heightField, matrix, 0.0f);
+	NewtonDestroyCollision (heightField);
+
+	delete[] attributes;
+	delete[] elevation;
+
+	DropDebris (world, BENCHMARK_DEBRIS_COUNT, 4.0f);
+	return new BenchmarkScene (world);
+}
+
+
+// the same terrain as the height field scene but as a polygon soup
+static BenchmarkScene* CreateMeshScene (NewtonWorld* const world)
+{
+	const int size = 64;
+	const dFloat cellSize = 2.0f;
+	const dFloat offset = -0.5f * cellSize * size;
+
+	NewtonCollision* const mesh = NewtonCreateTreeCollision (world, 0);
+	NewtonTreeCollisionBeginBuild (mesh);
+	for (int z = 0; z < size; z ++) {
+		for (int x = 0; x < size; x ++) {
+			dFloat p[4][3];
+			for (int i = 0; i < 4; i ++) {
+				p[i][0] = offset + (x + (i & 1)) * cellSize;
+				p[i][2] = offset + (z + (i >> 1)) * cellSize;
+				p[i][1] = TerrainElevation (p[i][0], p[i][2]);
+			}
+			dFloat face0[3][3] = {{p[0][0], p[0][1], p[0][2]}, {p[2][0], p[2][1], p[2][2]}, {p[1][0], p[1][1], p[1][2]}};
+			dFloat face1[3][3] = {{p[1][0], p[1][1], p[1][2]}, {p[2][0], p[2][1], p[2][2]}, {p[3][0], p[3][1], p[3][2]}};
+			NewtonTreeCollisionAddFace (mesh, 3, &face0[0][0], 3 * sizeof (dFloat), 0);
+			NewtonTreeCollisionAddFace (mesh, 3, &face1[0][0], 3 * sizeof (dFloat), 0);
+		}
+	}
+	NewtonTreeCollisionEndBuild (mesh, 1);
+
+	CreateRigidBody (world, mesh, dGetIdentityMatrix(), 0.0f);
+	NewtonDestroyCollision (mesh);
+
+	DropDebris (world, BENCHMARK_DEBRIS_COUNT, 4.0f);
+	return new BenchmarkScene (world);
+}
+
+
+// chassis with four hinged and motorized wheels, driving over a field of bumps
+static BenchmarkScene* CreateVehiclesScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 400.0f);
+
+	NewtonCollision* const bump = NewtonCreateBox (world, 80.0f, 0.2f, 0.5f, 0, NULL);
+	for (int i = 0; i < 10; i ++) {
+		dMatrix matrix (dGetIdentityMatrix());
+		matrix.m_posit = dVector (0.0f, 0.0f, 6.0f + i * 4.0f, 1.0f);
+		CreateRigidBody (world, bump, matrix, 0.0f);
+	}
+	NewtonDestroyCollision (bump);
+
+	NewtonCollision* const chassisShape = NewtonCreateBox (world, 2.0f, 0.5f, 4.0f, 0, NULL);
+	NewtonCollision* const wheelShape = NewtonCreateChamferCylinder (world, 0.4f, 0.3f, 0, NULL);
+	for (int i = 0; i < 8; i ++) {
+		for (int j = 0; j < 4; j ++) {
+			dMatrix chassisMatrix (dGetIdentityMatrix());
+			chassisMatrix.m_posit = dVector ((i - 4) * 8.0f, 1.0f, (j - 2) * 8.0f, 1.0f);
+			NewtonBody* const chassis = CreateRigidBody (world, chassisShape, chassisMatrix, 800.0f);
+
+			for (int k = 0; k < 4; k ++) {
+				dMatrix wheelMatrix (dGetIdentityMatrix());
+				wheelMatrix.m_posit = chassisMatrix.m_posit + dVector ((k & 1) ? 1.2f : -1.2f, -0.3f, (k & 2) ? 1.4f : -1.4f, 0.0f);
+				NewtonBody* const wheel = CreateRigidBody (world, wheelShape, wheelMatrix, 20.0f);
+
+				BenchmarkHinge::Create (world, wheelMatrix.m_posit, dVector (1.0f, 0.0f, 0.0f, 0.0f), wheel, chassis, 10.0f, 400.0f);
+			}
+		}
+	}
+	NewtonDestroyCollision (wheelShape);
+	NewtonDestroyCollision (chassisShape);
+
+	return new BenchmarkScene (world);
+}
+
+
+// a 12 x 12 x 7 block of touching boxes resting on the floor, the side and top contacts make it a single
+// island of more than 10000 contact joints, big enough for the single island parallel solver to take it
+static BenchmarkScene* CreateIslandScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+
+	const int side = BENCHMARK_ISLAND_SIDE;
+	NewtonCollision* const box = NewtonCreateBox (world, 1.0f, 1.0f, 1.0f, 0, NULL);
+	for (int layer = 0; layer < BENCHMARK_ISLAND_LAYERS; layer ++) {
+		for (int row = 0; row < side; row ++) {
+			for (int column = 0; column < side; column ++) {
+				dMatrix matrix (dGetIdentityMatrix());
+				matrix.m_posit = dVector (column - side * 0.5f, layer + 0.5f, row - side * 0.5f, 1.0f);
+				CreateRigidBody (world, box, matrix, 1.0f);
+			}
+		}
+	}
+	NewtonDestroyCollision (box);
+	return new BenchmarkScene (world);
+}
+
+
+// 1000 spheres poured into a box walled bin, almost all pairs are sphere against sphere or sphere 
+// against box, the pairs the narrow phase collides four at a time
+static BenchmarkScene* CreateSpheresScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+
+	const int side = BENCHMARK_SPHERES_SIDE;
+	const dFloat radius = 0.5f;
+	const dFloat halfWidth = side * radius + 0.5f;
+	NewtonCollision* const wall = NewtonCreateBox (world, 1.0f, 4.0f, 2.0f * halfWidth + 2.0f, 0, NULL);
+	for (int i = 0; i < 4; i ++) {
+		dMatrix matrix (dYawMatrix (i * dPi * 0.5f));
+		matrix.m_posit = matrix.RotateVector (dVector (halfWidth + 0.5f, 2.0f, 0.0f, 0.0f));
+		matrix.m_posit.m_w = 1.0f;
+		CreateRigidBody (world, wall, matrix, 0.0f);
+	}
+	NewtonDestroyCollision (wall);
+
+	BenchmarkRandom random;
+	NewtonCollision* const sphere = NewtonCreateSphere (world, radius, 0, NULL);
+	for (int layer = 0; layer < BENCHMARK_SPHERES_LAYERS; layer ++) {
+		for (int row = 0; row < side; row ++) {
+			for (int column = 0; column < side; column ++) {
+				dMatrix matrix (dGetIdentityMatrix());
+				const dFloat x = (column - side * 0.5f + 0.5f) * 2.0f * radius + random.Get (-0.05f, 0.05f);
+				const dFloat z = (row - side * 0.5f + 0.5f) * 2.0f * radius + random.Get (-0.05f, 0.05f);
+				matrix.m_posit = dVector (x, radius + layer * 2.1f * radius, z, 1.0f);
+				CreateRigidBody (world, sphere, matrix, 1.0f);
+			}
+		}
+	}
+	NewtonDestroyCollision (sphere);
+	return new BenchmarkScene (world);
+}
+
+
+// casts a fixed grid of vertical rays every frame from all worker threads
+class BenchmarkRayCastScene: public BenchmarkScene
+{
+	public:
+	class RayCastJob
+	{
+		public:
+		BenchmarkRayCastScene* m_scene;
+		int m_first;
+		int m_count;
+		int m_hits;
+	};
+
+	BenchmarkRayCastScene (NewtonWorld* const world)
+		:BenchmarkScene (world)
+		,m_frame(0)
+	{
+	}
+
+	static dFloat RayFilter (const NewtonBody* const body, const NewtonCollision* const shapeHit, const dFloat* const hitContact, const dFloat* const hitNormal, dLong collisionID, void* const userData, dFloat intersectParam)
+	{
+		dFloat* const param = (dFloat*) userData;
+		if (intersectParam < *param) {
+			*param = intersectParam;
+		}
+		return *param;
+	}
+
+	static void CastRays (NewtonWorld* const world, void* const userData, int threadIndex)
+	{
+		RayCastJob* const job = (RayCastJob*) userData;
+		const int side = 64;
+		const dFloat spacing = 0.5f;
+		const dFloat jitter = 0.01f * (job->m_scene->m_frame & 31);
+		for (int i = job->m_first; i < job->m_first + job->m_count; i ++) {
+			const dFloat x = ((i % side) - side / 2) * spacing + jitter;
+			const dFloat z = ((i / side) % side - side / 2) * spacing + jitter;
+			const dVector p0 (x, 30.0f, z, 0.0f);
+			const dVector p1 (x, -1.0f, z, 0.0f);
+			dFloat param = 1.2f;
+			NewtonWorldRayCast (world, &p0[0], &p1[0], RayFilter, &param, NULL, threadIndex);
+			job->m_hits += (param < 1.0f) ? 1 : 0;
+		}
+	}
+
+	virtual void PostUpdate (dFloat timestep)
+	{
+		RayCastJob jobs[64];
+		const int threads = NewtonGetThreadsCount (m_world);
+		const int jobsCount = (threads < 64) ? threads : 64;
+		const int raysPerJob = (BENCHMARK_RAYS_PER_FRAME + jobsCount - 1) / jobsCount;
+		for (int i = 0; i < jobsCount; i ++) {
+			const int first = i * raysPerJob;
+			jobs[i].m_scene = this;
+			jobs[i].m_first = first;
+			jobs[i].m_count = ((first + raysPerJob) < BENCHMARK_RAYS_PER_FRAME) ? raysPerJob : BENCHMARK_RAYS_PER_FRAME - first;
+			jobs[i].m_hits = 0;
+			NewtonDispachThreadJob (m_world, CastRays, &jobs[i]);
+		}
+		NewtonSyncThreadJobs (m_world);
+		m_frame ++;
+	}
+
+	int m_frame;
+};
+
+static BenchmarkScene* CreateRayCastScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+	DropDebris (world, BENCHMARK_DEBRIS_COUNT, 1.0f);
+	return new BenchmarkRayCastScene (world);
+}
+
+
+// casts the same grid of rays as the raycast scene with one batched call per frame
+class BenchmarkRayCastBatchScene: public BenchmarkScene
+{
+	public:
+	BenchmarkRayCastBatchScene (NewtonWorld* const world)
+		:BenchmarkScene (world)
+		,m_frame(0)
+		,m_hitCount(0)
+	{
+	}
+
+	virtual void PostUpdate (dFloat timestep)
+	{
+		const int side = 64;
+		const dFloat spacing = 0.5f;
+		const dFloat jitter = 0.01f * (m_frame & 31);
+		for (int i = 0; i < BENCHMARK_RAYS_PER_FRAME; i ++) {
+			const dFloat x = ((i % side) - side / 2) * spacing + jitter;
+			const dFloat z = ((i / side) % side - side / 2) * spacing + jitter;
+			NewtonWorldRayCastBatchRay& ray = m_rays[i];
+			ray.m_p0[0] = x;
+			ray.m_p0[1] = 30.0f;
+			ray.m_p0[2] = z;
+			ray.m_p0[3] = 0.0f;
+			ray.m_p1[0] = x;
+			ray.m_p1[1] = -1.0f;
+			ray.m_p1[2] = z;
+			ray.m_p1[3] = 0.0f;
+			ray.m_skipBody = NULL;
+			ray.m_skipFlags = 0;
+		}
+		NewtonWorldRayCastBatch (m_world, m_rays, m_hits, BENCHMARK_RAYS_PER_FRAME, NULL, NULL);
+
+		m_hitCount = 0;
+		for (int i = 0; i < BENCHMARK_RAYS_PER_FRAME; i ++) {
+			m_hitCount += m_hits[i].m_hitBody ? 1 : 0;
+		}
+		m_frame ++;
+	}
+
+	int m_frame;
+	int m_hitCount;
+	NewtonWorldRayCastBatchRay m_rays[BENCHMARK_RAYS_PER_FRAME];
+	NewtonWorldRayCastBatchHit m_hits[BENCHMARK_RAYS_PER_FRAME];
+};
+
+static BenchmarkScene* CreateRayCastBatchScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+	DropDebris (world, BENCHMARK_DEBRIS_COUNT, 1.0f);
+	return new BenchmarkRayCastBatchScene (world);
+}
+
+
+// sweeps a grid of spheres down onto the debris pile and tests a grid of boxes for overlap, one batch each per frame
+class BenchmarkShapeBatchScene: public BenchmarkScene
+{
+	public:
+	BenchmarkShapeBatchScene (NewtonWorld* const world)
+		:BenchmarkScene (world)
+		,m_frame(0)
+		,m_contactCount(0)
+	{
+		m_sphere = NewtonCreateSphere (world, 0.25f, 0, NULL);
+		m_box = NewtonCreateBox (world, 0.5f, 0.5f, 0.5f, 0, NULL);
+	}
+
+	~BenchmarkShapeBatchScene ()
+	{
+		NewtonDestroyCollision (m_sphere);
+		NewtonDestroyCollision (m_box);
+	}
+
+	virtual void PostUpdate (dFloat timestep)
+	{
+		const int side = 32;
+		const dFloat spacing = 0.5f;
+		const dFloat jitter = 0.01f * (m_frame & 31);
+		for (int i = 0; i < BENCHMARK_SHAPE_QUERIES; i ++) {
+			const dFloat x = ((i % side) - side / 2) * spacing + jitter;
+			const dFloat z = ((i / side) % side - side / 2) * spacing + jitter;
+
+			NewtonWorldConvexCastBatchQuery& cast = m_casts[i];
+			dMatrix matrix (dGetIdentityMatrix());
+			matrix.m_posit = dVector (x, 30.0f, z, 1.0f);
+			memcpy (cast.m_matrix, &matrix[0][0], sizeof (cast.m_matrix));
+			cast.m_target[0] = x;
+			cast.m_target[1] = -1.0f;
+			cast.m_target[2] = z;
+			cast.m_target[3] = 0.0f;
+			cast.m_shape = m_sphere;
+			cast.m_skipBody = NULL;
+			cast.m_skipFlags = 0;
+			cast.m_maxContacts = BENCHMARK_SHAPE_CONTACTS;
+
+			NewtonWorldConvexCastBatchQuery& overlap = m_overlaps[i];
+			overlap = cast;
+			overlap.m_matrix[13] = 1.0f;
+			overlap.m_shape = m_box;
+		}
+
+		m_contactCount = NewtonWorldConvexCastBatch (m_world, m_casts, m_results, BENCHMARK_SHAPE_QUERIES, m_contacts, NULL, NULL);
+		m_contactCount += NewtonWorldCollideBatch (m_world, m_overlaps, m_results, BENCHMARK_SHAPE_QUERIES, m_contacts, NULL, NULL);
+		m_frame ++;
+	}
+
+	int m_frame;
+	int m_contactCount;
+	NewtonCollision* m_sphere;
+	NewtonCollision* m_box;
+	NewtonWorldConvexCastBatchQuery m_casts[BENCHMARK_SHAPE_QUERIES];
+	NewtonWorldConvexCastBatchQuery m_overlaps[BENCHMARK_SHAPE_QUERIES];
+	NewtonWorldConvexCastBatchResult m_results[BENCHMARK_SHAPE_QUERIES];
+	NewtonWorldConvexCastReturnInfo m_contacts[BENCHMARK_SHAPE_QUERIES * BENCHMARK_SHAPE_CONTACTS];
+};
+
+static BenchmarkScene* CreateShapeBatchScene (NewtonWorld* const world)
+{
+	CreateFloor (world, 200.0f);
+	DropDebris (world, BENCHMARK_DEBRIS_COUNT, 1.0f);
+	return new BenchmarkShapeBatchScene (world);
+}
+
+
+// long rays over a large height field, half pass above the terrain and half come down onto it far away,
+// a small patch of the terrain is raised every frame so the elevation bounds are also updated
+class BenchmarkTerrainRaysScene: public BenchmarkScene
+{
+	public:
+	BenchmarkTerrainRaysScene (NewtonWorld* const world, NewtonBody* const terrain)
+		:BenchmarkScene (world)
+		,m_terrain(terrain)
+		,m_frame(0)
+		,m_hitCount(0)
+	{
+	}
+
+	static dFloat RayFilter (const NewtonBody* const body, const NewtonCollision* const shapeHit, const dFloat* const hitContact, const dFloat* const hitNormal, dLong collisionID, void* const userData, dFloat intersectParam)
+	{
+		dFloat* const param = (dFloat*) userData;
+		if (intersectParam < *param) {
+			*param = intersectParam;
+		}
+		return *param;
+	}
+
+	virtual void PostUpdate (dFloat timestep)
+	{
+		NewtonCollision* const heightField = NewtonBodyGetCollision (m_terrain);
+		NewtonCollisionInfoRecord info;
+		NewtonCollisionGetInfo (heightField, &info);
+		dFloat* const elevation = (dFloat*) info.m_heightField.m_vertialElevation;
+		const int x0 = (m_frame * 37) % (BENCHMARK_TERRAIN_SIZE - 8);
+		const int z0 = (m_frame * 53) % (BENCHMARK_TERRAIN_SIZE - 8);
+		for (int z = z0; z < z0 + 8; z ++) {
+			for (int x = x0; x < x0 + 8; x ++) {
+				elevation[z * BENCHMARK_TERRAIN_SIZE + x] += 0.01f;
+			}
+		}
+		NewtonHeightFieldUpdateElevations (heightField, x0, z0, x0 + 7, z0 + 7);
+
+		const dFloat extend = 0.5f * (BENCHMARK_TERRAIN_SIZE - 1);
+		const dFloat jitter = 0.01f * (m_frame & 31);
+		m_hitCount = 0;
+		for (int i = 0; i < BENCHMARK_TERRAIN_RAYS; i ++) {
+			const dFloat x = (i * 3.7f - extend) + jitter;
+			const dFloat y = (i & 1) ? 20.0f : 3.0f;
+			const dVector p0 (x, y, -extend, 0.0f);
+			const dVector p1 (-x, (i & 1) ? 20.0f : -4.0f, extend, 0.0f);
+			dFloat param = 1.2f;
+			NewtonWorldRayCast (m_world, &p0[0], &p1[0], RayFilter, &param, NULL, 0);
+			m_hitCount += (param < 1.0f) ? 1 : 0;
+		}
+		m_frame ++;
+	}
+
+	NewtonBody* m_terrain;
+	int m_frame;
+	int m_hitCount;
+};
+
+static BenchmarkScene* CreateTerrainRaysScene (NewtonWorld* const world)
+{
+	const int size = BENCHMARK_TERRAIN_SIZE;
+	const dFloat cellSize = 1.0f;
+	dFloat* const elevation = new dFloat[size * size];
+	char* const attributes = new char[size * size];
+	memset (attributes, 0, size * size * sizeof (char));
+
+	const dFloat offset = -0.5f * cellSize * (size - 1);
+	for (int z = 0; z < size; z ++) {
+		for (int x = 0; x < size; x ++) {
+			elevation[z * size + x] = TerrainElevation (offset + x * cellSize, offset + z * cellSize);
+		}
+	}
+
+	NewtonCollision* const heightField = NewtonCreateHeightFieldCollision (world, size, size, 1, 0, elevation, attributes, 1.0f, cellSize, cellSize, 0);
+	dMatrix matrix (dGetIdentityMatrix());
+	matrix.m_posit = dVector (offset, 0.0f, offset, 1.0f);
+	NewtonBody* const terrain = CreateRigidBody (world, heightField, matrix, 0.0f);
+	NewtonDestroyCollision (heightField);
+
+	delete[] attributes;
+	delete[] elevation;
+
+	return new BenchmarkTerrainRaysScene (world, terrain);
+}
+
+
+// a 65536 x 65536 tiled height field generated on demand, the full grid would need 20 gigabytes. debris falls
+// on the four tiles at the center and rays sweep a window that moves along the terrain, so new tiles keep
+// paging in while the least recently used ones are dropped
+class BenchmarkTiledTerrainScene: public BenchmarkScene
+{
+	public:
+	BenchmarkTiledTerrainScene (NewtonWorld* const world, NewtonBody* const terrain)
+		:BenchmarkScene (world)
+		,m_terrain(terrain)
+		,m_frame(0)
+		,m_hitCount(0)
+	{
+	}
+
+	static void GeneratePage (void* const userData, int x0, int z0, int width, int height, void* const elevation, char* const attributes)
+	{
+		dFloat* const page = (dFloat*) elevation;
+		const dFloat offset = -0.5f * (BENCHMARK_TILED_TERRAIN_SIZE - 1);
+		for (int z = 0; z < height; z ++) {
+			for (int x = 0; x < width; x ++) {
+				page[z * width + x] = TerrainElevation (offset + x0 + x, offset + z0 + z);
+			}
+		}
+		memset (attributes, 0, width * height * sizeof (char));
+	}
+
+	virtual void PostUpdate (dFloat timestep)
+	{
+		const dFloat size = 1024.0f;
+		const dFloat sweep = 64.0f * m_frame;
+		m_hitCount = 0;
+		for (int i = 0; i < BENCHMARK_TERRAIN_RAYS; i ++) {
+			const dFloat x = sweep + (i & 15) * size / 16.0f;
+			const dFloat z = (i >> 4) * size / 16.0f - 0.5f * size;
+			const dVector p0 (x, 20.0f, z, 0.0f);
+			const dVector p1 (x + 40.0f, -4.0f, z + 30.0f, 0.0f);
+			dFloat param = 1.2f;
+			NewtonWorldRayCast (m_world, &p0[0], &p1[0], BenchmarkTerrainRaysScene::RayFilter, &param, NULL, 0);
+			m_hitCount += (param < 1.0f) ? 1 : 0;
+		}
+		dAssert (NewtonTiledHeightFieldGetResidentTileCount (NewtonBodyGetCollision (m_terrain)) <= BENCHMARK_TILED_TERRAIN_CACHE);
+		m_frame ++;
+	}
+
+	NewtonBody* m_terrain;
+	int m_frame;
+	int m_hitCount;
+};
+
+static BenchmarkScene* CreateTiledTerrainScene (NewtonWorld* const world)
+{
+	const int size = BENCHMARK_TILED_TERRAIN_SIZE;
+	NewtonCollision* const heightField = NewtonCreateTiledHeightFieldCollision (world, size, size, BENCHMARK_TILED_TERRAIN_TILE, 1, 0, 1.0f, 1.0f, 1.0f, -2.5f, 2.5f,
+																				BENCHMARK_TILED_TERRAIN_CACHE, BenchmarkTiledTerrainScene::GeneratePage, NULL, 0);
+	const dFloat offset = -0.5f * (size - 1);
+	dMatrix matrix (dGetIdentityMatrix());
+	matrix.m_posit = dVector (offset, 0.0f, offset, 1.0f);
+	NewtonBody* const terrain = CreateRigidBody (world, heightField, matrix, 0.0f);
+	NewtonDestroyCollision (heightField);
+
+	DropDebris (world, BENCHMARK_DEBRIS_COUNT, 4.0f);
+	return new BenchmarkTiledTerrainScene (world, terrain);
+}
+
+
+BenchmarkSceneDescriptor benchmarkScenes[] =
+{
+	{"stacking", "jenga towers and a box pyramid", CreateStackingScene},
+	{"ragdoll", "pile of 48 ragdolls", CreateRagdollScene},
+	{"heightfield", "debris falling on a height field", CreateHeightFieldScene},
+	{"mesh", "debris falling on a polygon soup", CreateMeshScene},
+	{"vehicles", "32 hinged four wheel vehicles", CreateVehiclesScene},
+	{"island", "block of 1008 touching boxes, one island of more than 10000 contacts", CreateIslandScene},
+	{"spheres", "1000 spheres poured into a bin", CreateSpheresScene},
+	{"raycast", "debris pile with 4096 rays per frame", CreateRayCastScene},
+	{"raybatch", "debris pile with 4096 batched rays per frame", CreateRayCastBatchScene},
+	{"shapebatch", "debris pile with 1024 batched sphere casts and box overlaps per frame", CreateShapeBatchScene},
+	{"terrainrays", "256 long rays per frame over a 1024 x 1024 height field", CreateTerrainRaysScene},
+	{"tiledterrain", "debris and 256 rays per frame over a 65536 x 65536 tiled height field", CreateTiledTerrainScene},
+};
+
+int benchmarkScenesCount = sizeof (benchmarkScenes) / sizeof (benchmarkScenes[0]);
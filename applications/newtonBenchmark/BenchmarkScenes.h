@@ -0,0 +1,52 @@
+/* Copyright (c) <2003-2016> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#ifndef __BENCHMARK_SCENES_H__
+#define __BENCHMARK_SCENES_H__
+
+#include "benchmark_stdafx.h"
+
+// a scene populates a newly created world, it is deleted before the world is destroyed
+class BenchmarkScene
+{
+	public:
+	BenchmarkScene (NewtonWorld* const world)
+		:m_world(world)
+	{
+	}
+
+	virtual ~BenchmarkScene()
+	{
+	}
+
+	// called after each world update, it is part of the measured frame time
+	virtual void PostUpdate (dFloat timestep)
+	{
+	}
+
+	protected:
+	NewtonWorld* m_world;
+};
+
+typedef BenchmarkScene* (*BenchmarkSceneCreate) (NewtonWorld* const world);
+
+class BenchmarkSceneDescriptor
+{
+	public:
+	const char* m_name;
+	const char* m_description;
+	BenchmarkSceneCreate m_create;
+};
+
+extern BenchmarkSceneDescriptor benchmarkScenes[];
+extern int benchmarkScenesCount;
+
+#endif
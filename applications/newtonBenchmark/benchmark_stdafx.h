@@ -0,0 +1,26 @@
+/* Copyright (c) <2003-2016> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+#ifndef __BENCHMARK_STDAFX_H__
+#define __BENCHMARK_STDAFX_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <thread>
+
+#include <Newton.h>
+#include <dVector.h>
+#include <dMatrix.h>
+
+#endif
@@ -0,0 +1,235 @@
+/* Copyright (c) <2003-2016> <Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely
+*/
+
+// headless benchmark, steps each scene a fixed number of frames for
+// every requested thread count and prints the results as json to stdout.
+// usage: newtonBenchmark [-frames n] [-threads 1,2,4] [-scenes stacking,mesh] [-solver n] [-broadphase n] [-device n] [-parallel] [-list]
+// -parallel lets all threads work on big islands (NewtonSetMultiThreadSolverOnSingleIsland)
+// the mean height and the kinetic energy of the dynamic bodies at the last frame are printed so that 
+// runs with different solver settings can be checked against each other.
+// runs with more threads than the machine has hardware threads are flagged as oversubscribed,
+// their timings only show the threading overhead and say nothing about multi core scaling
+
+#include "benchmark_stdafx.h"
+#include "BenchmarkScenes.h"
+
+#define BENCHMARK_MAX_THREAD_COUNTS		16
+#define BENCHMARK_TIMESTEP				(1.0f / 60.0f)
+
+
+class BenchmarkResult
+{
+	public:
+	double m_msPerFrame;
+	double m_worstMsPerFrame;
+	int m_bodies;
+	int m_joints;
+	int m_contacts;
+	dLong m_memory;
+	double m_meanHeight;
+	double m_kineticEnergy;
+};
+
+static int CountContacts (NewtonWorld* const world)
+{
+	// each contact joint is visited from both bodies, only count it from body0
+	int count = 0;
+	for (NewtonBody* body = NewtonWorldGetFirstBody (world); body; body = NewtonWorldGetNextBody (world, body)) {
+		for (NewtonJoint* joint = NewtonBodyGetFirstContactJoint (body); joint; joint = NewtonBodyGetNextContactJoint (body, joint)) {
+			if (NewtonJointGetBody0 (joint) == body) {
+				count += NewtonContactJointGetContactCount (joint);
+			}
+		}
+	}
+	return count;
+}
+
+static void MeasureBodies (NewtonWorld* const world, BenchmarkResult& result)
+{
+	int count = 0;
+	double height = 0.0;
+	double energy = 0.0;
+	for (NewtonBody* body = NewtonWorldGetFirstBody (world); body; body = NewtonWorldGetNextBody (world, body)) {
+		dFloat Ixx;
+		dFloat Iyy;
+		dFloat Izz;
+		dFloat mass;
+		NewtonBodyGetMass (body, &mass, &Ixx, &Iyy, &Izz);
+		if (mass > 0.0f) {
+			dMatrix matrix;
+			dVector veloc (0.0f);
+			dVector omega (0.0f);
+			NewtonBodyGetMatrix (body, &matrix[0][0]);
+			NewtonBodyGetVelocity (body, &veloc[0]);
+			NewtonBodyGetOmega (body, &omega[0]);
+			height += matrix.m_posit.m_y;
+			energy += 0.5f * (mass * veloc.DotProduct3 (veloc) + Ixx * omega.m_x * omega.m_x + Iyy * omega.m_y * omega.m_y + Izz * omega.m_z * omega.m_z);
+			count ++;
+		}
+	}
+	result.m_meanHeight = count ? height / count : 0.0;
+	result.m_kineticEnergy = energy;
+}
+
+static void RunScene (const BenchmarkSceneDescriptor& descriptor, int threads, int frames, int solverModel, int broadphase, int device, int parallelIsland, BenchmarkResult& result)
+{
+	NewtonWorld* const world = NewtonCreate ();
+	NewtonSetThreadsCount (world, threads);
+	NewtonSetSolverModel (world, solverModel);
+	NewtonSelectBroadphaseAlgorithm (world, broadphase);
+	NewtonSetCurrentDevice (world, device);
+	NewtonSetMultiThreadSolverOnSingleIsland (world, parallelIsland);
+
+	BenchmarkScene* const scene = descriptor.m_create (world);
+
+	double total = 0.0;
+	double worst = 0.0;
+	for (int i = 0; i < frames; i ++) {
+		std::chrono::steady_clock::time_point start (std::chrono::steady_clock::now());
+		NewtonUpdate (world, BENCHMARK_TIMESTEP);
+		scene->PostUpdate (BENCHMARK_TIMESTEP);
+		const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		total += ms;
+		worst = (ms > worst) ? ms : worst;
+	}
+
+	result.m_msPerFrame = frames ? total / frames : 0.0;
+	result.m_worstMsPerFrame = worst;
+	result.m_bodies = NewtonWorldGetBodyCount (world);
+	result.m_joints = NewtonWorldGetConstraintCount (world);
+	result.m_contacts = CountContacts (world);
+	result.m_memory = NewtonGetMemoryUsed64 ();
+	MeasureBodies (world, result);
+
+	delete scene;
+	NewtonDestroy (world);
+}
+
+static bool IsSceneSelected (const char* const list, const char* const name)
+{
+	if (!list) {
+		return true;
+	}
+	const size_t length = strlen (name);
+	for (const char* ptr = strstr (list, name); ptr; ptr = strstr (ptr + 1, name)) {
+		const bool start = (ptr == list) || (ptr[-1] == ',');
+		const bool end = (ptr[length] == 0) || (ptr[length] == ',');
+		if (start && end) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static int ParseThreadCounts (const char* const list, int* const threadCounts)
+{
+	int count = 0;
+	for (const char* ptr = list; ptr && *ptr && (count < BENCHMARK_MAX_THREAD_COUNTS);) {
+		const int threads = atoi (ptr);
+		if (threads > 0) {
+			threadCounts[count] = threads;
+			count ++;
+		}
+		ptr = strchr (ptr, ',');
+		ptr = ptr ? ptr + 1 : NULL;
+	}
+	return count;
+}
+
+static void Usage ()
+{
+	fprintf (stderr, "usage: newtonBenchmark [-frames n] [-threads 1,2,4] [-scenes name,name] [-solver n] [-broadphase n] [-device n] [-parallel] [-list]\n");
+}
+
+int main (int argc, char** argv)
+{
+	int frames = 300;
+	int solverModel = 4;
+	int broadphase = NEWTON_BROADPHASE_DEFAULT;
+	int device = 0;
+	int parallelIsland = 0;
+	int threadCounts[BENCHMARK_MAX_THREAD_COUNTS];
+	int threadCountsCount = 1;
+	const char* sceneList = NULL;
+	threadCounts[0] = 1;
+
+	for (int i = 1; i < argc; i ++) {
+		const bool hasValue = (i + 1) < argc;
+		if (!strcmp (argv[i], "-frames") && hasValue) {
+			i ++;
+			frames = atoi (argv[i]);
+		} else if (!strcmp (argv[i], "-threads") && hasValue) {
+			i ++;
+			threadCountsCount = ParseThreadCounts (argv[i], threadCounts);
+		} else if (!strcmp (argv[i], "-scenes") && hasValue) {
+			i ++;
+			sceneList = argv[i];
+		} else if (!strcmp (argv[i], "-solver") && hasValue) {
+			i ++;
+			solverModel = atoi (argv[i]);
+		} else if (!strcmp (argv[i], "-broadphase") && hasValue) {
+			i ++;
+			broadphase = atoi (argv[i]);
+		} else if (!strcmp (argv[i], "-device") && hasValue) {
+			i ++;
+			device = atoi (argv[i]);
+		} else if (!strcmp (argv[i], "-parallel")) {
+			parallelIsland = 1;
+		} else if (!strcmp (argv[i], "-list")) {
+			for (int j = 0; j < benchmarkScenesCount; j ++) {
+				printf ("%-12s %s\n", benchmarkScenes[j].m_name, benchmarkScenes[j].m_description);
+			}
+			return 0;
+		} else {
+			Usage ();
+			return 1;
+		}
+	}
+
+	if (!threadCountsCount || (frames < 0)) {
+		Usage ();
+		return 1;
+	}
+
+	// zero when the count is not known, nothing is flagged then
+	const int hardwareThreads = int (std::thread::hardware_concurrency());
+	int major = NewtonWorldGetVersion () / 100;
+	int minor = NewtonWorldGetVersion () % 100;
+	printf ("{\n");
+	printf ("  \"version\": \"%d.%02d\",\n", major, minor);
+	printf ("  \"frames\": %d,\n", frames);
+	printf ("  \"solverModel\": %d,\n", solverModel);
+	printf ("  \"broadphase\": %d,\n", broadphase);
+	printf ("  \"device\": %d,\n", device);
+	printf ("  \"parallelIsland\": %d,\n", parallelIsland);
+	printf ("  \"hardwareThreads\": %d,\n", hardwareThreads);
+	printf ("  \"results\": [");
+
+	const char* separator = "\n";
+	for (int i = 0; i < benchmarkScenesCount; i ++) {
+		const BenchmarkSceneDescriptor& descriptor = benchmarkScenes[i];
+		if (!IsSceneSelected (sceneList, descriptor.m_name)) {
+			continue;
+		}
+		for (int j = 0; j < threadCountsCount; j ++) {
+			BenchmarkResult result;
+			RunScene (descriptor, threadCounts[j], frames, solverModel, broadphase, device, parallelIsland, result);
+			const bool oversubscribed = (hardwareThreads > 0) && (threadCounts[j] > hardwareThreads);
+			printf ("%s    {\"scene\": \"%s\", \"threads\": %d, \"oversubscribed\": %s, \"msPerFrame\": %.4f, \"worstMsPerFrame\": %.4f, \"bodies\": %d, \"joints\": %d, \"contacts\": %d, \"memory\": %lld, \"meanHeight\": %.4f, \"kineticEnergy\": %.4f}",
+					separator, descriptor.m_name, threadCounts[j], oversubscribed ? "true" : "false", result.m_msPerFrame, result.m_worstMsPerFrame,
+					result.m_bodies, result.m_joints, result.m_contacts, (long long) result.m_memory, result.m_meanHeight, result.m_kineticEnergy);
+			separator = ",\n";
+			fflush (stdout);
+		}
+	}
+	printf ("\n  ]\n}\n");
+	return 0;
+}
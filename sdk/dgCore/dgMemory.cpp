@@ -25,18 +25,26 @@
 #include "dgMemory.h"
 
 
-#ifdef _DEBUG
-static dgInt32 m_threadSanityCheck = 0;
-#define DG_MEMORY_THREAD_SANITY_CHECK_LOCK()		\
-	dgAssert (!m_threadSanityCheck);				\
-	dgAtomicExchangeAndAdd(&m_threadSanityCheck, 1);
-	#define DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK()	  dgAtomicExchangeAndAdd(&m_threadSanityCheck, -1);	
-#else 
-	#define DG_MEMORY_THREAD_SANITY_CHECK_LOCK()
-	#define DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK()
+#ifdef _MSC_VER
+	#define DG_THREAD_LOCAL __declspec(thread)
+#else
+	#define DG_THREAD_LOCAL __thread
 #endif
 
 
+// threads are spread over the cache slots in the order they first allocate, 
+// two threads sharing a slot is still safe because each slot has its own lock 
+static dgInt32 dgGetThreadCacheSlot()
+{
+	static dgInt32 threadCount = 0;
+	static DG_THREAD_LOCAL dgInt32 slot = -1;
+	if (slot < 0) {
+		slot = dgAtomicExchangeAndAdd(&threadCount, 1) & (DG_MEMORY_THREAD_CACHE_SLOTS - 1);
+	}
+	return slot;
+}
+
+
 class dgMemoryAllocator::dgMemoryBin
 {
 	public:
@@ -110,6 +118,18 @@ class dgGlobalAllocator: public dgMemoryAllocator, public dgList<dgMemoryAllocat
 		free (ptr);
 	}
 
+	// the only small blocks here are the allocator list nodes, keeping them out of 
+	// the bins and thread caches means nothing is left behind when the list empties
+	void *Malloc (dgInt32 memsize)
+	{
+		return MallocLow (memsize);
+	}
+
+	void Free (void* const retPtr)
+	{
+		FreeLow (retPtr);
+	}
+
 	void operator delete (void* const ptr)
 	{
 		dgAssert (0);
@@ -118,9 +138,9 @@ class dgGlobalAllocator: public dgMemoryAllocator, public dgList<dgMemoryAllocat
 	}
 
 
-	dgInt32 GetMemoryUsed () const
+	dgInt64 GetMemoryUsed () const
 	{
-		dgInt32 mem = m_memoryUsed;
+		dgInt64 mem = m_memoryUsed;
 		for (dgList<dgMemoryAllocator*>::dgListNode* node = GetFirst(); node; node = node->GetNext()) {
 			mem += node->GetInfo()->GetMemoryUsed();
 		}
@@ -139,6 +159,7 @@ class dgGlobalAllocator: public dgMemoryAllocator, public dgList<dgMemoryAllocat
 
 dgMemoryAllocator::dgMemoryAllocator ()
 	:m_emumerator(0)
+	,m_lock(0)
 	,m_memoryUsed(0)
 	,m_isInList(true)
 	,m_free(NULL)
@@ -146,11 +167,13 @@ dgMemoryAllocator::dgMemoryAllocator ()
 {
 	SetAllocatorsCallback (dgGlobalAllocator::GetGlobalAllocator().m_malloc, dgGlobalAllocator::GetGlobalAllocator().m_free);
 	memset (m_memoryDirectory, 0, sizeof (m_memoryDirectory));
+	memset (m_threadCache, 0, sizeof (m_threadCache));
 	dgGlobalAllocator::GetGlobalAllocator().Append(this);
 }
 
 dgMemoryAllocator::dgMemoryAllocator (dgMemAlloc memAlloc, dgMemFree memFree)
 	:m_emumerator(0)
+	,m_lock(0)
 	,m_memoryUsed(0)
 	,m_isInList(false)
 	,m_free(NULL)
@@ -158,6 +181,7 @@ dgMemoryAllocator::dgMemoryAllocator (dgMemAlloc memAlloc, dgMemFree memFree)
 {
 	SetAllocatorsCallback (memAlloc, memFree);
 	memset (m_memoryDirectory, 0, sizeof (m_memoryDirectory));
+	memset (m_threadCache, 0, sizeof (m_threadCache));
 }
 
 
@@ -166,6 +190,7 @@ dgMemoryAllocator::~dgMemoryAllocator  ()
 	if (m_isInList) {
 		dgGlobalAllocator::GetGlobalAllocator().Remove(this);
 	}
+	FlushThreadCaches();
 	dgAssert (m_memoryUsed == 0);
 }
 
@@ -181,7 +206,7 @@ void dgMemoryAllocator::operator delete (void* const ptr)
 }
 
 
-dgInt32 dgMemoryAllocator::GetMemoryUsed() const
+dgInt64 dgMemoryAllocator::GetMemoryUsed() const
 {
 	return m_memoryUsed;
 }
@@ -212,7 +237,7 @@ void *dgMemoryAllocator::MallocLow (dgInt32 workingSize, dgInt32 alignment)
 	dgMemoryInfo* const info = ((dgMemoryInfo*) (retPtr)) - 1;
 	info->SaveInfo(this, ptr, size, m_emumerator, workingSize);
 
-	dgAtomicExchangeAndAdd (&m_memoryUsed, size);
+	dgAtomicExchangeAndAdd (&m_memoryUsed, dgInt64 (size));
 	return retPtr;
 }
 
@@ -221,7 +246,7 @@ void dgMemoryAllocator::FreeLow (void* const retPtr)
 	dgMemoryInfo* const info = ((dgMemoryInfo*) (retPtr)) - 1;
 	dgAssert (info->m_allocator == this);
 
-	dgAtomicExchangeAndAdd (&m_memoryUsed, -info->m_size);
+	dgAtomicExchangeAndAdd (&m_memoryUsed, -dgInt64 (info->m_size));
 
 #ifdef _DEBUG
 	memset (retPtr, 0, info->m_workingSize);
@@ -230,6 +255,141 @@ void dgMemoryAllocator::FreeLow (void* const retPtr)
 	m_free (info->m_ptr, dgUnsigned32 (info->m_size));
 }
 
+// takes one block from the shared directory, the caller must hold m_lock
+void* dgMemoryAllocator::MallocShared (dgInt32 entry, dgInt32 memsize)
+{
+	const dgInt32 paddedSize = entry << DG_MEMORY_GRANULARITY_BITS;
+	if (!m_memoryDirectory[entry].m_cache) {
+		dgMemoryBin* const bin = (dgMemoryBin*) MallocLow (sizeof (dgMemoryBin));
+
+		dgInt32 count = dgInt32 (sizeof (bin->m_pool) / paddedSize);
+		bin->m_info.m_count = 0;
+		bin->m_info.m_totalCount = count;
+		bin->m_info.m_stepInBites = paddedSize;
+		bin->m_info.m_next = m_memoryDirectory[entry].m_first;
+		bin->m_info.m_prev = NULL;
+		if (bin->m_info.m_next) {
+			bin->m_info.m_next->m_info.m_prev = bin;
+		}
+
+		m_memoryDirectory[entry].m_first = bin;
+
+		dgInt8* charPtr = reinterpret_cast<dgInt8*>(bin->m_pool);
+		m_memoryDirectory[entry].m_cache = (dgMemoryCacheEntry*)charPtr;
+
+		for (dgInt32 i = 0; i < count; i ++) {
+			dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) charPtr;
+			cashe->m_next = (dgMemoryCacheEntry*) (charPtr + paddedSize);
+			cashe->m_prev = (dgMemoryCacheEntry*) (charPtr - paddedSize);
+			dgMemoryInfo* const info = ((dgMemoryInfo*) (charPtr + DG_MEMORY_GRANULARITY)) - 1;						
+			info->SaveInfo(this, bin, entry, m_emumerator, memsize);
+			charPtr += paddedSize;
+		}
+		dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) (charPtr - paddedSize);
+		cashe->m_next = NULL;
+		m_memoryDirectory[entry].m_cache->m_prev = NULL;
+	}
+
+
+	dgAssert (m_memoryDirectory[entry].m_cache);
+
+	dgMemoryCacheEntry* const cashe = m_memoryDirectory[entry].m_cache;
+	m_memoryDirectory[entry].m_cache = cashe->m_next;
+	if (cashe->m_next) {
+		cashe->m_next->m_prev = NULL;
+	}
+
+	void* const ptr = ((dgInt8*)cashe) + DG_MEMORY_GRANULARITY;
+
+	dgMemoryInfo* const info = ((dgMemoryInfo*) (ptr)) - 1;
+	dgAssert (info->m_allocator == this);
+
+	dgMemoryBin* const bin = (dgMemoryBin*) info->m_ptr;
+	bin->m_info.m_count ++;
+	return ptr;
+}
+
+// returns one block to the shared directory, the caller must hold m_lock
+void dgMemoryAllocator::FreeShared (void* const retPtr)
+{
+	dgMemoryInfo* const info = ((dgMemoryInfo*) (retPtr)) - 1;
+	dgAssert (info->m_allocator == this);
+
+	dgInt32 entry = info->m_size;
+	dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) (((char*)retPtr) - DG_MEMORY_GRANULARITY) ;
+
+	dgMemoryCacheEntry* const tmpCashe = m_memoryDirectory[entry].m_cache;
+	if (tmpCashe) {
+		dgAssert (!tmpCashe->m_prev);
+		tmpCashe->m_prev = cashe;
+	}
+	cashe->m_next = tmpCashe;
+	cashe->m_prev = NULL;
+
+	m_memoryDirectory[entry].m_cache = cashe;
+
+	dgMemoryBin* const bin = (dgMemoryBin *) info->m_ptr;
+
+	dgAssert (bin);
+	bin->m_info.m_count --;
+	if (bin->m_info.m_count == 0) {
+
+		dgInt32 count = bin->m_info.m_totalCount;
+		dgInt32 sizeInBytes = bin->m_info.m_stepInBites;
+		char* charPtr = bin->m_pool;
+		for (dgInt32 i = 0; i < count; i ++) {
+			dgMemoryCacheEntry* const tmpCashe1 = (dgMemoryCacheEntry*)charPtr;
+			charPtr += sizeInBytes;
+
+			if (tmpCashe1 == m_memoryDirectory[entry].m_cache) {
+				m_memoryDirectory[entry].m_cache = tmpCashe1->m_next;
+			}
+
+			if (tmpCashe1->m_prev) {
+				tmpCashe1->m_prev->m_next = tmpCashe1->m_next;
+			}
+
+			if (tmpCashe1->m_next) {
+				tmpCashe1->m_next->m_prev = tmpCashe1->m_prev;
+			}
+		}
+
+		if (m_memoryDirectory[entry].m_first == bin) {
+			m_memoryDirectory[entry].m_first = bin->m_info.m_next;
+		}
+
+		if (bin->m_info.m_next) {
+			bin->m_info.m_next->m_info.m_prev = bin->m_info.m_prev;
+		}
+		if (bin->m_info.m_prev) {
+			bin->m_info.m_prev->m_info.m_next = bin->m_info.m_next;
+		}
+
+		FreeLow (bin);
+	}
+}
+
+// blocks cached by the threads are still counted as used by their bins, 
+// so they must all go back before the bins can be released
+void dgMemoryAllocator::FlushThreadCaches ()
+{
+	dgSpinLock (&m_lock, true);
+	for (dgInt32 i = 0; i < DG_MEMORY_THREAD_CACHE_SLOTS; i ++) {
+		dgMemoryThreadCache& cache = m_threadCache[i];
+		dgSpinLock (&cache.m_lock, true);
+		for (dgInt32 j = 0; j < DG_MEMORY_BIN_ENTRIES; j ++) {
+			while (cache.m_free[j]) {
+				dgMemoryCacheEntry* const cashe = cache.m_free[j];
+				cache.m_free[j] = cashe->m_next;
+				FreeShared (((dgInt8*)cashe) + DG_MEMORY_GRANULARITY);
+			}
+			cache.m_count[j] = 0;
+		}
+		dgSpinUnlock (&cache.m_lock);
+	}
+	dgSpinUnlock (&m_lock);
+}
+
 // alloca memory on pool that are quantized to DG_MEMORY_GRANULARITY
 // if memory size is larger than DG_MEMORY_BIN_ENTRIES then the memory is not placed into a pool
 void *dgMemoryAllocator::Malloc (dgInt32 memsize)
@@ -246,59 +406,32 @@ void *dgMemoryAllocator::Malloc (dgInt32 memsize)
 	if (entry >= DG_MEMORY_BIN_ENTRIES) {
 		ptr = MallocLow (size);
 	} else {
-		if (!m_memoryDirectory[entry].m_cache) {
-			dgMemoryBin* const bin = (dgMemoryBin*) MallocLow (sizeof (dgMemoryBin));
-
-			dgInt32 count = dgInt32 (sizeof (bin->m_pool) / paddedSize);
-			bin->m_info.m_count = 0;
-			bin->m_info.m_totalCount = count;
-			bin->m_info.m_stepInBites = paddedSize;
-			bin->m_info.m_next = m_memoryDirectory[entry].m_first;
-			bin->m_info.m_prev = NULL;
-			if (bin->m_info.m_next) {
-				bin->m_info.m_next->m_info.m_prev = bin;
+		dgMemoryThreadCache& cache = m_threadCache[dgGetThreadCacheSlot()];
+		dgSpinLock (&cache.m_lock, true);
+		if (!cache.m_free[entry]) {
+			dgSpinLock (&m_lock, true);
+			for (dgInt32 i = 0; i < DG_MEMORY_THREAD_CACHE_BATCH; i ++) {
+				dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) (((dgInt8*)MallocShared (entry, memsize)) - DG_MEMORY_GRANULARITY);
+				cashe->m_next = cache.m_free[entry];
+				cache.m_free[entry] = cashe;
 			}
-
-			m_memoryDirectory[entry].m_first = bin;
-
-			dgInt8* charPtr = reinterpret_cast<dgInt8*>(bin->m_pool);
-			m_memoryDirectory[entry].m_cache = (dgMemoryCacheEntry*)charPtr;
-
-			for (dgInt32 i = 0; i < count; i ++) {
-				dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) charPtr;
-				cashe->m_next = (dgMemoryCacheEntry*) (charPtr + paddedSize);
-				cashe->m_prev = (dgMemoryCacheEntry*) (charPtr - paddedSize);
-				dgMemoryInfo* const info = ((dgMemoryInfo*) (charPtr + DG_MEMORY_GRANULARITY)) - 1;						
-				info->SaveInfo(this, bin, entry, m_emumerator, memsize);
-				charPtr += paddedSize;
-			}
-			dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) (charPtr - paddedSize);
-			cashe->m_next = NULL;
-			m_memoryDirectory[entry].m_cache->m_prev = NULL;
+			dgSpinUnlock (&m_lock);
+			cache.m_count[entry] = DG_MEMORY_THREAD_CACHE_BATCH;
 		}
 
-
-		dgAssert (m_memoryDirectory[entry].m_cache);
-
-		dgMemoryCacheEntry* const cashe = m_memoryDirectory[entry].m_cache;
-		m_memoryDirectory[entry].m_cache = cashe->m_next;
-		if (cashe->m_next) {
-			cashe->m_next->m_prev = NULL;
-		}
+		dgMemoryCacheEntry* const cashe = cache.m_free[entry];
+		cache.m_free[entry] = cashe->m_next;
+		cache.m_count[entry] --;
+		dgSpinUnlock (&cache.m_lock);
 
 		ptr = ((dgInt8*)cashe) + DG_MEMORY_GRANULARITY;
-
-		dgMemoryInfo* info;
-		info = ((dgMemoryInfo*) (ptr)) - 1;
-		dgAssert (info->m_allocator == this);
-
-		dgMemoryBin* const bin = (dgMemoryBin*) info->m_ptr;
-		bin->m_info.m_count ++;
+		dgAssert ((((dgMemoryInfo*) (ptr)) - 1)->m_allocator == this);
 
 		#ifdef __TRACK_MEMORY_LEAKS__
+		dgSpinLock (&m_lock, true);
 		m_leaklTracker.InsertBlock (dgInt32 (memsize), ptr);
+		dgSpinUnlock (&m_lock);
 		#endif
-
 	}
 	return ptr;
 }
@@ -316,70 +449,38 @@ void dgMemoryAllocator::Free (void* const retPtr)
 		FreeLow (retPtr);
 	} else {
 		#ifdef __TRACK_MEMORY_LEAKS__
+		dgSpinLock (&m_lock, true);
 		m_leaklTracker.RemoveBlock (retPtr);
+		dgSpinUnlock (&m_lock);
 		#endif
 
-		dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) (((char*)retPtr) - DG_MEMORY_GRANULARITY) ;
-
-		dgMemoryCacheEntry* const tmpCashe = m_memoryDirectory[entry].m_cache;
-		if (tmpCashe) {
-			dgAssert (!tmpCashe->m_prev);
-			tmpCashe->m_prev = cashe;
-		}
-		cashe->m_next = tmpCashe;
-		cashe->m_prev = NULL;
-
-		m_memoryDirectory[entry].m_cache = cashe;
-
-		dgMemoryBin* const bin = (dgMemoryBin *) info->m_ptr;
-
-		dgAssert (bin);
 #ifdef _DEBUG
-		dgAssert ((bin->m_info.m_stepInBites - DG_MEMORY_GRANULARITY) > 0);
-		memset (retPtr, 0, bin->m_info.m_stepInBites - DG_MEMORY_GRANULARITY);
+		dgAssert (((entry << DG_MEMORY_GRANULARITY_BITS) - DG_MEMORY_GRANULARITY) > 0);
+		memset (retPtr, 0, (entry << DG_MEMORY_GRANULARITY_BITS) - DG_MEMORY_GRANULARITY);
 #endif
 
-		bin->m_info.m_count --;
-		if (bin->m_info.m_count == 0) {
-
-			dgInt32 count = bin->m_info.m_totalCount;
-			dgInt32 sizeInBytes = bin->m_info.m_stepInBites;
-			char* charPtr = bin->m_pool;
-			for (dgInt32 i = 0; i < count; i ++) {
-				dgMemoryCacheEntry* const tmpCashe1 = (dgMemoryCacheEntry*)charPtr;
-				charPtr += sizeInBytes;
-
-				if (tmpCashe1 == m_memoryDirectory[entry].m_cache) {
-					m_memoryDirectory[entry].m_cache = tmpCashe1->m_next;
-				}
-
-				if (tmpCashe1->m_prev) {
-					tmpCashe1->m_prev->m_next = tmpCashe1->m_next;
-				}
-
-				if (tmpCashe1->m_next) {
-					tmpCashe1->m_next->m_prev = tmpCashe1->m_prev;
-				}
-			}
-
-			if (m_memoryDirectory[entry].m_first == bin) {
-				m_memoryDirectory[entry].m_first = bin->m_info.m_next;
-			}
-
-			if (bin->m_info.m_next) {
-				bin->m_info.m_next->m_info.m_prev = bin->m_info.m_prev;
-			}
-			if (bin->m_info.m_prev) {
-				bin->m_info.m_prev->m_info.m_next = bin->m_info.m_next;
+		dgMemoryThreadCache& cache = m_threadCache[dgGetThreadCacheSlot()];
+		dgSpinLock (&cache.m_lock, true);
+		dgMemoryCacheEntry* const cashe = (dgMemoryCacheEntry*) (((char*)retPtr) - DG_MEMORY_GRANULARITY) ;
+		cashe->m_next = cache.m_free[entry];
+		cache.m_free[entry] = cashe;
+		cache.m_count[entry] ++;
+
+		if (cache.m_count[entry] > DG_MEMORY_THREAD_CACHE_BATCH * 2) {
+			dgSpinLock (&m_lock, true);
+			for (dgInt32 i = 0; i < DG_MEMORY_THREAD_CACHE_BATCH; i ++) {
+				dgMemoryCacheEntry* const tmpCashe = cache.m_free[entry];
+				cache.m_free[entry] = tmpCashe->m_next;
+				FreeShared (((dgInt8*)tmpCashe) + DG_MEMORY_GRANULARITY);
 			}
-
-			FreeLow (bin);
+			dgSpinUnlock (&m_lock);
+			cache.m_count[entry] -= DG_MEMORY_THREAD_CACHE_BATCH;
 		}
+		dgSpinUnlock (&cache.m_lock);
 	}
 }
 
 
-
 	// this is a simple memory leak tracker, it uses an flat array of two megabyte indexed by a hatch code
 #ifdef __TRACK_MEMORY_LEAKS__
 
@@ -459,7 +560,7 @@ void dgMemoryAllocator::SetGlobalAllocators (dgMemAlloc malloc, dgMemFree free)
 	dgGlobalAllocator::GetGlobalAllocator().SetAllocatorsCallback (malloc, free);
 }
 
-dgInt32 dgMemoryAllocator::GetGlobalMemoryUsed ()
+dgInt64 dgMemoryAllocator::GetGlobalMemoryUsed ()
 {
 	return dgGlobalAllocator::GetGlobalAllocator().GetMemoryUsed();
 }
@@ -470,17 +571,13 @@ dgInt32 dgMemoryAllocator::GetGlobalMemoryUsed ()
 // but because of many complaint I changed it to use malloc and free
 void* dgApi dgMallocStack (size_t size)
 {
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	void * const ptr = dgGlobalAllocator::GetGlobalAllocator().MallocLow (dgInt32 (size));
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	return ptr;
 }
 
 void* dgApi dgMallocAligned (size_t size, dgInt32 align)
 {
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	void * const ptr = dgGlobalAllocator::GetGlobalAllocator().MallocLow (dgInt32 (size), align);
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	return ptr;
 	
 }
@@ -491,9 +588,7 @@ void* dgApi dgMallocAligned (size_t size, dgInt32 align)
 // but because of many complaint I changed it to use malloc and free
 void  dgApi dgFreeStack (void* const ptr)
 {
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	dgGlobalAllocator::GetGlobalAllocator().FreeLow (ptr);
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 }
 
 
@@ -503,12 +598,10 @@ void* dgApi dgMalloc (size_t size, dgMemoryAllocator* const allocator)
 	void* ptr = NULL;
 	dgAssert (allocator);
 
-	DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 	if (size) {
 		ptr = allocator->Malloc (dgInt32 (size));
 	}
 
-	DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	return ptr;
 }
 
@@ -517,12 +610,10 @@ void* dgApi dgMalloc (size_t size, dgMemoryAllocator* const allocator)
 void dgApi dgFree (void* const ptr)
 {
 	if (ptr) {
-		DG_MEMORY_THREAD_SANITY_CHECK_LOCK();
 		dgMemoryAllocator::dgMemoryInfo* info;
 		info = ((dgMemoryAllocator::dgMemoryInfo*) ptr) - 1; 
 		dgAssert (info->m_allocator);
 		info->m_allocator->Free (ptr);
-		DG_MEMORY_THREAD_SANITY_CHECK_UNLOCK();
 	}
 }
 
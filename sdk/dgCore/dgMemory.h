@@ -75,6 +75,8 @@ class dgMemoryAllocator
 	#define DG_MEMORY_SIZE						(1024 - 64)
 	#define DG_MEMORY_BIN_SIZE					(1024 * 16)
 	#define DG_MEMORY_BIN_ENTRIES				(DG_MEMORY_SIZE / DG_MEMORY_GRANULARITY)
+	#define DG_MEMORY_THREAD_CACHE_SLOTS		16
+	#define DG_MEMORY_THREAD_CACHE_BATCH		16
 
 	public: 
 	class dgMemoryBin;
@@ -88,6 +90,16 @@ class dgMemoryAllocator
 		dgMemoryCacheEntry* m_cache;
 	};
 
+	// small blocks free by a thread are kept here and move to and from the 
+	// shared directory in batches, so that most calls only touch an uncontended lock
+	class dgMemoryThreadCache
+	{
+		public: 
+		dgMemoryCacheEntry* m_free[DG_MEMORY_BIN_ENTRIES + 1];
+		dgInt32 m_count[DG_MEMORY_BIN_ENTRIES + 1];
+		dgInt32 m_lock;
+	};
+
 	// this is a simple memory leak tracker, it uses an flat array of two megabyte indexed by a hatch code
 #ifdef __TRACK_MEMORY_LEAKS__
 	class dgMemoryLeaksTracker
@@ -120,7 +132,7 @@ class dgMemoryAllocator
 
 	void *operator new (size_t size);
 	void operator delete (void* const ptr);
-	dgInt32 GetMemoryUsed() const;
+	dgInt64 GetMemoryUsed() const;
 
 	void SetAllocatorsCallback (dgMemAlloc memAlloc, dgMemFree memFree);
 	virtual void *MallocLow (dgInt32 size, dgInt32 alignment = DG_MEMORY_GRANULARITY);
@@ -128,23 +140,31 @@ class dgMemoryAllocator
 	virtual void *Malloc (dgInt32 memsize);
 	virtual void Free (void* const retPtr);
 
-	static dgInt32 GetGlobalMemoryUsed ();
+	static dgInt64 GetGlobalMemoryUsed ();
 	static void SetGlobalAllocators (dgMemAlloc alloc, dgMemFree free);
 
 	protected:
 	dgMemoryAllocator (bool init)
 	{	
 		m_memoryUsed = 0;
+		m_lock = 0;
 		m_isInList = false;
+		memset (m_threadCache, 0, sizeof (m_threadCache));
 	}
 	dgMemoryAllocator (dgMemAlloc memAlloc, dgMemFree memFree);
 
+	void* MallocShared (dgInt32 entry, dgInt32 memsize);
+	void FreeShared (void* const retPtr);
+	void FlushThreadCaches ();
+
 	dgInt32 m_emumerator;
-	dgInt32 m_memoryUsed;
+	dgInt32 m_lock;
+	dgInt64 m_memoryUsed;
 	bool m_isInList;
 	dgMemFree m_free;
 	dgMemAlloc m_malloc;
 	dgMemDirectory m_memoryDirectory[DG_MEMORY_BIN_ENTRIES + 1]; 
+	dgMemoryThreadCache m_threadCache[DG_MEMORY_THREAD_CACHE_SLOTS];
 
 #ifdef __TRACK_MEMORY_LEAKS__
 	dgMemoryLeaksTracker m_leaklTracker;
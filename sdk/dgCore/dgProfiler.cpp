@@ -0,0 +1,104 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgStdafx.h"
+#include "dgTypes.h"
+#include "dgMemory.h"
+#include "dgProfiler.h"
+
+
+dgProfiler::dgProfiler(dgMemoryAllocator* const allocator)
+	:m_allocator(allocator)
+	,m_frame(0)
+	,m_enabled(false)
+{
+	dgAssert (!(DG_PROFILER_RECORDS_PER_THREAD & (DG_PROFILER_RECORDS_PER_THREAD - 1)));
+	memset (m_threads, 0, sizeof (m_threads));
+}
+
+dgProfiler::~dgProfiler()
+{
+	for (dgInt32 i = 0; i < DG_PROFILER_THREADS_COUNT; i ++) {
+		if (m_threads[i].m_records) {
+			m_allocator->Free (m_threads[i].m_records);
+		}
+	}
+}
+
+// the ring buffers are only allocated the first time the profiler is enabled
+void dgProfiler::SetEnabled (bool state)
+{
+	if (state && !m_threads[0].m_records) {
+		for (dgInt32 i = 0; i < DG_PROFILER_THREADS_COUNT; i ++) {
+			m_threads[i].m_records = (dgRecord*) m_allocator->Malloc (DG_PROFILER_RECORDS_PER_THREAD * sizeof (dgRecord));
+		}
+	}
+	for (dgInt32 i = 0; i < DG_PROFILER_THREADS_COUNT; i ++) {
+		m_threads[i].m_count = 0;
+		m_threads[i].m_depth = 0;
+	}
+	m_enabled = state;
+}
+
+dgInt32 dgProfiler::GetRecordCount (dgInt32 threadIndex) const
+{
+	dgAssert ((threadIndex >= 0) && (threadIndex < DG_PROFILER_THREADS_COUNT));
+	return dgInt32 (dgMin (m_threads[threadIndex].m_count, dgUnsigned32 (DG_PROFILER_RECORDS_PER_THREAD)));
+}
+
+// index zero is the oldest record still in the ring
+const dgProfiler::dgRecord& dgProfiler::GetRecord (dgInt32 threadIndex, dgInt32 index) const
+{
+	dgAssert (index >= 0);
+	dgAssert (index < GetRecordCount (threadIndex));
+	const dgThreadRecords& thread = m_threads[threadIndex];
+	const dgUnsigned32 first = thread.m_count - dgUnsigned32 (GetRecordCount (threadIndex));
+	return thread.m_records[(first + dgUnsigned32 (index)) & (DG_PROFILER_RECORDS_PER_THREAD - 1)];
+}
+
+dgUnsigned64 dgProfiler::BeginScope (dgInt32 threadIndex)
+{
+	dgAssert ((threadIndex >= 0) && (threadIndex < DG_PROFILER_THREADS_COUNT));
+	m_threads[threadIndex].m_depth ++;
+	return GetTicks();
+}
+
+void dgProfiler::EndScope (dgInt32 threadIndex, dgInt32 phase, dgUnsigned64 start)
+{
+	const dgUnsigned64 end = GetTicks();
+	dgThreadRecords& thread = m_threads[threadIndex];
+	thread.m_depth --;
+	dgAssert (thread.m_depth >= 0);
+
+	dgRecord& record = thread.m_records[thread.m_count & (DG_PROFILER_RECORDS_PER_THREAD - 1)];
+	record.m_start = start;
+	record.m_end = end;
+	record.m_phase = phase;
+	record.m_depth = thread.m_depth;
+	record.m_frame = m_frame;
+	thread.m_count ++;
+}
+
+// ticks are in microseconds
+dgUnsigned64 dgProfiler::GetTicks()
+{
+	return dgGetTimeInMicrosenconds();
+}
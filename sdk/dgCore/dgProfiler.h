@@ -0,0 +1,126 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __DG_PROFILER_H__
+#define __DG_PROFILER_H__
+
+#include "dgStdafx.h"
+#include "dgTypes.h"
+#include "dgMemory.h"
+
+#define DG_PROFILER_RECORDS_PER_THREAD	(1024 * 4)
+#define DG_PROFILER_MAIN_THREAD			DG_MAX_THREADS_HIVE_COUNT
+#define DG_PROFILER_THREADS_COUNT		(DG_MAX_THREADS_HIVE_COUNT + 1)
+
+
+// each thread writes the scopes it closes into its own ring buffer, so no locks are needed.
+// worker threads use their hive index, the thread that drives the update uses DG_PROFILER_MAIN_THREAD
+class dgProfiler
+{
+	public:
+	class dgRecord
+	{
+		public:
+		dgUnsigned64 m_start;
+		dgUnsigned64 m_end;
+		dgInt32 m_phase;
+		dgInt32 m_depth;
+		dgUnsigned32 m_frame;
+	};
+
+	dgProfiler(dgMemoryAllocator* const allocator);
+	~dgProfiler();
+
+	bool IsEnabled() const;
+	void SetEnabled (bool state);
+
+	void NextFrame();
+	dgUnsigned32 GetFrame() const;
+
+	dgInt32 GetRecordCount (dgInt32 threadIndex) const;
+	const dgRecord& GetRecord (dgInt32 threadIndex, dgInt32 index) const;
+
+	dgUnsigned64 BeginScope (dgInt32 threadIndex);
+	void EndScope (dgInt32 threadIndex, dgInt32 phase, dgUnsigned64 start);
+
+	static dgUnsigned64 GetTicks();
+
+	private:
+	class dgThreadRecords
+	{
+		public:
+		dgRecord* m_records;
+		dgUnsigned32 m_count;
+		dgInt32 m_depth;
+	};
+
+	dgMemoryAllocator* m_allocator;
+	dgUnsigned32 m_frame;
+	bool m_enabled;
+	dgThreadRecords m_threads[DG_PROFILER_THREADS_COUNT];
+};
+
+
+class dgProfilerScope
+{
+	public:
+	dgProfilerScope (dgProfiler* const profiler, dgInt32 phase, dgInt32 threadIndex)
+		:m_profiler(profiler->IsEnabled() ? profiler : NULL)
+		,m_start(0)
+		,m_phase(phase)
+		,m_threadIndex(threadIndex)
+	{
+		if (m_profiler) {
+			m_start = m_profiler->BeginScope (m_threadIndex);
+		}
+	}
+
+	~dgProfilerScope()
+	{
+		if (m_profiler) {
+			m_profiler->EndScope (m_threadIndex, m_phase, m_start);
+		}
+	}
+
+	private:
+	dgProfiler* m_profiler;
+	dgUnsigned64 m_start;
+	dgInt32 m_phase;
+	dgInt32 m_threadIndex;
+};
+
+
+DG_INLINE bool dgProfiler::IsEnabled() const
+{
+	return m_enabled;
+}
+
+DG_INLINE dgUnsigned32 dgProfiler::GetFrame() const
+{
+	return m_frame;
+}
+
+DG_INLINE void dgProfiler::NextFrame()
+{
+	m_frame ++;
+}
+
+#endif
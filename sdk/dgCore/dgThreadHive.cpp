@@ -25,10 +25,103 @@
 #include "dgThreadHive.h"
 
 
+dgThreadHive::dgThreadJobDeque::dgThreadJobDeque()
+	:m_pool(NULL)
+	,m_allocator(NULL)
+	,m_head(0)
+	,m_tail(0)
+	,m_capacity(0)
+	,m_lock()
+{
+	dgAssert (!(DG_THREAD_BEE_JOB_SIZE & (DG_THREAD_BEE_JOB_SIZE - 1)));
+}
+
+dgThreadHive::dgThreadJobDeque::~dgThreadJobDeque()
+{
+	if (m_pool) {
+		m_allocator->Free(m_pool);
+	}
+}
+
+void dgThreadHive::dgThreadJobDeque::Init (dgMemoryAllocator* const allocator)
+{
+	m_allocator = allocator;
+	m_capacity = DG_THREAD_BEE_JOB_SIZE;
+	m_pool = (dgThreadJob*)m_allocator->Malloc(m_capacity * sizeof (dgThreadJob));
+}
+
+bool dgThreadHive::dgThreadJobDeque::IsFull() const
+{
+	return ((m_tail + 1) & (m_capacity - 1)) == m_head;
+}
+
+void dgThreadHive::dgThreadJobDeque::Grow()
+{
+	// called with the lock taken, the jobs are unrolled from head to tail so their order is kept
+	const dgInt32 count = (m_tail - m_head) & (m_capacity - 1);
+	dgThreadJob* const pool = (dgThreadJob*)m_allocator->Malloc(2 * m_capacity * sizeof (dgThreadJob));
+	for (dgInt32 i = 0; i < count; i ++) {
+		pool[i] = m_pool[(m_head + i) & (m_capacity - 1)];
+	}
+	m_allocator->Free(m_pool);
+	m_pool = pool;
+	m_head = 0;
+	m_tail = count;
+	m_capacity *= 2;
+}
+
+bool dgThreadHive::dgThreadJobDeque::IsEmpty() const
+{
+	return m_head == m_tail;
+}
+
+void dgThreadHive::dgThreadJobDeque::Push (const dgThreadJob& job)
+{
+	m_lock.Lock(false);
+	if (IsFull()) {
+		Grow();
+	}
+	m_pool[m_tail] = job;
+	m_tail = (m_tail + 1) & (m_capacity - 1);
+	m_lock.Unlock();
+}
+
+bool dgThreadHive::dgThreadJobDeque::Pop (dgThreadJob& job)
+{
+	bool state = false;
+	if (!IsEmpty()) {
+		m_lock.Lock(false);
+		if (!IsEmpty()) {
+			m_tail = (m_tail - 1) & (m_capacity - 1);
+			job = m_pool[m_tail];
+			state = true;
+		}
+		m_lock.Unlock();
+	}
+	return state;
+}
+
+bool dgThreadHive::dgThreadJobDeque::Steal (dgThreadJob& job)
+{
+	bool state = false;
+	if (!IsEmpty()) {
+		m_lock.Lock(false);
+		if (!IsEmpty()) {
+			job = m_pool[m_head];
+			m_head = (m_head + 1) & (m_capacity - 1);
+			state = true;
+		}
+		m_lock.Unlock();
+	}
+	return state;
+}
+
+
 dgThreadHive::dgThreadBee::dgThreadBee()
 	:dgThread()
 	,m_isBusy(0)
 	,m_myMutex()
+	,m_jobs()
 	,m_hive(NULL)
 	,m_allocator(NULL)
 {
@@ -47,6 +140,7 @@ void dgThreadHive::dgThreadBee::SetUp(dgMemoryAllocator* const allocator, const
 {
 	m_allocator = allocator;
 	m_hive = hive;
+	m_jobs.Init(allocator);
 	Init (name, id);
 }
 
@@ -78,34 +172,32 @@ void dgThreadHive::dgThreadBee::Execute (dgInt32 threadId)
 
 void dgThreadHive::dgThreadBee::RunNextJobInQueue(dgInt32 threadId)
 {
-	bool isEmpty = false;
-	do {
+	dgAssert (threadId == m_id);
+	// keep working until every queued job and every task released by a completed predecessor is done,
+	// a bee that runs dry yields so that the busy bees get the core when threads outnumber cores
+	while (m_hive->m_pendingJobs) {
 		dgThreadJob job;
-		dgAssert (threadId == m_id);
-		m_hive->m_jobsCriticalSection.Lock(false);
-		isEmpty = m_hive->m_jobsPool.IsEmpty();
-		if (!isEmpty) {
-			job = m_hive->m_jobsPool.GetHead();
-			m_hive->m_jobsPool.Pop();
-		}
-		m_hive->m_jobsCriticalSection.Unlock();
-
-		if (!isEmpty) {
+		if (m_jobs.Pop(job) || m_hive->StealJob(threadId, job)) {
 			job.m_callback (job.m_context0, job.m_context1, m_id);
+			if (job.m_task) {
+				m_hive->ReleaseSuccessors(job.m_task, threadId);
+			}
+			dgAtomicExchangeAndAdd(&m_hive->m_pendingJobs, -1);
+		} else {
+			dgThreadYield();
 		}
-	} while (!isEmpty);
+	}
 }
 
 
 dgThreadHive::dgThreadHive(dgMemoryAllocator* const allocator)
 	:m_beesCount(0)
+	,m_pendingJobs(0)
 	,m_currentIdleBee(0)
 	,m_workerBees(NULL)
 	,m_myMasterThread(NULL)
 	,m_allocator(allocator)
-	,m_jobsCriticalSection()
 	,m_globalCriticalSection()
-    ,m_jobsPool(allocator)
 {
 }
 
@@ -147,6 +239,7 @@ void dgThreadHive::SetThreadsCount (dgInt32 threads)
 		m_beesCount = 0;
 	}
 
+	m_currentIdleBee = 0;
 	if (m_beesCount) {
 		m_workerBees = new (m_allocator) dgThreadBee[dgUnsigned32 (m_beesCount)];
 
@@ -168,14 +261,72 @@ void dgThreadHive::QueueJob (dgWorkerThreadTaskCallback callback, void* const co
 			callback (context0, context1, 0);
 		#else 
 			dgThreadJob job (context0, context1, callback);
-			m_jobsPool.Push(job);
-			if (m_jobsPool.IsFull()) {
-				SynchronizationBarrier ();
+			PushJob (job);
+		#endif
+	}
+}
+
+void dgThreadHive::QueueTask (dgThreadTask* const task)
+{
+	if (!m_beesCount) {
+		dgAssert (!task->m_pendingPredecessors);
+		task->m_callback (task->m_context0, task->m_context1, 0);
+		ReleaseSuccessors (task, 0);
+	} else {
+		#ifdef DG_USE_THREAD_EMULATION
+			dgAssert (!task->m_pendingPredecessors);
+			task->m_callback (task->m_context0, task->m_context1, 0);
+			ReleaseSuccessors (task, 0);
+		#else 
+			// tasks with pending predecessors are pushed by the thread that completes the last one
+			dgAtomicExchangeAndAdd(&m_pendingJobs, 1);
+			if (!task->m_pendingPredecessors) {
+				dgThreadJob job (task->m_context0, task->m_context1, task->m_callback, task);
+				m_workerBees[m_currentIdleBee].m_jobs.Push(job);
+				m_currentIdleBee = (m_currentIdleBee + 1) % m_beesCount;
 			}
 		#endif
 	}
 }
 
+void dgThreadHive::PushJob (const dgThreadJob& job)
+{
+	dgAtomicExchangeAndAdd(&m_pendingJobs, 1);
+	m_workerBees[m_currentIdleBee].m_jobs.Push(job);
+	m_currentIdleBee = (m_currentIdleBee + 1) % m_beesCount;
+}
+
+bool dgThreadHive::StealJob (dgInt32 threadId, dgThreadJob& job)
+{
+	for (dgInt32 i = 1; i < m_beesCount; i ++) {
+		dgInt32 index = threadId + i;
+		index -= (index >= m_beesCount) ? m_beesCount : 0;
+		if (m_workerBees[index].m_jobs.Steal(job)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void dgThreadHive::ReleaseSuccessors (dgThreadTask* const task, dgInt32 threadId)
+{
+	// the first ready successor stays with this bee, the others are dealt to the following bees
+	// so that a task that releases several successors fans them out instead of running them in a row
+	dgInt32 beeIndex = threadId;
+	for (dgInt32 i = 0; i < task->m_successorsCount; i ++) {
+		dgThreadTask* const successor = task->m_successors[i];
+		if (dgAtomicExchangeAndAdd(&successor->m_pendingPredecessors, -1) == 1) {
+			if (m_beesCount) {
+				#ifndef DG_USE_THREAD_EMULATION
+				dgThreadJob job (successor->m_context0, successor->m_context1, successor->m_callback, successor);
+				m_workerBees[beeIndex].m_jobs.Push(job);
+				beeIndex = (beeIndex + 1) % m_beesCount;
+				#endif
+			}
+		}
+	}
+}
+
 
 void dgThreadHive::OnBeginWorkerThread (dgInt32 threadId)
 {
@@ -194,7 +345,8 @@ void dgThreadHive::SynchronizationBarrier ()
 		}
 
 		m_myMasterThread->SuspendExecution(m_beesCount, m_myMutex);
-		dgAssert (m_jobsPool.IsEmpty());
+		dgAssert (!m_pendingJobs);
+		m_currentIdleBee = 0;
 	}
 }
 
@@ -25,12 +25,13 @@
 
 #include "dgThread.h"
 #include "dgMemory.h"
-#include "dgFastQueue.h"
 
 
-
-//#define DG_THREAD_POOL_JOB_SIZE (512)
-#define DG_THREAD_POOL_JOB_SIZE (1024 * 8)
+//#define DG_THREAD_BEE_JOB_SIZE (256)
+// initial size of each bee deque, a deque that fills up doubles its size
+#define DG_THREAD_BEE_JOB_SIZE (1024)
+#define DG_THREAD_TASK_MAX_SUCCESSORS	DG_MAX_THREADS_HIVE_COUNT
+#define DG_PARALLEL_FOR_CHUNKS_PER_THREAD	4
 
 typedef void (*dgWorkerThreadTaskCallback) (void* const context0, void* const context1, dgInt32 threadID);
 
@@ -38,6 +39,45 @@ class dgThreadHive
 {
 	public:
 
+	// a job that can only run after all its predecessors are completed.
+	// tasks are owned by the caller and must be queued in dependency order.
+	class dgThreadTask
+	{
+		public:
+		dgThreadTask()
+			:m_context0(NULL)
+			,m_context1(NULL)
+			,m_callback(NULL)
+			,m_pendingPredecessors(0)
+			,m_successorsCount(0)
+		{
+		}
+
+		dgThreadTask (dgWorkerThreadTaskCallback callback, void* const context0, void* const context1)
+			:m_context0(context0)
+			,m_context1(context1)
+			,m_callback(callback)
+			,m_pendingPredecessors(0)
+			,m_successorsCount(0)
+		{
+		}
+
+		void DependsOn (dgThreadTask* const predecessor)
+		{
+			dgAssert (predecessor->m_successorsCount < DG_THREAD_TASK_MAX_SUCCESSORS);
+			predecessor->m_successors[predecessor->m_successorsCount] = this;
+			predecessor->m_successorsCount ++;
+			m_pendingPredecessors ++;
+		}
+
+		void* m_context0;
+		void* m_context1;
+		dgWorkerThreadTaskCallback m_callback;
+		dgInt32 m_pendingPredecessors;
+		dgInt32 m_successorsCount;
+		dgThreadTask* m_successors[DG_THREAD_TASK_MAX_SUCCESSORS];
+	};
+
 	class dgThreadJob
 	{
 		public:
@@ -45,15 +85,43 @@ class dgThreadHive
 		{
 		}
 
-		dgThreadJob (void* const context0, void* const context1, dgWorkerThreadTaskCallback callback)
+		dgThreadJob (void* const context0, void* const context1, dgWorkerThreadTaskCallback callback, dgThreadTask* const task = NULL)
 			:m_context0(context0)
 			,m_context1(context1)
 			,m_callback(callback)
+			,m_task(task)
 		{
 		}
 		void* m_context0;
 		void* m_context1;
 		dgWorkerThreadTaskCallback m_callback;
+		dgThreadTask* m_task;
+	};
+
+	// each bee owns one of these, the owner pops the newest job and idle bees steal the oldest
+	class dgThreadJobDeque
+	{
+		public:
+		dgThreadJobDeque();
+		~dgThreadJobDeque();
+
+		void Init (dgMemoryAllocator* const allocator);
+		bool IsEmpty() const;
+
+		void Push (const dgThreadJob& job);
+		bool Pop (dgThreadJob& job);
+		bool Steal (dgThreadJob& job);
+
+		private:
+		bool IsFull() const;
+		void Grow();
+
+		dgThreadJob* m_pool;
+		dgMemoryAllocator* m_allocator;
+		dgInt32 m_head;
+		dgInt32 m_tail;
+		dgInt32 m_capacity;
+		dgThread::dgCriticalSection m_lock;
 	};
 
 
@@ -73,6 +141,7 @@ class dgThreadHive
 
 		dgInt32 m_isBusy;
 		dgSemaphore m_myMutex;
+		dgThreadJobDeque m_jobs;
 		dgThreadHive* m_hive;
 		dgMemoryAllocator* m_allocator; 
 	};
@@ -96,20 +165,65 @@ class dgThreadHive
 	void SetThreadsCount (dgInt32 count);
 
 	void QueueJob (dgWorkerThreadTaskCallback callback, void* const context0, void* const context1);
+	void QueueTask (dgThreadTask* const task);
 	void SynchronizationBarrier ();
 
+	// calls kernel (start, end, threadID) over sub ranges of [start, end) on all threads, 
+	// chunks start large and shrink as the range runs out so that only one atomic is paid per chunk
+	template <class dgKernel>
+	void ParallelFor (const dgKernel& kernel, dgInt32 start, dgInt32 end, dgInt32 minChunkSize = 1);
+
 	private:
+	template <class dgKernel>
+	class dgParallelForDescriptor
+	{
+		public:
+		const dgKernel* m_kernel;
+		dgInt32 m_end;
+		dgInt32 m_minChunkSize;
+		dgInt32 m_chunkDivisor;
+		dgInt32 m_index;
+	};
+
+	public:
+	// a ParallelFor that is a node of a task graph, one task per thread claims chunks of the range.
+	// the range can be set by a predecessor, so a phase can size the phase that follows it.
+	template <class dgKernel>
+	class dgParallelForTasks
+	{
+		public:
+		dgParallelForTasks (dgThreadHive* const hive, const dgKernel& kernel, dgInt32 start, dgInt32 end, dgInt32 minChunkSize = 1);
+
+		void SetRange (dgInt32 start, dgInt32 end);
+		void DependsOn (dgThreadTask* const predecessor);
+		void Precedes (dgThreadTask* const successor);
+		void Queue ();
+
+		private:
+		dgKernel m_kernel;
+		dgParallelForDescriptor<dgKernel> m_descriptor;
+		dgThreadHive* m_hive;
+		dgInt32 m_tasksCount;
+		dgThreadTask m_tasks[DG_MAX_THREADS_HIVE_COUNT];
+	};
+	private:
+
+	template <class dgKernel>
+	static void ParallelForKernel (void* const context, void* const worldContext, dgInt32 threadID);
+
 	void DestroyThreads();
+	void PushJob (const dgThreadJob& job);
+	bool StealJob (dgInt32 threadId, dgThreadJob& job);
+	void ReleaseSuccessors (dgThreadTask* const task, dgInt32 threadId);
 
 	dgInt32 m_beesCount;
+	dgInt32 m_pendingJobs;
 	dgInt32 m_currentIdleBee;
 	dgThreadBee* m_workerBees;
 	dgThread* m_myMasterThread;
 	dgMemoryAllocator* m_allocator;
-	dgThread::dgCriticalSection m_jobsCriticalSection;
 	mutable dgThread::dgCriticalSection m_globalCriticalSection;
 	dgThread::dgSemaphore m_myMutex[DG_MAX_THREADS_HIVE_COUNT];
-	dgFastQueue<dgThreadJob, DG_THREAD_POOL_JOB_SIZE> m_jobsPool;
 };
 
 
@@ -138,6 +252,95 @@ DG_INLINE void dgThreadHive::ReleaseIndirectLock (dgThread::dgCriticalSection* c
 	}
 }
 
+template <class dgKernel>
+void dgThreadHive::ParallelFor (const dgKernel& kernel, dgInt32 start, dgInt32 end, dgInt32 minChunkSize)
+{
+	const dgInt32 threadCount = GetThreadCount();
+	if ((threadCount == 1) || ((end - start) <= minChunkSize)) {
+		kernel (start, end, 0);
+	} else {
+		dgParallelForDescriptor<dgKernel> descriptor;
+		descriptor.m_kernel = &kernel;
+		descriptor.m_end = end;
+		descriptor.m_minChunkSize = dgMax (minChunkSize, 1);
+		descriptor.m_chunkDivisor = threadCount * DG_PARALLEL_FOR_CHUNKS_PER_THREAD;
+		descriptor.m_index = start;
+		for (dgInt32 i = 0; i < threadCount; i ++) {
+			QueueJob (ParallelForKernel<dgKernel>, &descriptor, this);
+		}
+		SynchronizationBarrier();
+	}
+}
+
+template <class dgKernel>
+dgThreadHive::dgParallelForTasks<dgKernel>::dgParallelForTasks (dgThreadHive* const hive, const dgKernel& kernel, dgInt32 start, dgInt32 end, dgInt32 minChunkSize)
+	:m_kernel(kernel)
+	,m_hive(hive)
+	,m_tasksCount(hive->GetThreadCount())
+{
+	m_descriptor.m_kernel = &m_kernel;
+	m_descriptor.m_end = end;
+	m_descriptor.m_minChunkSize = dgMax (minChunkSize, 1);
+	m_descriptor.m_chunkDivisor = m_tasksCount * DG_PARALLEL_FOR_CHUNKS_PER_THREAD;
+	m_descriptor.m_index = start;
+	for (dgInt32 i = 0; i < m_tasksCount; i ++) {
+		m_tasks[i] = dgThreadTask (ParallelForKernel<dgKernel>, &m_descriptor, hive);
+	}
+}
+
+template <class dgKernel>
+void dgThreadHive::dgParallelForTasks<dgKernel>::SetRange (dgInt32 start, dgInt32 end)
+{
+	m_descriptor.m_index = start;
+	m_descriptor.m_end = end;
+}
+
+template <class dgKernel>
+void dgThreadHive::dgParallelForTasks<dgKernel>::DependsOn (dgThreadTask* const predecessor)
+{
+	for (dgInt32 i = 0; i < m_tasksCount; i ++) {
+		m_tasks[i].DependsOn (predecessor);
+	}
+}
+
+template <class dgKernel>
+void dgThreadHive::dgParallelForTasks<dgKernel>::Precedes (dgThreadTask* const successor)
+{
+	for (dgInt32 i = 0; i < m_tasksCount; i ++) {
+		successor->DependsOn (&m_tasks[i]);
+	}
+}
+
+template <class dgKernel>
+void dgThreadHive::dgParallelForTasks<dgKernel>::Queue ()
+{
+	for (dgInt32 i = 0; i < m_tasksCount; i ++) {
+		m_hive->QueueTask (&m_tasks[i]);
+	}
+}
+
+template <class dgKernel>
+void dgThreadHive::ParallelForKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgParallelForDescriptor<dgKernel>* const descriptor = (dgParallelForDescriptor<dgKernel>*) context;
+	const dgKernel& kernel = *descriptor->m_kernel;
+	const dgInt32 end = descriptor->m_end;
+	const dgInt32 minChunkSize = descriptor->m_minChunkSize;
+	const dgInt32 chunkDivisor = descriptor->m_chunkDivisor;
+
+	for (;;) {
+		// the remaining count is only a hint, the atomic add is what claims the range
+		const dgInt32 remaining = end - descriptor->m_index;
+		const dgInt32 chunkSize = dgMax (remaining / chunkDivisor, minChunkSize);
+		const dgInt32 first = dgAtomicExchangeAndAdd(&descriptor->m_index, chunkSize);
+		if (first >= end) {
+			break;
+		}
+		kernel (first, dgMin (first + chunkSize, end), threadID);
+	}
+}
+
+
 class dgThreadHiveScopeLock
 {
 	public:
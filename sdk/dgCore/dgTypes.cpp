@@ -72,6 +72,42 @@ dgUnsigned64 dgGetTimeInMicrosenconds()
 }
 
 
+// returns the wide instructions sets that both the cpu and the operating system support
+dgUnsigned32 dgGetCpuInstructionsSets()
+{
+	dgUnsigned32 sets = 0;
+#ifdef DG_AVX_RUNTIME_DISPATCH
+	#ifdef _MSC_VER
+		int info[4];
+		__cpuid (info, 0);
+		const int maxLeaf = info[0];
+		__cpuid (info, 1);
+		const bool osxsave = (info[2] & (1 << 27)) ? true : false;
+		const bool fma = (info[2] & (1 << 12)) ? true : false;
+		if (osxsave && fma && (maxLeaf >= 7)) {
+			// the os must save the ymm (and zmm) registers on context switches
+			const dgUnsigned64 xcr0 = _xgetbv (0);
+			__cpuidex (info, 7, 0);
+			if (((xcr0 & 0x06) == 0x06) && (info[1] & (1 << 5))) {
+				sets |= DG_CPU_AVX2_INSTRUCTIONS_SET;
+				if (((xcr0 & 0xe6) == 0xe6) && (info[1] & (1 << 16))) {
+					sets |= DG_CPU_AVX512_INSTRUCTIONS_SET;
+				}
+			}
+		}
+	#else
+		__builtin_cpu_init ();
+		if (__builtin_cpu_supports ("avx2") && __builtin_cpu_supports ("fma")) {
+			sets |= DG_CPU_AVX2_INSTRUCTIONS_SET;
+			if (__builtin_cpu_supports ("avx512f")) {
+				sets |= DG_CPU_AVX512_INSTRUCTIONS_SET;
+			}
+		}
+	#endif
+#endif
+	return sets;
+}
+
 dgFloat64 dgRoundToFloat(dgFloat64 val)
 {
 	dgInt32 exp;
@@ -548,9 +584,13 @@ dgInt32 dgDeserializeMarker(dgDeserialize serializeCallback, void* const userDat
 void dgSpinLock (dgInt32* const ptr, bool yield)
 {
 	#ifndef DG_USE_THREAD_EMULATION 
-	do {
-		_mm_pause();
-	} while (dgInterlockedExchange(ptr, 1));
+	while (dgInterlockedExchange(ptr, 1)) {
+		if (yield) {
+			dgThreadYield();
+		} else {
+			_mm_pause();
+		}
+	}
 
 	#endif
 }
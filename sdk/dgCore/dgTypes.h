@@ -227,6 +227,17 @@
 
 #define DG_VECTOR_SIMD_SIZE		16
 #define DG_VECTOR_AVX2_SIZE		32
+#define DG_VECTOR_AVX512_SIZE	64
+
+// x86 builds carry avx2 and avx512 kernels that are selected at run time
+#if !defined (DG_SCALAR_VECTOR_CLASS) && (defined (_M_IX86) || defined (_M_X64) || defined (__i386__) || defined (__x86_64__))
+	#if (defined (_MSC_VER) && (_MSC_VER >= 1910)) || defined (__clang__) || (defined (__GNUC__) && ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 9))))
+		#define DG_AVX_RUNTIME_DISPATCH
+	#endif
+#endif
+
+#define DG_CPU_AVX2_INSTRUCTIONS_SET	(1<<0)
+#define DG_CPU_AVX512_INSTRUCTIONS_SET	(1<<1)
 
 #if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
 	#define	DG_GCC_VECTOR_ALIGMENT	
@@ -244,6 +255,14 @@
 	#define	DG_MSC_AVX2_ALIGMENT			
 #endif
 
+#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
+	#define	DG_GCC_AVX512_ALIGMENT	
+	#define	DG_MSC_AVX512_ALIGMENT			__declspec(align(DG_VECTOR_AVX512_SIZE))
+#else
+	#define	DG_GCC_AVX512_ALIGMENT			__attribute__ ((aligned (DG_VECTOR_AVX512_SIZE)))
+	#define	DG_MSC_AVX512_ALIGMENT			
+#endif
+
 
 
 #if ((defined (_WIN_32_VER) || defined (_WIN_64_VER)) && (_MSC_VER  >= 1600))
@@ -545,7 +564,7 @@ void dgRadixSort (T* const array, T* const tmpArray, dgInt32 elements, dgInt32 r
 			
 			dgInt32 radixShift = (radix + 1) << 3;
 			for (dgInt32 i = 0; i < elements; i ++) {
-				dgInt32 key = (getRadixKey (&array[i], context) >> radixShift) & 0xff;
+				dgInt32 key = (getRadixKey (&tmpArray[i], context) >> radixShift) & 0xff;
 				dgInt32 index = scanCount[key];
 				array[index] = tmpArray[i];
 				scanCount[key] = index + 1;
@@ -772,6 +791,7 @@ enum dgSerializeRevisionNumber
 };
 
 dgUnsigned64 dgGetTimeInMicrosenconds();
+dgUnsigned32 dgGetCpuInstructionsSets();
 dgFloat64 dgRoundToFloat(dgFloat64 val);
 void dgSerializeMarker(dgSerialize serializeCallback, void* const userData);
 dgInt32 dgDeserializeMarker(dgDeserialize serializeCallback, void* const userData);
@@ -817,6 +837,22 @@ DG_INLINE dgInt32 dgAtomicExchangeAndAdd (dgInt32* const addend, dgInt32 amount)
 	#endif
 }
 
+DG_INLINE dgInt64 dgAtomicExchangeAndAdd (dgInt64* const addend, dgInt64 amount)
+{
+	#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
+		return _InterlockedExchangeAdd64((__int64*) addend, __int64 (amount));
+	#endif
+
+	#if (defined (_MINGW_32_VER) || defined (_MINGW_64_VER))
+		return InterlockedExchangeAdd64((long long*) addend, (long long) (amount));
+	#endif
+
+
+	#if (defined (_POSIX_VER) || defined (_POSIX_VER_64) ||defined (_MACOSX_VER))
+		return __sync_fetch_and_add ((int64_t*)addend, amount );
+	#endif
+}
+
 DG_INLINE dgInt32 dgInterlockedExchange(dgInt32* const ptr, dgInt32 value)
 {
 	#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
@@ -834,6 +870,38 @@ DG_INLINE dgInt32 dgInterlockedExchange(dgInt32* const ptr, dgInt32 value)
 	#endif
 }
 
+DG_INLINE bool dgAtomicCompareAndSwap (dgInt32* const ptr, dgInt32 oldValue, dgInt32 newValue)
+{
+	#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
+		return _InterlockedCompareExchange((long*) ptr, long (newValue), long (oldValue)) == long (oldValue);
+	#endif
+
+	#if (defined (_MINGW_32_VER) || defined (_MINGW_64_VER))
+		return InterlockedCompareExchange((long*) ptr, long (newValue), long (oldValue)) == long (oldValue);
+	#endif
+
+
+	#if (defined (_POSIX_VER) || defined (_POSIX_VER_64) ||defined (_MACOSX_VER))
+		return __sync_bool_compare_and_swap((int32_t*)ptr, oldValue, newValue);
+	#endif
+}
+
+DG_INLINE bool dgAtomicCompareAndSwap (dgInt64* const ptr, dgInt64 oldValue, dgInt64 newValue)
+{
+	#if (defined (_WIN_32_VER) || defined (_WIN_64_VER))
+		return _InterlockedCompareExchange64((__int64*) ptr, __int64 (newValue), __int64 (oldValue)) == __int64 (oldValue);
+	#endif
+
+	#if (defined (_MINGW_32_VER) || defined (_MINGW_64_VER))
+		return InterlockedCompareExchange64((long long*) ptr, (long long) (newValue), (long long) (oldValue)) == (long long) (oldValue);
+	#endif
+
+
+	#if (defined (_POSIX_VER) || defined (_POSIX_VER_64) ||defined (_MACOSX_VER))
+		return __sync_bool_compare_and_swap((int64_t*)ptr, oldValue, newValue);
+	#endif
+}
+
 DG_INLINE void dgThreadYield()
 {
 	#ifndef DG_USE_THREAD_EMULATION
@@ -99,6 +99,21 @@ void SaveCollision (const NewtonCollision* const collisionPtr)
   See also: ::NewtonCreate
 */
 int NewtonGetMemoryUsed()
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	return int (dgMin (dgMemoryAllocator::GetGlobalMemoryUsed(), dgInt64 (0x7fffffff)));
+}
+
+/*!
+  Return the exact amount of memory (in Bytes) use by the engine at any given time.
+
+  @return total memory use by the engine as a 64 bit value.
+
+  Same as ::NewtonGetMemoryUsed, but it does not saturate at two gigabytes.
+
+  See also: ::NewtonGetMemoryUsed
+*/
+dLong NewtonGetMemoryUsed64()
 {
 	TRACE_FUNCTION(__FUNCTION__);
 	return dgMemoryAllocator::GetGlobalMemoryUsed();
@@ -545,6 +560,130 @@ void NewtonSyncThreadJobs(const NewtonWorld* const newtonWorld)
 	world->SynchronizationBarrier();
 }
 
+
+/*!
+  Enable or disable the per phase profiler of the world.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param state non zero to start recording, zero to stop.
+
+  @return Nothing.
+
+  Each thread records the phases it executes into its own ring buffer, the buffers 
+  are allocated the first time the profiler is enabled and are cleared every time the state changes. 
+  This function must not be called while the world is updating.
+
+  See also: ::NewtonWorldGetProfileRecordCount, ::NewtonWorldGetProfileRecord
+*/
+void NewtonWorldSetProfilerEnable (const NewtonWorld* const newtonWorld, int state)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	world->GetProfiler()->SetEnabled (state ? true : false);
+}
+
+/*!
+  Return non zero if the profiler of the world is recording.
+
+  @param *newtonWorld Pointer to the Newton world.
+
+  See also: ::NewtonWorldSetProfilerEnable
+*/
+int NewtonWorldGetProfilerEnable (const NewtonWorld* const newtonWorld)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	return world->GetProfiler()->IsEnabled() ? 1 : 0;
+}
+
+/*!
+  Return the number of profiler threads.
+
+  @param *newtonWorld Pointer to the Newton world.
+
+  @return number of threads with profile records.
+
+  Thread zero is the thread that runs the world update, threads one and up are the worker threads.
+
+  See also: ::NewtonWorldGetProfileRecordCount
+*/
+int NewtonWorldGetProfileThreadCount (const NewtonWorld* const newtonWorld)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	return world->GetThreadCount() + 1;
+}
+
+static dgInt32 NewtonWorldGetProfileThreadSlot (int threadIndex)
+{
+	return threadIndex ? threadIndex - 1 : DG_PROFILER_MAIN_THREAD;
+}
+
+/*!
+  Return the number of records held by a profiler thread.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param threadIndex profiler thread, see ::NewtonWorldGetProfileThreadCount
+
+  @return number of records, the buffers only keep the most recent scopes.
+
+  See also: ::NewtonWorldGetProfileRecord
+*/
+int NewtonWorldGetProfileRecordCount (const NewtonWorld* const newtonWorld, int threadIndex)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	const dgProfiler* const profiler = world->GetProfiler();
+	if (!profiler->IsEnabled() || (threadIndex < 0) || (threadIndex >= world->GetThreadCount() + 1)) {
+		return 0;
+	}
+	return profiler->GetRecordCount (NewtonWorldGetProfileThreadSlot (threadIndex));
+}
+
+/*!
+  Copy a profile record.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param threadIndex profiler thread, see ::NewtonWorldGetProfileThreadCount
+  @param recordIndex index of the record, zero is the oldest.
+  @param *record pointer to the record to be filled.
+
+  @return one if the record was copied, zero if the index is out of range.
+
+  Records are written when a scope closes, so nested scopes appear before the scope that contains them. 
+  Records must only be read between world updates.
+
+  See also: ::NewtonWorldGetProfileRecordCount, ::NewtonWorldGetProfilePhaseName
+*/
+int NewtonWorldGetProfileRecord (const NewtonWorld* const newtonWorld, int threadIndex, int recordIndex, NewtonProfileRecord* const record)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	if ((recordIndex < 0) || (recordIndex >= NewtonWorldGetProfileRecordCount (newtonWorld, threadIndex))) {
+		return 0;
+	}
+	const dgProfiler::dgRecord& profileRecord = world->GetProfiler()->GetRecord (NewtonWorldGetProfileThreadSlot (threadIndex), recordIndex);
+	record->m_startTicks = (dLong) profileRecord.m_start;
+	record->m_endTicks = (dLong) profileRecord.m_end;
+	record->m_phase = profileRecord.m_phase;
+	record->m_depth = profileRecord.m_depth;
+	record->m_frame = dgInt32 (profileRecord.m_frame);
+	return 1;
+}
+
+/*!
+  Return the name of a profile phase.
+
+  @param phase one of the NEWTON_PROFILE_* values.
+
+  @return the name of the phase or NULL if the value is out of range.
+*/
+const char* NewtonWorldGetProfilePhaseName (int phase)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	return dgWorld::GetProfilePhaseName (phase);
+}
+
 int NewtonGetMultiThreadSolverOnSingleIsland(const NewtonWorld* const newtonWorld)
 {
 	TRACE_FUNCTION(__FUNCTION__);
@@ -1113,9 +1252,10 @@ int NewtonWorldGetConstraintCount(const NewtonWorld* const newtonWorld)
   one ray cast. This is much different than the collision system where the cost
   of calculating collision for 1000 pairs in much, much less that the 1000 times
   the cost of one pair. Therefore this function must be used with care, as
-  excessive use of it can degrade performance.
+  excessive use of it can degrade performance. Applications that only need the 
+  closest hit of many rays should use *NewtonWorldRayCastBatch* instead.
 
-  See also: ::NewtonWorldConvexCast
+  See also: ::NewtonWorldConvexCast, ::NewtonWorldRayCastBatch
 */
 void NewtonWorldRayCast(const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, NewtonWorldRayFilterCallback filter, void* const userData, NewtonWorldRayPrefilterCallback prefilter, int threadIndex)
 {
@@ -1129,6 +1269,36 @@ void NewtonWorldRayCast(const NewtonWorld* const newtonWorld, const dFloat* cons
 }
 
 
+/*!
+  Cast an array of rays and get the closest hit of each one.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *rays array of rays, each with its own skip body and skip flags.
+  @param *hits array of at least *count* entries that receives the closest hit of each ray.
+  @param count number of rays.
+  @param prefilter optional user function called for each body before intersection, shared by all rays.
+  @param *userData user data to be passed to the prefilter callback.
+
+  @return nothing
+
+  The rays are sorted by origin and spread over all worker threads, there is no callback 
+  per hit, *hits[i].m_hitBody* is NULL if ray *i* hit nothing. 
+
+  The prefilter, when not NULL, is called concurrently from all worker threads. 
+
+  This function must be called from the thread that calls NewtonUpdate, and not while the world 
+  is updating or from inside a job dispatched with NewtonDispachThreadJob. 
+
+  See also: ::NewtonWorldRayCast
+*/
+void NewtonWorldRayCastBatch (const NewtonWorld* const newtonWorld, const NewtonWorldRayCastBatchRay* const rays, NewtonWorldRayCastBatchHit* const hits, int count, NewtonWorldRayPrefilterCallback prefilter, void* const userData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *) newtonWorld;
+	world->GetBroadPhase()->RayCastBatch ((const dgRayCastBatchInfo*) rays, (dgRayCastBatchReturnInfo*) hits, count, (OnRayPrecastAction) prefilter, userData);
+}
+
+
 /*!
   cast a simple convex shape along the ray that goes for the matrix position to the destination and get the firsts contacts of collision.
 
@@ -1185,6 +1355,64 @@ int NewtonWorldCollide (const NewtonWorld* const newtonWorld, const dFloat* cons
 	return world->GetBroadPhase()->Collide((dgCollisionInstance*)shape, dgMatrix(matrix), (OnRayPrecastAction)prefilter, userData, (dgConvexCastReturnInfo*)info, maxContactsCount, threadIndex);
 }
 
+/*!
+  Cast an array of convex shapes along their own segments and get the first contacts of each one.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *queries array of queries, each with its shape, matrix, target, skip body, skip flags and contact capacity.
+  @param *results array of at least *count* entries that receives the time of impact and the contacts of each query.
+  @param count number of queries.
+  @param *contacts array with room for the sum of the *m_maxContacts* of all queries, it can be NULL if only the time of impact is needed.
+  @param prefilter optional user function called for each body before intersection, shared by all queries.
+  @param *userData user data to be passed to the prefilter callback.
+
+  @return the total number of contacts written to *contacts*.
+
+  Each query behaves like *NewtonWorldConvexCast* with *m_maxContacts* as its capacity. The queries are 
+  grouped by shape and spread over all worker threads, on return the contacts are packed so that the contacts 
+  of query *i* are *contacts[results[i].m_firstContact]* to *contacts[results[i].m_firstContact + results[i].m_contactCount - 1]*.
+
+  The prefilter, when not NULL, is called concurrently from all worker threads. 
+
+  This function must be called from the thread that calls NewtonUpdate, and not while the world 
+  is updating or from inside a job dispatched with NewtonDispachThreadJob. 
+
+  See also: ::NewtonWorldConvexCast, ::NewtonWorldCollideBatch
+*/
+int NewtonWorldConvexCastBatch (const NewtonWorld* const newtonWorld, const NewtonWorldConvexCastBatchQuery* const queries, NewtonWorldConvexCastBatchResult* const results, int count, 
+								NewtonWorldConvexCastReturnInfo* const contacts, NewtonWorldRayPrefilterCallback prefilter, void* const userData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	return world->GetBroadPhase()->ConvexCastBatch ((const dgConvexCastBatchInfo*) queries, (dgConvexCastBatchReturnInfo*) results, count, (dgConvexCastReturnInfo*) contacts, (OnRayPrecastAction) prefilter, userData, false);
+}
+
+/*!
+  Get the contacts of an array of convex shapes overlapping the bodies in the world.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param *queries array of queries, each with its shape, matrix, skip body, skip flags and contact capacity, *m_target* is ignored.
+  @param *results array of at least *count* entries that receives the contacts of each query.
+  @param count number of queries.
+  @param *contacts array with room for the sum of the *m_maxContacts* of all queries.
+  @param prefilter optional user function called for each body before intersection, shared by all queries.
+  @param *userData user data to be passed to the prefilter callback.
+
+  @return the total number of contacts written to *contacts*.
+
+  Each query behaves like *NewtonWorldCollide* with *m_maxContacts* as its capacity, the contacts are packed 
+  the same way as in *NewtonWorldConvexCastBatch*. 
+
+  See also: ::NewtonWorldCollide, ::NewtonWorldConvexCastBatch
+*/
+int NewtonWorldCollideBatch (const NewtonWorld* const newtonWorld, const NewtonWorldConvexCastBatchQuery* const queries, NewtonWorldConvexCastBatchResult* const results, int count, 
+							 NewtonWorldConvexCastReturnInfo* const contacts, NewtonWorldRayPrefilterCallback prefilter, void* const userData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	Newton* const world = (Newton *)newtonWorld;
+	return world->GetBroadPhase()->ConvexCastBatch ((const dgConvexCastBatchInfo*) queries, (dgConvexCastBatchReturnInfo*) results, count, (dgConvexCastReturnInfo*) contacts, (OnRayPrecastAction) prefilter, userData, true);
+}
+
 
 /*!
   Retrieve body by index from island.
@@ -3233,6 +3461,121 @@ void NewtonHeightFieldSetHorizontalDisplacement (const NewtonCollision* const he
 	}
 }
 
+/*!
+  Refresh the elevation bounds of a height field after the application changed part of its elevation map.
+
+  @param *heightField pointer to the height field collision.
+  @param x0 first column of the changed grid vertices.
+  @param z0 first row of the changed grid vertices.
+  @param x1 last column of the changed grid vertices.
+  @param z1 last row of the changed grid vertices.
+
+  @return Nothing.
+
+  The elevation map is edited in place through the pointer returned by ::NewtonCollisionGetInfo. 
+  The bodies using the height field do not recalculate their bounding box until they move.
+*/
+void NewtonHeightFieldUpdateElevations (const NewtonCollision* const heightField, int x0, int z0, int x1, int z1)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgCollisionInstance* const collision = (dgCollisionInstance*)heightField;
+	if (collision->IsType(dgCollision::dgCollisionHeightField_RTTI)) {
+		dgCollisionHeightField* const shape = (dgCollisionHeightField*)collision->GetChildShape();
+		shape->UpdateElevations (x0, z0, x1, z1);
+	}
+}
+
+/*!
+  Create a height field collision geometry that reads its grid on demand.
+
+  @param *newtonWorld Pointer to the Newton world.
+  @param width number of grid vertices along x.
+  @param height number of grid vertices along z.
+  @param tileSize number of grid cells along each side of a tile, rounded down to an even number.
+  @param gridsDiagonals diagonal pattern of the cells, same as ::NewtonCreateHeightFieldCollision.
+  @param elevationdatType 0 for 32 bit float elevations, 1 for 16 bit unsigned elevations.
+  @param verticalScale scale applied to the elevations.
+  @param horizontalScale_x size of a cell along x.
+  @param horizontalScale_z size of a cell along z.
+  @param minElevation lowest elevation of the grid, before the vertical scale.
+  @param maxElevation highest elevation of the grid, before the vertical scale.
+  @param maxResidentTiles number of tiles kept in memory.
+  @param pageCallback function that copies the elevations and attributes of a rectangle of grid vertices.
+  @param *pageUserData user data passed to the page callback.
+  @param shapeID user specified collision index that can be use for multi material collision.
+
+  @return Pointer to the collision.
+
+  The grid is split in tiles of tileSize x tileSize cells, neighbor tiles share their border vertices. 
+  A tile is read with the page callback the first time a ray or a body reaches it and it is kept in a 
+  least recently used cache of maxResidentTiles tiles, so the memory used does not depend on the grid size. 
+  The callback receives the first vertex and the size of the rectangle and writes it row by row, it can copy 
+  from a memory mapped file or generate the terrain. It is called from the worker threads and different tiles 
+  can be read at the same time, so the callback must be thread safe. A tile is never read twice at the same time.
+
+  A serialized tiled height field saves its layout but not the page callback, after loading it the callback must 
+  be set again with ::NewtonTiledHeightFieldSetPageCallback, until then the shape does not collide.
+
+  The elevation range is the bounding box of the shape and of the tiles that were never loaded, it must 
+  contain every elevation of the grid.
+*/
+NewtonCollision* NewtonCreateTiledHeightFieldCollision (const NewtonWorld* const newtonWorld, int width, int height, int tileSize, int gridsDiagonals, int elevationdatType,
+														dFloat verticalScale, dFloat horizontalScale_x, dFloat horizontalScale_z, dFloat minElevation, dFloat maxElevation,
+														int maxResidentTiles, NewtonHeightFieldPageCallback pageCallback, void* const pageUserData, int shapeID)
+{
+	Newton* const world = (Newton *)newtonWorld;
+
+	TRACE_FUNCTION(__FUNCTION__);
+	dgCollisionInstance* const collision = world->CreateTiledHeightField (width, height, tileSize, gridsDiagonals, elevationdatType, verticalScale, horizontalScale_x, horizontalScale_z, 
+																		  minElevation, maxElevation, maxResidentTiles, (dgCollisionTiledHeightField::OnTiledHeightFieldPageCallback) pageCallback, pageUserData);
+	collision->SetUserDataID(dgUnsigned32 (shapeID));
+	return (NewtonCollision*) collision;
+}
+
+/*!
+  Return the number of tiles of a tiled height field currently in memory.
+
+  @param *tiledHeightField pointer to the tiled height field collision.
+
+  @return number of resident tiles, zero if the collision is not a tiled height field.
+
+  See also: ::NewtonCreateTiledHeightFieldCollision
+*/
+int NewtonTiledHeightFieldGetResidentTileCount (const NewtonCollision* const tiledHeightField)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgCollisionInstance* const collision = (dgCollisionInstance*)tiledHeightField;
+	if (collision->IsType(dgCollision::dgCollisionTiledHeightField_RTTI)) {
+		dgCollisionTiledHeightField* const shape = (dgCollisionTiledHeightField*)collision->GetChildShape();
+		return shape->GetResidentTileCount();
+	}
+	return 0;
+}
+
+/*!
+  Set the function that reads the tiles of a tiled height field.
+
+  @param *tiledHeightField pointer to the tiled height field collision.
+  @param pageCallback function that copies the elevations and attributes of a rectangle of grid vertices.
+  @param *pageUserData user data passed to the page callback.
+
+  @return Nothing.
+
+  The callback is not serialized, a tiled height field created with ::NewtonCreateCollisionFromSerialization 
+  must have its callback set before the next update.
+
+  See also: ::NewtonCreateTiledHeightFieldCollision
+*/
+void NewtonTiledHeightFieldSetPageCallback (const NewtonCollision* const tiledHeightField, NewtonHeightFieldPageCallback pageCallback, void* const pageUserData)
+{
+	TRACE_FUNCTION(__FUNCTION__);
+	dgCollisionInstance* const collision = (dgCollisionInstance*)tiledHeightField;
+	if (collision->IsType(dgCollision::dgCollisionTiledHeightField_RTTI)) {
+		dgCollisionTiledHeightField* const shape = (dgCollisionTiledHeightField*)collision->GetChildShape();
+		shape->SetPageCallback ((dgCollisionTiledHeightField::OnTiledHeightFieldPageCallback) pageCallback, pageUserData);
+	}
+}
+
 /*!
   Prepare a *TreeCollision* to begin to accept the polygons that comprise the collision mesh.
 
@@ -5399,7 +5742,7 @@ void* NewtonContactJointGetNextContact(const NewtonJoint* const contactJoint, vo
 	dgContact* const joint = (dgContact *)contactJoint;
 
 	if ((joint->GetId() == dgConstraint::m_contactConstraint) && joint->GetCount()){
-		dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+		dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 		return node->GetNext();
 	} else {
 		return NULL;
@@ -5423,7 +5766,7 @@ void NewtonContactJointRemoveContact(const NewtonJoint* const contactJoint, void
 	dgContact* const joint = (dgContact *)contactJoint;
 
 	if ((joint->GetId() == dgConstraint::m_contactConstraint) && joint->GetCount()){
-		dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+		dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 
 		dgAssert (joint->GetBody0());
 		dgAssert (joint->GetBody1());
@@ -5458,7 +5801,7 @@ NewtonMaterial* NewtonContactGetMaterial(const void* const contact)
 {
 	TRACE_FUNCTION(__FUNCTION__);
 
-	dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+	dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 	dgContactMaterial& contactMaterial = node->GetInfo();
 	return (NewtonMaterial*) &contactMaterial;
 }
@@ -5467,7 +5810,7 @@ NewtonCollision* NewtonContactGetCollision0(const void* const contact)
 {
 	TRACE_FUNCTION(__FUNCTION__);
 
-	dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+	dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 	dgContactMaterial& contactMaterial = node->GetInfo();
 	return (NewtonCollision*) contactMaterial.m_collision0;
 }
@@ -5476,7 +5819,7 @@ NewtonCollision* NewtonContactGetCollision1(const void* const contact)
 {
 	TRACE_FUNCTION(__FUNCTION__);
 
-	dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+	dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 	dgContactMaterial& contactMaterial = node->GetInfo();
 	return (NewtonCollision*) contactMaterial.m_collision1;
 }
@@ -5485,7 +5828,7 @@ void* NewtonContactGetCollisionID0(const void* const contact)
 {
 	TRACE_FUNCTION(__FUNCTION__);
 
-	dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+	dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 	dgContactMaterial& contactMaterial = node->GetInfo();
 	return (void*) contactMaterial.m_shapeId0;
 }
@@ -5494,7 +5837,7 @@ void* NewtonContactGetCollisionID1(const void* const contact)
 {
 	TRACE_FUNCTION(__FUNCTION__);
 
-	dgList<dgContactMaterial>::dgListNode* const node = (dgList<dgContactMaterial>::dgListNode*) contact;
+	dgContact::dgListNode* const node = (dgContact::dgListNode*) contact;
 	dgContactMaterial& contactMaterial = node->GetInfo();
 	return (NewtonCollision*) contactMaterial.m_shapeId1;
 }
@@ -72,6 +72,29 @@ extern "C" {
 	
 	#define NEWTON_BROADPHASE_DEFAULT						0
 	#define NEWTON_BROADPHASE_PERSINTENT					1
+	// experimental, slower than the default broadphase on every benchmark scene, not recommended
+	#define NEWTON_BROADPHASE_SWEEP_AND_PRUNE				2
+	#define NEWTON_BROADPHASE_SPATIAL_HASH					3
+
+	#define NEWTON_PROFILE_WORLD_UPDATE						0
+	#define NEWTON_PROFILE_UPDATE_SKELETONS					1
+	#define NEWTON_PROFILE_UPDATE_BROADPHASE				2
+	#define NEWTON_PROFILE_BROADPHASE_APPLY_FORCES			3
+	#define NEWTON_PROFILE_FORCE_AND_TORQUE					4
+	#define NEWTON_PROFILE_SLEEPING_STATE					5
+	#define NEWTON_PROFILE_BROADPHASE_UPDATE_TREE			6
+	#define NEWTON_PROFILE_BROADPHASE_FIND_PAIRS			7
+	#define NEWTON_PROFILE_NARROW_PHASE						8
+	#define NEWTON_PROFILE_UPDATE_DYNAMICS					9
+	#define NEWTON_PROFILE_BUILD_CLUSTERS					10
+	#define NEWTON_PROFILE_SOLVE_CLUSTERS					11
+	#define NEWTON_PROFILE_BUILD_JACOBIAN_MATRIX			12
+	#define NEWTON_PROFILE_SOLVER_PASSES					13
+	#define NEWTON_PROFILE_UPDATE_TRANSFORMS				14
+	#define NEWTON_PROFILE_PHASES_COUNT						15
+
+	#define NEWTON_RAYCAST_BATCH_SKIP_STATIC				1
+	#define NEWTON_RAYCAST_BATCH_SKIP_DYNAMIC				2
 
 	#define NEWTON_DYNAMIC_BODY								0
 	#define NEWTON_KINEMATIC_BODY							1
@@ -93,6 +116,7 @@ extern "C" {
 	#define SERIALIZE_ID_USERMESH							13
 	#define SERIALIZE_ID_SCENE								14
 	#define SERIALIZE_ID_FRACTURED_COMPOUND					15
+	#define SERIALIZE_ID_TILED_HEIGHTFIELD					16
 
 #ifdef __cplusplus
 	class NewtonMesh;
@@ -201,6 +225,23 @@ extern "C" {
 		char* m_atributes;
 	} NewtonHeightFieldCollisionParam;
 
+	typedef struct NewtonTiledHeightFieldCollisionParam
+	{
+		int m_width;
+		int m_height;
+		int m_tileSize;
+		int m_gridsDiagonals;
+		int m_elevationDataType;	// 0 = 32 bit floats, 1 = unsigned 16 bit integers
+		int m_maxResidentTiles;
+		int m_residentTileCount;
+		dFloat m_verticalScale;
+		dFloat m_horizonalScale_x;
+		dFloat m_horizonalScale_z;
+		dFloat m_minElevation;
+		dFloat m_maxElevation;
+		void* m_pageUserData;
+	} NewtonTiledHeightFieldCollisionParam;
+
 	typedef struct NewtonSceneCollisionParam
 	{
 		int m_childrenProxyCount;
@@ -224,6 +265,7 @@ extern "C" {
 			NewtonCompoundCollisionParam m_compoundCollision;
 			NewtonCollisionTreeParam m_collisionTree;
 			NewtonHeightFieldCollisionParam m_heightField;
+			NewtonTiledHeightFieldCollisionParam m_tiledHeightField;
 			NewtonSceneCollisionParam m_sceneCollision;
 			dFloat m_paramArray[64];		    // user define collision can use this to store information
 		};
@@ -244,6 +286,15 @@ extern "C" {
 		char m_descriptionType[128];
 	} NewtonJointRecord;
 
+	typedef struct NewtonProfileRecord
+	{
+		dLong m_startTicks;							// microseconds 
+		dLong m_endTicks;
+		int m_phase;								// one of the NEWTON_PROFILE_* values
+		int m_depth;								// nesting level of the scope in its thread
+		int m_frame;								// world update that recorded the scope
+	} NewtonProfileRecord;
+
 	typedef struct NewtonUserMeshCollisionCollideDesc
 	{
 		dFloat m_boxP0[4];							// lower bounding box of intersection query in local space
@@ -281,6 +332,40 @@ extern "C" {
 		const NewtonBody* m_hitBody;			// body hit at contact point
 		dFloat m_penetration;                   // contact penetration at collision point
 	} NewtonWorldConvexCastReturnInfo;
+
+	typedef struct NewtonWorldRayCastBatchRay
+	{
+		dFloat m_p0[4];							// ray origin in global space
+		dFloat m_p1[4];							// ray end in global space
+		const NewtonBody* m_skipBody;			// body ignored by this ray, usually the one casting it, can be NULL
+		int m_skipFlags;						// combination of NEWTON_RAYCAST_BATCH_SKIP_* bits
+	} NewtonWorldRayCastBatchRay;
+
+	typedef struct NewtonWorldRayCastBatchHit
+	{
+		dFloat m_point[4];						// closest hit point in global space
+		dFloat m_normal[4];						// surface normal at the hit point in global space
+		dLong m_contactID;						// collision ID at the hit point
+		const NewtonBody* m_hitBody;			// closest body hit by the ray, NULL if the ray hit nothing
+		dFloat m_param;							// hit parameter along the ray, 1.0 if the ray hit nothing
+	} NewtonWorldRayCastBatchHit;
+
+	typedef struct NewtonWorldConvexCastBatchQuery
+	{
+		dFloat m_matrix[16];					// shape matrix in global space
+		dFloat m_target[4];						// destination of the shape origin, ignored by NewtonWorldCollideBatch
+		const NewtonCollision* m_shape;			// shape swept or tested by this query
+		const NewtonBody* m_skipBody;			// body ignored by this query, usually the one casting it, can be NULL
+		int m_skipFlags;						// combination of NEWTON_RAYCAST_BATCH_SKIP_* bits
+		int m_maxContacts;						// contacts reserved for this query in the contact array
+	} NewtonWorldConvexCastBatchQuery;
+
+	typedef struct NewtonWorldConvexCastBatchResult
+	{
+		dFloat m_param;							// time of impact of a cast, 1.0 if the shape hit nothing
+		int m_firstContact;						// first contact of this query in the packed contact array
+		int m_contactCount;						// number of contacts of this query
+	} NewtonWorldConvexCastBatchResult;
 	
 	typedef struct NewtonUserMeshCollisionRayHitDesc
 	{
@@ -376,6 +461,7 @@ extern "C" {
 
 	typedef dFloat (*NewtonCollisionTreeRayCastCallback) (const NewtonBody* const body, const NewtonCollision* const treeCollision, dFloat intersection, dFloat* const normal, int faceId, void* const usedData);
 	typedef dFloat (*NewtonHeightFieldRayCastCallback) (const NewtonBody* const body, const NewtonCollision* const heightFieldCollision, dFloat intersection, int row, int col, dFloat* const normal, int faceId, void* const usedData);
+	typedef void (*NewtonHeightFieldPageCallback) (void* const userData, int x0, int z0, int width, int height, void* const elevation, char* const attributes);
 
 	typedef void (*NewtonCollisionCopyConstructionCallback) (const NewtonWorld* const newtonWorld, NewtonCollision* const collision, const NewtonCollision* const sourceCollision);
 	typedef void (*NewtonCollisionDestructorCallback) (const NewtonWorld* const newtonWorld, const NewtonCollision* const collision);
@@ -429,6 +515,7 @@ extern "C" {
 	NEWTON_API int NewtonWorldFloatSize ();
 
 	NEWTON_API int NewtonGetMemoryUsed ();
+	NEWTON_API dLong NewtonGetMemoryUsed64 ();
 	NEWTON_API void NewtonSetMemorySystem (NewtonAllocMemory malloc, NewtonFreeMemory free);
 
 	NEWTON_API NewtonWorld* NewtonCreate ();
@@ -490,6 +577,14 @@ extern "C" {
 	NEWTON_API void NewtonDispachThreadJob(const NewtonWorld* const newtonWorld, NewtonJobTask task, void* const usedData);
 	NEWTON_API void NewtonSyncThreadJobs(const NewtonWorld* const newtonWorld);
 
+	// profiler interface 
+	NEWTON_API void NewtonWorldSetProfilerEnable (const NewtonWorld* const newtonWorld, int state);
+	NEWTON_API int NewtonWorldGetProfilerEnable (const NewtonWorld* const newtonWorld);
+	NEWTON_API int NewtonWorldGetProfileThreadCount (const NewtonWorld* const newtonWorld);
+	NEWTON_API int NewtonWorldGetProfileRecordCount (const NewtonWorld* const newtonWorld, int threadIndex);
+	NEWTON_API int NewtonWorldGetProfileRecord (const NewtonWorld* const newtonWorld, int threadIndex, int recordIndex, NewtonProfileRecord* const record);
+	NEWTON_API const char* NewtonWorldGetProfilePhaseName (int phase);
+
 	// atomic operations
 	NEWTON_API int NewtonAtomicAdd (int* const ptr, int value);
 	NEWTON_API int NewtonAtomicSwap (int* const ptr, int value);
@@ -522,6 +617,9 @@ extern "C" {
 	NEWTON_API void NewtonWorldSetCollisionConstructorDestructorCallback (const NewtonWorld* const newtonWorld, NewtonCollisionCopyConstructionCallback constructor, NewtonCollisionDestructorCallback destructor);
 
 	NEWTON_API void NewtonWorldRayCast (const NewtonWorld* const newtonWorld, const dFloat* const p0, const dFloat* const p1, NewtonWorldRayFilterCallback filter, void* const userData, NewtonWorldRayPrefilterCallback prefilter, int threadIndex);
+	NEWTON_API void NewtonWorldRayCastBatch (const NewtonWorld* const newtonWorld, const NewtonWorldRayCastBatchRay* const rays, NewtonWorldRayCastBatchHit* const hits, int count, NewtonWorldRayPrefilterCallback prefilter, void* const userData);
+	NEWTON_API int NewtonWorldConvexCastBatch (const NewtonWorld* const newtonWorld, const NewtonWorldConvexCastBatchQuery* const queries, NewtonWorldConvexCastBatchResult* const results, int count, NewtonWorldConvexCastReturnInfo* const contacts, NewtonWorldRayPrefilterCallback prefilter, void* const userData);
+	NEWTON_API int NewtonWorldCollideBatch (const NewtonWorld* const newtonWorld, const NewtonWorldConvexCastBatchQuery* const queries, NewtonWorldConvexCastBatchResult* const results, int count, NewtonWorldConvexCastReturnInfo* const contacts, NewtonWorldRayPrefilterCallback prefilter, void* const userData);
 	NEWTON_API int NewtonWorldConvexCast (const NewtonWorld* const newtonWorld, const dFloat* const matrix, const dFloat* const target, const NewtonCollision* const shape, dFloat* const param, void* const userData, NewtonWorldRayPrefilterCallback prefilter, NewtonWorldConvexCastReturnInfo* const info, int maxContactsCount, int threadIndex);
 	NEWTON_API int NewtonWorldCollide (const NewtonWorld* const newtonWorld, const dFloat* const matrix, const NewtonCollision* const shape, void* const userData, NewtonWorldRayPrefilterCallback prefilter, NewtonWorldConvexCastReturnInfo* const info, int maxContactsCount, int threadIndex);
 	
@@ -744,6 +842,13 @@ extern "C" {
 																  const void* const elevationMap, const char* const attributeMap, dFloat verticalScale, dFloat horizontalScale_x, dFloat horizontalScale_z, int shapeID);
 	NEWTON_API void NewtonHeightFieldSetUserRayCastCallback (const NewtonCollision* const heightfieldCollision, NewtonHeightFieldRayCastCallback rayHitCallback);
 	NEWTON_API void NewtonHeightFieldSetHorizontalDisplacement (const NewtonCollision* const heightfieldCollision, const unsigned short* const horizontalMap, dFloat scale);
+	NEWTON_API void NewtonHeightFieldUpdateElevations (const NewtonCollision* const heightfieldCollision, int x0, int z0, int x1, int z1);
+
+	NEWTON_API NewtonCollision* NewtonCreateTiledHeightFieldCollision (const NewtonWorld* const newtonWorld, int width, int height, int tileSize, int gridsDiagonals, int elevationdatType,
+																	   dFloat verticalScale, dFloat horizontalScale_x, dFloat horizontalScale_z, dFloat minElevation, dFloat maxElevation,
+																	   int maxResidentTiles, NewtonHeightFieldPageCallback pageCallback, void* const pageUserData, int shapeID);
+	NEWTON_API int NewtonTiledHeightFieldGetResidentTileCount (const NewtonCollision* const tiledHeightfieldCollision);
+	NEWTON_API void NewtonTiledHeightFieldSetPageCallback (const NewtonCollision* const tiledHeightfieldCollision, NewtonHeightFieldPageCallback pageCallback, void* const pageUserData);
 
 	NEWTON_API NewtonCollision* NewtonCreateTreeCollision (const NewtonWorld* const newtonWorld, int shapeID);
 	NEWTON_API NewtonCollision* NewtonCreateTreeCollisionFromMesh (const NewtonWorld* const newtonWorld, const NewtonMesh* const mesh, int shapeID);
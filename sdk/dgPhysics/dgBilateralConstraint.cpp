@@ -412,10 +412,10 @@ dgFloat32 dgBilateralConstraint::GetInverseDynamicAcceleration(dgInt32 index) co
 void dgBilateralConstraint::JointAccelerations(dgJointAccelerationDecriptor* const params)
 {
 	dgJacobianMatrixElement* const jacobianMatrixElements = params->m_rowMatrix;
-	const dgVector& bodyVeloc0 = m_body0->m_veloc;
-	const dgVector& bodyOmega0 = m_body0->m_omega;
-	const dgVector& bodyVeloc1 = m_body1->m_veloc;
-	const dgVector& bodyOmega1 = m_body1->m_omega;
+	const dgVector& bodyVeloc0 = *params->m_bodyVeloc0;
+	const dgVector& bodyOmega0 = *params->m_bodyOmega0;
+	const dgVector& bodyVeloc1 = *params->m_bodyVeloc1;
+	const dgVector& bodyOmega1 = *params->m_bodyOmega1;
 
 // remember the impulse branch 
 //dgAssert (params->m_timeStep > dgFloat32 (0.0f));
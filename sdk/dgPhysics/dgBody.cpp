@@ -67,12 +67,14 @@ dgBody::dgBody()
 	,m_matrixUpdate(NULL)
 	,m_index(0)
 	,m_uniqueID(0)
+	,m_activeIndex(-1)
 	,m_bodyGroupId(0)
 	,m_rtti(m_baseBodyRTTI)
 	,m_type(0)
 	,m_serializedEnum(-1)
 	,m_dynamicsLru(0)
 	,m_genericLRUMark(0)
+	,m_activeLru(0)
 {
 	m_autoSleep = true;
 	m_collidable = true;
@@ -110,12 +112,14 @@ dgBody::dgBody (dgWorld* const world, const dgTree<const dgCollision*, dgInt32>*
 	,m_matrixUpdate(NULL)
 	,m_index(0)
 	,m_uniqueID(0)
+	,m_activeIndex(-1)
 	,m_bodyGroupId(0)
 	,m_rtti(m_baseBodyRTTI)
 	,m_type(0)
 	,m_serializedEnum(-1)
 	,m_dynamicsLru(0)
 	,m_genericLRUMark(0)
+	,m_activeLru(0)
 {
 	m_autoSleep = true;
 	m_collidable = true;
@@ -179,6 +183,7 @@ void dgBody::AttachCollision (dgCollisionInstance* const collisionSrc)
 	}
 	m_collision = instance;
 	m_equilibrium = 0;
+	Activate();
 }
 
 void dgBody::Serialize (const dgTree<dgInt32, const dgCollision*>& collisionRemapId, dgSerialize serializeCallback, void* const userData)
@@ -233,6 +238,18 @@ void dgBody::SetMatrixResetSleep(const dgMatrix& matrix)
 	SetMatrix(matrix);
 }
 
+void dgBody::Activate()
+{
+	// bodies only get the per step updates while they are in the world active list,
+	// anything that may wake a body up or move it must call this
+	if (m_masterNode) {
+		m_activeLru = m_world->m_activeBodiesLru;
+		if (m_activeIndex < 0) {
+			m_world->ActivateBody(this);
+		}
+	}
+}
+
 void dgBody::UpdateWorlCollisionMatrix() const
 {
 	m_collision->SetGlobalMatrix (m_collision->GetLocalMatrix() * m_matrix);
@@ -243,6 +260,7 @@ void dgBody::UpdateWorlCollisionMatrix() const
 void dgBody::UpdateCollisionMatrix (dgFloat32 timestep, dgInt32 threadIndex)
 {
 	m_transformIsDirty = true;
+	Activate();
 	m_collision->SetGlobalMatrix (m_collision->GetLocalMatrix() * m_matrix);
 	m_collision->CalcAABB (m_collision->GetGlobalMatrix(), m_minAABB, m_maxAABB);
 
@@ -509,6 +527,7 @@ void dgBody::SetMassMatrix(dgFloat32 mass, const dgMatrix& inertia)
 		m_mass.m_z = Izz1;
 		m_mass.m_w = mass;
 
+		const bool wasStatic = (m_invMass.m_w == dgFloat32 (0.0f));
 		m_invMass.m_x = dgFloat32 (1.0f) / Ixx1;
 		m_invMass.m_y = dgFloat32 (1.0f) / Iyy1;
 		m_invMass.m_z = dgFloat32 (1.0f) / Izz1;
@@ -517,6 +536,12 @@ void dgBody::SetMassMatrix(dgFloat32 mass, const dgMatrix& inertia)
 		if (m_masterNode) {
 			dgBodyMasterList& masterList (*m_world);
 			masterList.RotateToEnd (m_masterNode);
+			if (wasStatic) {
+				// static bodies are not in the active list, so a body that gets a mass must be woken up
+				m_sleeping = false;
+				m_equilibrium = false;
+				Activate();
+			}
 		}
 	}
 
@@ -631,6 +656,7 @@ void dgBody::InvalidateCache ()
 {
 	m_sleeping = false;
 	m_equilibrium = false;
+	Activate();
 	m_genericLRUMark = 0;
 	dgMatrix matrix (m_matrix);
 	SetMatrixOriginAndRotation(matrix);
@@ -691,6 +717,7 @@ void dgBody::AddImpulse (const dgVector& pointDeltaVeloc, const dgVector& pointP
 
 	m_sleeping	= false;
 	m_equilibrium = false;
+	Activate();
 	Unfreeze ();
 }
 
@@ -708,6 +735,7 @@ void dgBody::ApplyImpulsePair (const dgVector& linearImpulseIn, const dgVector&
 
 	m_sleeping	= false;
 	m_equilibrium = false;
+	Activate();
 	Unfreeze ();
 }
 
@@ -741,6 +769,7 @@ void dgBody::ApplyImpulsesAtPoint (dgInt32 count, dgInt32 strideInBytes, const d
 
 	m_sleeping	= false;
 	m_equilibrium = false;
+	Activate();
 	Unfreeze ();
 }
 
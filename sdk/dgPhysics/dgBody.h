@@ -136,6 +136,7 @@ class dgBody
 
 	bool GetAutoSleep () const;
 	void SetAutoSleep (bool state);
+	void Activate ();
 
 	dgCollisionInstance* GetCollision () const;
 	dgBodyMasterList::dgListNode* GetMasterList() const;
@@ -276,12 +277,14 @@ class dgBody
 	
 	dgInt32 m_index;
 	dgInt32 m_uniqueID;
+	dgInt32 m_activeIndex;
 	dgInt32 m_bodyGroupId;
 	dgInt32 m_rtti;
 	dgInt32 m_type;
 	dgInt32 m_serializedEnum;
 	dgUnsigned32 m_dynamicsLru;
 	dgUnsigned32 m_genericLRUMark;
+	dgUnsigned32 m_activeLru;
 
 	friend class dgWorld;
 	friend class dgContact;
@@ -298,6 +301,7 @@ class dgBody
 	friend class dgBodyMasterListRow;
 	friend class dgWorldDynamicUpdate;
 	friend class dgBroadPhaseBodyNode;
+	friend class dgBroadPhasePersistent;
 	friend class dgBilateralConstraint;
 	friend class dgBroadPhaseAggregate;
 	friend class dgCollisionConvexPolygon;
@@ -405,6 +409,7 @@ DG_INLINE void dgBody::SetOmega (const dgVector& omega)
 {
 	SetOmegaNoSleep(omega);
 	m_equilibrium = false;
+	Activate();
 }
 
 
@@ -422,6 +427,7 @@ DG_INLINE void dgBody::SetVelocity (const dgVector& velocity)
 {
 	SetVelocityNoSleep(velocity);
 	m_equilibrium = false;
+	Activate();
 }
 
 
@@ -526,6 +532,7 @@ DG_INLINE void dgBody::SetAutoSleep (bool state)
 	m_autoSleep = dgUnsigned32 (state);
 	if (m_autoSleep == 0) {
 		m_sleeping = false;
+		Activate();
 	}
 }
 
@@ -544,6 +551,9 @@ DG_INLINE void dgBody::SetSleepState (bool state)
 {
 	m_sleeping = state;
 	m_equilibrium = state;
+	if (!state) {
+		Activate();
+	}
 }
 
 
@@ -45,9 +45,7 @@ dgBodyMasterListRow::dgListNode* dgBodyMasterListRow::AddContactJoint (dgConstra
 {
 	dgThreadHiveScopeLock lock (body->m_world, &m_body->m_criticalSectionLock, false);
 
-	body->m_world->GlobalLock(false);
 	dgListNode* const node = Addtop();
-	body->m_world->GlobalUnlock();
 
 #ifdef _DEBUG
 	for (dgListNode* ptr = GetFirst()->GetNext(); ptr && (ptr->GetInfo().m_joint->GetId() == dgConstraint::m_contactConstraint); ptr = ptr->GetNext()) { 
@@ -89,9 +87,7 @@ dgBodyMasterListRow::dgListNode* dgBodyMasterListRow::AddBilateralJoint (dgConst
 {
 	dgThreadHiveScopeLock lock (body->m_world, &m_body->m_criticalSectionLock, false);
 
-	body->m_world->GlobalLock(false);
 	dgListNode* const node = Append();
-	body->m_world->GlobalUnlock();
 	
 	node->GetInfo().m_joint = joint;
 	node->GetInfo().m_bodyNode = body;
@@ -113,9 +109,7 @@ void dgBodyMasterListRow::RemoveContactJoint (dgListNode* const link)
 {
 	dgThreadHiveScopeLock lock (m_body->m_world, &m_body->m_criticalSectionLock, false);
 	
-	m_body->m_world->GlobalLock(false);
 	Remove(link);
-	m_body->m_world->GlobalUnlock();
 	
 	m_contactCount --;
 	SetAcceleratedSearch();
@@ -125,9 +119,7 @@ void dgBodyMasterListRow::RemoveBilateralJoint (dgListNode* const link)
 {
 	dgThreadHiveScopeLock lock (m_body->m_world, &m_body->m_criticalSectionLock, false);
 	
-	m_body->m_world->GlobalLock(false);
 	Remove(link);
-	m_body->m_world->GlobalUnlock();
 }
 
 
@@ -241,6 +233,12 @@ dgBodyMasterList::dgBodyMasterList (dgMemoryAllocator* const allocator)
 	:dgList<dgBodyMasterListRow>(allocator)
 	,m_disableBodies(allocator)
 	,m_constraintCount (0)
+	,m_activeBodies(allocator)
+	,m_activeBodiesCount(0)
+	,m_activeBodiesUpdatedCount(0)
+	,m_activeBodiesLru(0)
+	,m_activeBodiesOverflow(0)
+	,m_activeBodiesLock()
 {
 }
 
@@ -260,6 +258,7 @@ void dgBodyMasterList::AddBody (dgBody* const body)
 	if (GetFirst() != node) {
 		InsertAfter (GetFirst(), node);
 	}
+	ActivateBody (body);
 }
 
 void dgBodyMasterList::RemoveBody (dgBody* const body)
@@ -272,6 +271,71 @@ void dgBodyMasterList::RemoveBody (dgBody* const body)
 
 	Remove (node);
 	body->m_masterNode = NULL;
+
+	if (body->m_activeIndex >= 0) {
+		dgAssert (m_activeBodies[body->m_activeIndex] == body);
+		m_activeBodiesCount --;
+		dgBody* const lastBody = m_activeBodies[m_activeBodiesCount];
+		m_activeBodies[body->m_activeIndex] = lastBody;
+		lastBody->m_activeIndex = body->m_activeIndex;
+		body->m_activeIndex = -1;
+	}
+}
+
+void dgBodyMasterList::ActivateBody (dgBody* const body)
+{
+	// the array only grows in RebuildActiveBodies, so bodies can be added while the update kernels read it,
+	// a body that does not fit is picked up by the next update, which then rebuilds the array
+	dgThreadHiveScopeLock lock (body->GetWorld(), &m_activeBodiesLock, false);
+	if (body->m_activeIndex < 0) {
+		if (m_activeBodiesCount < m_activeBodies.GetElementsCapacity()) {
+			body->m_activeIndex = m_activeBodiesCount;
+			m_activeBodies[m_activeBodiesCount] = body;
+			m_activeBodiesCount ++;
+		} else {
+			m_activeBodiesOverflow = 1;
+		}
+	}
+}
+
+void dgBodyMasterList::RebuildActiveBodies ()
+{
+	// all bodies go in, the ones that do not need the updates leave after their first one
+	m_activeBodiesOverflow = 0;
+	m_activeBodies.Resize (GetCount() * 2);
+	m_activeBodiesCount = 0;
+	m_activeBodiesUpdatedCount = 0;
+	for (dgListNode* node = GetFirst(); node; node = node->GetNext()) {
+		dgBody* const body = node->GetInfo().GetBody();
+		body->m_activeIndex = m_activeBodiesCount;
+		body->m_activeLru = m_activeBodiesLru;
+		m_activeBodies[m_activeBodiesCount] = body;
+		m_activeBodiesCount ++;
+	}
+}
+
+void dgBodyMasterList::UpdateActiveBodies ()
+{
+	if (m_activeBodiesOverflow) {
+		RebuildActiveBodies();
+	}
+
+	// bodies that fell asleep and static bodies leave the list once their transform was reported and they
+	// got at least one update since they were last activated, kinematic bodies are updated every step
+	dgInt32 count = 0;
+	for (dgInt32 i = 0; i < m_activeBodiesCount; i ++) {
+		dgBody* const body = m_activeBodies[i];
+		if ((body->m_activeLru == m_activeBodiesLru) || body->m_transformIsDirty || !(body->m_sleeping && body->m_equilibrium) || body->IsRTTIType(dgBody::m_kinematicBodyRTTI)) {
+			body->m_activeIndex = count;
+			m_activeBodies[count] = body;
+			count ++;
+		} else {
+			body->m_activeIndex = -1;
+		}
+	}
+	m_activeBodiesCount = count;
+	m_activeBodiesUpdatedCount = count;
+	m_activeBodiesLru ++;
 }
 
 
@@ -327,6 +391,8 @@ void dgBodyMasterList::AttachConstraint(dgConstraint* const constraint,	dgBody*
 
 		body0->m_equilibrium = body0->GetInvMass().m_w ? false : true;
 		body1->m_equilibrium = body1->GetInvMass().m_w ? false : true;
+		body0->Activate();
+		body1->Activate();
 		constraint->m_link0 = body0->m_masterNode->GetInfo().AddBilateralJoint (constraint, body1);
 		constraint->m_link1 = body1->m_masterNode->GetInfo().AddBilateralJoint (constraint, body0);
 	} else {
@@ -370,6 +436,10 @@ void dgBodyMasterList::RemoveConstraint (dgConstraint* const constraint)
 //		}
 	}
 
+	// clearing the saved forces wakes both bodies up on the next update, so they must be in the active list
+	body0->Activate();
+	body1->Activate();
+
 	if (constraint->GetId() == dgConstraint::m_contactConstraint) {
 		dgConstraint* const contact = (dgConstraint*) constraint;
 		if (contact->m_maxDOF) {
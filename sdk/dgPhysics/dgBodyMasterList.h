@@ -78,6 +78,10 @@ class dgBodyMasterList: public dgList<dgBodyMasterListRow>
 	void RemoveConstraint (dgConstraint* const constraint);
 	void AttachConstraint (dgConstraint* const constraint, dgBody* const body0, dgBody* const body1);
 
+	void ActivateBody (dgBody* const body);
+	void UpdateActiveBodies ();
+	void RebuildActiveBodies ();
+
 	dgContact* FindContactJoint (const dgBody* body0, const dgBody* body1) const;
 	dgBilateralConstraint* FindBilateralJoint (const dgBody* body0, const dgBody* body1) const;
 
@@ -89,6 +93,16 @@ class dgBodyMasterList: public dgList<dgBodyMasterListRow>
 	public:
 	dgTree<int, dgBody*> m_disableBodies;
 	dgUnsigned32 m_constraintCount;
+
+	// compact array of the bodies that need the per step updates, the awake dynamic bodies, 
+	// the kinematic bodies and the bodies that moved or were activated since the last update,
+	// the bodies at or past the updated count were activated after the update and missed it
+	dgArray<dgBody*> m_activeBodies;
+	dgInt32 m_activeBodiesCount;
+	dgInt32 m_activeBodiesUpdatedCount;
+	dgUnsigned32 m_activeBodiesLru;
+	dgInt32 m_activeBodiesOverflow;
+	dgThread::dgCriticalSection m_activeBodiesLock;
 };
 
 #endif
@@ -39,7 +39,20 @@
 #define DG_CONTACT_TRANSLATION_ERROR	dgFloat32 (1.0e-3f)
 #define DG_CONTACT_ANGULAR_ERROR		(dgFloat32 (0.25f * dgDEG2RAD))
 #define DG_NARROW_PHASE_DIST			dgFloat32 (0.2f)
+#define DG_NARROW_PHASE_CONVEX_DIST		dgFloat32 (1.0f / 64.0f)
 #define DG_CONTACT_DELAY_FRAMES			4
+#define DG_BROADPHASE_BUILD_BINS		16
+#define DG_BROADPHASE_BUILD_TASK_SIZE	256
+#define DG_BROADPHASE_BUILD_CHUNK_SIZE	256
+#define DG_BROADPHASE_REFIT_CHUNK_SIZE	64
+#define DG_BROADPHASE_BODY_CHUNK_SIZE	16
+#define DG_BROADPHASE_REBUILD_RATIO		dgFloat32 (2.0f)
+#define DG_RAYCAST_BATCH_CHUNK_SIZE		16
+#define DG_CONVEX_CAST_BATCH_CHUNK_SIZE	8
+#define DG_CONVEX_CAST_BATCH_GROUP_SIZE	8
+#define DG_CONVEX_CAST_BATCH_CANDIDATES	256
+#define DG_SPHERE_PAIRS_CHUNK_SIZE	16
+#define DG_BATCH_QUERY_SORT_MIN_COUNT	256
 
 
 dgVector dgBroadPhase::m_velocTol(dgFloat32(1.0e-16f)); 
@@ -62,93 +75,204 @@ dgInt32 dgBroadPhase::m_obbTestSimplex[4][4] =
 class dgBroadPhase::dgSpliteInfo
 {
 	public:
-	dgSpliteInfo (dgBroadPhaseNode** const boxArray, dgInt32 boxCount)
+	class dgBin
 	{
-		dgVector minP ( dgFloat32 (1.0e15f)); 
-		dgVector maxP (-dgFloat32 (1.0e15f)); 
-
-		if (boxCount == 2) {
-			m_axis = 1;
-			for (dgInt32 i = 0; i < boxCount; i ++) {
-				dgBroadPhaseNode* const node = boxArray[i];
-				dgAssert (node->IsLeafNode());
-				minP = minP.GetMin (node->m_minBox); 
-				maxP = maxP.GetMax (node->m_maxBox); 
+		public:
+		dgVector m_minBox;
+		dgVector m_maxBox;
+		dgInt32 m_count;
+	};
+
+	void ResetBounds ()
+	{
+		m_p0 = dgVector (dgFloat32 (1.0e15f));
+		m_p1 = dgVector (-dgFloat32 (1.0e15f));
+		m_c0 = m_p0;
+		m_c1 = m_p1;
+	}
+
+	void AddBounds (dgBroadPhaseNode** const boxArray, dgInt32 boxCount)
+	{
+		for (dgInt32 i = 0; i < boxCount; i ++) {
+			const dgBroadPhaseNode* const node = boxArray[i];
+			dgAssert (node->IsLeafNode() || node->IsAggregate());
+			const dgVector center (dgVector::m_half * (node->m_minBox + node->m_maxBox));
+			m_p0 = m_p0.GetMin (node->m_minBox);
+			m_p1 = m_p1.GetMax (node->m_maxBox);
+			m_c0 = m_c0.GetMin (center);
+			m_c1 = m_c1.GetMax (center);
+		}
+	}
+
+	void MergeBounds (const dgSpliteInfo& info)
+	{
+		m_p0 = m_p0.GetMin (info.m_p0);
+		m_p1 = m_p1.GetMax (info.m_p1);
+		m_c0 = m_c0.GetMin (info.m_c0);
+		m_c1 = m_c1.GetMax (info.m_c1);
+	}
+
+	void SetBins ()
+	{
+		dgVector extend (m_c1 - m_c0);
+		m_origin = m_c0;
+		m_scale = dgVector (dgFloat32 (0.0f));
+		for (dgInt32 i = 0; i < 3; i ++) {
+			if (extend[i] > dgFloat32 (1.0e-6f)) {
+				m_scale[i] = dgFloat32 (DG_BROADPHASE_BUILD_BINS) * dgFloat32 (0.999f) / extend[i];
 			}
-		} else {
-			dgVector median (dgFloat32 (0.0f));
-			dgVector varian (dgFloat32 (0.0f));
-			for (dgInt32 i = 0; i < boxCount; i ++) {
-				dgBroadPhaseNode* const node = boxArray[i];
-				dgAssert (node->IsLeafNode());
-				minP = minP.GetMin (node->m_minBox); 
-				maxP = maxP.GetMax (node->m_maxBox); 
-				dgVector p (dgVector::m_half * (node->m_minBox + node->m_maxBox));
-				median += p;
-				varian += p * p;
+		}
+		ResetBins();
+	}
+
+	void SetBins (const dgSpliteInfo& info)
+	{
+		m_origin = info.m_origin;
+		m_scale = info.m_scale;
+		ResetBins();
+	}
+
+	void ResetBins ()
+	{
+		for (dgInt32 i = 0; i < 3; i ++) {
+			for (dgInt32 j = 0; j < DG_BROADPHASE_BUILD_BINS; j ++) {
+				m_bins[i][j].m_minBox = dgVector (dgFloat32 (1.0e15f));
+				m_bins[i][j].m_maxBox = dgVector (-dgFloat32 (1.0e15f));
+				m_bins[i][j].m_count = 0;
 			}
+		}
+	}
 
-			varian = varian.Scale4 (dgFloat32 (boxCount)) - median * median;
+	dgInt32 GetBin (const dgBroadPhaseNode* const node, dgInt32 axis) const
+	{
+		const dgFloat32 center = (node->m_minBox[axis] + node->m_maxBox[axis]) * dgFloat32 (0.5f);
+		return dgClamp (dgInt32 ((center - m_origin[axis]) * m_scale[axis]), 0, DG_BROADPHASE_BUILD_BINS - 1);
+	}
 
-			dgInt32 index = 0;
-			dgFloat32 maxVarian = dgFloat32 (-1.0e10f);
-			for (dgInt32 i = 0; i < 3; i ++) {
-				if (varian[i] > maxVarian) {
-					index = i;
-					maxVarian = varian[i];
-				}
+	void AddBins (dgBroadPhaseNode** const boxArray, dgInt32 boxCount)
+	{
+		for (dgInt32 i = 0; i < boxCount; i ++) {
+			const dgBroadPhaseNode* const node = boxArray[i];
+			for (dgInt32 j = 0; j < 3; j ++) {
+				dgBin& bin = m_bins[j][GetBin (node, j)];
+				bin.m_minBox = bin.m_minBox.GetMin (node->m_minBox);
+				bin.m_maxBox = bin.m_maxBox.GetMax (node->m_maxBox);
+				bin.m_count ++;
 			}
+		}
+	}
 
-			dgVector center = median.Scale4 (dgFloat32 (1.0f) / dgFloat32 (boxCount));
+	void MergeBins (const dgSpliteInfo& info)
+	{
+		for (dgInt32 i = 0; i < 3; i ++) {
+			for (dgInt32 j = 0; j < DG_BROADPHASE_BUILD_BINS; j ++) {
+				dgBin& bin = m_bins[i][j];
+				const dgBin& srcBin = info.m_bins[i][j];
+				bin.m_minBox = bin.m_minBox.GetMin (srcBin.m_minBox);
+				bin.m_maxBox = bin.m_maxBox.GetMax (srcBin.m_maxBox);
+				bin.m_count += srcBin.m_count;
+			}
+		}
+	}
 
-			dgFloat32 test = center[index];
+	// pick the bin plane with the lowest surface area heuristic cost and partition the boxes on it
+	dgInt32 Partition (dgBroadPhaseNode** const boxArray, dgInt32 boxCount) const
+	{
+		dgInt32 bestAxis = -1;
+		dgInt32 bestSplit = 0;
+		dgFloat32 bestCost = dgFloat32 (1.0e30f);
+		for (dgInt32 i = 0; i < 3; i ++) {
+			if (m_scale[i] == dgFloat32 (0.0f)) {
+				continue;
+			}
 
-			dgInt32 i0 = 0;
-			dgInt32 i1 = boxCount - 1;
-			do {    
-				for (; i0 <= i1; i0 ++) {
-					dgBroadPhaseNode* const node = boxArray[i0];
-					dgFloat32 val = (node->m_minBox[index] + node->m_maxBox[index]) * dgFloat32 (0.5f);
-					if (val > test) {
-						break;
-					}
-				}
+			dgInt32 leftCount[DG_BROADPHASE_BUILD_BINS];
+			dgFloat32 leftArea[DG_BROADPHASE_BUILD_BINS];
+			dgVector minBox (dgFloat32 (1.0e15f));
+			dgVector maxBox (-dgFloat32 (1.0e15f));
+			dgInt32 count = 0;
+			for (dgInt32 j = 0; j < DG_BROADPHASE_BUILD_BINS - 1; j ++) {
+				const dgBin& bin = m_bins[i][j];
+				minBox = minBox.GetMin (bin.m_minBox);
+				maxBox = maxBox.GetMax (bin.m_maxBox);
+				count += bin.m_count;
+				leftCount[j] = count;
+				leftArea[j] = count ? Area (minBox, maxBox) : dgFloat32 (0.0f);
+			}
 
-				for (; i1 >= i0; i1 --) {
-					dgBroadPhaseNode* const node = boxArray[i1];
-					dgFloat32 val = (node->m_minBox[index] + node->m_maxBox[index]) * dgFloat32 (0.5f);
-					if (val < test) {
-						break;
+			count = 0;
+			minBox = dgVector (dgFloat32 (1.0e15f));
+			maxBox = dgVector (-dgFloat32 (1.0e15f));
+			for (dgInt32 j = DG_BROADPHASE_BUILD_BINS - 1; j > 0; j --) {
+				const dgBin& bin = m_bins[i][j];
+				minBox = minBox.GetMin (bin.m_minBox);
+				maxBox = maxBox.GetMax (bin.m_maxBox);
+				count += bin.m_count;
+				if (count && leftCount[j - 1]) {
+					const dgFloat32 cost = leftArea[j - 1] * dgFloat32 (leftCount[j - 1]) + Area (minBox, maxBox) * dgFloat32 (count);
+					if (cost < bestCost) {
+						bestCost = cost;
+						bestAxis = i;
+						bestSplit = j;
 					}
 				}
+			}
+		}
 
-				if (i0 < i1)	{
-					dgSwap(boxArray[i0], boxArray[i1]);
-					i0++; 
-					i1--;
-				}
-
-			} while (i0 <= i1);
+		if (bestAxis == -1) {
+			// all centers are coincident, any partition is as good as any other
+			return boxCount / 2;
+		}
 
-			if (i0 > 0){
-				i0 --;
-			}
-			if ((i0 + 1) >= boxCount) {
-				i0 = boxCount - 2;
+		dgInt32 i0 = 0;
+		dgInt32 i1 = boxCount - 1;
+		while (i0 <= i1) {
+			if (GetBin (boxArray[i0], bestAxis) < bestSplit) {
+				i0 ++;
+			} else {
+				dgSwap (boxArray[i0], boxArray[i1]);
+				i1 --;
 			}
-			m_axis = i0 + 1;
 		}
+		dgAssert (i0 > 0);
+		dgAssert (i0 < boxCount);
+		return i0;
+	}
 
-		dgAssert (maxP.m_x - minP.m_x >= dgFloat32 (0.0f));
-		dgAssert (maxP.m_y - minP.m_y >= dgFloat32 (0.0f));
-		dgAssert (maxP.m_z - minP.m_z >= dgFloat32 (0.0f));
-		m_p0 = minP;
-		m_p1 = maxP;
+	static dgFloat32 Area (const dgVector& minBox, const dgVector& maxBox)
+	{
+		dgVector side0 (maxBox - minBox);
+		return side0.DotProduct4 (side0.ShiftTripleRight()).GetScalar();
 	}
 
-	dgInt32 m_axis;
 	dgVector m_p0;
 	dgVector m_p1;
+	dgVector m_c0;
+	dgVector m_c1;
+	dgVector m_origin;
+	dgVector m_scale;
+	dgBin m_bins[3][DG_BROADPHASE_BUILD_BINS];
+};
+
+class dgBroadPhase::dgBuildTask
+{
+	public:
+	dgBroadPhaseNode** m_link;
+	dgBroadPhaseTreeNode* m_parent;
+	dgInt32 m_firstBox;
+	dgInt32 m_lastBox;
+	dgInt32 m_nodeIndex;
+};
+
+class dgBroadPhase::dgBuildSyncData
+{
+	public:
+	dgBroadPhaseNode** m_leafArray;
+	dgBroadPhaseTreeNode** m_nodeArray;
+	dgBuildTask* m_tasks;
+	dgSpliteInfo* m_threadInfo;
+	dgInt32 m_tasksCount;
+	dgInt32 m_taskSize;
 };
 
 
@@ -159,14 +283,29 @@ dgBroadPhase::dgBroadPhase(dgWorld* const world)
 	,m_updateList(world->GetAllocator())
 	,m_aggregateList(world->GetAllocator())
 	,m_lru(DG_CONTACT_DELAY_FRAMES)
-	,m_contacJointLock()
+	,m_pairCache(world->GetAllocator())
 	,m_criticalSectionLock()
-	,m_pendingSoftBodyCollisions(world->GetAllocator(), 64)
 	,m_pendingSoftBodyPairsCount(0)
+	,m_refitNodes(world->GetAllocator())
+	,m_refitLevels(world->GetAllocator())
+	,m_flatNodes(world->GetAllocator(), 64)
+	,m_flatLeaves(world->GetAllocator())
+	,m_flatNodesCount(0)
+	,m_flatLeavesCount(0)
 	,m_dirtyNodesCount(0)
+	,m_refitPending(0)
+	,m_flatNodesValid(false)
 	,m_scanTwoWays(false)
 	,m_recursiveChunks(false)
 {
+	for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
+		m_pendingSoftBodyCollisions[i].SetAllocator(world->GetAllocator());
+		m_pendingSoftBodyCollisionsCount[i] = 0;
+		m_pendingContacts[i].SetAllocator(world->GetAllocator());
+		m_pendingContactsCount[i] = 0;
+		m_pendingSpherePairs[i].SetAllocator(world->GetAllocator());
+		m_pendingSpherePairsCount[i] = 0;
+	}
 }
 
 dgBroadPhase::~dgBroadPhase()
@@ -203,6 +342,8 @@ dgBroadPhaseTreeNode* dgBroadPhase::InsertNode(dgBroadPhaseNode* const root, dgB
 	dgVector p0;
 	dgVector p1;
 
+	RefitDirtyNodes();
+	m_flatNodesValid = false;
 	dgBroadPhaseNode* sibling = root;
 	dgFloat32 surfaceArea = CalculateSurfaceArea(node, sibling, p0, p1);
 	while (!sibling->IsLeafNode()) {
@@ -249,26 +390,41 @@ void dgBroadPhase::UpdateAggregateEntropyKernel(void* const context, void* const
 	broadPhase->UpdateAggregateEntropy(descriptor, (dgList<dgBroadPhaseAggregate*>::dgListNode*) node, threadID);
 }
 
-void dgBroadPhase::ForceAndToqueKernel(void* const context, void* const node, dgInt32 threadID)
+void dgBroadPhase::ForceAndTorqueKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
 {
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
-	dgWorld* const world = descriptor->m_world;
-	dgBroadPhase* const broadPhase = world->GetBroadPhase();
-	broadPhase->ApplyForceAndtorque(descriptor, (dgBodyMasterList::dgListNode*) node, threadID);
+	dgProfilerScope scope (&m_world->m_profiler, m_profileForceAndTorque, threadID);
+	dgBody** const bodies = descriptor->m_activeBodies;
+	for (dgInt32 i = start; i < end; i ++) {
+		dgBody* const body = bodies[i];
+		if (DoNeedUpdate(body)) {
+			ApplyForceAndtorque(body, descriptor->m_timestep, threadID);
+		}
+	}
 }
 
-void dgBroadPhase::SleepingStateKernel(void* const context, void* const node, dgInt32 threadID)
+void dgBroadPhase::SleepingStateKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
 {
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
-	dgWorld* const world = descriptor->m_world;
-	dgBroadPhase* const broadPhase = world->GetBroadPhase();
-	broadPhase->SleepingState(descriptor, (dgBodyMasterList::dgListNode*) node, threadID);
+	dgProfilerScope scope (&m_world->m_profiler, m_profileSleepingState, threadID);
+	dgBody** const bodies = descriptor->m_activeBodies;
+	for (dgInt32 i = start; i < end; i ++) {
+		dgBody* const body = bodies[i];
+		if (DoNeedUpdate(body)) {
+			SleepingState(body, descriptor->m_timestep, threadID);
+		}
+	}
 }
 
-bool dgBroadPhase::DoNeedUpdate(dgBodyMasterList::dgListNode* const node) const
+void dgBroadPhase::ForceAndTorqueSleepingStateKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
 {
-	dgBody* const body = node->GetInfo().GetBody();
+	// without pre listeners nothing can run between the two, so each chunk goes through both without a barrier
+	ForceAndTorqueKernel(context, start, end, threadID);
+	SleepingStateKernel(context, start, end, threadID);
+}
 
+bool dgBroadPhase::DoNeedUpdate(dgBody* const body) const
+{
 	bool state = body->GetInvMass().m_w != dgFloat32 (0.0f);
 	state = state || !body->m_equilibrium || (body->GetExtForceAndTorqueCallback() != NULL);
 	return state;
@@ -286,73 +442,47 @@ void dgBroadPhase::UpdateAggregateEntropy (dgBroadphaseSyncDescriptor* const des
 }
 
 
-void dgBroadPhase::ApplyForceAndtorque(dgBroadphaseSyncDescriptor* const descriptor, dgBodyMasterList::dgListNode* node, dgInt32 threadID)
+void dgBroadPhase::ApplyForceAndtorque(dgBody* const body, dgFloat32 timestep, dgInt32 threadID)
 {
-	dgFloat32 timestep = descriptor->m_timestep;
-
-	const dgInt32 threadCount = descriptor->m_world->GetThreadCount();
-	while (node) {
-		if (DoNeedUpdate(node)) {
-			dgBody* const body = node->GetInfo().GetBody();
-
-			if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
-				dgDynamicBody* const dynamicBody = (dgDynamicBody*)body;
-				dynamicBody->ApplyExtenalForces(timestep, threadID);
-			}
-		}
-
-		for (dgInt32 i = 0; i < threadCount; i++) {
-			node = node ? node->GetPrev() : NULL;
-		}
+	if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
+		dgDynamicBody* const dynamicBody = (dgDynamicBody*)body;
+		dynamicBody->ApplyExtenalForces(timestep, threadID);
 	}
 }
 
 
-void dgBroadPhase::SleepingState(dgBroadphaseSyncDescriptor* const descriptor, dgBodyMasterList::dgListNode* node, dgInt32 threadID)
+void dgBroadPhase::SleepingState(dgBody* const body, dgFloat32 timestep, dgInt32 threadID)
 {
-	dgFloat32 timestep = descriptor->m_timestep;
-
-	const dgInt32 threadCount = descriptor->m_world->GetThreadCount();
-	while (node) {
-		if (DoNeedUpdate(node)) {
-			dgBody* const body = node->GetInfo().GetBody();
-
-			if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
-				dgDynamicBody* const dynamicBody = (dgDynamicBody*)body;
-				if (!dynamicBody->IsInEquilibrium()) {
-					dynamicBody->m_sleeping = false;
-					dynamicBody->m_equilibrium = false;
-					dynamicBody->UpdateCollisionMatrix(timestep, threadID);
-				}
-				if (dynamicBody->GetInvMass().m_w == dgFloat32(0.0f) || body->m_collision->IsType(dgCollision::dgCollisionMesh_RTTI)) {
-					dynamicBody->m_sleeping = true;
-					dynamicBody->m_autoSleep = true;
-					dynamicBody->m_equilibrium = true;
-				}
-
-				dynamicBody->m_savedExternalForce = dynamicBody->m_externalForce;
-				dynamicBody->m_savedExternalTorque = dynamicBody->m_externalTorque;
-			} else {
-				dgAssert(body->IsRTTIType(dgBody::m_kinematicBodyRTTI));
+	if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
+		dgDynamicBody* const dynamicBody = (dgDynamicBody*)body;
+		if (!dynamicBody->IsInEquilibrium()) {
+			dynamicBody->m_sleeping = false;
+			dynamicBody->m_equilibrium = false;
+			dynamicBody->UpdateCollisionMatrix(timestep, threadID);
+		}
+		if (dynamicBody->GetInvMass().m_w == dgFloat32(0.0f) || body->m_collision->IsType(dgCollision::dgCollisionMesh_RTTI)) {
+			dynamicBody->m_sleeping = true;
+			dynamicBody->m_autoSleep = true;
+			dynamicBody->m_equilibrium = true;
+		}
 
-				// kinematic bodies are always sleeping (skip collision with kinematic bodies)
-				if (body->IsCollidable()) {
-					body->m_sleeping = false;
-					body->m_autoSleep = false;
-				} else {
-					body->m_sleeping = true;
-					body->m_autoSleep = true;
-				}
-				body->m_equilibrium = true;
+		dynamicBody->m_savedExternalForce = dynamicBody->m_externalForce;
+		dynamicBody->m_savedExternalTorque = dynamicBody->m_externalTorque;
+	} else {
+		dgAssert(body->IsRTTIType(dgBody::m_kinematicBodyRTTI));
 
-				// update collision matrix by calling the transform callback for all kinematic bodies
-				body->UpdateCollisionMatrix(timestep, threadID);
-			}
+		// kinematic bodies are always sleeping (skip collision with kinematic bodies)
+		if (body->IsCollidable()) {
+			body->m_sleeping = false;
+			body->m_autoSleep = false;
+		} else {
+			body->m_sleeping = true;
+			body->m_autoSleep = true;
 		}
+		body->m_equilibrium = true;
 
-		for (dgInt32 i = 0; i < threadCount; i++) {
-			node = node ? node->GetPrev() : NULL;
-		}
+		// update collision matrix by calling the transform callback for all kinematic bodies
+		body->UpdateCollisionMatrix(timestep, threadID);
 	}
 }
 
@@ -662,23 +792,818 @@ void dgBroadPhase::RayCast(const dgBroadPhaseNode** stackPool, dgFloat32* const
 					dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
 				}
 
-				const dgBroadPhaseNode* const right = me->GetRight();
-				dgAssert(right);
-				dist1 = ray.BoxIntersect(right->m_minBox, right->m_maxBox);
-				if (dist1 < maxParam) {
-					dgInt32 j = stack;
-					for (; j && (dist1 > distance[j - 1]); j--) {
-						stackPool[j] = stackPool[j - 1];
-						distance[j] = distance[j - 1];
-					}
-					stackPool[j] = right;
-					distance[j] = dist1;
-					stack++;
-					dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+				const dgBroadPhaseNode* const right = me->GetRight();
+				dgAssert(right);
+				dist1 = ray.BoxIntersect(right->m_minBox, right->m_maxBox);
+				if (dist1 < maxParam) {
+					dgInt32 j = stack;
+					for (; j && (dist1 > distance[j - 1]); j--) {
+						stackPool[j] = stackPool[j - 1];
+						distance[j] = distance[j - 1];
+					}
+					stackPool[j] = right;
+					distance[j] = dist1;
+					stack++;
+					dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+				}
+			}
+		}
+	}
+}
+
+void dgBroadPhase::FlatForEachBodyInAABB(dgInt32* const stackPool, dgInt32 stack, const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const
+{
+	const dgBroadPhaseFlatNode* const flatNodes = &m_flatNodes[0];
+	const dgBroadPhaseFlatLeaf* const flatLeaves = &m_flatLeaves[0];
+	while (stack) {
+		stack--;
+		const dgInt32 index = stackPool[stack];
+		const dgBroadPhaseFlatNode& rootNode = flatNodes[index];
+		if (dgOverlapTest(rootNode.m_minBox, rootNode.m_maxBox, minBox, maxBox)) {
+			if (rootNode.IsLeafNode()) {
+				dgBody* const body = flatLeaves[rootNode.GetLeaf()].m_body;
+				if (body && dgOverlapTest(body->m_minAABB, body->m_maxAABB, minBox, maxBox)) {
+					if (!callback(body, userData)) {
+						break;
+					}
+				}
+			} else {
+				stackPool[stack] = index + 1;
+				stack++;
+				dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+
+				stackPool[stack] = rootNode.GetRight();
+				stack++;
+				dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+			}
+		}
+	}
+}
+
+DG_INLINE dgInt32 dgBroadPhase::PushFlatNode(dgInt32* const stackPool, dgFloat32* const distance, dgInt32 stack, dgInt32 index, dgFloat32 dist)
+{
+	dgInt32 j = stack;
+	for (; j && (dist > distance[j - 1]); j--) {
+		stackPool[j] = stackPool[j - 1];
+		distance[j] = distance[j - 1];
+	}
+	stackPool[j] = index;
+	distance[j] = dist;
+	stack++;
+	dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+	return stack;
+}
+
+void dgBroadPhase::FlatRayCast(dgInt32* const stackPool, dgFloat32* const distance, dgInt32 stack, const dgVector& l0, const dgVector& l1, dgFastRayTest& ray, OnRayCastAction filter, OnRayPrecastAction prefilter, void* const userData) const
+{
+	dgLineBox line;
+	line.m_l0 = l0;
+	line.m_l1 = l1;
+
+	dgFloat32 maxParam = dgFloat32 (1.2f);
+	dgVector test(line.m_l0 <= line.m_l1);
+	line.m_boxL0 = (line.m_l0 & test) | line.m_l1.AndNot(test);
+	line.m_boxL1 = (line.m_l1 & test) | line.m_l0.AndNot(test);
+
+	const dgBroadPhaseFlatNode* const flatNodes = &m_flatNodes[0];
+	const dgBroadPhaseFlatLeaf* const flatLeaves = &m_flatLeaves[0];
+	while (stack) {
+		stack--;
+		dgFloat32 dist = distance[stack];
+		if (dist > maxParam) {
+			break;
+		} else {
+			const dgInt32 index = stackPool[stack];
+			const dgBroadPhaseFlatNode& me = flatNodes[index];
+			if (me.IsLeafNode()) {
+				dgBody* const body = flatLeaves[me.GetLeaf()].m_body;
+				if (body) {
+					dgFloat32 param = body->RayCast(line, filter, prefilter, userData, maxParam);
+					if (param < maxParam) {
+						maxParam = param;
+						if (maxParam < dgFloat32(1.0e-8f)) {
+							break;
+						}
+					}
+				}
+			} else {
+				const dgBroadPhaseFlatNode& left = flatNodes[index + 1];
+				dgFloat32 dist1 = ray.BoxIntersect(left.GetMinBox(), left.GetMaxBox());
+				if (dist1 < maxParam) {
+					stack = PushFlatNode(stackPool, distance, stack, index + 1, dist1);
+				}
+
+				const dgInt32 rightIndex = me.GetRight();
+				const dgBroadPhaseFlatNode& right = flatNodes[rightIndex];
+				dist1 = ray.BoxIntersect(right.GetMinBox(), right.GetMaxBox());
+				if (dist1 < maxParam) {
+					stack = PushFlatNode(stackPool, distance, stack, rightIndex, dist1);
+				}
+			}
+		}
+	}
+}
+
+dgInt32 dgBroadPhase::FlatConvexCast(dgInt32* const stackPool, dgFloat32* const distance, dgInt32 stack, const dgVector& velocA, const dgVector& velocB, dgFastRayTest& ray,
+									 dgCollisionInstance* const shape, const dgMatrix& matrix, const dgVector& target, dgFloat32* const param, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const
+{
+	dgVector boxP0;
+	dgVector boxP1;
+	dgTriplex points[DG_CONVEX_CAST_POOLSIZE];
+	dgTriplex normals[DG_CONVEX_CAST_POOLSIZE];
+	dgFloat32 penetration[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeA[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeB[DG_CONVEX_CAST_POOLSIZE];
+	dgInt32 totalCount = 0;
+
+	dgAssert(matrix.TestOrthogonal());
+	shape->CalcAABB(matrix, boxP0, boxP1);
+
+	maxContacts = dgMin (maxContacts, DG_CONVEX_CAST_POOLSIZE);
+	dgAssert (!maxContacts || (maxContacts && info));
+	dgFloat32 maxParam = *param;
+	dgFloat32 timeToImpact = *param;
+	const dgBroadPhaseFlatNode* const flatNodes = &m_flatNodes[0];
+	const dgBroadPhaseFlatLeaf* const flatLeaves = &m_flatLeaves[0];
+	while (stack) {
+		stack--;
+
+		dgFloat32 dist = distance[stack];
+		if (dist > maxParam) {
+			break;
+		} else {
+			const dgInt32 index = stackPool[stack];
+			const dgBroadPhaseFlatNode& me = flatNodes[index];
+			if (me.IsLeafNode()) {
+				dgBody* const body = flatLeaves[me.GetLeaf()].m_body;
+				if (body && !PREFILTER_RAYCAST(prefilter, body, body->m_collision, userData)) {
+					dgInt32 count = m_world->CollideContinue(shape, matrix, velocA, velocB, body->m_collision, body->m_matrix, velocB, velocB, timeToImpact, points, normals, penetration, attributeA, attributeB, maxContacts, threadIndex);
+
+					if (timeToImpact < maxParam) {
+						if ((timeToImpact - maxParam) < dgFloat32(-1.0e-3f)) {
+							totalCount = 0;
+						}
+						maxParam = timeToImpact;
+						if (count >= (maxContacts - totalCount)) {
+							count = maxContacts - totalCount;
+						}
+
+						for (dgInt32 i = 0; i < count; i++) {
+							info[totalCount].m_point[0] = points[i].m_x;
+							info[totalCount].m_point[1] = points[i].m_y;
+							info[totalCount].m_point[2] = points[i].m_z;
+							info[totalCount].m_point[3] = dgFloat32(0.0f);
+							info[totalCount].m_normal[0] = normals[i].m_x;
+							info[totalCount].m_normal[1] = normals[i].m_y;
+							info[totalCount].m_normal[2] = normals[i].m_z;
+							info[totalCount].m_normal[3] = dgFloat32(0.0f);
+							info[totalCount].m_penetration = penetration[i];
+							info[totalCount].m_contaID = attributeB[i];
+
+							info[totalCount].m_hitBody = body;
+							totalCount++;
+						}
+					}
+					if (maxParam < 1.0e-8f) {
+						break;
+					}
+				}
+			} else {
+				const dgBroadPhaseFlatNode& left = flatNodes[index + 1];
+				dgVector minBox(left.GetMinBox() - boxP1);
+				dgVector maxBox(left.GetMaxBox() - boxP0);
+				dgFloat32 dist1 = ray.BoxIntersect(minBox, maxBox);
+				if (dist1 < maxParam) {
+					stack = PushFlatNode(stackPool, distance, stack, index + 1, dist1);
+				}
+
+				const dgInt32 rightIndex = me.GetRight();
+				const dgBroadPhaseFlatNode& right = flatNodes[rightIndex];
+				minBox = right.GetMinBox() - boxP1;
+				maxBox = right.GetMaxBox() - boxP0;
+				dist1 = ray.BoxIntersect(minBox, maxBox);
+				if (dist1 < maxParam) {
+					stack = PushFlatNode(stackPool, distance, stack, rightIndex, dist1);
+				}
+			}
+		}
+	}
+	*param = maxParam;
+	return totalCount;
+}
+
+dgInt32 dgBroadPhase::FlatCollide(dgInt32* const stackPool, dgInt32* const ovelapStack, dgInt32 stack, const dgVector& boxP0, const dgVector& boxP1, dgCollisionInstance* const shape, const dgMatrix& matrix, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const
+{
+	dgTriplex points[DG_CONVEX_CAST_POOLSIZE];
+	dgTriplex normals[DG_CONVEX_CAST_POOLSIZE];
+	dgFloat32 penetration[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeA[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeB[DG_CONVEX_CAST_POOLSIZE];
+
+	dgInt32 totalCount = 0;
+	const dgBroadPhaseFlatNode* const flatNodes = &m_flatNodes[0];
+	const dgBroadPhaseFlatLeaf* const flatLeaves = &m_flatLeaves[0];
+	while (stack) {
+		stack--;
+
+		dgInt32 test = ovelapStack[stack];
+		if (test) {
+			const dgInt32 index = stackPool[stack];
+			const dgBroadPhaseFlatNode& me = flatNodes[index];
+			if (me.IsLeafNode()) {
+				dgBody* const body = flatLeaves[me.GetLeaf()].m_body;
+				if (body && !PREFILTER_RAYCAST(prefilter, body, body->m_collision, userData)) {
+					dgInt32 count = m_world->Collide(shape, matrix, body->m_collision, body->m_matrix, points, normals, penetration, attributeA, attributeB, DG_CONVEX_CAST_POOLSIZE, threadIndex);
+
+					if (count) {
+						bool teminate = false;
+						if (count >= (maxContacts - totalCount)) {
+							count = maxContacts - totalCount;
+							teminate = true;
+						}
+
+						for (dgInt32 i = 0; i < count; i++) {
+							info[totalCount].m_point[0] = points[i].m_x;
+							info[totalCount].m_point[1] = points[i].m_y;
+							info[totalCount].m_point[2] = points[i].m_z;
+							info[totalCount].m_point[3] = dgFloat32(0.0f);
+							info[totalCount].m_normal[0] = normals[i].m_x;
+							info[totalCount].m_normal[1] = normals[i].m_y;
+							info[totalCount].m_normal[2] = normals[i].m_z;
+							info[totalCount].m_normal[3] = dgFloat32(0.0f);
+							info[totalCount].m_penetration = penetration[i];
+							info[totalCount].m_contaID = attributeB[i];
+							info[totalCount].m_hitBody = body;
+							totalCount++;
+						}
+
+						if (teminate) {
+							break;
+						}
+					}
+				}
+			} else {
+				const dgBroadPhaseFlatNode& left = flatNodes[index + 1];
+				stackPool[stack] = index + 1;
+				ovelapStack[stack] = dgOverlapTest(left.m_minBox, left.m_maxBox, boxP0, boxP1);
+				stack ++;
+				dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+
+				const dgInt32 rightIndex = me.GetRight();
+				const dgBroadPhaseFlatNode& right = flatNodes[rightIndex];
+				stackPool[stack] = rightIndex;
+				ovelapStack[stack] = dgOverlapTest(right.m_minBox, right.m_maxBox, boxP0, boxP1);
+				stack++;
+				dgAssert(stack < DG_BROADPHASE_MAX_STACK_DEPTH);
+			}
+		}
+	}
+	return totalCount;
+}
+
+dgInt32 dgBroadPhase::FlattenNode(dgBroadPhaseNode* const node, dgInt32 aggregateLeaf)
+{
+	if (node->IsAggregate()) {
+		// the aggregate sub tree is inlined, its root is tagged with the aggregate leaf
+		dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*)node;
+		const dgInt32 leaf = m_flatLeavesCount;
+		m_flatLeaves[leaf].m_body = NULL;
+		m_flatLeaves[leaf].m_node = aggregate;
+		m_flatLeavesCount++;
+		if (aggregate->m_root) {
+			return FlattenNode(aggregate->m_root, leaf);
+		}
+		aggregateLeaf = leaf;
+	}
+
+	const dgInt32 index = m_flatNodesCount;
+	m_flatNodesCount++;
+	m_flatNodes[index].m_minBox = node->m_minBox;
+	m_flatNodes[index].m_maxBox = node->m_maxBox;
+
+	dgInt32 link;
+	if (node->IsLeafNode()) {
+		link = m_flatLeavesCount - 1;
+		if (!node->IsAggregate()) {
+			link = m_flatLeavesCount;
+			m_flatLeaves[link].m_body = node->GetBody();
+			m_flatLeaves[link].m_node = node;
+			m_flatLeavesCount++;
+		}
+		link = -1 - link;
+	} else {
+		dgBroadPhaseTreeNode* const treeNode = (dgBroadPhaseTreeNode*)node;
+		treeNode->m_flatIndex = index;
+		FlattenNode(treeNode->m_left, -1);
+		link = FlattenNode(treeNode->m_right, -1);
+	}
+	m_flatNodes[index].SetLinks(link, aggregateLeaf);
+	return index;
+}
+
+void dgBroadPhase::BuildFlatNodes()
+{
+	m_flatNodesCount = 0;
+	m_flatLeavesCount = 0;
+	if (m_rootNode) {
+		dgBroadPhaseNode* root = m_rootNode;
+		if (root->IsPersistentRoot() && !(root->GetLeft() && root->GetRight())) {
+			((dgBroadPhaseTreeNode*)root)->m_flatIndex = -1;
+			root = root->GetLeft() ? root->GetLeft() : root->GetRight();
+		}
+		if (root) {
+			FlattenNode(root, -1);
+		}
+	}
+	m_flatNodesValid = true;
+}
+
+void dgBroadPhase::SyncFlatNode(const dgBroadPhaseTreeNode* const node)
+{
+	const dgInt32 index = node->m_flatIndex;
+	if (m_flatNodesValid && (index >= 0)) {
+		dgBroadPhaseFlatNode& flatNode = m_flatNodes[index];
+		flatNode.SetBox(node);
+		m_flatNodes[index + 1].SetBox(node->m_left);
+		m_flatNodes[flatNode.GetRight()].SetBox(node->m_right);
+	}
+}
+
+dgInt32 dgBroadPhase::GetFlatLeft(const dgBroadPhaseTreeNode* const node) const
+{
+	dgAssert(node->m_flatIndex >= 0);
+	return node->m_flatIndex + 1;
+}
+
+dgInt32 dgBroadPhase::GetFlatRight(const dgBroadPhaseTreeNode* const node) const
+{
+	dgAssert(node->m_flatIndex >= 0);
+	return m_flatNodes[node->m_flatIndex].GetRight();
+}
+
+class dgBroadPhase::dgBatchQueryFilter
+{
+	public:
+	const dgBody* m_skipBody;
+	dgInt32 m_skipFlags;
+	OnRayPrecastAction m_prefilter;
+	void* m_userData;
+};
+
+class dgBroadPhase::dgBatchQueryKey
+{
+	public:
+	const dgCollisionInstance* m_shape;
+	dgInt32 m_key;
+	dgInt32 m_index;
+};
+
+class dgBroadPhase::dgBatchQueryContext
+{
+	public:
+	const void* m_queries;
+	void* m_results;
+	dgConvexCastReturnInfo* m_contacts;
+	const dgBatchQueryKey* m_order;
+	OnRayPrecastAction m_prefilter;
+	void* m_userData;
+	bool m_collide;
+};
+
+class dgBroadPhase::dgBatchQueryCandidates
+{
+	public:
+	dgBody* m_bodies[DG_CONVEX_CAST_BATCH_CANDIDATES];
+	dgInt32 m_count;
+	bool m_overflow;
+};
+
+class dgBroadPhase::dgRayCastBatchRay: public dgBroadPhase::dgBatchQueryFilter
+{
+	public:
+	dgRayCastBatchReturnInfo* m_hit;
+};
+
+dgUnsigned32 dgApi dgBroadPhase::BatchQueryPrefilter(const dgBody* const body, const dgCollisionInstance* const collision, void* const userData)
+{
+	const dgBatchQueryFilter* const filter = (dgBatchQueryFilter*)userData;
+	if (body == filter->m_skipBody) {
+		return 0;
+	}
+	if (filter->m_skipFlags) {
+		const dgInt32 flag = (body->GetInvMass().m_w == dgFloat32(0.0f)) ? DG_RAYCAST_BATCH_SKIP_STATIC : DG_RAYCAST_BATCH_SKIP_DYNAMIC;
+		if (filter->m_skipFlags & flag) {
+			return 0;
+		}
+	}
+	return filter->m_prefilter ? filter->m_prefilter(body, collision, filter->m_userData) : 1;
+}
+
+dgInt32 dgApi dgBroadPhase::BatchQueryCollectCandidate(dgBody* body, void* const userData)
+{
+	dgBatchQueryCandidates* const candidates = (dgBatchQueryCandidates*)userData;
+	if (candidates->m_count >= DG_CONVEX_CAST_BATCH_CANDIDATES) {
+		candidates->m_overflow = true;
+		return 0;
+	}
+	candidates->m_bodies[candidates->m_count] = body;
+	candidates->m_count++;
+	return 1;
+}
+
+dgFloat32 dgApi dgBroadPhase::RayCastBatchFilter(const dgBody* const body, const dgCollisionInstance* const collision, const dgVector& contact, const dgVector& normal, dgInt64 collisionID, void* const userData, dgFloat32 intersetParam)
+{
+	const dgRayCastBatchRay* const context = (dgRayCastBatchRay*)userData;
+	dgRayCastBatchReturnInfo* const hit = context->m_hit;
+	if (intersetParam < hit->m_param) {
+		hit->m_point[0] = contact.m_x;
+		hit->m_point[1] = contact.m_y;
+		hit->m_point[2] = contact.m_z;
+		hit->m_point[3] = dgFloat32(0.0f);
+		hit->m_normal[0] = normal.m_x;
+		hit->m_normal[1] = normal.m_y;
+		hit->m_normal[2] = normal.m_z;
+		hit->m_normal[3] = dgFloat32(0.0f);
+		hit->m_contaID = collisionID;
+		hit->m_hitBody = body;
+		hit->m_param = intersetParam;
+	}
+	return hit->m_param;
+}
+
+dgInt32 dgBroadPhase::BatchQueryCompareKeys(const dgBatchQueryKey* const keyA, const dgBatchQueryKey* const keyB, void* const context)
+{
+	// queries are grouped by shape first and sorted along a morton curve inside each group
+	if (keyA->m_shape < keyB->m_shape) {
+		return -1;
+	} else if (keyA->m_shape > keyB->m_shape) {
+		return 1;
+	}
+	if (keyA->m_key < keyB->m_key) {
+		return -1;
+	} else if (keyA->m_key > keyB->m_key) {
+		return 1;
+	}
+	return keyA->m_index - keyB->m_index;
+}
+
+void dgBroadPhase::BatchQuerySort(dgBatchQueryKey* const keys, const dgFloat32* const points, dgInt32 strideInBytes, const void* const shapes, dgInt32 count) const
+{
+	dgVector minBox(dgFloat32(1.0e15f));
+	dgVector maxBox(dgFloat32(-1.0e15f));
+	for (dgInt32 i = 0; i < count; i++) {
+		const dgFloat32* const point = (const dgFloat32*)((const char*)points + i * strideInBytes);
+		const dgVector p(point[0], point[1], point[2], dgFloat32(0.0f));
+		minBox = minBox.GetMin(p);
+		maxBox = maxBox.GetMax(p);
+	}
+
+	const dgVector size((maxBox - minBox).GetMax(dgVector(dgFloat32(1.0e-3f))));
+	const dgVector scale((dgVector(dgFloat32(1023.0f)) * size.Reciproc()) & dgVector::m_triplexMask);
+	for (dgInt32 i = 0; i < count; i++) {
+		const dgFloat32* const point = (const dgFloat32*)((const char*)points + i * strideInBytes);
+		const dgVector p(point[0], point[1], point[2], dgFloat32(0.0f));
+		const dgVector cell((p - minBox) * scale);
+		const dgInt32 x = dgClamp(dgInt32(cell.m_x), 0, 1023);
+		const dgInt32 y = dgClamp(dgInt32(cell.m_y), 0, 1023);
+		const dgInt32 z = dgClamp(dgInt32(cell.m_z), 0, 1023);
+		dgInt32 key = 0;
+		for (dgInt32 j = 0; j < 10; j++) {
+			key |= (((x >> j) & 1) << (3 * j)) | (((y >> j) & 1) << (3 * j + 1)) | (((z >> j) & 1) << (3 * j + 2));
+		}
+		keys[i].m_shape = shapes ? *(dgCollisionInstance* const*)((const char*)shapes + i * strideInBytes) : NULL;
+		keys[i].m_key = key;
+		keys[i].m_index = i;
+	}
+	dgSort(keys, count, BatchQueryCompareKeys);
+}
+
+void dgBroadPhase::RayCastBatchKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	const dgBatchQueryContext* const batch = (dgBatchQueryContext*)context;
+	const dgRayCastBatchInfo* const rays = (dgRayCastBatchInfo*)batch->m_queries;
+	dgRayCastBatchReturnInfo* const hits = (dgRayCastBatchReturnInfo*)batch->m_results;
+	for (dgInt32 i = start; i < end; i++) {
+		const dgInt32 index = batch->m_order ? batch->m_order[i].m_index : i;
+		const dgRayCastBatchInfo& info = rays[index];
+
+		dgRayCastBatchRay ray;
+		ray.m_skipBody = info.m_skipBody;
+		ray.m_skipFlags = info.m_skipFlags;
+		ray.m_prefilter = batch->m_prefilter;
+		ray.m_userData = batch->m_userData;
+		ray.m_hit = &hits[index];
+		ray.m_hit->m_hitBody = NULL;
+		ray.m_hit->m_param = dgFloat32(1.0f);
+
+		const dgVector p0(info.m_p0[0], info.m_p0[1], info.m_p0[2], dgFloat32(0.0f));
+		const dgVector p1(info.m_p1[0], info.m_p1[1], info.m_p1[2], dgFloat32(0.0f));
+		RayCast(p0, p1, RayCastBatchFilter, BatchQueryPrefilter, &ray);
+	}
+}
+
+void dgBroadPhase::ConvexCastBatchBox(const dgConvexCastBatchInfo& query, bool collide, dgVector& minBox, dgVector& maxBox)
+{
+	const dgMatrix matrix(&query.m_matrix[0][0]);
+	query.m_shape->CalcAABB(matrix, minBox, maxBox);
+	if (!collide) {
+		const dgVector step((dgVector(query.m_target[0], query.m_target[1], query.m_target[2], dgFloat32(0.0f)) - matrix.m_posit) & dgVector::m_triplexMask);
+		minBox = minBox.GetMin(minBox + step);
+		maxBox = maxBox.GetMax(maxBox + step);
+	}
+}
+
+dgInt32 dgBroadPhase::ConvexCast(const dgBatchQueryCandidates* const candidates, dgCollisionInstance* const shape, const dgMatrix& matrix, const dgVector& target, dgFloat32* const param, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const
+{
+	dgVector boxP0;
+	dgVector boxP1;
+	dgTriplex points[DG_CONVEX_CAST_POOLSIZE];
+	dgTriplex normals[DG_CONVEX_CAST_POOLSIZE];
+	dgFloat32 penetration[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeA[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeB[DG_CONVEX_CAST_POOLSIZE];
+	dgInt32 stackPool[DG_CONVEX_CAST_BATCH_CANDIDATES];
+	dgFloat32 distance[DG_CONVEX_CAST_BATCH_CANDIDATES];
+	dgInt32 totalCount = 0;
+
+	dgAssert(matrix.TestOrthogonal());
+	shape->CalcAABB(matrix, boxP0, boxP1);
+
+	const dgVector velocA((target - matrix.m_posit) & dgVector::m_triplexMask);
+	const dgVector velocB(dgFloat32(0.0f));
+	dgFastRayTest ray(dgVector(dgFloat32(0.0f)), velocA);
+
+	// the candidates are sorted far to near, so that they are visited in the same order the tree walk would reach them
+	dgInt32 stack = 0;
+	for (dgInt32 i = 0; i < candidates->m_count; i++) {
+		const dgBody* const body = candidates->m_bodies[i];
+		const dgFloat32 dist = ray.BoxIntersect(body->m_minAABB - boxP1, body->m_maxAABB - boxP0);
+		if (dist < *param) {
+			dgInt32 j = stack;
+			for (; j && (dist > distance[j - 1]); j--) {
+				stackPool[j] = stackPool[j - 1];
+				distance[j] = distance[j - 1];
+			}
+			stackPool[j] = i;
+			distance[j] = dist;
+			stack++;
+		}
+	}
+
+	maxContacts = dgMin (maxContacts, DG_CONVEX_CAST_POOLSIZE);
+	dgAssert (!maxContacts || (maxContacts && info));
+	dgFloat32 maxParam = *param;
+	dgFloat32 timeToImpact = *param;
+	while (stack) {
+		stack--;
+		if (distance[stack] > maxParam) {
+			break;
+		}
+		dgBody* const body = candidates->m_bodies[stackPool[stack]];
+		if (!PREFILTER_RAYCAST(prefilter, body, body->m_collision, userData)) {
+			dgInt32 count = m_world->CollideContinue(shape, matrix, velocA, velocB, body->m_collision, body->m_matrix, velocB, velocB, timeToImpact, points, normals, penetration, attributeA, attributeB, maxContacts, threadIndex);
+
+			if (timeToImpact < maxParam) {
+				if ((timeToImpact - maxParam) < dgFloat32(-1.0e-3f)) {
+					totalCount = 0;
+				}
+				maxParam = timeToImpact;
+				if (count >= (maxContacts - totalCount)) {
+					count = maxContacts - totalCount;
+				}
+
+				for (dgInt32 i = 0; i < count; i++) {
+					info[totalCount].m_point[0] = points[i].m_x;
+					info[totalCount].m_point[1] = points[i].m_y;
+					info[totalCount].m_point[2] = points[i].m_z;
+					info[totalCount].m_point[3] = dgFloat32(0.0f);
+					info[totalCount].m_normal[0] = normals[i].m_x;
+					info[totalCount].m_normal[1] = normals[i].m_y;
+					info[totalCount].m_normal[2] = normals[i].m_z;
+					info[totalCount].m_normal[3] = dgFloat32(0.0f);
+					info[totalCount].m_penetration = penetration[i];
+					info[totalCount].m_contaID = attributeB[i];
+
+					info[totalCount].m_hitBody = body;
+					totalCount++;
+				}
+			}
+			if (maxParam < 1.0e-8f) {
+				break;
+			}
+		}
+	}
+	*param = maxParam;
+	return totalCount;
+}
+
+dgInt32 dgBroadPhase::Collide(const dgBatchQueryCandidates* const candidates, dgCollisionInstance* const shape, const dgMatrix& matrix, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const
+{
+	dgVector boxP0;
+	dgVector boxP1;
+	dgTriplex points[DG_CONVEX_CAST_POOLSIZE];
+	dgTriplex normals[DG_CONVEX_CAST_POOLSIZE];
+	dgFloat32 penetration[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeA[DG_CONVEX_CAST_POOLSIZE];
+	dgInt64 attributeB[DG_CONVEX_CAST_POOLSIZE];
+
+	dgAssert(matrix.TestOrthogonal());
+	shape->CalcAABB(matrix, boxP0, boxP1);
+
+	dgInt32 totalCount = 0;
+	for (dgInt32 i = 0; i < candidates->m_count; i++) {
+		dgBody* const body = candidates->m_bodies[i];
+		if (dgOverlapTest(body->m_minAABB, body->m_maxAABB, boxP0, boxP1) && !PREFILTER_RAYCAST(prefilter, body, body->m_collision, userData)) {
+			dgInt32 count = m_world->Collide(shape, matrix, body->m_collision, body->m_matrix, points, normals, penetration, attributeA, attributeB, DG_CONVEX_CAST_POOLSIZE, threadIndex);
+
+			if (count) {
+				bool teminate = false;
+				if (count >= (maxContacts - totalCount)) {
+					count = maxContacts - totalCount;
+					teminate = true;
+				}
+
+				for (dgInt32 j = 0; j < count; j++) {
+					info[totalCount].m_point[0] = points[j].m_x;
+					info[totalCount].m_point[1] = points[j].m_y;
+					info[totalCount].m_point[2] = points[j].m_z;
+					info[totalCount].m_point[3] = dgFloat32(0.0f);
+					info[totalCount].m_normal[0] = normals[j].m_x;
+					info[totalCount].m_normal[1] = normals[j].m_y;
+					info[totalCount].m_normal[2] = normals[j].m_z;
+					info[totalCount].m_normal[3] = dgFloat32(0.0f);
+					info[totalCount].m_penetration = penetration[j];
+					info[totalCount].m_contaID = attributeB[j];
+					info[totalCount].m_hitBody = body;
+					totalCount++;
+				}
+
+				if (teminate) {
+					break;
+				}
+			}
+		}
+	}
+	return totalCount;
+}
+
+void dgBroadPhase::ConvexCastBatchKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	const dgBatchQueryContext* const batch = (dgBatchQueryContext*)context;
+	const dgConvexCastBatchInfo* const queries = (dgConvexCastBatchInfo*)batch->m_queries;
+	dgConvexCastBatchReturnInfo* const results = (dgConvexCastBatchReturnInfo*)batch->m_results;
+
+	dgBatchQueryCandidates candidates;
+	for (dgInt32 i = start; i < end; ) {
+		// consecutive queries on the same shape whose boxes are close to each other make a group, 
+		// the tree is walked once with the union of their boxes and the bodies it finds are shared by the group
+		const dgConvexCastBatchInfo& first = queries[batch->m_order ? batch->m_order[i].m_index : i];
+		dgVector groupP0;
+		dgVector groupP1;
+		ConvexCastBatchBox(first, batch->m_collide, groupP0, groupP1);
+		dgVector side(groupP1 - groupP0);
+		dgFloat32 groupArea = side.DotProduct4(side.ShiftTripleRight()).GetScalar();
+
+		dgInt32 groupCount = 1;
+		for (; (groupCount < DG_CONVEX_CAST_BATCH_GROUP_SIZE) && ((i + groupCount) < end); groupCount++) {
+			const dgInt32 index = batch->m_order ? batch->m_order[i + groupCount].m_index : i + groupCount;
+			const dgConvexCastBatchInfo& query = queries[index];
+			if (query.m_shape != first.m_shape) {
+				break;
+			}
+			dgVector boxP0;
+			dgVector boxP1;
+			ConvexCastBatchBox(query, batch->m_collide, boxP0, boxP1);
+			const dgVector unionP0(groupP0.GetMin(boxP0));
+			const dgVector unionP1(groupP1.GetMax(boxP1));
+			side = boxP1 - boxP0;
+			const dgFloat32 area = side.DotProduct4(side.ShiftTripleRight()).GetScalar();
+			side = unionP1 - unionP0;
+			const dgFloat32 unionArea = side.DotProduct4(side.ShiftTripleRight()).GetScalar();
+			if (unionArea > (groupArea + area)) {
+				// the query is far from the group, a shared walk would visit more nodes than two separate ones
+				break;
+			}
+			groupP0 = unionP0;
+			groupP1 = unionP1;
+			groupArea += area;
+		}
+
+		candidates.m_count = 0;
+		candidates.m_overflow = false;
+		if (groupCount > 1) {
+			ForEachBodyInAABB(groupP0, groupP1, BatchQueryCollectCandidate, &candidates);
+		}
+		const bool shared = (groupCount > 1) && !candidates.m_overflow;
+
+		for (dgInt32 j = 0; j < groupCount; j++) {
+			const dgInt32 index = batch->m_order ? batch->m_order[i + j].m_index : i + j;
+			const dgConvexCastBatchInfo& query = queries[index];
+			dgConvexCastBatchReturnInfo& result = results[index];
+
+			dgBatchQueryFilter filter;
+			filter.m_skipBody = query.m_skipBody;
+			filter.m_skipFlags = query.m_skipFlags;
+			filter.m_prefilter = batch->m_prefilter;
+			filter.m_userData = batch->m_userData;
+
+			// each query writes to its own slice of the contact array, slices are packed after all queries are done
+			dgConvexCastReturnInfo* const info = batch->m_contacts ? &batch->m_contacts[result.m_firstContact] : NULL;
+			const dgInt32 maxContacts = info ? query.m_maxContacts : 0;
+			const dgMatrix matrix(&query.m_matrix[0][0]);
+			if (batch->m_collide) {
+				result.m_param = dgFloat32(0.0f);
+				if (shared) {
+					result.m_contactCount = Collide(&candidates, query.m_shape, matrix, BatchQueryPrefilter, &filter, info, maxContacts, threadID);
+				} else {
+					result.m_contactCount = Collide(query.m_shape, matrix, BatchQueryPrefilter, &filter, info, maxContacts, threadID);
+				}
+			} else {
+				const dgVector target(query.m_target[0], query.m_target[1], query.m_target[2], dgFloat32(0.0f));
+				result.m_param = dgFloat32(1.0f);
+				if (shared) {
+					result.m_contactCount = ConvexCast(&candidates, query.m_shape, matrix, target, &result.m_param, BatchQueryPrefilter, &filter, info, maxContacts, threadID);
+				} else {
+					result.m_contactCount = ConvexCast(query.m_shape, matrix, target, &result.m_param, BatchQueryPrefilter, &filter, info, maxContacts, threadID);
+				}
+			}
+		}
+		i += groupCount;
+	}
+}
+
+void dgBroadPhase::RayCastBatch(const dgRayCastBatchInfo* const rays, dgRayCastBatchReturnInfo* const hits, dgInt32 count, OnRayPrecastAction prefilter, void* const userData)
+{
+	if (count <= 0) {
+		return;
+	}
+
+	dgBatchQueryContext context;
+	context.m_queries = rays;
+	context.m_results = hits;
+	context.m_contacts = NULL;
+	context.m_order = NULL;
+	context.m_prefilter = prefilter;
+	context.m_userData = userData;
+	context.m_collide = false;
+
+	// rays are visited in morton order of their origins, so that the rays claimed by 
+	// one thread are coherent and walk the same nodes of the tree
+	dgStack<dgBatchQueryKey> order((count >= DG_BATCH_QUERY_SORT_MIN_COUNT) ? count : 1);
+	if (count >= DG_BATCH_QUERY_SORT_MIN_COUNT) {
+		BatchQuerySort(&order[0], &rays[0].m_p0[0], sizeof (dgRayCastBatchInfo), NULL, count);
+		context.m_order = &order[0];
+	}
+
+	BroadPhaseFor(&dgBroadPhase::RayCastBatchKernel, &context, 0, count, DG_RAYCAST_BATCH_CHUNK_SIZE);
+}
+
+dgInt32 dgBroadPhase::ConvexCastBatch(const dgConvexCastBatchInfo* const queries, dgConvexCastBatchReturnInfo* const results, dgInt32 count, dgConvexCastReturnInfo* const contacts, OnRayPrecastAction prefilter, void* const userData, bool collide)
+{
+	if (count <= 0) {
+		return 0;
+	}
+
+	dgInt32 contactsCount = 0;
+	for (dgInt32 i = 0; i < count; i++) {
+		results[i].m_firstContact = contactsCount;
+		results[i].m_contactCount = 0;
+		contactsCount += contacts ? queries[i].m_maxContacts : 0;
+	}
+
+	dgBatchQueryContext context;
+	context.m_queries = queries;
+	context.m_results = results;
+	context.m_contacts = contacts;
+	context.m_order = NULL;
+	context.m_prefilter = prefilter;
+	context.m_userData = userData;
+	context.m_collide = collide;
+
+	// queries that share a shape run back to back so that the shape data and the tree nodes
+	// near the query stay in the cache of the thread that claimed them
+	dgStack<dgBatchQueryKey> order((count >= DG_BATCH_QUERY_SORT_MIN_COUNT) ? count : 1);
+	if (count >= DG_BATCH_QUERY_SORT_MIN_COUNT) {
+		BatchQuerySort(&order[0], &queries[0].m_matrix[3][0], sizeof (dgConvexCastBatchInfo), &queries[0].m_shape, count);
+		context.m_order = &order[0];
+	}
+
+	BroadPhaseFor(&dgBroadPhase::ConvexCastBatchKernel, &context, 0, count, DG_CONVEX_CAST_BATCH_CHUNK_SIZE);
+
+	contactsCount = 0;
+	if (contacts) {
+		for (dgInt32 i = 0; i < count; i++) {
+			dgConvexCastBatchReturnInfo& result = results[i];
+			if (result.m_firstContact != contactsCount) {
+				for (dgInt32 j = 0; j < result.m_contactCount; j++) {
+					contacts[contactsCount + j] = contacts[result.m_firstContact + j];
 				}
 			}
+			result.m_firstContact = contactsCount;
+			contactsCount += result.m_contactCount;
 		}
 	}
+	return contactsCount;
 }
 
 void dgBroadPhase::CollisionChange (dgBody* const body, dgCollisionInstance* const collision)
@@ -709,71 +1634,289 @@ void dgBroadPhase::UpdateBody(dgBody* const body, dgInt32 threadIndex)
 
 		const dgBroadPhaseNode* const root = (m_rootNode->GetLeft() && m_rootNode->GetRight()) ? NULL : m_rootNode;
 
-		dgThreadHiveScopeLock lock(m_world, &m_criticalSectionLock, true);
-		if (body1->GetBroadPhaseAggregate()) {
-			dgBroadPhaseAggregate* const aggregate = body1->GetBroadPhaseAggregate();
-			aggregate->m_isInEquilibrium = body1->m_equilibrium;
-			aggregate->SetAsDirty(m_lru + 1);
-		}
-
-		m_dirtyNodesCount += (node->m_nodeIsDirtyLru != (m_lru + 1)) ? 1 : 0;
-		node->SetAsDirty(m_lru + 1);
-		if (!dgBoxInclusionTest(body1->m_minAABB, body1->m_maxAABB, node->m_minBox, node->m_maxBox)) {
-			dgAssert(!node->IsAggregate());
-			node->SetAABB(body1->m_minAABB, body1->m_maxAABB);
-			for (dgBroadPhaseNode* parent = node->m_parent; parent != root; parent = parent->m_parent) {
-				if (!parent->IsAggregate()) {
-					dgVector minBox;
-					dgVector maxBox;
-					dgFloat32 area = CalculateSurfaceArea(parent->GetLeft(), parent->GetRight(), minBox, maxBox);
-					if (dgBoxInclusionTest(minBox, maxBox, parent->m_minBox, parent->m_maxBox)) {
+		if (m_world->m_inUpdate && !body1->GetBroadPhaseAggregate()) {
+			// during the update the threads only touch their own leaf and mark the path to the root,
+			// the marked nodes are refitted bottom up by RefitDirtyNodes
+			if (node->m_nodeIsDirtyLru != (m_lru + 1)) {
+				dgAtomicExchangeAndAdd(&m_dirtyNodesCount, 1);
+				node->SetAsDirty(m_lru + 1);
+			}
+			if (!dgBoxInclusionTest(body1->m_minAABB, body1->m_maxAABB, node->m_minBox, node->m_maxBox)) {
+				node->SetAABB(body1->m_minAABB, body1->m_maxAABB);
+				for (dgBroadPhaseNode* parent = node->m_parent; parent != root; parent = parent->m_parent) {
+					dgAssert(!parent->IsLeafNode() && !parent->IsAggregate());
+					dgBroadPhaseTreeNode* const treeNode = (dgBroadPhaseTreeNode*)parent;
+					if (dgInterlockedExchange(&treeNode->m_refitMark, 1)) {
 						break;
 					}
-					parent->m_minBox = minBox;
-					parent->m_maxBox = maxBox;
-					parent->m_surfaceArea = area;
-				} else {
-					dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*)parent;
-					aggregate->m_minBox = aggregate->m_root->m_minBox;
-					aggregate->m_maxBox = aggregate->m_root->m_maxBox;
-					aggregate->m_surfaceArea = aggregate->m_root->m_surfaceArea;
+				}
+				m_refitPending = 1;
+			}
+		} else {
+			dgThreadHiveScopeLock lock(m_world, &m_criticalSectionLock, true);
+			if (body1->GetBroadPhaseAggregate()) {
+				dgBroadPhaseAggregate* const aggregate = body1->GetBroadPhaseAggregate();
+				aggregate->m_isInEquilibrium = body1->m_equilibrium;
+				aggregate->SetAsDirty(m_lru + 1);
+			}
+
+			m_dirtyNodesCount += (node->m_nodeIsDirtyLru != (m_lru + 1)) ? 1 : 0;
+			node->SetAsDirty(m_lru + 1);
+			if (!dgBoxInclusionTest(body1->m_minAABB, body1->m_maxAABB, node->m_minBox, node->m_maxBox)) {
+				dgAssert(!node->IsAggregate());
+				node->SetAABB(body1->m_minAABB, body1->m_maxAABB);
+				for (dgBroadPhaseNode* parent = node->m_parent; parent != root; parent = parent->m_parent) {
+					if (!parent->IsAggregate()) {
+						dgVector minBox;
+						dgVector maxBox;
+						dgFloat32 area = CalculateSurfaceArea(parent->GetLeft(), parent->GetRight(), minBox, maxBox);
+						if (dgBoxInclusionTest(minBox, maxBox, parent->m_minBox, parent->m_maxBox)) {
+							SyncFlatNode((dgBroadPhaseTreeNode*)parent);
+							break;
+						}
+						parent->m_minBox = minBox;
+						parent->m_maxBox = maxBox;
+						parent->m_surfaceArea = area;
+						SyncFlatNode((dgBroadPhaseTreeNode*)parent);
+					} else {
+						dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*)parent;
+						aggregate->m_minBox = aggregate->m_root->m_minBox;
+						aggregate->m_maxBox = aggregate->m_root->m_maxBox;
+						aggregate->m_surfaceArea = aggregate->m_root->m_surfaceArea;
+					}
+				}
+			}
+		}
+	}
+}
+
+
+bool dgBroadPhase::IsRefitPending(const dgBroadPhaseNode* const node)
+{
+	return node && !node->IsLeafNode() && !node->IsAggregate() && ((dgBroadPhaseTreeNode*)node)->m_refitMark;
+}
+
+
+void dgBroadPhase::RefitNodesKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	dgBroadPhaseTreeNode** const nodes = (dgBroadPhaseTreeNode**)context;
+	for (dgInt32 i = start; i < end; i++) {
+		dgBroadPhaseTreeNode* const node = nodes[i];
+		node->m_surfaceArea = CalculateSurfaceArea(node->m_left, node->m_right, node->m_minBox, node->m_maxBox);
+		SyncFlatNode(node);
+	}
+}
+
+
+void dgBroadPhase::RefitDirtyNodes()
+{
+	if (m_refitPending) {
+		m_refitPending = 0;
+		dgAssert(m_rootNode && !m_rootNode->IsLeafNode());
+
+		// the marked nodes are a connected sub tree, collect it level by level starting from the root
+		dgInt32 count = 0;
+		if (IsRefitPending(m_rootNode)) {
+			m_refitNodes[count] = (dgBroadPhaseTreeNode*)m_rootNode;
+			count++;
+		} else {
+			if (IsRefitPending(m_rootNode->GetLeft())) {
+				m_refitNodes[count] = (dgBroadPhaseTreeNode*)m_rootNode->GetLeft();
+				count++;
+			}
+			if (IsRefitPending(m_rootNode->GetRight())) {
+				m_refitNodes[count] = (dgBroadPhaseTreeNode*)m_rootNode->GetRight();
+				count++;
+			}
+		}
+
+		dgInt32 levelsCount = 0;
+		for (dgInt32 start = 0; start < count; ) {
+			const dgInt32 end = count;
+			m_refitLevels[levelsCount] = start;
+			levelsCount++;
+			for (dgInt32 i = start; i < end; i++) {
+				dgBroadPhaseTreeNode* const node = m_refitNodes[i];
+				node->m_refitMark = 0;
+				if (IsRefitPending(node->m_left)) {
+					m_refitNodes[count] = (dgBroadPhaseTreeNode*)node->m_left;
+					count++;
+				}
+				if (IsRefitPending(node->m_right)) {
+					m_refitNodes[count] = (dgBroadPhaseTreeNode*)node->m_right;
+					count++;
 				}
 			}
+			start = end;
 		}
+		m_refitLevels[levelsCount] = count;
+
+		// nodes on the same level are independent, refit from the deepest level up
+		dgBroadPhaseTreeNode** const nodes = &m_refitNodes[0];
+		for (dgInt32 i = levelsCount - 1; i >= 0; i--) {
+			BroadPhaseFor(&dgBroadPhase::RefitNodesKernel, nodes, m_refitLevels[i], m_refitLevels[i + 1], DG_BROADPHASE_REFIT_CHUNK_SIZE);
+		}
+	}
+}
+
+
+void dgBroadPhase::BroadPhaseFor(dgBroadPhaseKernel::dgKernel kernel, void* const context, dgInt32 start, dgInt32 end, dgInt32 minChunkSize)
+{
+	m_world->ParallelFor(dgBroadPhaseKernel(this, kernel, context), start, end, minChunkSize);
+}
+
+
+dgInt32 dgBroadPhase::SpliteBoxes(dgBroadPhaseNode** const boxArray, dgInt32 boxCount, dgVector& minBox, dgVector& maxBox) const
+{
+	dgSpliteInfo info;
+	info.ResetBounds();
+	info.AddBounds(boxArray, boxCount);
+	minBox = info.m_p0;
+	maxBox = info.m_p1;
+	if (boxCount == 2) {
+		return 1;
+	}
+	info.SetBins();
+	info.AddBins(boxArray, boxCount);
+	return info.Partition(boxArray, boxCount);
+}
+
+
+void dgBroadPhase::BuildBoundsKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	dgBuildSyncData* const syncData = (dgBuildSyncData*)context;
+	syncData->m_threadInfo[threadID].AddBounds(&syncData->m_leafArray[start], end - start);
+}
+
+
+void dgBroadPhase::BuildBinsKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	dgBuildSyncData* const syncData = (dgBuildSyncData*)context;
+	syncData->m_threadInfo[threadID].AddBins(&syncData->m_leafArray[start], end - start);
+}
+
+
+dgInt32 dgBroadPhase::SpliteBoxesParallel(dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 boxCount, dgVector& minBox, dgVector& maxBox)
+{
+	const dgInt32 threadCount = m_world->GetThreadCount();
+	dgSpliteInfo* const threadInfo = syncData->m_threadInfo;
+	for (dgInt32 i = 0; i < threadCount; i++) {
+		threadInfo[i].ResetBounds();
+	}
+	BroadPhaseFor(&dgBroadPhase::BuildBoundsKernel, syncData, firstBox, firstBox + boxCount, DG_BROADPHASE_BUILD_CHUNK_SIZE);
+
+	dgSpliteInfo& info = threadInfo[0];
+	for (dgInt32 i = 1; i < threadCount; i++) {
+		info.MergeBounds(threadInfo[i]);
+	}
+	minBox = info.m_p0;
+	maxBox = info.m_p1;
+
+	info.SetBins();
+	for (dgInt32 i = 1; i < threadCount; i++) {
+		threadInfo[i].SetBins(info);
+	}
+	BroadPhaseFor(&dgBroadPhase::BuildBinsKernel, syncData, firstBox, firstBox + boxCount, DG_BROADPHASE_BUILD_CHUNK_SIZE);
+
+	for (dgInt32 i = 1; i < threadCount; i++) {
+		info.MergeBins(threadInfo[i]);
 	}
+	return info.Partition(&syncData->m_leafArray[firstBox], boxCount);
 }
 
 
-dgBroadPhaseNode* dgBroadPhase::BuildTopDown(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode)
+dgBroadPhaseNode* dgBroadPhase::BuildTopDown(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgBroadPhaseTreeNode** const nodeArray, dgInt32 nodeIndex) const
 {
 	dgAssert(firstBox >= 0);
-	dgAssert(lastBox >= 0);
+	dgAssert(lastBox >= firstBox);
 
 	if (lastBox == firstBox) {
 		return leafArray[firstBox];
 	} else {
-		dgSpliteInfo info(&leafArray[firstBox], lastBox - firstBox + 1);
+		// a sub tree with n leaves uses the n - 1 nodes starting at nodeIndex
+		dgVector minBox;
+		dgVector maxBox;
+		const dgInt32 leftCount = SpliteBoxes(&leafArray[firstBox], lastBox - firstBox + 1, minBox, maxBox);
 
-		dgBroadPhaseTreeNode* const parent = (*nextNode)->GetInfo();
+		dgBroadPhaseTreeNode* const parent = nodeArray[nodeIndex];
 		parent->m_parent = NULL;
-		*nextNode = (*nextNode)->GetNext();
-
-		parent->SetAABB(info.m_p0, info.m_p1);
+		parent->SetAABB(minBox, maxBox);
 
-		parent->m_left = BuildTopDown(leafArray, firstBox, firstBox + info.m_axis - 1, nextNode);
+		parent->m_left = BuildTopDown(leafArray, firstBox, firstBox + leftCount - 1, nodeArray, nodeIndex + 1);
 		parent->m_left->m_parent = parent;
 
-		parent->m_right = BuildTopDown(leafArray, firstBox + info.m_axis, lastBox, nextNode);
+		parent->m_right = BuildTopDown(leafArray, firstBox + leftCount, lastBox, nodeArray, nodeIndex + leftCount);
 		parent->m_right->m_parent = parent;
 		return parent;
 	}
 }
 
 
-dgBroadPhaseNode* dgBroadPhase::BuildTopDownBig(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode)
+void dgBroadPhase::SpliteTopDown(dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 lastBox, dgInt32 nodeIndex, dgBroadPhaseTreeNode* const parent, dgBroadPhaseNode** const link)
+{
+	const dgInt32 boxCount = lastBox - firstBox + 1;
+	if (boxCount <= syncData->m_taskSize) {
+		dgBuildTask& task = syncData->m_tasks[syncData->m_tasksCount];
+		task.m_link = link;
+		task.m_parent = parent;
+		task.m_firstBox = firstBox;
+		task.m_lastBox = lastBox;
+		task.m_nodeIndex = nodeIndex;
+		syncData->m_tasksCount++;
+	} else {
+		dgVector minBox;
+		dgVector maxBox;
+		const dgInt32 leftCount = SpliteBoxesParallel(syncData, firstBox, boxCount, minBox, maxBox);
+
+		dgBroadPhaseTreeNode* const node = syncData->m_nodeArray[nodeIndex];
+		node->m_parent = parent;
+		node->SetAABB(minBox, maxBox);
+		*link = node;
+
+		SpliteTopDown(syncData, firstBox, firstBox + leftCount - 1, nodeIndex + 1, node, &node->m_left);
+		SpliteTopDown(syncData, firstBox + leftCount, lastBox, nodeIndex + leftCount, node, &node->m_right);
+	}
+}
+
+
+void dgBroadPhase::BuildSubtreesKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
 {
+	dgBuildSyncData* const syncData = (dgBuildSyncData*)context;
+	for (dgInt32 i = start; i < end; i++) {
+		const dgBuildTask& task = syncData->m_tasks[i];
+		dgBroadPhaseNode* const node = BuildTopDown(syncData->m_leafArray, task.m_firstBox, task.m_lastBox, syncData->m_nodeArray, task.m_nodeIndex);
+		node->m_parent = task.m_parent;
+		*task.m_link = node;
+	}
+}
+
+
+dgBroadPhaseNode* dgBroadPhase::BuildTopDownParallel(dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 lastBox, dgInt32 nodeIndex)
+{
+	const dgInt32 threadCount = m_world->GetThreadCount();
+	const dgInt32 boxCount = lastBox - firstBox + 1;
+	if ((threadCount == 1) || (boxCount <= DG_BROADPHASE_BUILD_TASK_SIZE * 2)) {
+		return BuildTopDown(syncData->m_leafArray, firstBox, lastBox, syncData->m_nodeArray, nodeIndex);
+	}
+
+	// bin the top levels in parallel until there are enough independent sub trees to keep all threads busy,
+	// since the node ranges are fixed by the leaf counts the tree is the same for any number of threads
+	syncData->m_tasksCount = 0;
+	syncData->m_taskSize = dgMax(boxCount / (threadCount * DG_PARALLEL_FOR_CHUNKS_PER_THREAD), DG_BROADPHASE_BUILD_TASK_SIZE);
+
+	dgBroadPhaseNode* root = NULL;
+	SpliteTopDown(syncData, firstBox, lastBox, nodeIndex, NULL, &root);
+	BroadPhaseFor(&dgBroadPhase::BuildSubtreesKernel, syncData, 0, syncData->m_tasksCount, 1);
+	dgAssert(root && !root->m_parent);
+	return root;
+}
+
+
+dgBroadPhaseNode* dgBroadPhase::BuildTopDownBig(dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 lastBox, dgInt32 nodeIndex)
+{
+	dgBroadPhaseNode** const leafArray = syncData->m_leafArray;
 	if (lastBox == firstBox) {
-		return BuildTopDown(leafArray, firstBox, lastBox, nextNode);
+		return leafArray[firstBox];
 	}
 
 	dgInt32 midPoint = -1;
@@ -790,27 +1933,25 @@ dgBroadPhaseNode* dgBroadPhase::BuildTopDownBig(dgBroadPhaseNode** const leafArr
 	}
 
 	if (midPoint == -1) {
-		return BuildTopDown(leafArray, firstBox, lastBox, nextNode);
+		return BuildTopDownParallel(syncData, firstBox, lastBox, nodeIndex);
 	} else {
-		dgBroadPhaseTreeNode* const parent = (*nextNode)->GetInfo();
-
+		dgBroadPhaseTreeNode* const parent = syncData->m_nodeArray[nodeIndex];
 		parent->m_parent = NULL;
-		*nextNode = (*nextNode)->GetNext();
 
 		dgVector minP(dgFloat32(1.0e15f));
 		dgVector maxP(-dgFloat32(1.0e15f));
 		for (dgInt32 i = 0; i <= count; i++) {
 			const dgBroadPhaseNode* const node = leafArray[firstBox + i];
-			dgAssert(node->IsLeafNode());
+			dgAssert(node->IsLeafNode() || node->IsAggregate());
 			minP = minP.GetMin(node->m_minBox);
 			maxP = maxP.GetMax(node->m_maxBox);
 		}
 
 		parent->SetAABB(minP, maxP);
-		parent->m_left = BuildTopDown(leafArray, firstBox, firstBox + midPoint, nextNode);
+		parent->m_left = BuildTopDownParallel(syncData, firstBox, firstBox + midPoint, nodeIndex + 1);
 		parent->m_left->m_parent = parent;
 
-		parent->m_right = BuildTopDownBig(leafArray, firstBox + midPoint + 1, lastBox, nextNode);
+		parent->m_right = BuildTopDownBig(syncData, firstBox + midPoint + 1, lastBox, nodeIndex + midPoint + 1);
 		parent->m_right->m_parent = parent;
 		return parent;
 	}
@@ -836,16 +1977,33 @@ void dgBroadPhase::ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy,
 	if (*root) {
 		dgBroadPhaseNode* const parent = (*root)->m_parent;
 		(*root)->m_parent = NULL;
-		dgFloat64 entropy = CalculateEntropy(fitness, root);
 
-		if ((entropy > oldEntropy * dgFloat32(2.0f)) || (entropy < oldEntropy * dgFloat32(0.5f))) {
+		// rotations are cheap when the tree cost is close to the last optimized cost, 
+		// but a tree that drifted too far is rebuilt rather than rotated back into shape
+		const dgFloat64 maxEntropy = oldEntropy * DG_BROADPHASE_REBUILD_RATIO;
+		const dgFloat64 minEntropy = oldEntropy / DG_BROADPHASE_REBUILD_RATIO;
+		dgFloat64 entropy = fitness.TotalCost();
+		if ((entropy <= maxEntropy) && (entropy >= minEntropy)) {
+			entropy = CalculateEntropy(fitness, root);
+		}
+
+		if ((entropy > maxEntropy) || (entropy < minEntropy)) {
 			if (fitness.GetFirst()) {
-				m_world->m_solverJacobiansMemory.ResizeIfNecessary ((fitness.GetCount() * 2 + 16) * sizeof (dgBroadPhaseNode*));
+				m_flatNodesValid = false;
+				const dgInt32 nodesCount = fitness.GetCount();
+				const dgInt32 leafArraySize = nodesCount * 2 + 16;
+				m_world->m_solverJacobiansMemory.ResizeIfNecessary (leafArraySize * sizeof (dgBroadPhaseNode*) + nodesCount * sizeof (dgBroadPhaseTreeNode*) + (nodesCount + 16) * sizeof (dgBuildTask));
 				dgBroadPhaseNode** const leafArray = (dgBroadPhaseNode**)&m_world->m_solverJacobiansMemory[0];
+				dgBroadPhaseTreeNode** const nodeArray = (dgBroadPhaseTreeNode**)&leafArray[leafArraySize];
+				dgBuildTask* const tasks = (dgBuildTask*)&nodeArray[nodesCount];
 
 				dgInt32 leafNodesCount = 0;
+				dgInt32 treeNodesCount = 0;
 				for (dgFitnessList::dgListNode* nodePtr = fitness.GetFirst(); nodePtr; nodePtr = nodePtr->GetNext()) {
-					dgBroadPhaseNode* const node = nodePtr->GetInfo();
+					dgBroadPhaseTreeNode* const node = nodePtr->GetInfo();
+					nodeArray[treeNodesCount] = node;
+					treeNodesCount++;
+
 					dgBroadPhaseNode* const leftNode = node->GetLeft();
 					dgBody* const leftBody = leftNode->GetBody();
 					if (leftBody) {
@@ -867,11 +2025,19 @@ void dgBroadPhase::ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy,
 						leafNodesCount++;
 					}
 				}
+				dgAssert(leafNodesCount == (treeNodesCount + 1));
 
-				dgFitnessList::dgListNode* nodePtr = fitness.GetFirst();
+				dgSpliteInfo threadInfo[DG_MAX_THREADS_HIVE_COUNT];
+				dgBuildSyncData syncData;
+				syncData.m_leafArray = leafArray;
+				syncData.m_nodeArray = nodeArray;
+				syncData.m_tasks = tasks;
+				syncData.m_threadInfo = threadInfo;
+				syncData.m_tasksCount = 0;
+				syncData.m_taskSize = leafNodesCount;
 
 				dgSortIndirect(leafArray, leafNodesCount, CompareNodes);
-				*root = BuildTopDownBig(leafArray, 0, leafNodesCount - 1, &nodePtr);
+				*root = BuildTopDownBig(&syncData, 0, leafNodesCount - 1, 0);
 				dgAssert(!(*root)->m_parent);
 				entropy = CalculateEntropy(fitness, root);
 			}
@@ -1065,7 +2231,11 @@ void dgBroadPhase::CalculatePairContacts (dgPair* const pair, dgInt32 threadID)
 	pair->m_cacheIsValid = false;
 	pair->m_contactBuffer = contacts;
 	m_world->CalculateContacts(pair, threadID, false, false);
+	ApplyPairContacts (pair, threadID);
+}
 
+void dgBroadPhase::ApplyPairContacts (dgPair* const pair, dgInt32 threadID)
+{
 	if (pair->m_contactCount) {
 //		if (pair->m_contact->m_body0->m_invMass.m_w != dgFloat32 (0.0f)) {
 //			pair->m_contact->m_body0->m_equilibrium = false;
@@ -1086,7 +2256,7 @@ void dgBroadPhase::CalculatePairContacts (dgPair* const pair, dgInt32 threadID)
 	}
 }
 
-void dgBroadPhase::AddPair (dgContact* const contact, dgFloat32 timestep, dgInt32 threadIndex)
+bool dgBroadPhase::IsPairCollidable (dgContact* const contact, dgInt32 threadIndex) const
 {
 	dgWorld* const world = (dgWorld*) m_world;
 	dgBody* const body0 = contact->m_body0;
@@ -1101,7 +2271,7 @@ void dgBroadPhase::AddPair (dgContact* const contact, dgFloat32 timestep, dgInt3
 	dgAssert (body1->GetWorld() == world);
 	if (!(body0->m_collideWithLinkedBodies & body1->m_collideWithLinkedBodies)) {
 		if (world->AreBodyConnectedByJoints (body0, body1)) {
-			return;
+			return false;
 		}
 	}
 
@@ -1112,60 +2282,257 @@ void dgBroadPhase::AddPair (dgContact* const contact, dgFloat32 timestep, dgInt3
 			processContacts = material->m_aabbOverlap (*material, *body0, *body1, threadIndex);
 		}
 		if (processContacts) {
-            dgPair pair;
 			dgAssert (!body0->m_collision->IsType (dgCollision::dgCollisionNull_RTTI));
 			dgAssert (!body1->m_collision->IsType (dgCollision::dgCollisionNull_RTTI));
+			return true;
+		}
+	}
+	return false;
+}
+
+void dgBroadPhase::AddPair (dgContact* const contact, dgFloat32 timestep, dgInt32 threadIndex)
+{
+	if (IsPairCollidable (contact, threadIndex)) {
+		dgPair pair;
+		pair.m_contact = contact;
+		pair.m_timestep = timestep;
+		CalculatePairContacts (&pair, threadIndex);
+	}
+}
+
+
+const dgContactMaterial* dgBroadPhase::GetPairMaterial (dgBody* const body0, dgBody* const body1) const
+{
+	const dgBilateralConstraint* const bilateral = m_world->FindBilateralJoint (body0, body1);
+	const bool isCollidable = bilateral ? bilateral->IsCollidable() : true;
+	if (isCollidable) {
+		dgUnsigned32 group0_ID = dgUnsigned32 (body0->m_bodyGroupId);
+		dgUnsigned32 group1_ID = dgUnsigned32 (body1->m_bodyGroupId);
+		if (group1_ID < group0_ID) {
+			dgSwap (group0_ID, group1_ID);
+		}
+
+		dgUnsigned32 key = (group1_ID << 16) + group0_ID;
+		const dgBodyMaterialList* const materialList = m_world;  
+		dgAssert (materialList->Find (key));
+		const dgContactMaterial* const material = &materialList->Find (key)->GetInfo();
+
+		if (material->m_flags & dgContactMaterial::m_collisionEnable) {
+			const dgInt32 kinematicBodyEquilibrium = (((body0->IsRTTIType(dgBody::m_kinematicBodyRTTI) ? true : false) & body0->IsCollidable()) | ((body1->IsRTTIType(dgBody::m_kinematicBodyRTTI) ? true : false) & body1->IsCollidable())) ? 0 : 1;
+			if (!(body0->m_equilibrium & body1->m_equilibrium & kinematicBodyEquilibrium)) {
+				return material;
+			}
+		}
+	}
+	return NULL;
+}
+
+dgContact* dgBroadPhase::CreateContact (dgBody* const body0, dgBody* const body1, const dgContactMaterial* const material)
+{
+	// only called from one thread, after the pairs scan
+	dgContact* const contact = new (m_world->m_allocator) dgContact(m_world, material);
+	contact->AppendToActiveList();
+	m_world->AttachConstraint(contact, body0, body1);
+
+	dgAssert(contact);
+	contact->m_contactActive = 0;
+	contact->m_positAcc = dgVector(dgFloat32(10.0f));
+	contact->m_timeOfImpact = dgFloat32(1.0e10f);
+	return contact;
+}
+
+dgInt32 dgBroadPhase::ComparePendingContacts(const dgPendingContact* const contactA, const dgPendingContact* const contactB, void* const notUsed)
+{
+	if (contactA->m_key < contactB->m_key) {
+		return -1;
+	} else if (contactA->m_key > contactB->m_key) {
+		return 1;
+	}
+	// the reserved pairs go before the pairs that could not get a cache slot
+	return contactB->m_slot - contactA->m_slot;
+}
 
-			pair.m_contact = contact;
-			pair.m_timestep = timestep;
-            CalculatePairContacts (&pair, threadIndex);
+void dgBroadPhase::CreatePendingContacts()
+{
+	const dgInt32 threadsCount = m_world->GetThreadCount();
+	dgArray<dgPendingCollisionSofBodies>& pendingSoftBodies = m_pendingSoftBodyCollisions[0];
+	m_pendingSoftBodyPairsCount = m_pendingSoftBodyCollisionsCount[0];
+	m_pendingSoftBodyCollisionsCount[0] = 0;
+	for (dgInt32 i = 1; i < threadsCount; i ++) {
+		const dgInt32 threadCount = m_pendingSoftBodyCollisionsCount[i];
+		if (threadCount) {
+			pendingSoftBodies.ResizeIfNecessary(m_pendingSoftBodyPairsCount + threadCount);
+			memcpy(&pendingSoftBodies[m_pendingSoftBodyPairsCount], &m_pendingSoftBodyCollisions[i][0], threadCount * sizeof (dgPendingCollisionSofBodies));
+			m_pendingSoftBodyPairsCount += threadCount;
+			m_pendingSoftBodyCollisionsCount[i] = 0;
+		}
+	}
+
+	dgArray<dgPendingContact>& pendingContacts = m_pendingContacts[0];
+	dgInt32 count = m_pendingContactsCount[0];
+	for (dgInt32 i = 1; i < threadsCount; i ++) {
+		const dgInt32 threadCount = m_pendingContactsCount[i];
+		if (threadCount) {
+			pendingContacts.ResizeIfNecessary(count + threadCount);
+			memcpy(&pendingContacts[count], &m_pendingContacts[i][0], threadCount * sizeof (dgPendingContact));
+			count += threadCount;
+			m_pendingContactsCount[i] = 0;
+		}
+	}
+	m_pendingContactsCount[0] = 0;
+
+	if (count) {
+		// sorted by body ids the joints are created in the same order for any number of threads
+		dgPendingContact* const pairs = &pendingContacts[0];
+		dgSort(pairs, count, ComparePendingContacts);
+		for (dgInt32 i = 0; i < count; i ++) {
+			const dgPendingContact& pair = pairs[i];
+			if (pair.m_slot >= 0) {
+				dgContact* const contact = CreateContact (pair.m_body0, pair.m_body1, pair.m_material);
+				contact->m_broadphaseLru = m_lru;
+				m_pairCache.SetContact (pair.m_slot, contact);
+			} else {
+				// without a cache slot more than one thread can queue the same pair, 
+				// or the joint can already exist, the master list tells
+				dgContact* contact = m_world->FindContactJoint(pair.m_body0, pair.m_body1);
+				if (!contact) {
+					contact = CreateContact (pair.m_body0, pair.m_body1, pair.m_material);
+				}
+				contact->m_broadphaseLru = m_lru;
+			}
+		}
+	}
+}
+
+dgInt32 dgBroadPhase::CompareSpherePairs(const dgPendingSpherePair* const pairA, const dgPendingSpherePair* const pairB, void* const notUsed)
+{
+	if (pairA->m_key < pairB->m_key) {
+		return -1;
+	} else if (pairA->m_key > pairB->m_key) {
+		return 1;
+	}
+	return 0;
+}
+
+dgInt32 dgBroadPhase::MergeSpherePairs()
+{
+	dgArray<dgPendingSpherePair>& pendingPairs = m_pendingSpherePairs[0];
+	dgInt32 count = m_pendingSpherePairsCount[0];
+	const dgInt32 threadsCount = m_world->GetThreadCount();
+	for (dgInt32 i = 1; i < threadsCount; i ++) {
+		const dgInt32 threadCount = m_pendingSpherePairsCount[i];
+		if (threadCount) {
+			pendingPairs.ResizeIfNecessary(count + threadCount);
+			memcpy(&pendingPairs[count], &m_pendingSpherePairs[i][0], threadCount * sizeof (dgPendingSpherePair));
+			count += threadCount;
+			m_pendingSpherePairsCount[i] = 0;
 		}
 	}
+	m_pendingSpherePairsCount[0] = 0;
+
+	if (count) {
+		// sorted by shape types each run of pairs goes through the same kernel
+		dgSort(&pendingPairs[0], count, CompareSpherePairs);
+	}
+	return count;
+}
+
+void dgBroadPhase::MergeSpherePairsKernel(void* const context, void* const spherePairsTasks, dgInt32 threadID)
+{
+	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
+	dgWorld* const world = descriptor->m_world;
+	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	const dgInt32 count = broadPhase->MergeSpherePairs();
+	((dgBroadPhaseForTasks*)spherePairsTasks)->SetRange(0, count);
 }
 
+void dgBroadPhase::SpherePairsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
+	const dgPendingSpherePair* const pendingPairs = &m_pendingSpherePairs[0][0];
+	const dgFloat32 timestep = descriptor->m_timestep;
+
+	dgInt32 index = start;
+	while (index < end) {
+		// gather a batch of collidable pairs with the same shape types
+		const dgInt32 key = pendingPairs[index].m_key;
+		dgPair pairs[DG_SPHERE_PAIR_BATCH];
+		dgContactPoint contacts[DG_SPHERE_PAIR_BATCH];
+		dgInt32 count = 0;
+		for (; (index < end) && (count < DG_SPHERE_PAIR_BATCH) && (pendingPairs[index].m_key == key); index ++) {
+			dgContact* const contact = pendingPairs[index].m_contact;
+			if (IsPairCollidable (contact, threadID)) {
+				pairs[count].m_contact = contact;
+				pairs[count].m_timestep = timestep;
+				pairs[count].m_contactBuffer = &contacts[count];
+				pairs[count].m_cacheIsValid = false;
+				count ++;
+			} else if (contact->m_maxDOF) {
+				contact->m_timeOfImpact = dgFloat32(1.0e10f);
+			}
+		}
+
+		if (count) {
+			// the pairs the batch does not resolve go through the generic path
+			const dgInt32 resolvedMask = m_world->CalculateSpherePairsContacts (pairs, count, key);
+			for (dgInt32 i = 0; i < count; i ++) {
+				dgPair* const pair = &pairs[i];
+				if (resolvedMask & (1 << i)) {
+					ApplyPairContacts (pair, threadID);
+				} else {
+					CalculatePairContacts (pair, threadID);
+				}
+				if (pair->m_contact->m_maxDOF) {
+					pair->m_contact->m_timeOfImpact = dgFloat32(1.0e10f);
+				}
+			}
+		}
+	}
+}
 
 void dgBroadPhase::AddPair (dgBody* const body0, dgBody* const body1, const dgFloat32 timestep, dgInt32 threadID)
 {
 //	dgAssert ((body0->GetInvMass().m_w != dgFloat32 (0.0f)) || (body1->GetInvMass().m_w != dgFloat32 (0.0f)) || (body0->IsRTTIType(dgBody::m_kinematicBodyRTTI)) || (body1->IsRTTIType(dgBody::m_kinematicBodyRTTI)));
 	if ((body0->GetInvMass().m_w != dgFloat32 (0.0f)) || (body1->GetInvMass().m_w != dgFloat32 (0.0f)) || 
 		(body0->IsRTTIType(dgBody::m_kinematicBodyRTTI)) || (body1->IsRTTIType(dgBody::m_kinematicBodyRTTI))) {
-		dgThreadHiveScopeLock lock(m_world, &m_contacJointLock, true);
-		dgContact* contact = m_world->FindContactJoint(body0, body1);
-		if (!contact) {
-			const dgBilateralConstraint* const bilateral = m_world->FindBilateralJoint (body0, body1);
-			const bool isCollidable = bilateral ? bilateral->IsCollidable() : true;
-
-			if (isCollidable) {
-				dgUnsigned32 group0_ID = dgUnsigned32 (body0->m_bodyGroupId);
-				dgUnsigned32 group1_ID = dgUnsigned32 (body1->m_bodyGroupId);
-				if (group1_ID < group0_ID) {
-					dgSwap (group0_ID, group1_ID);
-				}
 
-				dgUnsigned32 key = (group1_ID << 16) + group0_ID;
-				const dgBodyMaterialList* const materialList = m_world;  
-				dgAssert (materialList->Find (key));
-				const dgContactMaterial* const material = &materialList->Find (key)->GetInfo();
-
-				if (material->m_flags & dgContactMaterial::m_collisionEnable) {
-					const dgInt32 kinematicBodyEquilibrium = (((body0->IsRTTIType(dgBody::m_kinematicBodyRTTI) ? true : false) & body0->IsCollidable()) | ((body1->IsRTTIType(dgBody::m_kinematicBodyRTTI) ? true : false) & body1->IsCollidable())) ? 0 : 1;
-					if (!(body0->m_equilibrium & body1->m_equilibrium & kinematicBodyEquilibrium)) {
-						const dgInt32 isSofBody0 = body0->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI);
-						const dgInt32 isSofBody1 = body1->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI);
-						if (isSofBody0 || isSofBody1) {
-							m_pendingSoftBodyCollisions[m_pendingSoftBodyPairsCount].m_body0 = body0;
-							m_pendingSoftBodyCollisions[m_pendingSoftBodyPairsCount].m_body1 = body1;
-							m_pendingSoftBodyPairsCount++;
-						} else {
-							contact = new (m_world->m_allocator) dgContact(m_world, material);
-							contact->AppendToActiveList();
-							m_world->AttachConstraint(contact, body0, body1);
-
-							dgAssert(contact);
-							contact->m_contactActive = 0;
-							contact->m_positAcc = dgVector(dgFloat32(10.0f));
-							contact->m_timeOfImpact = dgFloat32(1.0e10f);
+		// the pair cache lets all threads find existing contacts without locking, 
+		// new contact joints are queued and created after the scan
+		dgContact* contact = NULL;
+		if (!m_pairCache.Find (body0, body1, &contact)) {
+			const dgContactMaterial* const material = GetPairMaterial (body0, body1);
+			if (material) {
+				const dgInt32 isSofBody0 = body0->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI);
+				const dgInt32 isSofBody1 = body1->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI);
+				if (isSofBody0 || isSofBody1) {
+					const dgInt32 index = m_pendingSoftBodyCollisionsCount[threadID];
+					dgPendingCollisionSofBodies& pending = m_pendingSoftBodyCollisions[threadID][index];
+					pending.m_body0 = body0;
+					pending.m_body1 = body1;
+					m_pendingSoftBodyCollisionsCount[threadID] = index + 1;
+				} else {
+					dgInt32 slot = 0;
+					const dgBroadPhasePairCache::dgInsertResult result = m_pairCache.Insert (body0, body1, &slot);
+					if (result == dgBroadPhasePairCache::m_full) {
+						// the cache is full or not built yet, no joint is created during the scan so the master list can be searched
+						contact = m_world->FindContactJoint(body0, body1);
+						slot = -1;
+					}
+					if (!contact && (result != dgBroadPhasePairCache::m_duplicated)) {
+						// the pair is reserved or has no slot, its contact joint is created after the scan
+						dgUnsigned64 id0 = dgUnsigned64 (body0->GetUniqueID());
+						dgUnsigned64 id1 = dgUnsigned64 (body1->GetUniqueID());
+						if (id1 < id0) {
+							dgSwap (id0, id1);
 						}
+						const dgInt32 index = m_pendingContactsCount[threadID];
+						dgPendingContact& pending = m_pendingContacts[threadID][index];
+						pending.m_key = (id1 << 32) | id0;
+						pending.m_body0 = body0;
+						pending.m_body1 = body1;
+						pending.m_material = material;
+						pending.m_slot = slot;
+						m_pendingContactsCount[threadID] = index + 1;
 					}
 				}
 			}
@@ -1225,34 +2592,38 @@ dgAssert (0);
 }
 
 
-void dgBroadPhase::SubmitPairs(dgBroadPhaseNode* const leafNode, dgBroadPhaseNode* const node, dgFloat32 timestep, dgInt32 threadCount, dgInt32 threadID)
+void dgBroadPhase::SubmitPairs(dgBroadPhaseNode* const leafNode, dgInt32 flatIndex, dgFloat32 timestep, dgInt32 threadCount, dgInt32 threadID)
 {
-	dgBroadPhaseNode* pool[DG_BROADPHASE_MAX_STACK_DEPTH];
-	pool[0] = node;
+	dgInt32 pool[DG_BROADPHASE_MAX_STACK_DEPTH];
+	pool[0] = flatIndex;
 	dgInt32 stack = 1;
 
+	dgAssert (m_flatNodesValid);
 	dgAssert (leafNode->IsLeafNode());
 	dgBody* const body0 = leafNode->GetBody();
 	const dgVector boxP0 (body0 ? body0->m_minAABB : leafNode->m_minBox);
 	const dgVector boxP1 (body0 ? body0->m_maxAABB : leafNode->m_maxBox);
 
+	const dgBroadPhaseFlatNode* const flatNodes = &m_flatNodes[0];
+	const dgBroadPhaseFlatLeaf* const flatLeaves = &m_flatLeaves[0];
 	const bool test0 = body0 ? (body0->GetInvMass().m_w != dgFloat32(0.0f)) : true;
 	while (stack) {
 		stack--;
-		dgBroadPhaseNode* const rootNode = pool[stack];
-		if (dgOverlapTest(rootNode->m_minBox, rootNode->m_maxBox, boxP0, boxP1)) {
-			if (rootNode->IsLeafNode()) {
-				dgAssert(!rootNode->GetRight());
-				dgAssert(!rootNode->GetLeft());
-				dgBody* const body1 = rootNode->GetBody();
+		const dgInt32 index = pool[stack];
+		const dgBroadPhaseFlatNode& rootNode = flatNodes[index];
+		if (dgOverlapTest(rootNode.m_minBox, rootNode.m_maxBox, boxP0, boxP1)) {
+			const dgInt32 aggregateLeaf = rootNode.GetAggregate();
+			if (rootNode.IsLeafNode() || (aggregateLeaf >= 0)) {
+				const dgBroadPhaseFlatLeaf& leaf = flatLeaves[(aggregateLeaf >= 0) ? aggregateLeaf : rootNode.GetLeaf()];
+				dgBody* const body1 = leaf.m_body;
 				if (body0) {
 					if (body1) {
 						if (test0 || (body1->GetInvMass().m_w != dgFloat32(0.0f))) {
 							AddPair(body0, body1, timestep, threadID);
 						}
 					} else {
-						dgAssert (rootNode->IsAggregate());
-						dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*) rootNode;
+						dgAssert (leaf.m_node->IsAggregate());
+						dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*) leaf.m_node;
 						aggregate->SummitPairs(body0, timestep, threadID);
 					}
 				} else {
@@ -1261,20 +2632,16 @@ void dgBroadPhase::SubmitPairs(dgBroadPhaseNode* const leafNode, dgBroadPhaseNod
 					if (body1) {
 						aggregate->SummitPairs(body1, timestep, threadID);
 					} else {
-						dgAssert (rootNode->IsAggregate());
-						aggregate->SummitPairs((dgBroadPhaseAggregate*) rootNode, timestep, threadID);
+						dgAssert (leaf.m_node->IsAggregate());
+						aggregate->SummitPairs((dgBroadPhaseAggregate*) leaf.m_node, timestep, threadID);
 					}
 				}
 			} else {
-				dgBroadPhaseTreeNode* const tmpNode = (dgBroadPhaseTreeNode*) rootNode;
-				dgAssert (tmpNode->m_left);
-				dgAssert (tmpNode->m_right);
-
-				pool[stack] = tmpNode->m_left;
+				pool[stack] = index + 1;
 				stack++;
 				dgAssert(stack < dgInt32(sizeof (pool) / sizeof (pool[0])));
 
-				pool[stack] = tmpNode->m_right;
+				pool[stack] = rootNode.GetRight();
 				stack++;
 				dgAssert(stack < dgInt32(sizeof (pool) / sizeof (pool[0])));
 			}
@@ -1283,6 +2650,30 @@ void dgBroadPhase::SubmitPairs(dgBroadPhaseNode* const leafNode, dgBroadPhaseNod
 }
 
 
+void dgBroadPhase::SubmitLeafPair(dgBroadPhaseNode* const leaf0, dgBroadPhaseNode* const leaf1, dgFloat32 timestep, dgInt32 threadID)
+{
+	dgBody* const body0 = leaf0->GetBody();
+	dgBody* const body1 = leaf1->GetBody();
+	if (body0) {
+		if (body1) {
+			AddPair(body0, body1, timestep, threadID);
+		} else {
+			dgAssert(leaf1->IsAggregate());
+			((dgBroadPhaseAggregate*)leaf1)->SummitPairs(body0, timestep, threadID);
+		}
+	} else {
+		dgAssert(leaf0->IsAggregate());
+		dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*)leaf0;
+		if (body1) {
+			aggregate->SummitPairs(body1, timestep, threadID);
+		} else {
+			dgAssert(leaf1->IsAggregate());
+			aggregate->SummitPairs((dgBroadPhaseAggregate*)leaf1, timestep, threadID);
+		}
+	}
+}
+
+
 void dgBroadPhase::ImproveNodeFitness(dgBroadPhaseTreeNode* const node, dgBroadPhaseNode** const root)
 {
 	dgAssert(node->GetLeft());
@@ -1291,6 +2682,7 @@ void dgBroadPhase::ImproveNodeFitness(dgBroadPhaseTreeNode* const node, dgBroadP
 	dgBroadPhaseNode* const parent = node->m_parent;
 	if (parent && parent->m_parent) {
 		dgAssert (!parent->IsLeafNode());
+		m_flatNodesValid = false;
 		if (parent->GetLeft() == node) {
 			RotateRight(node, root);
 		} else {
@@ -1354,6 +2746,7 @@ void dgBroadPhase::CollidingPairsKernel(void* const context, void* const node, d
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
 	dgWorld* const world = descriptor->m_world;
 	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	dgProfilerScope scope (&world->m_profiler, m_profileBroadphaseFindPairs, threadID);
 	if (broadPhase->m_scanTwoWays) {
 		broadPhase->FindCollidingPairsForwardAndBackward(descriptor, (dgList<dgBroadPhaseNode*>::dgListNode*) node, threadID);
 	} else {
@@ -1374,12 +2767,15 @@ void dgBroadPhase::AddGeneratedBodiesContactsKernel (void* const context, void*
 void dgBroadPhase::ScanForContactJoints(dgBroadphaseSyncDescriptor& syncPoints)
 {
 	dgInt32 threadsCount = m_world->GetThreadCount();
+	m_pairCache.Prepare (m_world, m_world->GetBodiesCount());
+
 	dgList<dgBroadPhaseNode*>::dgListNode* node = m_updateList.GetFirst();
 	for (dgInt32 i = 0; i < threadsCount; i++) {
 		m_world->QueueJob(CollidingPairsKernel, &syncPoints, node);
 		node = node ? node->GetNext() : NULL;
 	}
 	m_world->SynchronizationBarrier();
+	CreatePendingContacts();
 
 	const dgUnsigned32 lru = m_lru - DG_CONTACT_DELAY_FRAMES;
 	dgActiveContacts* const contactList = m_world;
@@ -1421,6 +2817,7 @@ void dgBroadPhase::UpdateSoftBodyContactKernel(void* const context, void* const
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
 	dgWorld* const world = descriptor->m_world;
 	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	dgProfilerScope scope (&world->m_profiler, m_profileNarrowPhase, threadID);
 	broadPhase->UpdateSoftBodyContacts(descriptor, descriptor->m_timestep, threadID);
 }
 
@@ -1429,6 +2826,7 @@ void dgBroadPhase::UpdateRigidBodyContactKernel(void* const context, void* const
 	dgBroadphaseSyncDescriptor* const descriptor = (dgBroadphaseSyncDescriptor*)context;
 	dgWorld* const world = descriptor->m_world;
 	dgBroadPhase* const broadPhase = world->GetBroadPhase();
+	dgProfilerScope scope (&world->m_profiler, m_profileNarrowPhase, threadID);
 	broadPhase->UpdateRigidBodyContacts(descriptor, (dgActiveContacts::dgListNode*) node, descriptor->m_timestep, threadID);
 }
 
@@ -1436,7 +2834,7 @@ void dgBroadPhase::UpdateSoftBodyContacts(dgBroadphaseSyncDescriptor* const desc
 {
 	const dgInt32 count = m_pendingSoftBodyPairsCount;
 	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_pairsAtomicCounter, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_pairsAtomicCounter, 1)) {
-		dgPendingCollisionSofBodies& pair = m_pendingSoftBodyCollisions[i];
+		dgPendingCollisionSofBodies& pair = m_pendingSoftBodyCollisions[0][i];
 		if (pair.m_body0->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI)) {
 			dgCollisionLumpedMassParticles* const lumpedMassShape = (dgCollisionLumpedMassParticles*)pair.m_body0->m_collision->GetChildShape();
 			dgAssert(pair.m_body0->IsRTTIType(dgBody::m_dynamicBodyRTTI));
@@ -1469,14 +2867,25 @@ void dgBroadPhase::UpdateRigidBodyContacts(dgBroadphaseSyncDescriptor* const des
 				contact->m_positAcc = dgVector::m_zero;
 				contact->m_rotationAcc = dgQuaternion();
 
+				// the separation of two convex shapes is the exact distance between them, so the pair can skip 
+				// the narrow phase until the motion bound closes the gap, for the other shapes it is only a estimate
+				// contacts are generated inside the material skin, so the convex threshold can not be smaller than the skin,
+				// and the forces of this step change the velocities before the bodies move, so their effect is added as a margin
+				const dgCollisionInstance* const collision0 = body0->GetCollision();
+				const dgCollisionInstance* const collision1 = body1->GetCollision();
+				const bool isConvexPair = collision0->IsType(dgCollision::dgCollisionConvexShape_RTTI) && collision1->IsType(dgCollision::dgCollisionConvexShape_RTTI);
+				const dgVector accel0 (body0->GetForce().Scale4 (body0->GetInvMass().m_w));
+				const dgVector accel1 (body1->GetForce().Scale4 (body1->GetInvMass().m_w));
+				const dgVector accelLinear (accel1 - accel0);
+				const dgFloat32 forceMargin = dgSqrt ((accelLinear.DotProduct4(accelLinear)).GetScalar()) * timestep * timestep;
+				const dgFloat32 narrowPhaseDist = (isConvexPair ? dgMax (DG_NARROW_PHASE_CONVEX_DIST, contact->m_material->m_skinThickness) : DG_NARROW_PHASE_DIST) + forceMargin;
+
 				dgFloat32 distance = contact->m_separationDistance;
-				if (distance >= DG_NARROW_PHASE_DIST) {
+				if (distance >= narrowPhaseDist) {
 					const dgVector veloc0 (body0->GetVelocity());
 					const dgVector veloc1 (body1->GetVelocity());
 					const dgVector omega0 (body0->GetOmega());
 					const dgVector omega1 (body1->GetOmega());
-					const dgCollisionInstance* const collision0 = body0->GetCollision();
-					const dgCollisionInstance* const collision1 = body1->GetCollision();
 					const dgFloat32 maxDiameter0 = dgFloat32 (3.5f) * collision0->GetBoxMaxRadius(); 
 					const dgFloat32 maxDiameter1 = dgFloat32 (3.5f) * collision1->GetBoxMaxRadius(); 
 
@@ -1487,10 +2896,20 @@ void dgBroadPhase::UpdateRigidBodyContacts(dgBroadphaseSyncDescriptor* const des
 					distance -= speed * timestep;
 					contact->m_separationDistance = distance;
 				}
-				if (distance < DG_NARROW_PHASE_DIST) {
-					AddPair(contact, timestep, threadID);
-					if (contact->m_maxDOF) {
-						contact->m_timeOfImpact = dgFloat32(1.0e10f);
+				if (distance < narrowPhaseDist) {
+					const dgInt32 key = m_world->GetSpherePairKey (contact);
+					if (key >= 0) {
+						// collided later with the other pairs of the same shape types
+						const dgInt32 index = m_pendingSpherePairsCount[threadID];
+						dgPendingSpherePair& pending = m_pendingSpherePairs[threadID][index];
+						pending.m_contact = contact;
+						pending.m_key = key;
+						m_pendingSpherePairsCount[threadID] = index + 1;
+					} else {
+						AddPair(contact, timestep, threadID);
+						if (contact->m_maxDOF) {
+							contact->m_timeOfImpact = dgFloat32(1.0e10f);
+						}
 					}
 				}
 			}
@@ -1514,37 +2933,65 @@ void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 	m_recursiveChunks = true;
 	const dgInt32 threadsCount = m_world->GetThreadCount();
 
-	const dgBodyMasterList* const masterList = m_world;
 	dgBroadphaseSyncDescriptor syncPoints(timestep, m_world);
 
-	dgBodyMasterList::dgListNode* node = masterList->GetLast();
-	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob(ForceAndToqueKernel, &syncPoints, node);
-		node = node ? node->GetPrev() : NULL;
+	// only the bodies in the active list get their forces and sleeping state updated, 
+	// the sleeping and the static bodies are not visited at all
+	m_world->UpdateActiveBodies();
+	const dgInt32 activeBodiesCount = m_world->m_activeBodiesCount;
+	syncPoints.m_activeBodies = activeBodiesCount ? &m_world->m_activeBodies[0] : NULL;
+
+	bool hasPreListeners = false;
+	for (dgWorld::dgListenerList::dgListNode* node1 = m_world->m_listeners.GetFirst(); node1; node1 = node1->GetNext()) {
+		hasPreListeners = hasPreListeners || (node1->GetInfo().m_onPreUpdate != NULL);
 	}
-	m_world->SynchronizationBarrier();
 
-	// update pre-listeners after the force and true are applied
-	if (m_world->m_listeners.GetCount()) {
-		for (dgWorld::dgListenerList::dgListNode* node1 = m_world->m_listeners.GetFirst(); node1; node1 = node1->GetNext()) {
-			dgWorld::dgListener& listener = node1->GetInfo();
-			if (listener.m_onPreUpdate) {
-				listener.m_onPreUpdate(m_world, listener.m_userData, timestep);
+	{
+		dgProfilerScope scope (&m_world->m_profiler, m_profileBroadphaseApplyForces, DG_PROFILER_MAIN_THREAD);
+
+		// the aggregates can be improved once all bodies have updated their aabb, 
+		// so each aggregate task depends on all the sleeping state tasks
+		dgThreadHive::dgThreadTask aggregateEntropyTasks[DG_MAX_THREADS_HIVE_COUNT];
+		dgList<dgBroadPhaseAggregate*>::dgListNode* aggregateNode = m_aggregateList.GetFirst();
+		const dgInt32 aggregateTasksCount = aggregateNode ? threadsCount : 0;
+		for (dgInt32 i = 0; i < aggregateTasksCount; i++) {
+			aggregateEntropyTasks[i] = dgThreadHive::dgThreadTask (UpdateAggregateEntropyKernel, &syncPoints, aggregateNode);
+			aggregateNode = aggregateNode ? aggregateNode->GetNext() : NULL;
+		}
+
+		// without pre listeners nothing runs between the force and the sleeping state of a body, 
+		// so each chunk goes through both and the aggregates follow in the same barrier
+		dgBroadPhaseKernel::dgKernel sleepingStateKernel = &dgBroadPhase::ForceAndTorqueSleepingStateKernel;
+		if (hasPreListeners) {
+			BroadPhaseFor(&dgBroadPhase::ForceAndTorqueKernel, &syncPoints, 0, activeBodiesCount, DG_BROADPHASE_BODY_CHUNK_SIZE);
+			RefitDirtyNodes();
+
+			// update pre-listeners after the force and true are applied
+			for (dgWorld::dgListenerList::dgListNode* node1 = m_world->m_listeners.GetFirst(); node1; node1 = node1->GetNext()) {
+				dgWorld::dgListener& listener = node1->GetInfo();
+				if (listener.m_onPreUpdate) {
+					listener.m_onPreUpdate(m_world, listener.m_userData, timestep);
+				}
 			}
+			sleepingStateKernel = &dgBroadPhase::SleepingStateKernel;
 		}
-	}
 
-	node = masterList->GetLast();
-	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob(SleepingStateKernel, &syncPoints, node);
-		node = node ? node->GetPrev() : NULL;
+		dgBroadPhaseForTasks sleepingStateTasks (m_world, dgBroadPhaseKernel(this, sleepingStateKernel, &syncPoints), 0, activeBodiesCount, DG_BROADPHASE_BODY_CHUNK_SIZE);
+		for (dgInt32 i = 0; i < aggregateTasksCount; i++) {
+			sleepingStateTasks.Precedes(&aggregateEntropyTasks[i]);
+		}
+		sleepingStateTasks.Queue();
+		for (dgInt32 i = 0; i < aggregateTasksCount; i++) {
+			m_world->QueueTask(&aggregateEntropyTasks[i]);
+		}
+		m_world->SynchronizationBarrier();
 	}
-	m_world->SynchronizationBarrier();
 
 
 #if 0
 	static dgInt32 xxx;
 	xxx ++;
+	const dgBodyMasterList* const masterList = m_world;
 	for (dgBodyMasterList::dgListNode* node = masterList->GetLast(); node; node = node->GetPrev()) {
 		dgDynamicBody* const body = (dgDynamicBody*)node->GetInfo().GetBody();
 		if ((body->GetType() == dgBody::m_dynamicBody) && (body->GetInvMass().m_w > dgFloat32 (0.0f))) {
@@ -1582,29 +3029,50 @@ void dgBroadPhase::UpdateContacts(dgFloat32 timestep)
 #endif
 
 
-	dgList<dgBroadPhaseAggregate*>::dgListNode* aggregateNode = m_aggregateList.GetFirst();
-	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob (UpdateAggregateEntropyKernel, &syncPoints, aggregateNode);
-		aggregateNode = aggregateNode ? aggregateNode->GetNext() : NULL;
+	{
+		dgProfilerScope scope (&m_world->m_profiler, m_profileBroadphaseUpdateTree, DG_PROFILER_MAIN_THREAD);
+		RefitDirtyNodes();
+		UpdateFitness();
+		if (SearchPairsInTree()) {
+			BuildFlatNodes();
+		}
 	}
-	m_world->SynchronizationBarrier();
-	UpdateFitness();
-
-	m_scanTwoWays = (lastDirtyCount * 100) < (40 * m_updateList.GetCount());
-	ScanForContactJoints (syncPoints);
 
-	dgActiveContacts* const contactList = m_world;
-	dgActiveContacts::dgListNode* contactListNode = contactList->GetFirst();
-	for (dgInt32 i = 0; i < threadsCount; i++) {
-		m_world->QueueJob(UpdateRigidBodyContactKernel, &syncPoints, contactListNode);
-		contactListNode = contactListNode ? contactListNode->GetNext() : NULL;
+	{
+		dgProfilerScope scope (&m_world->m_profiler, m_profileBroadphaseFindPairs, DG_PROFILER_MAIN_THREAD);
+		m_scanTwoWays = (lastDirtyCount * 100) < (40 * m_updateList.GetCount());
+		ScanForContactJoints (syncPoints);
 	}
-	m_world->SynchronizationBarrier();
 
-	if (m_pendingSoftBodyPairsCount) {
+	{
+		dgProfilerScope scope (&m_world->m_profiler, m_profileNarrowPhase, DG_PROFILER_MAIN_THREAD);
+		dgActiveContacts* const contactList = m_world;
+		dgActiveContacts::dgListNode* contactListNode = contactList->GetFirst();
+
+		// the sphere pairs are gathered after all rigid body pairs are done and collided in a parallel for
+		// that the merge task sizes, the soft body pairs are independent of both, the whole phase is one barrier
+		dgThreadHive::dgThreadTask rigidBodyTasks[DG_MAX_THREADS_HIVE_COUNT];
+		dgThreadHive::dgThreadTask softBodyTasks[DG_MAX_THREADS_HIVE_COUNT];
+		dgBroadPhaseForTasks spherePairsTasks (m_world, dgBroadPhaseKernel(this, &dgBroadPhase::SpherePairsKernel, &syncPoints), 0, 0, DG_SPHERE_PAIRS_CHUNK_SIZE);
+		dgThreadHive::dgThreadTask mergeSpherePairsTask (MergeSpherePairsKernel, &syncPoints, &spherePairsTasks);
+		for (dgInt32 i = 0; i < threadsCount; i++) {
+			rigidBodyTasks[i] = dgThreadHive::dgThreadTask (UpdateRigidBodyContactKernel, &syncPoints, contactListNode);
+			mergeSpherePairsTask.DependsOn(&rigidBodyTasks[i]);
+			contactListNode = contactListNode ? contactListNode->GetNext() : NULL;
+		}
+		spherePairsTasks.DependsOn(&mergeSpherePairsTask);
+
 		for (dgInt32 i = 0; i < threadsCount; i++) {
-			m_world->QueueJob(UpdateSoftBodyContactKernel, &syncPoints, contactListNode);
+			m_world->QueueTask(&rigidBodyTasks[i]);
+		}
+		if (m_pendingSoftBodyPairsCount) {
+			for (dgInt32 i = 0; i < threadsCount; i++) {
+				softBodyTasks[i] = dgThreadHive::dgThreadTask (UpdateSoftBodyContactKernel, &syncPoints, contactListNode);
+				m_world->QueueTask(&softBodyTasks[i]);
+			}
 		}
+		m_world->QueueTask(&mergeSpherePairsTask);
+		spherePairsTasks.Queue();
 		m_world->SynchronizationBarrier();
 	}
 
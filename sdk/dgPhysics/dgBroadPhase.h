@@ -25,6 +25,7 @@
 #include "dgPhysicsStdafx.h"
 #include "dgBody.h"
 #include "dgBodyMasterList.h"
+#include "dgBroadPhasePairCache.h"
 
 class dgBody;
 class dgWorld;
@@ -32,6 +33,7 @@ class dgContact;
 class dgCollision;
 class dgDynamicBody;
 class dgCollisionInstance;
+class dgContactMaterial;
 class dgBroadPhaseAggregate;
 
 
@@ -50,6 +52,47 @@ class dgConvexCastReturnInfo
 	dgFloat32 m_penetration;                // contact penetration at collision point
 };
 
+#define DG_RAYCAST_BATCH_SKIP_STATIC	1
+#define DG_RAYCAST_BATCH_SKIP_DYNAMIC	2
+
+class dgRayCastBatchInfo
+{
+	public:
+	dgFloat32 m_p0[4];						// ray origin in global space
+	dgFloat32 m_p1[4];						// ray end in global space
+	const dgBody* m_skipBody;				// body ignored by this ray, usually the one casting it
+	dgInt32 m_skipFlags;					// combination of DG_RAYCAST_BATCH_SKIP_* bits
+};
+
+class dgRayCastBatchReturnInfo
+{
+	public:
+	dgFloat32 m_point[4];					// closest hit point in global space
+	dgFloat32 m_normal[4];					// surface normal at the hit point in global space
+	dgInt64  m_contaID;						// collision ID at the hit point
+	const dgBody* m_hitBody;				// closest body hit by the ray, NULL if the ray hit nothing
+	dgFloat32 m_param;						// hit parameter along the ray, 1.0 if the ray hit nothing
+};
+
+class dgConvexCastBatchInfo
+{
+	public:
+	dgFloat32 m_matrix[4][4];				// shape matrix in global space
+	dgFloat32 m_target[4];					// destination of the shape origin, ignored by overlap queries
+	dgCollisionInstance* m_shape;			// shape swept or tested by this query
+	const dgBody* m_skipBody;				// body ignored by this query, usually the one casting it
+	dgInt32 m_skipFlags;					// combination of DG_RAYCAST_BATCH_SKIP_* bits
+	dgInt32 m_maxContacts;					// contacts reserved for this query in the contact array
+};
+
+class dgConvexCastBatchReturnInfo
+{
+	public:
+	dgFloat32 m_param;						// time of impact of a cast, 1.0 if the shape hit nothing
+	dgInt32 m_firstContact;					// first contact of this query in the packed contact array
+	dgInt32 m_contactCount;					// number of contacts of this query
+};
+
 
 DG_MSC_VECTOR_ALIGMENT
 class dgBroadPhaseNode
@@ -173,6 +216,8 @@ class dgBroadPhaseTreeNode: public dgBroadPhaseNode
 		,m_left(NULL)
 		,m_right(NULL)
 		,m_fitnessNode(NULL)
+		,m_refitMark(0)
+		,m_flatIndex(-1)
 	{
 	}
 
@@ -181,6 +226,8 @@ class dgBroadPhaseTreeNode: public dgBroadPhaseNode
 		,m_left(sibling)
 		,m_right(myNode)
 		,m_fitnessNode(NULL)
+		,m_refitMark(0)
+		,m_flatIndex(-1)
 	{
 		if (m_parent) {
 			dgBroadPhaseTreeNode* const myParent = (dgBroadPhaseTreeNode*)m_parent;
@@ -227,19 +274,96 @@ class dgBroadPhaseTreeNode: public dgBroadPhaseNode
 	dgBroadPhaseNode* m_left;
 	dgBroadPhaseNode* m_right;
 	dgList<dgBroadPhaseTreeNode*>::dgListNode* m_fitnessNode;
+	dgInt32 m_refitMark;
+	dgInt32 m_flatIndex;
 } DG_GCC_VECTOR_ALIGMENT;
 
+// linearized copy of the tree used for traversal, nodes are in depth first order so the left child 
+// of an inner node is always the next node. the w component of the min box holds the index of the 
+// right child, or -(leaf + 1) for leaf nodes, the w component of the max box holds the leaf index of 
+// the aggregate that owns the sub tree rooted at the node, or -1.
+DG_MSC_VECTOR_ALIGMENT
+class dgBroadPhaseFlatNode
+{
+	public:
+	DG_INLINE void SetBox (const dgBroadPhaseNode* const node)
+	{
+		const dgInt32 right = m_minBox.m_iw;
+		const dgInt32 aggregate = m_maxBox.m_iw;
+		m_minBox = node->m_minBox;
+		m_maxBox = node->m_maxBox;
+		m_minBox.m_iw = right;
+		m_maxBox.m_iw = aggregate;
+	}
+
+	DG_INLINE void SetLinks (dgInt32 right, dgInt32 aggregate)
+	{
+		m_minBox.m_iw = right;
+		m_maxBox.m_iw = aggregate;
+	}
+
+	DG_INLINE dgVector GetMinBox () const
+	{
+		return m_minBox & dgVector::m_triplexMask;
+	}
+
+	DG_INLINE dgVector GetMaxBox () const
+	{
+		return m_maxBox & dgVector::m_triplexMask;
+	}
+
+	DG_INLINE bool IsLeafNode () const
+	{
+		return m_minBox.m_iw < 0;
+	}
+
+	DG_INLINE dgInt32 GetRight () const
+	{
+		dgAssert (m_minBox.m_iw > 0);
+		return m_minBox.m_iw;
+	}
+
+	DG_INLINE dgInt32 GetLeaf () const
+	{
+		dgAssert (m_minBox.m_iw < 0);
+		return -1 - m_minBox.m_iw;
+	}
+
+	DG_INLINE dgInt32 GetAggregate () const
+	{
+		return m_maxBox.m_iw;
+	}
+
+	dgVector m_minBox;
+	dgVector m_maxBox;
+} DG_GCC_VECTOR_ALIGMENT;
+
+class dgBroadPhaseFlatLeaf
+{
+	public:
+	dgBody* m_body;
+	dgBroadPhaseNode* m_node;
+};
+
 
 class dgBroadPhase
 {
 	protected:
 	class dgSpliteInfo;
+	class dgBuildTask;
+	class dgBuildSyncData;
+	class dgBatchQueryKey;
+	class dgBatchQueryFilter;
+	class dgBatchQueryContext;
+	class dgBatchQueryCandidates;
+	class dgRayCastBatchRay;
 	class dgBroadphaseSyncDescriptor
 	{
 		public:
 		dgBroadphaseSyncDescriptor(dgFloat32 timestep, dgWorld* const world)
 			:m_world(world)
 			,m_newBodiesNodes(NULL)
+			,m_activeBodies(NULL)
 			,m_timestep(timestep)
 			,m_pairsAtomicCounter(0)
 		{
@@ -247,6 +371,7 @@ class dgBroadPhase
 
 		dgWorld* m_world;
 		dgList<dgBody*>::dgListNode* m_newBodiesNodes;
+		dgBody** m_activeBodies;
 		dgFloat32 m_timestep;
 		dgInt32 m_pairsAtomicCounter;
 	};
@@ -326,6 +451,21 @@ class dgBroadPhase
 	virtual void FindCollidingPairsForward (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID) = 0;
 	virtual void FindCollidingPairsForwardAndBackward (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID) = 0;
 
+	// the broad phases that do not search the pairs in the tree skip the rotations and the flat copy of the 
+	// tree, only the node boxes are refitted so that the queries can still walk it
+	virtual bool SearchPairsInTree() const
+	{
+		return true;
+	}
+
+	// casts all rays across the worker threads and writes the closest hit of each ray to hits[i], 
+	// must be called from the thread that updates the world and not while the world is updating
+	void RayCastBatch (const dgRayCastBatchInfo* const rays, dgRayCastBatchReturnInfo* const hits, dgInt32 count, OnRayPrecastAction prefilter, void* const userData);
+
+	// sweeps (or overlaps when collide is true) each shape across the worker threads, query i may write up to 
+	// m_maxContacts contacts, on return the contacts of all queries are packed and the total count is returned
+	dgInt32 ConvexCastBatch (const dgConvexCastBatchInfo* const queries, dgConvexCastBatchReturnInfo* const results, dgInt32 count, dgConvexCastReturnInfo* const contacts, OnRayPrecastAction prefilter, void* const userData, bool collide);
+
 	void ScanForContactJoints(dgBroadphaseSyncDescriptor& syncPoints);
 
 	void UpdateBody(dgBody* const body, dgInt32 threadIndex);
@@ -335,15 +475,39 @@ class dgBroadPhase
 	}
 
 	void UpdateContacts(dgFloat32 timestep);
+	void RefitDirtyNodes();
 	void CollisionChange (dgBody* const body, dgCollisionInstance* const collisionSrc);
 
 	void MoveNodes (dgBroadPhase* const dest);
 
 	protected:
+	class dgBroadPhaseKernel
+	{
+		public:
+		typedef void (dgBroadPhase::*dgKernel) (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+
+		dgBroadPhaseKernel (dgBroadPhase* const me, dgKernel kernel, void* const context)
+			:m_me(me)
+			,m_kernel(kernel)
+			,m_context(context)
+		{
+		}
+
+		void operator() (dgInt32 start, dgInt32 end, dgInt32 threadID) const
+		{
+			(m_me->*m_kernel) (m_context, start, end, threadID);
+		}
+
+		dgBroadPhase* m_me;
+		dgKernel m_kernel;
+		void* m_context;
+	};
+	typedef dgThreadHive::dgParallelForTasks<dgBroadPhaseKernel> dgBroadPhaseForTasks;
+
 	virtual void LinkAggregate (dgBroadPhaseAggregate* const aggregate) = 0; 
 	virtual void UnlinkAggregate (dgBroadPhaseAggregate* const aggregate) = 0; 
 
-	bool DoNeedUpdate(dgBodyMasterList::dgListNode* const node) const;
+	bool DoNeedUpdate(dgBody* const body) const;
 	dgFloat64 CalculateEntropy (dgFitnessList& fitness, dgBroadPhaseNode** const root);
 	dgBroadPhaseTreeNode* InsertNode (dgBroadPhaseNode* const root, dgBroadPhaseNode* const node);
 
@@ -353,11 +517,30 @@ class dgBroadPhase
 	void ImproveFitness(dgFitnessList& fitness, dgFloat64& oldEntropy, dgBroadPhaseNode** const root);
 
 	void CalculatePairContacts (dgPair* const pair, dgInt32 threadID);
+	void ApplyPairContacts (dgPair* const pair, dgInt32 threadID);
+	bool IsPairCollidable (dgContact* const contact, dgInt32 threadIndex) const;
 	bool ValidateContactCache(dgContact* const contact, dgFloat32 timestep) const;
     void AddPair (dgContact* const contact, dgFloat32 timestep, dgInt32 threadIndex);
 	void AddPair (dgBody* const body0, dgBody* const body1, dgFloat32 timestep, dgInt32 threadID);	
+	const dgContactMaterial* GetPairMaterial (dgBody* const body0, dgBody* const body1) const;
+	dgContact* CreateContact (dgBody* const body0, dgBody* const body1, const dgContactMaterial* const material);
+	void CreatePendingContacts ();
+	dgInt32 MergeSpherePairs ();
 
 	void ForEachBodyInAABB (const dgBroadPhaseNode** stackPool, dgInt32 stack, const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const;
+	void FlatForEachBodyInAABB (dgInt32* const stackPool, dgInt32 stack, const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const;
+	void FlatRayCast (dgInt32* const stackPool, dgFloat32* const distance, dgInt32 stack, const dgVector& l0, const dgVector& l1, dgFastRayTest& ray, OnRayCastAction filter, OnRayPrecastAction prefilter, void* const userData) const;
+	dgInt32 FlatConvexCast (dgInt32* const stackPool, dgFloat32* const distance, dgInt32 stack, const dgVector& velocA, const dgVector& velocB, dgFastRayTest& ray,  
+							dgCollisionInstance* const shape, const dgMatrix& matrix, const dgVector& target, dgFloat32* const param, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const;
+	dgInt32 FlatCollide (dgInt32* const stackPool, dgInt32* const overlap, dgInt32 stack, const dgVector& p0, const dgVector& p1, 
+						 dgCollisionInstance* const shape, const dgMatrix& matrix, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const;
+
+	void BuildFlatNodes ();
+	void SyncFlatNode (const dgBroadPhaseTreeNode* const node);
+	dgInt32 FlattenNode (dgBroadPhaseNode* const node, dgInt32 aggregateLeaf);
+	dgInt32 GetFlatLeft (const dgBroadPhaseTreeNode* const node) const;
+	dgInt32 GetFlatRight (const dgBroadPhaseTreeNode* const node) const;
+	static DG_INLINE dgInt32 PushFlatNode (dgInt32* const stackPool, dgFloat32* const distance, dgInt32 stack, dgInt32 index, dgFloat32 dist);
 	void RayCast (const dgBroadPhaseNode** stackPool, dgFloat32* const distance, dgInt32 stack, const dgVector& l0, const dgVector& l1, dgFastRayTest& ray, OnRayCastAction filter, OnRayPrecastAction prefilter, void* const userData) const;
 
 	dgInt32 ConvexCast (const dgBroadPhaseNode** stackPool, dgFloat32* const distance, dgInt32 stack, const dgVector& velocA, const dgVector& velocB, dgFastRayTest& ray,  
@@ -366,28 +549,54 @@ class dgBroadPhase
 	dgInt32 Collide(const dgBroadPhaseNode** stackPool, dgInt32* const overlap, dgInt32 stack, const dgVector& p0, const dgVector& p1, 
 		            dgCollisionInstance* const shape, const dgMatrix& matrix, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const;
 
-	void SleepingState (dgBroadphaseSyncDescriptor* const descriptor, dgBodyMasterList::dgListNode* node, dgInt32 threadID);
-	void ApplyForceAndtorque (dgBroadphaseSyncDescriptor* const descriptor, dgBodyMasterList::dgListNode* node, dgInt32 threadID);
+	dgInt32 ConvexCast (const dgBatchQueryCandidates* const candidates, dgCollisionInstance* const shape, const dgMatrix& matrix, const dgVector& target, dgFloat32* const param, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const;
+	dgInt32 Collide (const dgBatchQueryCandidates* const candidates, dgCollisionInstance* const shape, const dgMatrix& matrix, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const;
+
+	void SleepingState (dgBody* const body, dgFloat32 timestep, dgInt32 threadID);
+	void ApplyForceAndtorque (dgBody* const body, dgFloat32 timestep, dgInt32 threadID);
+	void ForceAndTorqueKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void SleepingStateKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void ForceAndTorqueSleepingStateKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
 	
 	void UpdateAggregateEntropy (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseAggregate*>::dgListNode* node, dgInt32 threadID);
 
-	dgBroadPhaseNode* BuildTopDown(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode);
-	dgBroadPhaseNode* BuildTopDownBig(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgFitnessList::dgListNode** const nextNode);
+	void BroadPhaseFor (dgBroadPhaseKernel::dgKernel kernel, void* const context, dgInt32 start, dgInt32 end, dgInt32 minChunkSize);
+	dgInt32 SpliteBoxes (dgBroadPhaseNode** const boxArray, dgInt32 boxCount, dgVector& minBox, dgVector& maxBox) const;
+	dgInt32 SpliteBoxesParallel (dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 boxCount, dgVector& minBox, dgVector& maxBox);
+	void SpliteTopDown (dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 lastBox, dgInt32 nodeIndex, dgBroadPhaseTreeNode* const parent, dgBroadPhaseNode** const link);
+	dgBroadPhaseNode* BuildTopDown(dgBroadPhaseNode** const leafArray, dgInt32 firstBox, dgInt32 lastBox, dgBroadPhaseTreeNode** const nodeArray, dgInt32 nodeIndex) const;
+	dgBroadPhaseNode* BuildTopDownParallel(dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 lastBox, dgInt32 nodeIndex);
+	dgBroadPhaseNode* BuildTopDownBig(dgBuildSyncData* const syncData, dgInt32 firstBox, dgInt32 lastBox, dgInt32 nodeIndex);
+
+	void BuildBoundsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void BuildBinsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void BuildSubtreesKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void RefitNodesKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void RayCastBatchKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void ConvexCastBatchKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void SpherePairsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void BatchQuerySort (dgBatchQueryKey* const keys, const dgFloat32* const points, dgInt32 strideInBytes, const void* const shapes, dgInt32 count) const;
+	static dgInt32 BatchQueryCompareKeys (const dgBatchQueryKey* const keyA, const dgBatchQueryKey* const keyB, void* const context);
+	static void ConvexCastBatchBox (const dgConvexCastBatchInfo& query, bool collide, dgVector& minBox, dgVector& maxBox);
+	static dgInt32 dgApi BatchQueryCollectCandidate (dgBody* body, void* const userData);
+	static dgUnsigned32 dgApi BatchQueryPrefilter (const dgBody* const body, const dgCollisionInstance* const collision, void* const userData);
+	static dgFloat32 dgApi RayCastBatchFilter (const dgBody* const body, const dgCollisionInstance* const collision, const dgVector& contact, const dgVector& normal, dgInt64 collisionID, void* const userData, dgFloat32 intersetParam);
+	static bool IsRefitPending (const dgBroadPhaseNode* const node);
 
 	void KinematicBodyActivation (dgContact* const contatJoint) const;
 	
 	void FindGeneratedBodiesCollidingPairs (dgBroadphaseSyncDescriptor* const descriptor, dgInt32 threadID);
 	void UpdateSoftBodyContacts(dgBroadphaseSyncDescriptor* const descriptor, dgFloat32 timeStep, dgInt32 threadID);
 	void UpdateRigidBodyContacts (dgBroadphaseSyncDescriptor* const descriptor, dgActiveContacts::dgListNode* const node, dgFloat32 timeStep, dgInt32 threadID);
-	void SubmitPairs (dgBroadPhaseNode* const body, dgBroadPhaseNode* const node, dgFloat32 timestep, dgInt32 threaCount, dgInt32 threadID);
+	void SubmitPairs (dgBroadPhaseNode* const body, dgInt32 flatIndex, dgFloat32 timestep, dgInt32 threaCount, dgInt32 threadID);
+	void SubmitLeafPair (dgBroadPhaseNode* const leaf0, dgBroadPhaseNode* const leaf1, dgFloat32 timestep, dgInt32 threadID);
 		
-	static void SleepingStateKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
-	static void ForceAndToqueKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void CollidingPairsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void UpdateAggregateEntropyKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void AddGeneratedBodiesContactsKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void UpdateRigidBodyContactKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
 	static void UpdateSoftBodyContactKernel(void* const descriptor, void* const worldContext, dgInt32 threadID);
+	static void MergeSpherePairsKernel(void* const descriptor, void* const spherePairsTasks, dgInt32 threadID);
 	static dgInt32 CompareNodes(const dgBroadPhaseNode* const nodeA, const dgBroadPhaseNode* const nodeB, void* const notUsed);
 
 	class dgPendingCollisionSofBodies
@@ -397,17 +606,54 @@ class dgBroadPhase
 		dgBody* m_body1;
 	};
 
+	class dgPendingContact
+	{
+		public:
+		dgUnsigned64 m_key;
+		dgBody* m_body0;
+		dgBody* m_body1;
+		const dgContactMaterial* m_material;
+		dgInt32 m_slot;
+	};
+	static dgInt32 ComparePendingContacts(const dgPendingContact* const contactA, const dgPendingContact* const contactB, void* const notUsed);
+
+	class dgPendingSpherePair
+	{
+		public:
+		dgContact* m_contact;
+		dgInt32 m_key;
+	};
+	static dgInt32 CompareSpherePairs(const dgPendingSpherePair* const pairA, const dgPendingSpherePair* const pairB, void* const notUsed);
+
 	dgWorld* m_world;
 	dgBroadPhaseNode* m_rootNode;
 	dgList<dgBody*> m_generatedBodies;
 	dgList<dgBroadPhaseNode*> m_updateList;
 	dgList<dgBroadPhaseAggregate*> m_aggregateList;
 	dgUnsigned32 m_lru;
-	dgThread::dgCriticalSection m_contacJointLock;
+	dgBroadPhasePairCache m_pairCache;
 	dgThread::dgCriticalSection m_criticalSectionLock;
-	dgArray<dgPendingCollisionSofBodies> m_pendingSoftBodyCollisions;
 	dgInt32 m_pendingSoftBodyPairsCount;
+
+	// the new pairs of each thread, their contact joints are created and the soft body pairs are 
+	// gathered after the pairs scan, so the scan never locks
+	dgArray<dgPendingCollisionSofBodies> m_pendingSoftBodyCollisions[DG_MAX_THREADS_HIVE_COUNT];
+	dgInt32 m_pendingSoftBodyCollisionsCount[DG_MAX_THREADS_HIVE_COUNT];
+	dgArray<dgPendingContact> m_pendingContacts[DG_MAX_THREADS_HIVE_COUNT];
+	dgInt32 m_pendingContactsCount[DG_MAX_THREADS_HIVE_COUNT];
+
+	// the pairs of a sphere against a sphere, a capsule or a box of each thread, they are collided four at a time sorted by shape types
+	dgArray<dgPendingSpherePair> m_pendingSpherePairs[DG_MAX_THREADS_HIVE_COUNT];
+	dgInt32 m_pendingSpherePairsCount[DG_MAX_THREADS_HIVE_COUNT];
+	dgArray<dgBroadPhaseTreeNode*> m_refitNodes;
+	dgArray<dgInt32> m_refitLevels;
+	dgArray<dgBroadPhaseFlatNode> m_flatNodes;
+	dgArray<dgBroadPhaseFlatLeaf> m_flatLeaves;
+	dgInt32 m_flatNodesCount;
+	dgInt32 m_flatLeavesCount;
 	dgInt32 m_dirtyNodesCount;
+	dgInt32 m_refitPending;
+	bool m_flatNodesValid;
 	bool m_scanTwoWays;
 	bool m_recursiveChunks;
 
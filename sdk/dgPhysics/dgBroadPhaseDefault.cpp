@@ -66,9 +66,15 @@ void dgBroadPhaseDefault::InvalidateCache()
 void dgBroadPhaseDefault::ForEachBodyInAABB(const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const
 {
 	if (m_rootNode) {
-		const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
-		stackPool[0] = m_rootNode;
-		dgBroadPhase::ForEachBodyInAABB(stackPool, 1, minBox, maxBox, callback, userData);
+		if (m_flatNodesValid) {
+			dgInt32 stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			stackPool[0] = 0;
+			dgBroadPhase::FlatForEachBodyInAABB(stackPool, 1, minBox, maxBox, callback, userData);
+		} else {
+			const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			stackPool[0] = m_rootNode;
+			dgBroadPhase::ForEachBodyInAABB(stackPool, 1, minBox, maxBox, callback, userData);
+		}
 	}
 }
 
@@ -81,13 +87,18 @@ void dgBroadPhaseDefault::RayCast(const dgVector& l0, const dgVector& l1, OnRayC
 		if (dist2 > dgFloat32(1.0e-8f)) {
 
 			dgFloat32 distance[DG_BROADPHASE_MAX_STACK_DEPTH];
-			const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
-
 			dgFastRayTest ray(l0, l1);
 
-			stackPool[0] = m_rootNode;
 			distance[0] = ray.BoxIntersect(m_rootNode->m_minBox, m_rootNode->m_maxBox);
-			dgBroadPhase::RayCast(stackPool, distance, 1, l0, l1, ray, filter, prefilter, userData);
+			if (m_flatNodesValid) {
+				dgInt32 stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+				stackPool[0] = 0;
+				dgBroadPhase::FlatRayCast(stackPool, distance, 1, l0, l1, ray, filter, prefilter, userData);
+			} else {
+				const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+				stackPool[0] = m_rootNode;
+				dgBroadPhase::RayCast(stackPool, distance, 1, l0, l1, ray, filter, prefilter, userData);
+			}
 		}
 	}
 }
@@ -103,7 +114,6 @@ dgInt32 dgBroadPhaseDefault::ConvexCast(dgCollisionInstance* const shape, const
 		shape->CalcAABB(matrix, boxP0, boxP1);
 
 		dgFloat32 distance[DG_BROADPHASE_MAX_STACK_DEPTH];
-		const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
 
 		dgVector velocA((target - matrix.m_posit) & dgVector::m_triplexMask);
 		dgVector velocB(dgFloat32(0.0f));
@@ -111,11 +121,18 @@ dgInt32 dgBroadPhaseDefault::ConvexCast(dgCollisionInstance* const shape, const
 
 		dgVector minBox(m_rootNode->m_minBox - boxP1);
 		dgVector maxBox(m_rootNode->m_maxBox - boxP0);
-		stackPool[0] = m_rootNode;
 		distance[0] = ray.BoxIntersect(minBox, maxBox);
 
 		*param = dgFloat32 (1.0f);
-		totalCount = dgBroadPhase::ConvexCast(stackPool, distance, 1, velocA, velocB, ray, shape, matrix, target, param, prefilter, userData, info, maxContacts, threadIndex);
+		if (m_flatNodesValid) {
+			dgInt32 stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			stackPool[0] = 0;
+			totalCount = dgBroadPhase::FlatConvexCast(stackPool, distance, 1, velocA, velocB, ray, shape, matrix, target, param, prefilter, userData, info, maxContacts, threadIndex);
+		} else {
+			const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			stackPool[0] = m_rootNode;
+			totalCount = dgBroadPhase::ConvexCast(stackPool, distance, 1, velocA, velocB, ray, shape, matrix, target, param, prefilter, userData, info, maxContacts, threadIndex);
+		}
 	}
 
 	return totalCount;
@@ -131,12 +148,17 @@ dgInt32 dgBroadPhaseDefault::Collide(dgCollisionInstance* const shape, const dgM
 		shape->CalcAABB(matrix, boxP0, boxP1);
 
 		dgInt32 overlaped[DG_BROADPHASE_MAX_STACK_DEPTH];
-		const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
-
-		stackPool[0] = m_rootNode;
 		overlaped[0] = dgOverlapTest(m_rootNode->m_minBox, m_rootNode->m_maxBox, boxP0, boxP1);
 
-		totalCount = dgBroadPhase::Collide(stackPool, overlaped, 1, boxP0, boxP1, shape, matrix, prefilter, userData, info, maxContacts, threadIndex);
+		if (m_flatNodesValid) {
+			dgInt32 stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			stackPool[0] = 0;
+			totalCount = dgBroadPhase::FlatCollide(stackPool, overlaped, 1, boxP0, boxP1, shape, matrix, prefilter, userData, info, maxContacts, threadIndex);
+		} else {
+			const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			stackPool[0] = m_rootNode;
+			totalCount = dgBroadPhase::Collide(stackPool, overlaped, 1, boxP0, boxP1, shape, matrix, prefilter, userData, info, maxContacts, threadIndex);
+		}
 	}
 
 	return totalCount;
@@ -144,6 +166,7 @@ dgInt32 dgBroadPhaseDefault::Collide(dgCollisionInstance* const shape, const dgM
 
 void dgBroadPhaseDefault::AddNode(dgBroadPhaseNode* const newNode)
 {
+	m_flatNodesValid = false;
 	if (!m_rootNode) {
 		m_rootNode = newNode;
 	} else {
@@ -181,6 +204,8 @@ void dgBroadPhaseDefault::LinkAggregate(dgBroadPhaseAggregate* const aggregate)
 
 void dgBroadPhaseDefault::RemoveNode(dgBroadPhaseNode* const node)
 {
+	RefitDirtyNodes();
+	m_flatNodesValid = false;
 	if (node->m_parent) {
 		if (!node->m_parent->IsAggregate()) {
 			dgBroadPhaseTreeNode* const parent = (dgBroadPhaseTreeNode*)node->m_parent;
@@ -357,7 +382,7 @@ void dgBroadPhaseDefault::FindCollidingPairsForward(dgBroadphaseSyncDescriptor*
 			dgAssert(!parent->IsLeafNode());
 			dgBroadPhaseNode* const sibling = parent->m_right;
 			if (sibling != ptr) {
-				SubmitPairs(broadPhaseNode, sibling, timestep, 0, threadID);
+				SubmitPairs(broadPhaseNode, GetFlatRight(parent), timestep, 0, threadID);
 			}
 		}
 
@@ -390,11 +415,11 @@ void dgBroadPhaseDefault::FindCollidingPairsForwardAndBackward(dgBroadphaseSyncD
 				dgAssert(!parent->IsLeafNode());
 				dgBroadPhaseNode* const rightSibling = parent->m_right;
 				if (rightSibling && (rightSibling != ptr)) {
-					SubmitPairs(broadPhaseNode, rightSibling, timestep, threadCount, threadID);
+					SubmitPairs(broadPhaseNode, GetFlatRight(parent), timestep, threadCount, threadID);
 				}
 				dgBroadPhaseNode* const leftSibling = parent->m_left;
 				if (leftSibling != ptr) {
-					SubmitPairs(broadPhaseNode, leftSibling, timestep, threadCount, threadID);
+					SubmitPairs(broadPhaseNode, GetFlatLeft(parent), timestep, threadCount, threadID);
 				}
 			}
 		}
@@ -0,0 +1,209 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgContact.h"
+#include "dgBroadPhasePairCache.h"
+
+#define DG_PAIR_CACHE_MIN_SIZE		256
+#define DG_PAIR_CACHE_EMPTY_KEY		dgInt64 (0)
+#define DG_PAIR_CACHE_DELETED_KEY	dgInt64 (-1)
+
+
+dgBroadPhasePairCache::dgBroadPhasePairCache(dgMemoryAllocator* const allocator)
+	:m_allocator(allocator)
+	,m_entries(NULL)
+	,m_capacity(0)
+	,m_shift(64)
+	,m_count(0)
+	,m_deletedCount(0)
+	,m_overflow(0)
+	,m_valid(false)
+{
+}
+
+dgBroadPhasePairCache::~dgBroadPhasePairCache()
+{
+	if (m_entries) {
+		m_allocator->FreeLow(m_entries);
+	}
+}
+
+DG_INLINE dgInt64 dgBroadPhasePairCache::MakeKey (const dgBody* const body0, const dgBody* const body1) const
+{
+	// unique ids start at one and are positive, so a key can never be the empty or the deleted key
+	dgUnsigned32 id0 = dgUnsigned32 (body0->GetUniqueID());
+	dgUnsigned32 id1 = dgUnsigned32 (body1->GetUniqueID());
+	if (id1 < id0) {
+		dgSwap (id0, id1);
+	}
+	dgAssert (id0);
+	return dgInt64 ((dgUnsigned64 (id1) << 32) | dgUnsigned64 (id0));
+}
+
+DG_INLINE dgInt32 dgBroadPhasePairCache::HashKey (dgInt64 key) const
+{
+	// fibonacci hashing, the top bits of the product are the best mixed
+	const dgUnsigned64 hash = dgUnsigned64 (key) * dgUnsigned64 (0x9e3779b97f4a7c15ULL);
+	return dgInt32 (hash >> m_shift);
+}
+
+void dgBroadPhasePairCache::Invalidate ()
+{
+	m_valid = false;
+}
+
+void dgBroadPhasePairCache::Prepare (dgWorld* const world, dgInt32 bodyCount)
+{
+	// leave room for each body to start one new pair, and keep the load below one half
+	if (!m_valid || m_overflow || ((m_count + m_deletedCount + bodyCount) * 2 > m_capacity)) {
+		const dgActiveContacts* const contactList = world;
+		const dgInt32 count = dgMax (contactList->GetCount() * 2 + bodyCount, DG_PAIR_CACHE_MIN_SIZE / 2);
+		dgInt32 capacity = DG_PAIR_CACHE_MIN_SIZE;
+		while (capacity < count * 2) {
+			capacity *= 2;
+		}
+		Rebuild (world, capacity);
+	}
+}
+
+void dgBroadPhasePairCache::Rebuild (dgWorld* const world, dgInt32 capacity)
+{
+	if (capacity != m_capacity) {
+		if (m_entries) {
+			m_allocator->FreeLow(m_entries);
+		}
+		m_capacity = capacity;
+		m_entries = (dgEntry*)m_allocator->MallocLow(dgInt32 (sizeof (dgEntry) * capacity));
+		m_shift = 64;
+		for (dgInt32 i = capacity; i > 1; i >>= 1) {
+			m_shift --;
+		}
+	}
+	memset (m_entries, 0, sizeof (dgEntry) * m_capacity);
+
+	m_count = 0;
+	m_overflow = 0;
+	m_deletedCount = 0;
+	m_valid = true;
+
+	const dgInt32 mask = m_capacity - 1;
+	const dgActiveContacts* const contactList = world;
+	for (dgActiveContacts::dgListNode* node = contactList->GetFirst(); node; node = node->GetNext()) {
+		dgContact* const contact = node->GetInfo();
+		const dgInt64 key = MakeKey (contact->GetBody0(), contact->GetBody1());
+		dgInt32 index = HashKey (key);
+		while (m_entries[index].m_key != DG_PAIR_CACHE_EMPTY_KEY) {
+			dgAssert (m_entries[index].m_key != key);
+			index = (index + 1) & mask;
+		}
+		m_entries[index].m_key = key;
+		m_entries[index].m_contact = contact;
+		m_count ++;
+	}
+	dgAssert (m_count * 2 <= m_capacity);
+}
+
+bool dgBroadPhasePairCache::Find (const dgBody* const body0, const dgBody* const body1, dgContact** const contact) const
+{
+	*contact = NULL;
+	if (m_valid) {
+		const dgInt32 mask = m_capacity - 1;
+		const dgInt64 key = MakeKey (body0, body1);
+		dgInt32 index = HashKey (key);
+		for (dgInt32 i = 0; i < m_capacity; i ++) {
+			const dgEntry* const entry = &m_entries[index];
+			const dgInt64 entryKey = *((volatile dgInt64*) &entry->m_key);
+			if (entryKey == key) {
+				*contact = *((dgContact* volatile*) &entry->m_contact);
+				return true;
+			}
+			if (entryKey == DG_PAIR_CACHE_EMPTY_KEY) {
+				break;
+			}
+			index = (index + 1) & mask;
+		}
+	}
+	return false;
+}
+
+dgBroadPhasePairCache::dgInsertResult dgBroadPhasePairCache::Insert (const dgBody* const body0, const dgBody* const body1, dgInt32* const slotIndex)
+{
+	// deleted entries are not recycled here, so while the broad phase is scanning empty entries can only 
+	// be taken, a thread that finds no empty entry knows that no other thread can add the pair either
+	if (m_valid) {
+		const dgInt32 mask = m_capacity - 1;
+		const dgInt64 key = MakeKey (body0, body1);
+		dgInt32 index = HashKey (key);
+		for (dgInt32 i = 0; i < m_capacity; i ++) {
+			dgEntry* const entry = &m_entries[index];
+			dgInt64 entryKey = *((volatile dgInt64*) &entry->m_key);
+			if (entryKey == DG_PAIR_CACHE_EMPTY_KEY) {
+				if (dgAtomicCompareAndSwap (&entry->m_key, DG_PAIR_CACHE_EMPTY_KEY, key)) {
+					dgAtomicExchangeAndAdd (&m_count, 1);
+					*slotIndex = index;
+					return m_inserted;
+				}
+				entryKey = *((volatile dgInt64*) &entry->m_key);
+			}
+			if (entryKey == key) {
+				return m_duplicated;
+			}
+			index = (index + 1) & mask;
+		}
+		m_overflow = 1;
+	}
+	return m_full;
+}
+
+void dgBroadPhasePairCache::SetContact (dgInt32 slotIndex, dgContact* const contact)
+{
+	dgAssert (m_entries[slotIndex].m_key == MakeKey (contact->GetBody0(), contact->GetBody1()));
+	*((dgContact* volatile*) &m_entries[slotIndex].m_contact) = contact;
+}
+
+void dgBroadPhasePairCache::Remove (const dgContact* const contact)
+{
+	if (m_valid) {
+		const dgInt32 mask = m_capacity - 1;
+		const dgInt64 key = MakeKey (contact->GetBody0(), contact->GetBody1());
+		dgInt32 index = HashKey (key);
+		for (dgInt32 i = 0; i < m_capacity; i ++) {
+			dgEntry* const entry = &m_entries[index];
+			if (entry->m_key == key) {
+				dgAssert (entry->m_contact == contact);
+				if (entry->m_contact == contact) {
+					entry->m_key = DG_PAIR_CACHE_DELETED_KEY;
+					entry->m_contact = NULL;
+					m_count --;
+					m_deletedCount ++;
+				}
+				break;
+			}
+			if (entry->m_key == DG_PAIR_CACHE_EMPTY_KEY) {
+				break;
+			}
+			index = (index + 1) & mask;
+		}
+	}
+}
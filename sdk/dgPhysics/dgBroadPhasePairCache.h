@@ -0,0 +1,89 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __DG_BROADPHASE_PAIR_CACHE_H__
+#define __DG_BROADPHASE_PAIR_CACHE_H__
+
+#include "dgPhysicsStdafx.h"
+
+class dgBody;
+class dgWorld;
+class dgContact;
+
+// open addressing table that maps the unique ids of two bodies to their contact joint.
+// Find and Insert are lock free and can be called from all threads while the broad phase
+// scans for colliding pairs, Remove, Prepare and Invalidate must be called from one thread only.
+class dgBroadPhasePairCache
+{
+	public:
+	enum dgInsertResult
+	{
+		m_inserted,
+		m_duplicated,
+		m_full,
+	};
+
+	dgBroadPhasePairCache(dgMemoryAllocator* const allocator);
+	~dgBroadPhasePairCache();
+
+	// rebuilds the table from the world contact list when it was invalidated, overflowed
+	// or is too crowded to take the new pairs of one more update
+	void Prepare (dgWorld* const world, dgInt32 bodyCount);
+	void Invalidate ();
+
+	bool IsValid() const
+	{
+		return m_valid;
+	}
+
+	// returns true when the pair is in the table, contact is NULL when the pair was
+	// inserted during this scan, its contact joint is created after the scan
+	bool Find (const dgBody* const body0, const dgBody* const body1, dgContact** const contact) const;
+
+	// reserves the pair entry, only the thread that gets m_inserted queues the contact
+	// joint, which is published with SetContact once it is created
+	dgInsertResult Insert (const dgBody* const body0, const dgBody* const body1, dgInt32* const slotIndex);
+	void SetContact (dgInt32 slotIndex, dgContact* const contact);
+	void Remove (const dgContact* const contact);
+
+	private:
+	class dgEntry
+	{
+		public:
+		dgInt64 m_key;
+		dgContact* m_contact;
+	};
+
+	DG_INLINE dgInt64 MakeKey (const dgBody* const body0, const dgBody* const body1) const;
+	DG_INLINE dgInt32 HashKey (dgInt64 key) const;
+	void Rebuild (dgWorld* const world, dgInt32 capacity);
+
+	dgMemoryAllocator* m_allocator;
+	dgEntry* m_entries;
+	dgInt32 m_capacity;
+	dgInt32 m_shift;
+	dgInt32 m_count;
+	dgInt32 m_deletedCount;
+	dgInt32 m_overflow;
+	bool m_valid;
+};
+
+#endif
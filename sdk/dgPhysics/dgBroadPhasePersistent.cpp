@@ -44,7 +44,7 @@ class dgBroadPhasePesistanceRootNode: public dgBroadPhaseTreeNode
 	{
 		if (m_right && m_left) {
 			dgVector minBox (m_right->m_minBox.GetMin(m_left->m_minBox));
-			dgVector maxBox (m_right->m_maxBox.GetMin(m_left->m_maxBox));
+			dgVector maxBox (m_right->m_maxBox.GetMax(m_left->m_maxBox));
 			SetAABB(minBox, maxBox);
 		} else if (m_right) {
 			SetAABB(m_right->m_minBox, m_right->m_maxBox);
@@ -57,16 +57,29 @@ class dgBroadPhasePesistanceRootNode: public dgBroadPhaseTreeNode
 dgBroadPhasePersistent::dgBroadPhasePersistent(dgWorld* const world)
 	:dgBroadPhase(world)
 	,m_staticEntropy(dgFloat32 (0.0f))
+	,m_sleepingEntropy(dgFloat32 (0.0f))
 	,m_dynamicsEntropy(dgFloat32 (0.0f))
 	,m_staticFitness(world->GetAllocator())
+	,m_sleepingFitness(world->GetAllocator())
 	,m_dynamicsFitness(world->GetAllocator())
+	,m_wakeBodies(world->GetAllocator())
+	,m_inactiveRoot(NULL)
+	,m_sleepingRoot(NULL)
+	,m_staticRoot(NULL)
+	,m_wakeBodiesCount(0)
 	,m_staticNeedsUpdate(true)
+	,m_sleepingNeedsUpdate(false)
 {
 	m_rootNode = new (world->GetAllocator()) dgBroadPhasePesistanceRootNode();
+	m_inactiveRoot = new (world->GetAllocator()) dgBroadPhaseTreeNode();
 }
 
 dgBroadPhasePersistent::~dgBroadPhasePersistent()
 {
+	// the inactive root owns the sleeping and the static tree only while it is linked
+	if (m_rootNode->GetRight() != m_inactiveRoot) {
+		delete m_inactiveRoot;
+	}
 	delete m_rootNode;
 }
 
@@ -92,31 +105,80 @@ void dgBroadPhasePersistent::CheckStaticDynamic(dgBody* const body, dgFloat32 ma
 void dgBroadPhasePersistent::Add(dgBody* const body)
 {
 	dgAssert (!body->GetCollision()->IsType (dgCollision::dgCollisionNull_RTTI));
-	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
 	dgAssert (m_rootNode->IsPersistentRoot());
 
+	m_flatNodesValid = false;
 	if (body->GetCollision()->IsType(dgCollision::dgCollisionMesh_RTTI) || (body->GetInvMass().m_w == dgFloat32(0.0f))) {
 		m_staticNeedsUpdate = true;
-		if (root->m_right) {
-			dgBroadPhaseTreeNode* const node = InsertNode(root->m_right, new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body));
-			node->m_fitnessNode = m_staticFitness.Append(node);
-		} else {
-			root->m_right = new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body);
-			root->m_right->m_parent = root;
-		}
+		AddInactiveNode(&m_staticRoot, m_staticFitness, new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body));
 	} else {
 		dgBroadPhaseBodyNode* const newNode = new (m_world->GetAllocator()) dgBroadPhaseBodyNode(body);
-		if (root->m_left) {
-			dgBroadPhaseTreeNode* const node = InsertNode(root->m_left, newNode);
-			node->m_fitnessNode = m_dynamicsFitness.Append(node);
-		} else {
-			root->m_left = newNode;
-			root->m_left->m_parent = root;
-		}
+		AddActiveNode(newNode);
 		newNode->m_updateNode = m_updateList.Append(newNode);
 	}
 }
 
+void dgBroadPhasePersistent::AddActiveNode(dgBroadPhaseNode* const node)
+{
+	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
+	if (root->m_left) {
+		dgBroadPhaseTreeNode* const parent = InsertNode(root->m_left, node);
+		parent->m_fitnessNode = m_dynamicsFitness.Append(parent);
+	} else {
+		root->m_left = node;
+		root->m_left->m_parent = root;
+	}
+}
+
+void dgBroadPhasePersistent::AddInactiveNode(dgBroadPhaseNode** const root, dgFitnessList& fitness, dgBroadPhaseNode* const node)
+{
+	if (*root) {
+		dgBroadPhaseTreeNode* const parent = InsertNode(*root, node);
+		parent->m_fitnessNode = fitness.Append(parent);
+		if (parent->m_left == *root) {
+			*root = parent;
+		}
+	} else {
+		*root = node;
+	}
+	LinkInactiveRoots();
+}
+
+void dgBroadPhasePersistent::LinkInactiveRoots()
+{
+	// the inactive root is only linked when it has both children, so all nodes below the 
+	// persistent root are ordinary tree nodes for the refit, the flat nodes and the queries
+	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
+	m_flatNodesValid = false;
+	m_inactiveRoot->m_left = NULL;
+	m_inactiveRoot->m_right = NULL;
+	m_inactiveRoot->m_parent = NULL;
+	m_inactiveRoot->m_refitMark = 0;
+	if (m_sleepingRoot && m_staticRoot) {
+		m_inactiveRoot->m_left = m_sleepingRoot;
+		m_inactiveRoot->m_right = m_staticRoot;
+		m_inactiveRoot->m_parent = root;
+		m_sleepingRoot->m_parent = m_inactiveRoot;
+		m_staticRoot->m_parent = m_inactiveRoot;
+		m_inactiveRoot->m_surfaceArea = CalculateSurfaceArea(m_sleepingRoot, m_staticRoot, m_inactiveRoot->m_minBox, m_inactiveRoot->m_maxBox);
+		root->m_right = m_inactiveRoot;
+	} else {
+		root->m_right = m_sleepingRoot ? m_sleepingRoot : m_staticRoot;
+		if (root->m_right) {
+			root->m_right->m_parent = root;
+		}
+	}
+}
+
+dgBroadPhaseNode* dgBroadPhasePersistent::GetTreeRoot(dgBroadPhaseNode* const node) const
+{
+	dgBroadPhaseNode* root = node;
+	while ((root->m_parent != m_rootNode) && (root->m_parent != m_inactiveRoot)) {
+		root = root->m_parent;
+	}
+	return root;
+}
+
 dgBroadPhaseAggregate* dgBroadPhasePersistent::CreateAggregate()
 {
 	dgBroadPhaseAggregate* const aggregate = new (m_world->GetAllocator()) dgBroadPhaseAggregate(m_world->GetBroadPhase());
@@ -127,16 +189,10 @@ dgBroadPhaseAggregate* dgBroadPhasePersistent::CreateAggregate()
 void dgBroadPhasePersistent::LinkAggregate(dgBroadPhaseAggregate* const aggregate)
 {
 	dgAssert(m_rootNode->IsPersistentRoot());
-	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
 
+	m_flatNodesValid = false;
 	aggregate->m_broadPhase = this;
-	if (root->m_left) {
-		dgBroadPhaseTreeNode* const node = InsertNode(root->m_left, aggregate);
-		node->m_fitnessNode = m_dynamicsFitness.Append(node);
-	} else {
-		root->m_left = aggregate;
-		root->m_left->m_parent = m_rootNode;
-	}
+	AddActiveNode(aggregate);
 	aggregate->m_updateNode = m_updateList.Append(aggregate);
 	aggregate->m_myAggregateNode = m_aggregateList.Append(aggregate);
 }
@@ -150,21 +206,33 @@ void dgBroadPhasePersistent::DestroyAggregate(dgBroadPhaseAggregate* const aggre
 
 void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 {
-	dgAssert (node->m_parent);
+	DetachNode(node);
+	delete node;
+}
 
-	if (node->m_parent->IsPersistentRoot()) {
-		dgBroadPhasePesistanceRootNode* const parent = (dgBroadPhasePesistanceRootNode*)m_rootNode;
-		dgAssert(parent == node->m_parent);
+void dgBroadPhasePersistent::DetachNode(dgBroadPhaseNode* const node)
+{
+	// unlinks the node from its tree without deleting it, the node can be inserted again in any tree
+	RefitDirtyNodes();
+	m_flatNodesValid = false;
+	dgAssert (node->m_parent);
 
-		if (parent->m_right == node) {
+	if ((node->m_parent == m_rootNode) || (node->m_parent == m_inactiveRoot)) {
+		// the node is the only leaf of its tree
+		if (node == m_staticRoot) {
 			m_staticNeedsUpdate = true;
-			parent->m_right = NULL;
+			m_staticRoot = NULL;
+			LinkInactiveRoots();
+		} else if (node == m_sleepingRoot) {
+			m_sleepingNeedsUpdate = true;
+			m_sleepingRoot = NULL;
+			LinkInactiveRoots();
 		} else {
-			dgAssert(parent->m_left == node);
-			parent->m_left = NULL;
+			dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
+			dgAssert(root->m_left == node);
+			root->m_left = NULL;
 		}
 		node->m_parent = NULL;
-		delete node;
 	} else if (node->m_parent->IsAggregate()) {
 		dgBroadPhaseAggregate* const aggregate = (dgBroadPhaseAggregate*)node->m_parent;
 		dgBody* const body = node->GetBody();
@@ -173,7 +241,6 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 		body->SetBroadPhaseAggregate(NULL);
 		aggregate->m_root = NULL;
 		node->m_parent = NULL;
-		delete node;
 	} else {
 		dgBroadPhaseTreeNode* const parent = (dgBroadPhaseTreeNode*)node->m_parent;
 		if (parent->m_parent->IsAggregate()) {
@@ -189,7 +256,10 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 				parent->m_left->m_parent = aggregate;
 				parent->m_left = NULL;
 			}
+			parent->m_left = NULL;
+			parent->m_right = NULL;
 			parent->m_parent = NULL;
+			node->m_parent = NULL;
 
 			if (parent->m_fitnessNode) {
 				dgBody* const body = node->GetBody();
@@ -203,85 +273,46 @@ void dgBroadPhasePersistent::RemoveNode(dgBroadPhaseNode* const node)
 
 			delete parent;
 
-		} else if (parent->m_parent->IsPersistentRoot()) {
-			dgBroadPhasePesistanceRootNode* const grandParent = (dgBroadPhasePesistanceRootNode*) parent->m_parent;
-			if (grandParent->m_right == parent) {
-				m_staticNeedsUpdate = true;
-				if (parent->m_right == node) {
-					grandParent->m_right = parent->m_left;
-					parent->m_left->m_parent = grandParent;
-					parent->m_left = NULL;
-					parent->m_parent = NULL;
-				} else {
-					grandParent->m_right = parent->m_right;
-					parent->m_right->m_parent = grandParent;
-					parent->m_right = NULL;
-					parent->m_parent = NULL;
-				}
-				m_staticFitness.Remove(parent->m_fitnessNode);
-				delete parent;
-			} else {
-				dgAssert (grandParent->m_left == parent);
-				if (parent->m_right == node) {
-					grandParent->m_left = parent->m_left;
-					parent->m_left->m_parent = grandParent;
-					parent->m_left = NULL;
-					parent->m_parent = NULL;
-				} else {
-					grandParent->m_left = parent->m_right;
-					parent->m_right->m_parent = grandParent;
-					parent->m_right = NULL;
-					parent->m_parent = NULL;
-				}
-				m_dynamicsFitness.Remove(parent->m_fitnessNode);
-				delete parent;
-			}
 		} else {
+			dgBody* const body = node->GetBody();
+			dgBroadPhaseAggregate* const aggregate = body ? body->GetBroadPhaseAggregate() : NULL;
+			dgBroadPhaseNode* const treeRoot = aggregate ? NULL : GetTreeRoot(parent);
+
 			dgBroadPhaseTreeNode* const grandParent = (dgBroadPhaseTreeNode*)parent->m_parent;
-			dgAssert (grandParent->GetLeft());
-			dgAssert (grandParent->GetRight());
+			dgBroadPhaseNode* const sibling = (parent->m_left == node) ? parent->m_right : parent->m_left;
+			dgAssert ((parent->m_left == node) || (parent->m_right == node));
+			dgAssert (grandParent->IsPersistentRoot() || (grandParent->GetLeft() && grandParent->GetRight()));
 			if (grandParent->m_left == parent) {
-				if (parent->m_right == node) {
-					grandParent->m_left = parent->m_left;
-					parent->m_left->m_parent = grandParent;
-					parent->m_left = NULL;
-					parent->m_parent = NULL;
-				} else {
-					grandParent->m_left = parent->m_right;
-					parent->m_right->m_parent = grandParent;
-					parent->m_right = NULL;
-					parent->m_parent = NULL;
-				}
+				grandParent->m_left = sibling;
 			} else {
-				if (parent->m_right == node) {
-					grandParent->m_right = parent->m_left;
-					parent->m_left->m_parent = grandParent;
-					parent->m_left = NULL;
-					parent->m_parent = NULL;
-				} else {
-					grandParent->m_right = parent->m_right;
-					parent->m_right->m_parent = grandParent;
-					parent->m_right = NULL;
-					parent->m_parent = NULL;
-				}
+				dgAssert(grandParent->m_right == parent);
+				grandParent->m_right = sibling;
 			}
+			sibling->m_parent = grandParent;
+			parent->m_left = NULL;
+			parent->m_right = NULL;
+			parent->m_parent = NULL;
 
-			dgBody* const body = node->GetBody();
-			if (body) {
-				if (body->GetInvMass().m_w == dgFloat32(0.0f)) {
-					m_staticNeedsUpdate = true;
-					m_staticFitness.Remove(parent->m_fitnessNode);
-				} else if (body->GetBroadPhaseAggregate()) {
-					body->GetBroadPhaseAggregate()->m_fitnessList.Remove(parent->m_fitnessNode);
-					body->SetBroadPhaseAggregate(NULL);
-				} else {
-					m_dynamicsFitness.Remove(parent->m_fitnessNode);
+			if (aggregate) {
+				aggregate->m_fitnessList.Remove(parent->m_fitnessNode);
+				body->SetBroadPhaseAggregate(NULL);
+			} else if (treeRoot == m_staticRoot) {
+				m_staticNeedsUpdate = true;
+				m_staticFitness.Remove(parent->m_fitnessNode);
+				if (parent == m_staticRoot) {
+					m_staticRoot = sibling;
+				}
+			} else if (treeRoot == m_sleepingRoot) {
+				m_sleepingNeedsUpdate = true;
+				m_sleepingFitness.Remove(parent->m_fitnessNode);
+				if (parent == m_sleepingRoot) {
+					m_sleepingRoot = sibling;
 				}
 			} else {
-				dgAssert (node->IsAggregate());
 				m_dynamicsFitness.Remove(parent->m_fitnessNode);
 			}
 
+			node->m_parent = NULL;
 			delete parent;
 		}
 	}
@@ -338,7 +369,9 @@ void dgBroadPhasePersistent::Remove(dgBody* const body)
 void dgBroadPhasePersistent::ResetEntropy()
 {
 	m_staticNeedsUpdate = true;
+	m_sleepingNeedsUpdate = true;
 	m_staticEntropy = dgFloat32(0.0f);
+	m_sleepingEntropy = dgFloat32(0.0f);
 	m_dynamicsEntropy = dgFloat32(0.0f);
 }
 
@@ -347,40 +380,153 @@ void dgBroadPhasePersistent::InvalidateCache()
 {
 	ResetEntropy();
 	m_staticNeedsUpdate = false;
+	m_sleepingNeedsUpdate = false;
 	dgAssert (m_rootNode->IsPersistentRoot());
 	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
-	ImproveFitness(m_staticFitness, m_staticEntropy, &root->m_right);
+	ImproveFitness(m_staticFitness, m_staticEntropy, &m_staticRoot);
+	ImproveFitness(m_sleepingFitness, m_sleepingEntropy, &m_sleepingRoot);
+	LinkInactiveRoots();
 	ImproveFitness(m_dynamicsFitness, m_dynamicsEntropy, &root->m_left);
 	root->SetBox ();
 }
 
 void dgBroadPhasePersistent::UpdateFitness()
 {
+	UpdateSleepingTree();
+
+	// the static and the sleeping tree are only improved after they change
 	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
-	if (m_staticNeedsUpdate) {
-		m_staticNeedsUpdate = false;
-		ImproveFitness(m_staticFitness, m_staticEntropy, &root->m_right);
+	if (m_staticNeedsUpdate || m_sleepingNeedsUpdate) {
+		if (m_staticNeedsUpdate) {
+			m_staticNeedsUpdate = false;
+			ImproveFitness(m_staticFitness, m_staticEntropy, &m_staticRoot);
+		}
+		if (m_sleepingNeedsUpdate) {
+			m_sleepingNeedsUpdate = false;
+			ImproveFitness(m_sleepingFitness, m_sleepingEntropy, &m_sleepingRoot);
+		}
+		LinkInactiveRoots();
 	}
 	ImproveFitness(m_dynamicsFitness, m_dynamicsEntropy, &root->m_left);
 	root->SetBox ();
 }
 
-void dgBroadPhasePersistent::ForEachBodyInAABB(const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const
+void dgBroadPhasePersistent::UpdateSleepingTree()
+{
+	// a pair of sleeping bodies never makes a new contact, so the active leaves that fell 
+	// asleep move to the sleeping tree, where they are only found by the active leaves
+	dgList<dgBroadPhaseNode*>::dgListNode* next;
+	for (dgList<dgBroadPhaseNode*>::dgListNode* ptr = m_updateList.GetFirst(); ptr; ptr = next) {
+		next = ptr->GetNext();
+		dgBroadPhaseNode* const node = ptr->GetInfo();
+		dgBody* const body = node->GetBody();
+		if (body && body->m_sleeping && body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
+			MoveToSleepingTree((dgBroadPhaseBodyNode*)node);
+		}
+	}
+
+	// the bodies that woke up are all in the world active list, and so are the kinematic 
+	// bodies, which collide with resting bodies, the bodies they touch are woken as well
+	const dgInt32 count = m_world->m_activeBodiesCount;
+	dgBody** const bodies = count ? &m_world->m_activeBodies[0] : NULL;
+	for (dgInt32 i = 0; (i < count) && m_sleepingRoot; i ++) {
+		dgBody* const body = bodies[i];
+		dgBroadPhaseBodyNode* const node = body->GetBroadPhase();
+		if (node && !body->GetBroadPhaseAggregate()) {
+			if (body->IsRTTIType(dgBody::m_kinematicBodyRTTI)) {
+				if (body->IsCollidable()) {
+					WakeSleepingBodies(body->m_minAABB, body->m_maxAABB);
+				}
+			} else if (!body->m_sleeping && !node->m_updateNode && (GetTreeRoot(node) == m_sleepingRoot)) {
+				MoveToActiveTree(node);
+			}
+		}
+	}
+}
+
+void dgBroadPhasePersistent::MoveToSleepingTree(dgBroadPhaseBodyNode* const node)
+{
+	dgBody* const body = node->GetBody();
+	m_updateList.Remove(node->m_updateNode);
+	node->m_updateNode = NULL;
+	DetachNode(node);
+
+	m_sleepingNeedsUpdate = true;
+	node->SetAsDirty(0);
+	node->SetAABB(body->m_minAABB, body->m_maxAABB);
+	AddInactiveNode(&m_sleepingRoot, m_sleepingFitness, node);
+}
+
+void dgBroadPhasePersistent::MoveToActiveTree(dgBroadPhaseBodyNode* const node)
+{
+	dgBody* const body = node->GetBody();
+	dgAssert (!node->m_updateNode);
+	DetachNode(node);
+
+	// the woken leaf is dirty, so it is also scanned when only the dirty leaves look for pairs
+	node->SetAsDirty(m_lru + 1);
+	node->SetAABB(body->m_minAABB, body->m_maxAABB);
+	m_dirtyNodesCount ++;
+	AddActiveNode(node);
+	node->m_updateNode = m_updateList.Append(node);
+}
+
+dgInt32 dgApi dgBroadPhasePersistent::CollectSleepingBody(dgBody* const body, void* const userData)
+{
+	dgBroadPhasePersistent* const me = (dgBroadPhasePersistent*)userData;
+	me->m_wakeBodies[me->m_wakeBodiesCount] = body;
+	me->m_wakeBodiesCount ++;
+	return 1;
+}
+
+void dgBroadPhasePersistent::WakeSleepingBodies(const dgVector& minBox, const dgVector& maxBox)
 {
-	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
 	const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+	stackPool[0] = m_sleepingRoot;
+	m_wakeBodiesCount = 0;
+	dgBroadPhase::ForEachBodyInAABB(stackPool, 1, minBox, maxBox, CollectSleepingBody, this);
+	for (dgInt32 i = 0; i < m_wakeBodiesCount; i ++) {
+		MoveToActiveTree(m_wakeBodies[i]->GetBroadPhase());
+	}
+}
 
-	dgInt32 stack = 0;
-	if (root->m_left) {
-		stackPool[stack] = root->m_left;
-		stack++;
+dgInt32 dgBroadPhasePersistent::GetFlatRoots(dgInt32* const roots) const
+{
+	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
+	dgInt32 count = 0;
+	if (root->m_left && root->m_right) {
+		roots[0] = 1;
+		roots[1] = m_flatNodes[0].GetRight();
+		count = 2;
+	} else if (root->m_left || root->m_right) {
+		roots[0] = 0;
+		count = 1;
 	}
+	return count;
+}
 
-	if (root->m_right) {
-		stackPool[stack] = root->m_right;
-		stack++;
+void dgBroadPhasePersistent::ForEachBodyInAABB(const dgVector& minBox, const dgVector& maxBox, OnBodiesInAABB callback, void* const userData) const
+{
+	dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
+	if (m_flatNodesValid) {
+		dgInt32 stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+		dgInt32 stack = GetFlatRoots(stackPool);
+		dgBroadPhase::FlatForEachBodyInAABB(stackPool, stack, minBox, maxBox, callback, userData);
+	} else {
+		const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+
+		dgInt32 stack = 0;
+		if (root->m_left) {
+			stackPool[stack] = root->m_left;
+			stack++;
+		}
+
+		if (root->m_right) {
+			stackPool[stack] = root->m_right;
+			stack++;
+		}
+		dgBroadPhase::ForEachBodyInAABB(stackPool, stack, minBox, maxBox, callback, userData);
 	}
-	dgBroadPhase::ForEachBodyInAABB(stackPool, stack, minBox, maxBox, callback, userData);
 }
 
 void dgBroadPhasePersistent::RayCast(const dgVector& l0, const dgVector& l1, OnRayCastAction filter, OnRayPrecastAction prefilter, void* const userData) const
@@ -393,6 +539,7 @@ void dgBroadPhasePersistent::RayCast(const dgVector& l0, const dgVector& l1, OnR
 
 			dgFloat32 distance[DG_BROADPHASE_MAX_STACK_DEPTH];
 			const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+			dgInt32 flatStackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
 
 			dgFastRayTest ray(l0, l1);
 
@@ -407,14 +554,24 @@ void dgBroadPhasePersistent::RayCast(const dgVector& l0, const dgVector& l1, OnR
 				distance[stack] = ray.BoxIntersect(root->m_right->m_minBox, root->m_right->m_maxBox);
 				stack++;
 			}
+			if (m_flatNodesValid) {
+				GetFlatRoots(flatStackPool);
+			}
 			if (stack == 2) {
 				if (distance[0] < distance[1]) {
 					dgSwap(distance[0], distance[1]);
 					dgSwap(stackPool[0], stackPool[1]);
+					if (m_flatNodesValid) {
+						dgSwap(flatStackPool[0], flatStackPool[1]);
+					}
 				}
 			}
 
-			dgBroadPhase::RayCast(stackPool, distance, stack, l0, l1, ray, filter, prefilter, userData);
+			if (m_flatNodesValid) {
+				dgBroadPhase::FlatRayCast(flatStackPool, distance, stack, l0, l1, ray, filter, prefilter, userData);
+			} else {
+				dgBroadPhase::RayCast(stackPool, distance, stack, l0, l1, ray, filter, prefilter, userData);
+			}
 		}
 	}
 }
@@ -430,6 +587,7 @@ dgInt32 dgBroadPhasePersistent::ConvexCast(dgCollisionInstance* const shape, con
 
 		dgFloat32 distance[DG_BROADPHASE_MAX_STACK_DEPTH];
 		const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+		dgInt32 flatStackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
 
 		dgVector velocA((target - matrix.m_posit) & dgVector::m_triplexMask);
 		dgVector velocB(dgFloat32(0.0f));
@@ -452,15 +610,25 @@ dgInt32 dgBroadPhasePersistent::ConvexCast(dgCollisionInstance* const shape, con
 			distance[stack] = ray.BoxIntersect(minBox, maxBox);
 			stack++;
 		}
+		if (m_flatNodesValid) {
+			GetFlatRoots(flatStackPool);
+		}
 		if (stack == 2) {
 			if (distance[0] < distance[1]) {
 				dgSwap(distance[0], distance[1]);
 				dgSwap(stackPool[0], stackPool[1]);
+				if (m_flatNodesValid) {
+					dgSwap(flatStackPool[0], flatStackPool[1]);
+				}
 			}
 		}
 
 		*param = dgFloat32 (1.0f);
-		totalCount = dgBroadPhase::ConvexCast(stackPool, distance, 2, velocA, velocB, ray, shape, matrix, target, param, prefilter, userData, info, maxContacts, threadIndex);
+		if (m_flatNodesValid) {
+			totalCount = dgBroadPhase::FlatConvexCast(flatStackPool, distance, stack, velocA, velocB, ray, shape, matrix, target, param, prefilter, userData, info, maxContacts, threadIndex);
+		} else {
+			totalCount = dgBroadPhase::ConvexCast(stackPool, distance, stack, velocA, velocB, ray, shape, matrix, target, param, prefilter, userData, info, maxContacts, threadIndex);
+		}
 	}
 	return totalCount;
 }
@@ -476,6 +644,7 @@ dgInt32 dgBroadPhasePersistent::Collide(dgCollisionInstance* const shape, const
 
 		dgInt32 overlaped[DG_BROADPHASE_MAX_STACK_DEPTH];
 		const dgBroadPhaseNode* stackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
+		dgInt32 flatStackPool[DG_BROADPHASE_MAX_STACK_DEPTH];
 
 		dgInt32 stack = 0;
 		dgBroadPhasePesistanceRootNode* const root = (dgBroadPhasePesistanceRootNode*)m_rootNode;
@@ -485,12 +654,17 @@ dgInt32 dgBroadPhasePersistent::Collide(dgCollisionInstance* const shape, const
 				overlaped[stack] = dgOverlapTest(root->m_left->m_minBox, root->m_left->m_maxBox, boxP0, boxP1);
 				stack ++;
 			}
-			if (root->m_left) {
+			if (root->m_right) {
 				stackPool[stack] = root->m_right;
 				overlaped[stack] = dgOverlapTest(root->m_right->m_minBox, root->m_right->m_maxBox, boxP0, boxP1);
 				stack++;
 			}
-			totalCount = dgBroadPhase::Collide(stackPool, overlaped, 1, boxP0, boxP1, shape, matrix, prefilter, userData, info, maxContacts, threadIndex);
+			if (m_flatNodesValid) {
+				GetFlatRoots(flatStackPool);
+				totalCount = dgBroadPhase::FlatCollide(flatStackPool, overlaped, stack, boxP0, boxP1, shape, matrix, prefilter, userData, info, maxContacts, threadIndex);
+			} else {
+				totalCount = dgBroadPhase::Collide(stackPool, overlaped, stack, boxP0, boxP1, shape, matrix, prefilter, userData, info, maxContacts, threadIndex);
+			}
 		}
 	}
 
@@ -517,7 +691,7 @@ void dgBroadPhasePersistent::FindCollidingPairsForward (dgBroadphaseSyncDescript
 			dgAssert(!parent->IsLeafNode());
 			dgBroadPhaseNode* const sibling = parent->m_right;
 			if (sibling && (sibling != ptr)) {
-				SubmitPairs(broadPhaseNode, sibling, timestep, 0, threadID);
+				SubmitPairs(broadPhaseNode, GetFlatRight(parent), timestep, 0, threadID);
 			}
 		}
 
@@ -551,11 +725,11 @@ void dgBroadPhasePersistent::FindCollidingPairsForwardAndBackward (dgBroadphaseS
 				dgAssert(!parent->IsLeafNode());
 				dgBroadPhaseNode* const rightSibling = parent->m_right;
 				if (rightSibling && (rightSibling != ptr)) {
-					SubmitPairs(broadPhaseNode, rightSibling, timestep, threadCount, threadID);
+					SubmitPairs(broadPhaseNode, GetFlatRight(parent), timestep, threadCount, threadID);
 				}
 				dgBroadPhaseNode* const leftSibling = parent->m_left;
 				if (leftSibling && (leftSibling != ptr)) {
-					SubmitPairs(broadPhaseNode, leftSibling, timestep, threadCount, threadID);
+					SubmitPairs(broadPhaseNode, GetFlatLeft(parent), timestep, threadCount, threadID);
 				}
 			}
 		}
@@ -26,6 +26,11 @@
 #include "dgBroadPhase.h"
 
 
+// the dynamic bodies are split in two trees, the active tree and the sleeping tree. Only the 
+// leaves of the active tree are in the update list, so a resting body is not refitted, rotated 
+// or tested for new pairs, its pairs with the active bodies are found from the active side. 
+// The root has the active tree on the left and the inactive trees on the right, when both the 
+// sleeping and the static tree are present they are joined under the inactive root node.
 class dgBroadPhasePersistent: public dgBroadPhase
 {
 	public:
@@ -56,11 +61,32 @@ class dgBroadPhasePersistent: public dgBroadPhase
 	virtual dgInt32 ConvexCast(dgCollisionInstance* const shape, const dgMatrix& matrix, const dgVector& target, dgFloat32* const param, OnRayPrecastAction prefilter, void* const userData, dgConvexCastReturnInfo* const info, dgInt32 maxContacts, dgInt32 threadIndex) const;
 
 	void RemoveNode(dgBroadPhaseNode* const node);
+	void DetachNode(dgBroadPhaseNode* const node);
+	dgInt32 GetFlatRoots(dgInt32* const roots) const;
+
+	void AddActiveNode(dgBroadPhaseNode* const node);
+	void AddInactiveNode(dgBroadPhaseNode** const root, dgFitnessList& fitness, dgBroadPhaseNode* const node);
+	void LinkInactiveRoots();
+	dgBroadPhaseNode* GetTreeRoot(dgBroadPhaseNode* const node) const;
+
+	void UpdateSleepingTree();
+	void MoveToSleepingTree(dgBroadPhaseBodyNode* const node);
+	void MoveToActiveTree(dgBroadPhaseBodyNode* const node);
+	void WakeSleepingBodies(const dgVector& minBox, const dgVector& maxBox);
+	static dgInt32 dgApi CollectSleepingBody(dgBody* const body, void* const userData);
 
 	dgFloat64 m_staticEntropy;
+	dgFloat64 m_sleepingEntropy;
 	dgFloat64 m_dynamicsEntropy;
 	dgFitnessList m_staticFitness;
+	dgFitnessList m_sleepingFitness;
 	dgFitnessList m_dynamicsFitness;
+	dgArray<dgBody*> m_wakeBodies;
+	dgBroadPhaseTreeNode* m_inactiveRoot;
+	dgBroadPhaseNode* m_sleepingRoot;
+	dgBroadPhaseNode* m_staticRoot;
+	dgInt32 m_wakeBodiesCount;
 	bool m_staticNeedsUpdate;
+	bool m_sleepingNeedsUpdate;
 };
 #endif
@@ -0,0 +1,74 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgBroadPhaseAggregate.h"
+#include "dgBroadPhaseProxyList.h"
+
+
+dgBroadPhaseProxyList::dgBroadPhaseProxyList(dgWorld* const world)
+	:dgBroadPhaseDefault(world)
+	,m_proxiesCount(0)
+	,m_proxiesValid(false)
+{
+}
+
+dgBroadPhaseProxyList::~dgBroadPhaseProxyList()
+{
+}
+
+void dgBroadPhaseProxyList::Add(dgBody* const body)
+{
+	m_proxiesValid = false;
+	dgBroadPhaseDefault::Add(body);
+}
+
+void dgBroadPhaseProxyList::Remove(dgBody* const body)
+{
+	m_proxiesValid = false;
+	dgBroadPhaseDefault::Remove(body);
+}
+
+bool dgBroadPhaseProxyList::SearchPairsInTree() const
+{
+	return false;
+}
+
+void dgBroadPhaseProxyList::DestroyAggregate(dgBroadPhaseAggregate* const aggregate)
+{
+	m_proxiesValid = false;
+	dgBroadPhaseDefault::DestroyAggregate(aggregate);
+}
+
+void dgBroadPhaseProxyList::LinkAggregate(dgBroadPhaseAggregate* const aggregate)
+{
+	m_proxiesValid = false;
+	dgBroadPhaseDefault::LinkAggregate(aggregate);
+}
+
+void dgBroadPhaseProxyList::UnlinkAggregate(dgBroadPhaseAggregate* const aggregate)
+{
+	m_proxiesValid = false;
+	dgBroadPhaseDefault::UnlinkAggregate(aggregate);
+}
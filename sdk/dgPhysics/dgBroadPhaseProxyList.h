@@ -0,0 +1,53 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+
+#ifndef __AFX_BROADPHASE_PROXY_LIST_H_
+#define __AFX_BROADPHASE_PROXY_LIST_H_
+
+#include "dgPhysicsStdafx.h"
+#include "dgBroadPhaseDefault.h"
+
+// base of the broad phases that find the colliding pairs from a flat array of proxies built from the 
+// leaves of the update list, bodies and aggregates, instead of searching the tree. Adding or removing 
+// any of them invalidates the proxies. The tree is not rotated or flattened, only its boxes are 
+// refitted because the ray casts, convex casts and the aggregates still walk it.
+class dgBroadPhaseProxyList: public dgBroadPhaseDefault
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator);
+
+	dgBroadPhaseProxyList(dgWorld* const world);
+	virtual ~dgBroadPhaseProxyList();
+
+	protected:
+	virtual void Add(dgBody* const body);
+	virtual void Remove(dgBody* const body);
+	virtual bool SearchPairsInTree() const;
+	virtual void DestroyAggregate(dgBroadPhaseAggregate* const aggregate);
+	virtual void LinkAggregate (dgBroadPhaseAggregate* const aggregate);
+	virtual void UnlinkAggregate (dgBroadPhaseAggregate* const aggregate);
+
+	dgInt32 m_proxiesCount;
+	bool m_proxiesValid;
+};
+
+#endif
@@ -0,0 +1,457 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgBroadPhaseAggregate.h"
+#include "dgBroadPhaseSpatialHash.h"
+
+#define DG_SPATIAL_HASH_CHUNK_SIZE			32
+#define DG_SPATIAL_HASH_BLOCK_SIZE			256
+#define DG_SPATIAL_HASH_LEVEL_SCALE			dgFloat32 (4.0f)
+#define DG_SPATIAL_HASH_CELL_SCALE			dgFloat32 (2.0f)
+#define DG_SPATIAL_HASH_MIN_EXTENT			dgFloat32 (1.0e-2f)
+#define DG_SPATIAL_HASH_INDEX_BITS			20
+#define DG_SPATIAL_HASH_INDEX_MASK			((1<<DG_SPATIAL_HASH_INDEX_BITS) - 1)
+
+
+dgBroadPhaseSpatialHash::dgBroadPhaseSpatialHash(dgWorld* const world)
+	:dgBroadPhaseProxyList(world)
+	,m_proxies(world->GetAllocator())
+	,m_blocks(world->GetAllocator())
+	,m_cellRuns(world->GetAllocator())
+	,m_oversized(world->GetAllocator())
+	,m_sortedCells(NULL)
+	,m_blocksCount(0)
+	,m_cellsCount(0)
+	,m_cellRunsCount(0)
+	,m_oversizedCount(0)
+	,m_workIndex(0)
+{
+	m_cells[0].SetAllocator(world->GetAllocator());
+	m_cells[1].SetAllocator(world->GetAllocator());
+	for (dgInt32 i = 0; i < DG_SPATIAL_HASH_LEVELS; i ++) {
+		m_cellSize[i] = dgFloat32 (1.0f);
+		m_invCellSize[i] = dgFloat32 (1.0f);
+		m_levelCount[i] = 0;
+	}
+}
+
+dgBroadPhaseSpatialHash::~dgBroadPhaseSpatialHash()
+{
+}
+
+dgInt32 dgBroadPhaseSpatialHash::GetType() const
+{
+	return dgWorld::m_spatialHashBroadphase;
+}
+
+void dgBroadPhaseSpatialHash::UpdateFitness()
+{
+	BuildGrid();
+}
+
+dgInt32 dgBroadPhaseSpatialHash::CompareCells(const dgHashCell* const cellA, const dgHashCell* const cellB, void* const context)
+{
+	if (cellA->m_key < cellB->m_key) {
+		return -1;
+	} else if (cellA->m_key > cellB->m_key) {
+		return 1;
+	}
+	return cellA->m_proxy - cellB->m_proxy;
+}
+
+DG_INLINE void dgBroadPhaseSpatialHash::GetCellRange(const dgHashProxy& proxy, dgInt32 level, dgVector& minIndex, dgVector& maxIndex) const
+{
+	const dgVector invCellSize(m_invCellSize[level]);
+	minIndex = (proxy.m_minBox * invCellSize).GetInt();
+	maxIndex = (proxy.m_maxBox * invCellSize).GetInt();
+}
+
+DG_INLINE dgUnsigned64 dgBroadPhaseSpatialHash::GetCellKey(dgInt32 level, dgInt32 x, dgInt32 y, dgInt32 z) const
+{
+	// the cell indices wrap around, two far away cells can share a key, but a leaf never spans
+	// more than two cells per axis so it never touches the same key twice
+	return (dgUnsigned64 (level) << (3 * DG_SPATIAL_HASH_INDEX_BITS)) |
+		   (dgUnsigned64 (x & DG_SPATIAL_HASH_INDEX_MASK) << (2 * DG_SPATIAL_HASH_INDEX_BITS)) |
+		   (dgUnsigned64 (y & DG_SPATIAL_HASH_INDEX_MASK) << DG_SPATIAL_HASH_INDEX_BITS) |
+		    dgUnsigned64 (z & DG_SPATIAL_HASH_INDEX_MASK);
+}
+
+DG_INLINE bool dgBroadPhaseSpatialHash::IsHomeCell(const dgHashProxy& proxy0, const dgHashProxy& proxy1, dgInt32 level, dgUnsigned64 key) const
+{
+	// two overlapping leaves share all the cells that contain the min corner of their intersection,
+	// the pair is only reported by the cell that contains that corner
+	const dgVector invCellSize(m_invCellSize[level]);
+	const dgVector index((proxy0.m_minBox.GetMax(proxy1.m_minBox) * invCellSize).GetInt());
+	return GetCellKey(level, index.m_ix, index.m_iy, index.m_iz) == key;
+}
+
+void dgBroadPhaseSpatialHash::BuildGrid()
+{
+	// a leaf was added or removed, the proxies and their blocks are rebuilt
+	if (!m_proxiesValid) {
+		m_proxiesCount = m_updateList.GetCount();
+		m_blocksCount = (m_proxiesCount + DG_SPATIAL_HASH_BLOCK_SIZE - 1) / DG_SPATIAL_HASH_BLOCK_SIZE;
+		m_proxies.ResizeIfNecessary(m_proxiesCount + 1);
+		m_oversized.ResizeIfNecessary(m_proxiesCount + 1);
+		m_blocks.ResizeIfNecessary(m_blocksCount + 1);
+
+		dgInt32 index = 0;
+		for (dgList<dgBroadPhaseNode*>::dgListNode* node = m_updateList.GetFirst(); node; node = node->GetNext()) {
+			m_proxies[index].m_node = node->GetInfo();
+			index ++;
+		}
+		m_proxiesValid = true;
+	}
+
+	m_workIndex = 0;
+	m_cellsCount = 0;
+	m_cellRunsCount = 0;
+	m_oversizedCount = 0;
+	for (dgInt32 i = 0; i < DG_SPATIAL_HASH_LEVELS; i ++) {
+		m_levelCount[i] = 0;
+	}
+	if (!m_proxiesCount) {
+		return;
+	}
+
+	// the finest cells are a little larger than the typical leaf, the geometric mean
+	// of the leaves sizes is not dragged up by a few very large leaves like the ground
+	BroadPhaseFor((dgBroadPhaseKernel::dgKernel)&dgBroadPhaseSpatialHash::UpdateProxiesKernel, NULL, 0, m_blocksCount, 1);
+
+	dgFloat32 logSum = dgFloat32 (0.0f);
+	dgHashBlock* const blocks = &m_blocks[0];
+	for (dgInt32 i = 0; i < m_blocksCount; i ++) {
+		logSum += blocks[i].m_logSum;
+	}
+
+	dgFloat32 cellSize = DG_SPATIAL_HASH_CELL_SCALE * dgPow(dgFloat32 (2.718281828f), logSum / m_proxiesCount);
+	for (dgInt32 i = 0; i < DG_SPATIAL_HASH_LEVELS; i ++) {
+		m_cellSize[i] = cellSize;
+		m_invCellSize[i] = dgFloat32 (1.0f) / cellSize;
+		cellSize *= DG_SPATIAL_HASH_LEVEL_SCALE;
+	}
+
+	BroadPhaseFor((dgBroadPhaseKernel::dgKernel)&dgBroadPhaseSpatialHash::AssignLevelsKernel, NULL, 0, m_blocksCount, 1);
+
+	// only the blocks are scanned here, each proxy already has its offset inside its block
+	dgInt32 cellsCount = 0;
+	for (dgInt32 i = 0; i < m_blocksCount; i ++) {
+		dgHashBlock& block = blocks[i];
+		block.m_firstCell = cellsCount;
+		block.m_firstOversized = m_oversizedCount;
+		cellsCount += block.m_cellsCount;
+		m_oversizedCount += block.m_oversizedCount;
+		for (dgInt32 j = 0; j < DG_SPATIAL_HASH_LEVELS; j ++) {
+			m_levelCount[j] += block.m_levelCount[j];
+		}
+	}
+	blocks[m_blocksCount].m_firstCell = cellsCount;
+	m_cellsCount = cellsCount;
+	m_cells[0].ResizeIfNecessary(cellsCount + 1);
+	m_cells[1].ResizeIfNecessary(cellsCount + 1);
+
+	BroadPhaseFor((dgBroadPhaseKernel::dgKernel)&dgBroadPhaseSpatialHash::InsertCellsKernel, NULL, 0, m_blocksCount, 1);
+
+	// sorting the cells by key puts all the leaves in the same cell next to each other, the sorted
+	// blocks are merged in pairs, each pass doubles the length of the sorted runs
+	dgHashMergePass pass;
+	pass.m_src = &m_cells[0][0];
+	pass.m_dst = &m_cells[1][0];
+	for (pass.m_width = 1; pass.m_width < m_blocksCount; pass.m_width *= 2) {
+		const dgInt32 pairsCount = (m_blocksCount + 2 * pass.m_width - 1) / (2 * pass.m_width);
+		BroadPhaseFor((dgBroadPhaseKernel::dgKernel)&dgBroadPhaseSpatialHash::MergeCellsKernel, &pass, 0, pairsCount, 1);
+		dgSwap(pass.m_src, pass.m_dst);
+	}
+	m_sortedCells = pass.m_src;
+
+	m_cellRuns.ResizeIfNecessary(cellsCount + 1);
+	dgHashCellRun* const runs = &m_cellRuns[0];
+	const dgHashCell* const cells = m_sortedCells;
+	for (dgInt32 i = 0; i < cellsCount; ) {
+		dgInt32 j = i + 1;
+		for (; (j < cellsCount) && (cells[j].m_key == cells[i].m_key); j ++);
+		runs[m_cellRunsCount].m_key = cells[i].m_key;
+		runs[m_cellRunsCount].m_start = i;
+		runs[m_cellRunsCount].m_count = j - i;
+		m_cellRunsCount ++;
+		i = j;
+	}
+}
+
+void dgBroadPhaseSpatialHash::UpdateProxiesKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	const dgUnsigned32 lru = m_lru + 1;
+	dgHashProxy* const proxies = &m_proxies[0];
+	for (dgInt32 i = start; i < end; i ++) {
+		const dgInt32 first = i * DG_SPATIAL_HASH_BLOCK_SIZE;
+		const dgInt32 last = dgMin(first + DG_SPATIAL_HASH_BLOCK_SIZE, m_proxiesCount);
+
+		dgFloat32 logSum = dgFloat32 (0.0f);
+		for (dgInt32 j = first; j < last; j ++) {
+			dgHashProxy& proxy = proxies[j];
+			const dgBroadPhaseNode* const node = proxy.m_node;
+			proxy.m_minBox = node->m_minBox;
+			proxy.m_maxBox = node->m_maxBox;
+			proxy.m_isDirty = (node->GetDirtyLru() == lru) ? 1 : 0;
+
+			const dgVector size(node->m_maxBox - node->m_minBox);
+			logSum += dgLog(dgMax(dgMax(size.m_x, size.m_y, size.m_z), DG_SPATIAL_HASH_MIN_EXTENT));
+		}
+		m_blocks[i].m_logSum = logSum;
+	}
+}
+
+void dgBroadPhaseSpatialHash::AssignLevelsKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	// a leaf goes to the finest level with cells at least as large as the leaf, so it touches at most two cells per axis
+	dgHashProxy* const proxies = &m_proxies[0];
+	for (dgInt32 i = start; i < end; i ++) {
+		dgHashBlock& block = m_blocks[i];
+		block.m_cellsCount = 0;
+		block.m_oversizedCount = 0;
+		for (dgInt32 level = 0; level < DG_SPATIAL_HASH_LEVELS; level ++) {
+			block.m_levelCount[level] = 0;
+		}
+
+		const dgInt32 first = i * DG_SPATIAL_HASH_BLOCK_SIZE;
+		const dgInt32 last = dgMin(first + DG_SPATIAL_HASH_BLOCK_SIZE, m_proxiesCount);
+		for (dgInt32 j = first; j < last; j ++) {
+			dgHashProxy& proxy = proxies[j];
+			const dgVector size(proxy.m_maxBox - proxy.m_minBox);
+			const dgFloat32 extent = dgMax(size.m_x, size.m_y, size.m_z);
+
+			proxy.m_level = -1;
+			proxy.m_firstCell = block.m_cellsCount;
+			for (dgInt32 level = 0; level < DG_SPATIAL_HASH_LEVELS; level ++) {
+				if (extent <= m_cellSize[level]) {
+					dgVector minIndex;
+					dgVector maxIndex;
+					GetCellRange(proxy, level, minIndex, maxIndex);
+					const dgInt32 count = (maxIndex.m_ix - minIndex.m_ix + 1) * (maxIndex.m_iy - minIndex.m_iy + 1) * (maxIndex.m_iz - minIndex.m_iz + 1);
+					dgAssert(count <= 8);
+					proxy.m_level = level;
+					block.m_cellsCount += count;
+					block.m_levelCount[level] ++;
+					break;
+				}
+			}
+			if (proxy.m_level < 0) {
+				block.m_oversizedCount ++;
+			}
+		}
+	}
+}
+
+void dgBroadPhaseSpatialHash::InsertCellsKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	dgHashCell* const cells = &m_cells[0][0];
+	dgInt32* const oversized = &m_oversized[0];
+	dgHashProxy* const proxies = &m_proxies[0];
+	for (dgInt32 i = start; i < end; i ++) {
+		const dgHashBlock& block = m_blocks[i];
+		const dgInt32 first = i * DG_SPATIAL_HASH_BLOCK_SIZE;
+		const dgInt32 last = dgMin(first + DG_SPATIAL_HASH_BLOCK_SIZE, m_proxiesCount);
+		dgInt32 oversizedIndex = block.m_firstOversized;
+		for (dgInt32 j = first; j < last; j ++) {
+			dgHashProxy& proxy = proxies[j];
+			proxy.m_firstCell += block.m_firstCell;
+			if (proxy.m_level >= 0) {
+				dgVector minIndex;
+				dgVector maxIndex;
+				GetCellRange(proxy, proxy.m_level, minIndex, maxIndex);
+
+				dgInt32 index = proxy.m_firstCell;
+				for (dgInt32 x = minIndex.m_ix; x <= maxIndex.m_ix; x ++) {
+					for (dgInt32 y = minIndex.m_iy; y <= maxIndex.m_iy; y ++) {
+						for (dgInt32 z = minIndex.m_iz; z <= maxIndex.m_iz; z ++) {
+							cells[index].m_key = GetCellKey(proxy.m_level, x, y, z);
+							cells[index].m_proxy = j;
+							index ++;
+						}
+					}
+				}
+			} else {
+				oversized[oversizedIndex] = j;
+				oversizedIndex ++;
+			}
+		}
+		dgSort(&cells[block.m_firstCell], block.m_cellsCount, CompareCells);
+	}
+}
+
+void dgBroadPhaseSpatialHash::MergeCellsKernel(void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID)
+{
+	const dgHashMergePass* const pass = (dgHashMergePass*)context;
+	const dgHashCell* const src = pass->m_src;
+	dgHashCell* const dst = pass->m_dst;
+	const dgHashBlock* const blocks = &m_blocks[0];
+	for (dgInt32 i = start; i < end; i ++) {
+		const dgInt32 block0 = i * 2 * pass->m_width;
+		const dgInt32 block1 = dgMin(block0 + pass->m_width, m_blocksCount);
+		const dgInt32 block2 = dgMin(block1 + pass->m_width, m_blocksCount);
+
+		dgInt32 i0 = blocks[block0].m_firstCell;
+		dgInt32 i1 = blocks[block1].m_firstCell;
+		const dgInt32 end0 = i1;
+		const dgInt32 end1 = blocks[block2].m_firstCell;
+		dgInt32 index = i0;
+		while ((i0 < end0) && (i1 < end1)) {
+			if (CompareCells(&src[i1], &src[i0], NULL) < 0) {
+				dst[index] = src[i1];
+				i1 ++;
+			} else {
+				dst[index] = src[i0];
+				i0 ++;
+			}
+			index ++;
+		}
+		for (; i0 < end0; i0 ++) {
+			dst[index] = src[i0];
+			index ++;
+		}
+		for (; i1 < end1; i1 ++) {
+			dst[index] = src[i1];
+			index ++;
+		}
+	}
+}
+
+const dgBroadPhaseSpatialHash::dgHashCellRun* dgBroadPhaseSpatialHash::FindCell(dgUnsigned64 key) const
+{
+	const dgHashCellRun* const runs = &m_cellRuns[0];
+	dgInt32 i0 = 0;
+	dgInt32 i1 = m_cellRunsCount - 1;
+	while (i0 <= i1) {
+		const dgInt32 mid = (i0 + i1) >> 1;
+		if (runs[mid].m_key < key) {
+			i0 = mid + 1;
+		} else if (runs[mid].m_key > key) {
+			i1 = mid - 1;
+		} else {
+			return &runs[mid];
+		}
+	}
+	return NULL;
+}
+
+void dgBroadPhaseSpatialHash::FindCellPairs(const dgHashCellRun& run, dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID)
+{
+	// all the leaves of a cell are in the same level
+	const dgHashCell* const cells = &m_sortedCells[run.m_start];
+	const dgHashProxy* const proxies = &m_proxies[0];
+	const dgInt32 level = dgInt32 (run.m_key >> (3 * DG_SPATIAL_HASH_INDEX_BITS));
+	for (dgInt32 i = 0; i < run.m_count; i ++) {
+		const dgHashProxy& proxy0 = proxies[cells[i].m_proxy];
+		for (dgInt32 j = i + 1; j < run.m_count; j ++) {
+			const dgHashProxy& proxy1 = proxies[cells[j].m_proxy];
+			if ((proxy0.m_isDirty | proxy1.m_isDirty) || !dirtyPairsOnly) {
+				if (dgOverlapTest(proxy0.m_minBox, proxy0.m_maxBox, proxy1.m_minBox, proxy1.m_maxBox) && IsHomeCell(proxy0, proxy1, level, run.m_key)) {
+					SubmitLeafPair(proxy0.m_node, proxy1.m_node, timestep, threadID);
+				}
+			}
+		}
+	}
+}
+
+void dgBroadPhaseSpatialHash::FindProxyPairs(dgInt32 proxyIndex, dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID)
+{
+	const dgHashProxy* const proxies = &m_proxies[0];
+	const dgHashProxy& proxy0 = proxies[proxyIndex];
+	if (proxy0.m_node->IsAggregate() && (proxy0.m_isDirty || !dirtyPairsOnly)) {
+		((dgBroadPhaseAggregate*)proxy0.m_node)->SubmitSeltPairs(timestep, threadID);
+	}
+
+	if (proxy0.m_level >= 0) {
+		// a leaf looks for the leaves of coarser levels in the cells it overlaps on those levels,
+		// the leaves of the same level are found by the cells themselves
+		const dgHashCell* const cells = m_sortedCells;
+		for (dgInt32 level = proxy0.m_level + 1; level < DG_SPATIAL_HASH_LEVELS; level ++) {
+			if (m_levelCount[level]) {
+				dgVector minIndex;
+				dgVector maxIndex;
+				GetCellRange(proxy0, level, minIndex, maxIndex);
+				for (dgInt32 x = minIndex.m_ix; x <= maxIndex.m_ix; x ++) {
+					for (dgInt32 y = minIndex.m_iy; y <= maxIndex.m_iy; y ++) {
+						for (dgInt32 z = minIndex.m_iz; z <= maxIndex.m_iz; z ++) {
+							const dgUnsigned64 key = GetCellKey(level, x, y, z);
+							const dgHashCellRun* const run = FindCell(key);
+							if (run) {
+								for (dgInt32 i = 0; i < run->m_count; i ++) {
+									const dgHashProxy& proxy1 = proxies[cells[run->m_start + i].m_proxy];
+									if ((proxy0.m_isDirty | proxy1.m_isDirty) || !dirtyPairsOnly) {
+										if (dgOverlapTest(proxy0.m_minBox, proxy0.m_maxBox, proxy1.m_minBox, proxy1.m_maxBox) && IsHomeCell(proxy0, proxy1, level, key)) {
+											SubmitLeafPair(proxy0.m_node, proxy1.m_node, timestep, threadID);
+										}
+									}
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// leaves too large for the grid are tested against all others, and against each other only once
+	const dgInt32* const oversized = &m_oversized[0];
+	for (dgInt32 i = 0; i < m_oversizedCount; i ++) {
+		const dgInt32 index = oversized[i];
+		if ((proxy0.m_level >= 0) || (index > proxyIndex)) {
+			const dgHashProxy& proxy1 = proxies[index];
+			if ((proxy0.m_isDirty | proxy1.m_isDirty) || !dirtyPairsOnly) {
+				if (dgOverlapTest(proxy0.m_minBox, proxy0.m_maxBox, proxy1.m_minBox, proxy1.m_maxBox)) {
+					SubmitLeafPair(proxy0.m_node, proxy1.m_node, timestep, threadID);
+				}
+			}
+		}
+	}
+}
+
+void dgBroadPhaseSpatialHash::FindPairs(dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID)
+{
+	// all jobs pull chunks of work until it is consumed, first the cells and then the leaves
+	const dgInt32 count = m_cellRunsCount + m_proxiesCount;
+	const dgHashCellRun* const runs = &m_cellRuns[0];
+	for (dgInt32 start = dgAtomicExchangeAndAdd(&m_workIndex, DG_SPATIAL_HASH_CHUNK_SIZE); start < count; start = dgAtomicExchangeAndAdd(&m_workIndex, DG_SPATIAL_HASH_CHUNK_SIZE)) {
+		const dgInt32 end = dgMin(start + DG_SPATIAL_HASH_CHUNK_SIZE, count);
+		for (dgInt32 i = start; i < end; i ++) {
+			if (i < m_cellRunsCount) {
+				FindCellPairs(runs[i], timestep, dirtyPairsOnly, threadID);
+			} else {
+				FindProxyPairs(i - m_cellRunsCount, timestep, dirtyPairsOnly, threadID);
+			}
+		}
+	}
+}
+
+void dgBroadPhaseSpatialHash::FindCollidingPairsForward(dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID)
+{
+	FindPairs(descriptor->m_timestep, false, threadID);
+}
+
+void dgBroadPhaseSpatialHash::FindCollidingPairsForwardAndBackward(dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID)
+{
+	// few leaves moved, only the pairs with at least one moving leaf can change
+	FindPairs(descriptor->m_timestep, true, threadID);
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __AFX_BROADPHASE_SPATIAL_HASH_H_
+#define __AFX_BROADPHASE_SPATIAL_HASH_H_
+
+#include "dgPhysicsStdafx.h"
+#include "dgBroadPhaseProxyList.h"
+
+#define DG_SPATIAL_HASH_LEVELS		4
+
+// finds the colliding pairs with a multi level grid of hashed cells, each leaf goes to the finest
+// level with cells larger than the leaf, so it touches at most eight cells, and leaves too large
+// for the coarsest level are tested against all others. The grid is rebuilt every update from the
+// leaves of the update list, the proxies are split in blocks that count, insert and sort their
+// cells in parallel, and the sorted blocks are merged pairwise.
+class dgBroadPhaseSpatialHash: public dgBroadPhaseProxyList
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator);
+
+	dgBroadPhaseSpatialHash(dgWorld* const world);
+	virtual ~dgBroadPhaseSpatialHash();
+
+	protected:
+	DG_MSC_VECTOR_ALIGMENT
+	class dgHashProxy
+	{
+		public:
+		dgVector m_minBox;
+		dgVector m_maxBox;
+		dgBroadPhaseNode* m_node;
+		dgInt32 m_level;
+		dgInt32 m_firstCell;
+		dgInt32 m_isDirty;
+	} DG_GCC_VECTOR_ALIGMENT;
+
+	class dgHashCell
+	{
+		public:
+		dgUnsigned64 m_key;
+		dgInt32 m_proxy;
+	};
+
+	class dgHashCellRun
+	{
+		public:
+		dgUnsigned64 m_key;
+		dgInt32 m_start;
+		dgInt32 m_count;
+	};
+
+	class dgHashBlock
+	{
+		public:
+		dgFloat32 m_logSum;
+		dgInt32 m_firstCell;
+		dgInt32 m_cellsCount;
+		dgInt32 m_firstOversized;
+		dgInt32 m_oversizedCount;
+		dgInt32 m_levelCount[DG_SPATIAL_HASH_LEVELS];
+	};
+
+	class dgHashMergePass
+	{
+		public:
+		dgHashCell* m_src;
+		dgHashCell* m_dst;
+		dgInt32 m_width;
+	};
+
+	virtual dgInt32 GetType() const;
+	virtual void UpdateFitness();
+	virtual void FindCollidingPairsForward (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID);
+	virtual void FindCollidingPairsForwardAndBackward (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID);
+
+	void BuildGrid();
+	void UpdateProxiesKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void AssignLevelsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void InsertCellsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void MergeCellsKernel (void* const context, dgInt32 start, dgInt32 end, dgInt32 threadID);
+	void FindPairs (dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID);
+	void FindCellPairs (const dgHashCellRun& run, dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID);
+	void FindProxyPairs (dgInt32 proxyIndex, dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID);
+	const dgHashCellRun* FindCell (dgUnsigned64 key) const;
+
+	DG_INLINE void GetCellRange (const dgHashProxy& proxy, dgInt32 level, dgVector& minIndex, dgVector& maxIndex) const;
+	DG_INLINE dgUnsigned64 GetCellKey (dgInt32 level, dgInt32 x, dgInt32 y, dgInt32 z) const;
+	DG_INLINE bool IsHomeCell (const dgHashProxy& proxy0, const dgHashProxy& proxy1, dgInt32 level, dgUnsigned64 key) const;
+	static dgInt32 CompareCells (const dgHashCell* const cellA, const dgHashCell* const cellB, void* const context);
+
+	dgArray<dgHashProxy> m_proxies;
+	dgArray<dgHashBlock> m_blocks;
+	dgArray<dgHashCell> m_cells[2];
+	dgArray<dgHashCellRun> m_cellRuns;
+	dgArray<dgInt32> m_oversized;
+	dgHashCell* m_sortedCells;
+	dgFloat32 m_cellSize[DG_SPATIAL_HASH_LEVELS];
+	dgFloat32 m_invCellSize[DG_SPATIAL_HASH_LEVELS];
+	dgInt32 m_levelCount[DG_SPATIAL_HASH_LEVELS];
+	dgInt32 m_blocksCount;
+	dgInt32 m_cellsCount;
+	dgInt32 m_cellRunsCount;
+	dgInt32 m_oversizedCount;
+	dgInt32 m_workIndex;
+};
+
+#endif
@@ -0,0 +1,193 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgBroadPhaseAggregate.h"
+#include "dgBroadPhaseSweepAndPrune.h"
+
+#define DG_SWEEP_AND_PRUNE_CHUNK_SIZE		32
+#define DG_SWEEP_AND_PRUNE_MAX_SWAP_FACTOR	8
+
+
+dgBroadPhaseSweepAndPrune::dgBroadPhaseSweepAndPrune(dgWorld* const world)
+	:dgBroadPhaseProxyList(world)
+	,m_proxies(world->GetAllocator())
+	,m_sweepAxis(0)
+	,m_sweepIndex(0)
+{
+	for (dgInt32 i = 0; i < 3; i ++) {
+		m_endPoints[i].SetAllocator(world->GetAllocator());
+		m_axisIsSorted[i] = false;
+	}
+}
+
+dgBroadPhaseSweepAndPrune::~dgBroadPhaseSweepAndPrune()
+{
+}
+
+dgInt32 dgBroadPhaseSweepAndPrune::GetType() const
+{
+	return dgWorld::m_sweepAndPruneBroadphase;
+}
+
+void dgBroadPhaseSweepAndPrune::UpdateFitness()
+{
+	UpdateProxies();
+}
+
+dgInt32 dgBroadPhaseSweepAndPrune::CompareEndPoints(const dgSweepEndPoint* const pointA, const dgSweepEndPoint* const pointB, void* const context)
+{
+	if (pointA->m_min < pointB->m_min) {
+		return -1;
+	} else if (pointA->m_min > pointB->m_min) {
+		return 1;
+	}
+	return 0;
+}
+
+void dgBroadPhaseSweepAndPrune::UpdateProxies()
+{
+	// a leaf was added or removed, the end points are rebuilt along with the proxies
+	if (!m_proxiesValid) {
+		m_proxiesCount = m_updateList.GetCount();
+		m_proxies.ResizeIfNecessary(m_proxiesCount + 1);
+		for (dgInt32 i = 0; i < 3; i ++) {
+			m_endPoints[i].ResizeIfNecessary(m_proxiesCount + 1);
+			m_axisIsSorted[i] = false;
+		}
+
+		dgInt32 index = 0;
+		for (dgList<dgBroadPhaseNode*>::dgListNode* node = m_updateList.GetFirst(); node; node = node->GetNext()) {
+			m_proxies[index].m_node = node->GetInfo();
+			for (dgInt32 i = 0; i < 3; i ++) {
+				m_endPoints[i][index].m_proxy = index;
+			}
+			index ++;
+		}
+		m_proxiesValid = true;
+	}
+
+	// pick the axis with the largest spread of the leaves centers, that is the one with the fewest overlaps
+	const dgUnsigned32 lru = m_lru + 1;
+	dgVector sum(dgFloat32(0.0f));
+	dgVector sum2(dgFloat32(0.0f));
+	dgSweepProxy* const proxies = &m_proxies[0];
+	for (dgInt32 i = 0; i < m_proxiesCount; i ++) {
+		dgSweepProxy& proxy = proxies[i];
+		const dgBroadPhaseNode* const node = proxy.m_node;
+		proxy.m_minBox = node->m_minBox;
+		proxy.m_maxBox = node->m_maxBox;
+		proxy.m_isDirty = (node->GetDirtyLru() == lru) ? 1 : 0;
+
+		const dgVector center((node->m_minBox + node->m_maxBox) * dgVector::m_half);
+		sum += center;
+		sum2 += center * center;
+	}
+
+	if (m_proxiesCount) {
+		const dgVector den(dgFloat32(1.0f) / m_proxiesCount);
+		const dgVector mean(sum * den);
+		const dgVector variance(sum2 * den - mean * mean);
+		m_sweepAxis = 0;
+		if (variance.m_y > variance[m_sweepAxis]) {
+			m_sweepAxis = 1;
+		}
+		if (variance.m_z > variance[m_sweepAxis]) {
+			m_sweepAxis = 2;
+		}
+		SortAxis(m_sweepAxis);
+	}
+	m_sweepIndex = 0;
+}
+
+void dgBroadPhaseSweepAndPrune::SortAxis(dgInt32 axis)
+{
+	dgSweepEndPoint* const endPoints = &m_endPoints[axis][0];
+	const dgSweepProxy* const proxies = &m_proxies[0];
+	for (dgInt32 i = 0; i < m_proxiesCount; i ++) {
+		dgSweepEndPoint& point = endPoints[i];
+		point.m_min = proxies[point.m_proxy].m_minBox[axis];
+		point.m_max = proxies[point.m_proxy].m_maxBox[axis];
+	}
+
+	// the order of the last update is almost right when the motion is coherent, an insertion sort fixes it
+	// in linear time, but an axis that was not swept for a while can be far off and is sorted from scratch
+	bool isSorted = m_axisIsSorted[axis];
+	if (isSorted) {
+		dgInt32 swapsBudget = m_proxiesCount * DG_SWEEP_AND_PRUNE_MAX_SWAP_FACTOR;
+		for (dgInt32 i = 1; (i < m_proxiesCount) && isSorted; i ++) {
+			const dgSweepEndPoint point(endPoints[i]);
+			dgInt32 j = i - 1;
+			for (; (j >= 0) && (endPoints[j].m_min > point.m_min); j --) {
+				endPoints[j + 1] = endPoints[j];
+			}
+			endPoints[j + 1] = point;
+			swapsBudget -= i - 1 - j;
+			isSorted = (swapsBudget >= 0);
+		}
+	}
+
+	if (!isSorted) {
+		dgSort(endPoints, m_proxiesCount, CompareEndPoints);
+	}
+	m_axisIsSorted[axis] = true;
+}
+
+void dgBroadPhaseSweepAndPrune::SweepPairs(dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID)
+{
+	// all jobs pull chunks of the sorted end points until the axis is consumed, each leaf is
+	// tested against the leaves that start before it ends, so each pair is found only once
+	const dgInt32 count = m_proxiesCount;
+	const dgSweepProxy* const proxies = &m_proxies[0];
+	const dgSweepEndPoint* const endPoints = &m_endPoints[m_sweepAxis][0];
+	for (dgInt32 start = dgAtomicExchangeAndAdd(&m_sweepIndex, DG_SWEEP_AND_PRUNE_CHUNK_SIZE); start < count; start = dgAtomicExchangeAndAdd(&m_sweepIndex, DG_SWEEP_AND_PRUNE_CHUNK_SIZE)) {
+		const dgInt32 end = dgMin(start + DG_SWEEP_AND_PRUNE_CHUNK_SIZE, count);
+		for (dgInt32 i = start; i < end; i ++) {
+			const dgSweepEndPoint& point = endPoints[i];
+			const dgSweepProxy& proxy0 = proxies[point.m_proxy];
+			if (proxy0.m_node->IsAggregate() && (proxy0.m_isDirty || !dirtyPairsOnly)) {
+				((dgBroadPhaseAggregate*)proxy0.m_node)->SubmitSeltPairs(timestep, threadID);
+			}
+
+			for (dgInt32 j = i + 1; (j < count) && (endPoints[j].m_min <= point.m_max); j ++) {
+				const dgSweepProxy& proxy1 = proxies[endPoints[j].m_proxy];
+				if ((proxy0.m_isDirty | proxy1.m_isDirty) || !dirtyPairsOnly) {
+					if (dgOverlapTest(proxy0.m_minBox, proxy0.m_maxBox, proxy1.m_minBox, proxy1.m_maxBox)) {
+						SubmitLeafPair(proxy0.m_node, proxy1.m_node, timestep, threadID);
+					}
+				}
+			}
+		}
+	}
+}
+
+void dgBroadPhaseSweepAndPrune::FindCollidingPairsForward(dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID)
+{
+	SweepPairs(descriptor->m_timestep, false, threadID);
+}
+
+void dgBroadPhaseSweepAndPrune::FindCollidingPairsForwardAndBackward(dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID)
+{
+	// few leaves moved, only the pairs with at least one moving leaf can change
+	SweepPairs(descriptor->m_timestep, true, threadID);
+}
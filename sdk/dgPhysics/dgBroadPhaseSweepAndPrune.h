@@ -0,0 +1,77 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __AFX_BROADPHASE_SWEEP_AND_PRUNE_H_
+#define __AFX_BROADPHASE_SWEEP_AND_PRUNE_H_
+
+#include "dgPhysicsStdafx.h"
+#include "dgBroadPhaseProxyList.h"
+
+// finds the colliding pairs by sweeping the leaves along the axis with the largest spread,
+// only that axis is sorted each update, each axis keeps the order of the last time it was swept
+// so that coherent motion only costs a few swaps.
+// experimental: the single axis sweep tests more pairs than the default tree and is slower than 
+// the default broadphase on every benchmark scene, vehicles included, it is not recommended.
+class dgBroadPhaseSweepAndPrune: public dgBroadPhaseProxyList
+{
+	public:
+	DG_CLASS_ALLOCATOR(allocator);
+
+	dgBroadPhaseSweepAndPrune(dgWorld* const world);
+	virtual ~dgBroadPhaseSweepAndPrune();
+
+	protected:
+	DG_MSC_VECTOR_ALIGMENT
+	class dgSweepProxy
+	{
+		public:
+		dgVector m_minBox;
+		dgVector m_maxBox;
+		dgBroadPhaseNode* m_node;
+		dgInt32 m_isDirty;
+	} DG_GCC_VECTOR_ALIGMENT;
+
+	class dgSweepEndPoint
+	{
+		public:
+		dgFloat32 m_min;
+		dgFloat32 m_max;
+		dgInt32 m_proxy;
+	};
+
+	virtual dgInt32 GetType() const;
+	virtual void UpdateFitness();
+	virtual void FindCollidingPairsForward (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID);
+	virtual void FindCollidingPairsForwardAndBackward (dgBroadphaseSyncDescriptor* const descriptor, dgList<dgBroadPhaseNode*>::dgListNode* const node, dgInt32 threadID);
+
+	void UpdateProxies();
+	void SortAxis (dgInt32 axis);
+	void SweepPairs (dgFloat32 timestep, bool dirtyPairsOnly, dgInt32 threadID);
+	static dgInt32 CompareEndPoints (const dgSweepEndPoint* const pointA, const dgSweepEndPoint* const pointB, void* const context);
+
+	dgArray<dgSweepProxy> m_proxies;
+	dgArray<dgSweepEndPoint> m_endPoints[3];
+	dgInt32 m_sweepAxis;
+	dgInt32 m_sweepIndex;
+	bool m_axisIsSorted[3];
+};
+
+#endif
@@ -67,6 +67,7 @@ enum dgCollisionID
 	m_userMesh,
 	m_sceneCollision,
 	m_compoundFracturedCollision,
+	m_tiledHeightField,
 
 	// these are for internal use only	
 	m_contactCloud,
@@ -169,6 +170,23 @@ class dgCollisionInfo
 		
 	};
 
+	struct dgTiledHeightMapCollisionData
+	{
+		dgInt32 m_width;
+		dgInt32 m_height;
+		dgInt32 m_tileSize;
+		dgInt32 m_gridsDiagonals;
+		dgInt32 m_elevationDataType;		// 0 = 32 bit floats, 1 = unsigned 16 bit intergers
+		dgInt32 m_maxResidentTiles;
+		dgInt32 m_residentTileCount;
+		dgFloat32 m_verticalScale;
+		dgFloat32 m_horizonalScale_x;
+		dgFloat32 m_horizonalScale_z;
+		dgFloat32 m_minElevation;
+		dgFloat32 m_maxElevation;
+		void* m_pageUserData;
+	};
+
 	struct dgSceneData
 	{
 		dgInt32 m_childrenProxyCount;
@@ -191,6 +209,7 @@ class dgCollisionInfo
 		dgCoumpountCollisionData m_compoundCollision;
 		dgCollisionBVHData m_bvhCollision;
 		dgHeightMapCollisionData m_heightFieldCollision;
+		dgTiledHeightMapCollisionData m_tiledHeightFieldCollision;
 		dgSceneData m_sceneCollision;
 		dgFloat32 m_paramArray[32];
 	};
@@ -228,6 +247,7 @@ class dgCollision
 		dgCollisionHeightField_RTTI					= 1<<19,
 		dgCollisionScene_RTTI						= 1<<20,
 		dgCollisionCompoundBreakable_RTTI			= 1<<21,
+		dgCollisionTiledHeightField_RTTI			= 1<<22,
 	};													 
 	
 	DG_CLASS_ALLOCATOR(allocator)
@@ -330,9 +350,10 @@ DG_INLINE const dgCollision* dgCollision::AddRef () const
 
 DG_INLINE dgInt32 dgCollision::Release () const
 {
-	dgAtomicExchangeAndAdd (&m_refCount, -1);
-	if (m_refCount) {
-		return m_refCount;
+	// use the value returned by the decrement, two threads releasing at the same time must not both see zero
+	const dgInt32 count = dgAtomicExchangeAndAdd (&m_refCount, -1) - 1;
+	if (count) {
+		return count;
 	}
 	delete this;
 	return 0;
@@ -27,6 +27,7 @@
 #include "dgCollisionInstance.h"
 #include "dgCollisionUserMesh.h"
 #include "dgCollisionHeightField.h"
+#include "dgCollisionTiledHeightField.h"
 
 
 //////////////////////////////////////////////////////////////////////
@@ -1539,7 +1540,7 @@ dgInt32 dgCollisionCompound::CalculateContacts (dgBroadPhase::dgPair* const pair
 				contactCount = CalculateContactsToCompoundContinue (pair, proxy);
 			} else if (body1->m_collision->IsType (dgCollision::dgCollisionBVH_RTTI)) {
 				contactCount = CalculateContactsToCollisionTreeContinue (pair, proxy);
-			} else if (body1->m_collision->IsType (dgCollision::dgCollisionHeightField_RTTI)) {
+			} else if (body1->m_collision->IsType (dgCollision::dgCollisionHeightField_RTTI) || body1->m_collision->IsType (dgCollision::dgCollisionTiledHeightField_RTTI)) {
 				dgAssert (0);
 //				contactCount = CalculateContactsToHeightField (pair, proxy);
 			} else {
@@ -1555,7 +1556,7 @@ dgInt32 dgCollisionCompound::CalculateContacts (dgBroadPhase::dgPair* const pair
 				contactCount = CalculateContactsToCompound (pair, proxy);
 			} else if (body1->m_collision->IsType (dgCollision::dgCollisionBVH_RTTI)) {
 				contactCount = CalculateContactsToCollisionTree (pair, proxy);
-			} else if (body1->m_collision->IsType (dgCollision::dgCollisionHeightField_RTTI)) {
+			} else if (body1->m_collision->IsType (dgCollision::dgCollisionHeightField_RTTI) || body1->m_collision->IsType (dgCollision::dgCollisionTiledHeightField_RTTI)) {
 				contactCount = CalculateContactsToHeightField (pair, proxy);
 			} else {
 				dgAssert (body1->m_collision->IsType (dgCollision::dgCollisionUserMesh_RTTI));
@@ -1919,8 +1920,10 @@ dgInt32 dgCollisionCompound::CalculateContactsToHeightField (dgBroadPhase::dgPai
 	dgCollisionInstance* const terrainInstance = terrainBody->m_collision;
 
 	dgAssert (compoundInstance->GetChildShape() == this);
-	dgAssert (terrainInstance->IsType (dgCollision::dgCollisionHeightField_RTTI));
-	dgCollisionHeightField* const terrainCollision = (dgCollisionHeightField*)terrainInstance->GetChildShape();
+	dgAssert (terrainInstance->IsType (dgCollision::dgCollisionHeightField_RTTI) || terrainInstance->IsType (dgCollision::dgCollisionTiledHeightField_RTTI));
+	const bool isTiled = terrainInstance->IsType (dgCollision::dgCollisionTiledHeightField_RTTI) ? true : false;
+	dgCollisionHeightField* const terrainCollision = isTiled ? NULL : (dgCollisionHeightField*)terrainInstance->GetChildShape();
+	dgCollisionTiledHeightField* const tiledTerrainCollision = isTiled ? (dgCollisionTiledHeightField*)terrainInstance->GetChildShape() : NULL;
 
 	proxy.m_body0 = myBody;
 	proxy.m_body1 = terrainBody;
@@ -1948,7 +1951,11 @@ dgInt32 dgCollisionCompound::CalculateContactsToHeightField (dgBroadPhase::dgPai
 		dgVector size (data.m_absMatrix.UnrotateVector(me->m_size));
 		dgVector p0 (origin - size);
 		dgVector p1 (origin + size);
-		terrainCollision->GetLocalAABB (p0, p1, nodeProxi.m_p0, nodeProxi.m_p1);
+		if (isTiled) {
+			tiledTerrainCollision->GetLocalAABB (p0, p1, nodeProxi.m_p0, nodeProxi.m_p1);
+		} else {
+			terrainCollision->GetLocalAABB (p0, p1, nodeProxi.m_p0, nodeProxi.m_p1);
+		}
 		//nodeProxi.m_size = (nodeProxi.m_p1 - nodeProxi.m_p0).Scale3 (dgFloat32 (0.5f));
 		//nodeProxi.m_origin = (nodeProxi.m_p1 + nodeProxi.m_p0).Scale3 (dgFloat32 (0.5f));
 		nodeProxi.m_size = dgVector::m_half * (nodeProxi.m_p1 - nodeProxi.m_p0);
@@ -29,6 +29,7 @@
 
 dgVector dgCollisionHeightField::m_yMask (0xffffffff, 0, 0xffffffff, 0);
 dgVector dgCollisionHeightField::m_padding (dgFloat32 (0.25f), dgFloat32 (0.25f), dgFloat32 (0.25f), dgFloat32 (0.0f));
+dgVector dgCollisionHeightField::m_blockPadding (dgFloat32 (1.0e-3f), dgFloat32 (1.0e-3f), dgFloat32 (1.0e-3f), dgFloat32 (0.0f));
 dgVector dgCollisionHeightField::m_elevationPadding (dgFloat32 (0.0f), dgFloat32 (1.0e10f), dgFloat32 (0.0f), dgFloat32 (0.0f));
 
 dgInt32 dgCollisionHeightField::m_cellIndices[][4] =
@@ -59,10 +60,12 @@ dgCollisionHeightField::dgCollisionHeightField(
 	const void* const elevationMap, dgElevationType elevationDataType, dgFloat32 verticalScale, 
 	const dgInt8* const atributeMap, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z)
 	:dgCollisionMesh (world, m_heightField)
+	,m_origin(dgFloat32 (0.0f))
 	,m_width(width)
 	,m_height(height)
 	,m_diagonalMode (dgCollisionHeightFieldGridConstruction  (dgClamp (contructionMode, dgInt32 (m_normalDiagonals), dgInt32 (m_starInvertexDiagonals))))
 	,m_horizontalDisplacement(NULL)
+	,m_elevationPyramid(NULL)
 	,m_verticalScale(verticalScale)
 	,m_horizontalScale_x(horizontalScale_x)
 	,m_horizontalScaleInv_x (dgFloat32 (1.0f) / m_horizontalScale_x)
@@ -230,25 +233,11 @@ dgCollisionHeightField::dgCollisionHeightField(
 	}
 	memcpy (m_atributeMap, atributeMap, m_width * m_height * sizeof (dgInt8));
 
-	dgTree<void*, unsigned>::dgTreeNode* nodeData = world->m_perInstanceData.Find(DG_HIGHTFIELD_DATA_ID);
-	if (!nodeData) {
-		m_instanceData = (dgPerIntanceData*) new dgPerIntanceData();
-		m_instanceData->m_refCount = 0;
-		m_instanceData->m_world = world;
-		for (dgInt32 i = 0 ; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
-			m_instanceData->m_vertex[i] = NULL;
-			m_instanceData->m_vertexCount[i] = 0;
-			m_instanceData->m_vertex[i].SetAllocator(world->GetAllocator());
-			AllocateVertex(world, i);
-		}
-		nodeData = world->m_perInstanceData.Insert (m_instanceData, DG_HIGHTFIELD_DATA_ID);
-	}
-	m_instanceData = (dgPerIntanceData*) nodeData->GetInfo();
-
-	m_instanceData->m_refCount ++;
+	m_instanceData = AddInstanceDataRef (world);
 
+	BuildElevationPyramid();
 	CalculateAABB();
-	SetCollisionBBox(m_minBox, m_maxBox);
+	SetCollisionBBox(m_minBox + m_origin, m_maxBox + m_origin);
 }
 
 dgCollisionHeightField::dgCollisionHeightField (dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber)
@@ -258,8 +247,10 @@ dgCollisionHeightField::dgCollisionHeightField (dgWorld* const world, dgDeserial
 	
 	dgInt32 elevationDataType;
 
+	m_origin = dgVector (dgFloat32 (0.0f));
 	m_userRayCastCallback = NULL;
 	m_horizontalDisplacement = NULL;
+	m_elevationPyramid = NULL;
 	deserialization (userData, &m_width, sizeof (dgInt32));
 	deserialization (userData, &m_height, sizeof (dgInt32));
 	deserialization (userData, &m_diagonalMode, sizeof (dgInt32));
@@ -307,36 +298,18 @@ dgCollisionHeightField::dgCollisionHeightField (dgWorld* const world, dgDeserial
 	m_horizontalScaleInv_x = dgFloat32 (1.0f) / m_horizontalScale_x;
 	m_horizontalScaleInv_z = dgFloat32 (1.0f) / m_horizontalScale_z;
 
-	dgTree<void*, unsigned>::dgTreeNode* nodeData = world->m_perInstanceData.Find(DG_HIGHTFIELD_DATA_ID);
-	if (!nodeData) {
-		m_instanceData = (dgPerIntanceData*) new dgPerIntanceData();
-		m_instanceData->m_refCount = 0;
-		m_instanceData->m_world = world;
-		for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i++) {
-			m_instanceData->m_vertex[i] = NULL;
-			m_instanceData->m_vertexCount[i] = 0;
-			m_instanceData->m_vertex[i].SetAllocator(world->GetAllocator());
-			AllocateVertex(world, i);
-		}
-		nodeData = world->m_perInstanceData.Insert(m_instanceData, DG_HIGHTFIELD_DATA_ID);
-	}
-	m_instanceData = (dgPerIntanceData*)nodeData->GetInfo();
-
-	m_instanceData->m_refCount ++;
-	SetCollisionBBox(m_minBox, m_maxBox);
+	m_instanceData = AddInstanceDataRef (world);
+	BuildElevationPyramid();
+	SetCollisionBBox(m_minBox + m_origin, m_maxBox + m_origin);
 }
 
 dgCollisionHeightField::~dgCollisionHeightField(void)
 {
-	m_instanceData->m_refCount --;
-	if (!m_instanceData->m_refCount) {
-		dgWorld* const world = m_instanceData->m_world;
-		delete m_instanceData;
-		world->m_perInstanceData.Remove(DG_HIGHTFIELD_DATA_ID);
-	}
+	ReleaseInstanceDataRef (m_instanceData);
 	dgFreeStack(m_elevationMap);
 	dgFreeStack(m_atributeMap);
 	dgFreeStack(m_diagonals);
+	dgFreeStack(m_elevationPyramid);
 
 	if (m_horizontalDisplacement) {
 		dgFreeStack(m_horizontalDisplacement);
@@ -411,6 +384,37 @@ void dgCollisionHeightField::AllocateVertex(dgWorld* const world, dgInt32 thread
 	m_instanceData->m_vertexCount[threadIndex] = m_instanceData->m_vertex[threadIndex].GetElementsCapacity();
 }
 
+// the per world vertex buffers are shared by all height fields, the tiles of a tiled height field 
+// are created and destroyed by the worker threads, so the reference count is updated atomically
+dgCollisionHeightField::dgPerIntanceData* dgCollisionHeightField::AddInstanceDataRef (dgWorld* const world)
+{
+	dgTree<void*, unsigned>::dgTreeNode* nodeData = world->m_perInstanceData.Find(DG_HIGHTFIELD_DATA_ID);
+	if (!nodeData) {
+		dgPerIntanceData* const instanceData = new dgPerIntanceData();
+		instanceData->m_refCount = 0;
+		instanceData->m_world = world;
+		for (dgInt32 i = 0 ; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
+			instanceData->m_vertex[i] = NULL;
+			instanceData->m_vertex[i].SetAllocator(world->GetAllocator());
+			instanceData->m_vertex[i].Resize (instanceData->m_vertex[i].GetElementsCapacity() * 2);
+			instanceData->m_vertexCount[i] = instanceData->m_vertex[i].GetElementsCapacity();
+		}
+		nodeData = world->m_perInstanceData.Insert (instanceData, DG_HIGHTFIELD_DATA_ID);
+	}
+	dgPerIntanceData* const instanceData = (dgPerIntanceData*) nodeData->GetInfo();
+	dgAtomicExchangeAndAdd (&instanceData->m_refCount, 1);
+	return instanceData;
+}
+
+void dgCollisionHeightField::ReleaseInstanceDataRef (dgPerIntanceData* const instanceData)
+{
+	if (dgAtomicExchangeAndAdd (&instanceData->m_refCount, -1) == 1) {
+		dgWorld* const world = instanceData->m_world;
+		delete instanceData;
+		world->m_perInstanceData.Remove(DG_HIGHTFIELD_DATA_ID);
+	}
+}
+
 
 
 DG_INLINE void dgCollisionHeightField::CalculateMinExtend2d(const dgVector& p0, const dgVector& p1, dgVector& boxP0, dgVector& boxP1) const
@@ -465,32 +469,137 @@ DG_INLINE void dgCollisionHeightField::CalculateMinExtend3d(const dgVector& p0,
 
 void dgCollisionHeightField::CalculateAABB()
 {
-	dgFloat32 y0 = dgFloat32 (dgFloat32 (1.0e10f));
-	dgFloat32 y1 = dgFloat32 (-dgFloat32 (1.0e10f));
-	switch (m_elevationDataType) 
-	{
-		case m_float32Bit:
-		{
-			const dgFloat32* const elevation = (dgFloat32*)m_elevationMap;
-			for (dgInt32 i = 0; i < m_width * m_height; i ++) {
-				y0 = dgMin(y0, elevation[i]);
-				y1 = dgMax(y1, elevation[i]);
-			}
+	const dgElevationRange& root = m_elevationPyramid[m_pyramidStart[m_pyramidLevels - 1]];
+	dgFloat32 y0 = root.m_minHeight;
+	dgFloat32 y1 = root.m_maxHeight;
+
+	m_minBox = dgVector (dgFloat32 (dgFloat32 (0.0f)),                  y0 * m_verticalScale, dgFloat32 (dgFloat32 (0.0f)),               dgFloat32 (0.0f)); 
+	m_maxBox = dgVector (dgFloat32 (m_width - 1) * m_horizontalScale_x, y1 * m_verticalScale, dgFloat32 (m_height-1) * m_horizontalScale_z, dgFloat32 (0.0f)); 
+}
+
+void dgCollisionHeightField::BuildElevationPyramid()
+{
+	dgInt32 width = dgMax ((m_width - 1 + DG_HEIGHTFIELD_PYRAMID_BLOCK - 1) / DG_HEIGHTFIELD_PYRAMID_BLOCK, 1);
+	dgInt32 height = dgMax ((m_height - 1 + DG_HEIGHTFIELD_PYRAMID_BLOCK - 1) / DG_HEIGHTFIELD_PYRAMID_BLOCK, 1);
+
+	dgInt32 count = 0;
+	m_pyramidLevels = 0;
+	do {
+		dgAssert (m_pyramidLevels < DG_HEIGHTFIELD_PYRAMID_MAX_LEVELS);
+		m_pyramidWidth[m_pyramidLevels] = width;
+		m_pyramidHeight[m_pyramidLevels] = height;
+		m_pyramidStart[m_pyramidLevels] = count;
+		m_pyramidLevels ++;
+		count += width * height;
+		if ((width == 1) && (height == 1)) {
 			break;
 		}
+		width = (width + 1) >> 1;
+		height = (height + 1) >> 1;
+	} while (true);
 
-		case m_unsigned16Bit:
-		{
-			const dgUnsigned16* const elevation = (dgUnsigned16*)m_elevationMap;
-			for (dgInt32 i = 0; i < m_width * m_height; i ++) {
-				y0 = dgMin(y0, dgFloat32 (elevation[i]));
-				y1 = dgMax(y1, dgFloat32 (elevation[i]));
+	m_elevationPyramid = (dgElevationRange*) dgMallocStack(count * sizeof (dgElevationRange));
+	UpdateElevationPyramid (0, m_width - 1, 0, m_height - 1);
+}
+
+void dgCollisionHeightField::UpdateElevationPyramid(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1)
+{
+	// a vertex on a block border belongs to the blocks at both sides
+	dgInt32 blockX0 = dgMax ((x0 - 1) / DG_HEIGHTFIELD_PYRAMID_BLOCK, 0);
+	dgInt32 blockZ0 = dgMax ((z0 - 1) / DG_HEIGHTFIELD_PYRAMID_BLOCK, 0);
+	dgInt32 blockX1 = dgMin (x1 / DG_HEIGHTFIELD_PYRAMID_BLOCK, m_pyramidWidth[0] - 1);
+	dgInt32 blockZ1 = dgMin (z1 / DG_HEIGHTFIELD_PYRAMID_BLOCK, m_pyramidHeight[0] - 1);
+
+	dgElevationRange* const level0 = &m_elevationPyramid[m_pyramidStart[0]];
+	for (dgInt32 z = blockZ0; z <= blockZ1; z ++) {
+		const dgInt32 cellZ0 = z * DG_HEIGHTFIELD_PYRAMID_BLOCK;
+		const dgInt32 cellZ1 = dgMin (cellZ0 + DG_HEIGHTFIELD_PYRAMID_BLOCK, m_height - 1);
+		for (dgInt32 x = blockX0; x <= blockX1; x ++) {
+			const dgInt32 cellX0 = x * DG_HEIGHTFIELD_PYRAMID_BLOCK;
+			const dgInt32 cellX1 = dgMin (cellX0 + DG_HEIGHTFIELD_PYRAMID_BLOCK, m_width - 1);
+			dgFloat32 minHeight = dgFloat32 (1.0e10f);
+			dgFloat32 maxHeight = dgFloat32 (-1.0e10f);
+			switch (m_elevationDataType) 
+			{
+				case m_float32Bit:
+				{
+					CalculateMinAndMaxElevation(cellX0, cellX1, cellZ0, cellZ1, (dgFloat32*)m_elevationMap, minHeight, maxHeight);
+					break;
+				}
+
+				case m_unsigned16Bit:
+				{
+					CalculateMinAndMaxElevation(cellX0, cellX1, cellZ0, cellZ1, (dgUnsigned16*)m_elevationMap, minHeight, maxHeight);
+					break;
+				}
 			}
+			dgElevationRange& block = level0[z * m_pyramidWidth[0] + x];
+			block.m_minHeight = minHeight;
+			block.m_maxHeight = maxHeight;
 		}
 	}
 
-	m_minBox = dgVector (dgFloat32 (dgFloat32 (0.0f)),                  y0 * m_verticalScale, dgFloat32 (dgFloat32 (0.0f)),               dgFloat32 (0.0f)); 
-	m_maxBox = dgVector (dgFloat32 (m_width - 1) * m_horizontalScale_x, y1 * m_verticalScale, dgFloat32 (m_height-1) * m_horizontalScale_z, dgFloat32 (0.0f)); 
+	for (dgInt32 level = 1; level < m_pyramidLevels; level ++) {
+		blockX0 >>= 1;
+		blockZ0 >>= 1;
+		blockX1 >>= 1;
+		blockZ1 >>= 1;
+		const dgInt32 childWidth = m_pyramidWidth[level - 1];
+		const dgInt32 childHeight = m_pyramidHeight[level - 1];
+		const dgElevationRange* const children = &m_elevationPyramid[m_pyramidStart[level - 1]];
+		dgElevationRange* const parents = &m_elevationPyramid[m_pyramidStart[level]];
+		for (dgInt32 z = blockZ0; z <= blockZ1; z ++) {
+			for (dgInt32 x = blockX0; x <= blockX1; x ++) {
+				dgFloat32 minHeight = dgFloat32 (1.0e10f);
+				dgFloat32 maxHeight = dgFloat32 (-1.0e10f);
+				for (dgInt32 j = z * 2; j < dgMin (z * 2 + 2, childHeight); j ++) {
+					for (dgInt32 i = x * 2; i < dgMin (x * 2 + 2, childWidth); i ++) {
+						const dgElevationRange& child = children[j * childWidth + i];
+						minHeight = dgMin (minHeight, child.m_minHeight);
+						maxHeight = dgMax (maxHeight, child.m_maxHeight);
+					}
+				}
+				dgElevationRange& block = parents[z * m_pyramidWidth[level] + x];
+				block.m_minHeight = minHeight;
+				block.m_maxHeight = maxHeight;
+			}
+		}
+	}
+}
+
+void dgCollisionHeightField::UpdateElevations (dgInt32 x0, dgInt32 z0, dgInt32 x1, dgInt32 z1)
+{
+	x0 = dgClamp (x0, dgInt32 (0), m_width - 1);
+	x1 = dgClamp (x1, dgInt32 (0), m_width - 1);
+	z0 = dgClamp (z0, dgInt32 (0), m_height - 1);
+	z1 = dgClamp (z1, dgInt32 (0), m_height - 1);
+	if ((x0 <= x1) && (z0 <= z1)) {
+		UpdateElevationPyramid (x0, x1, z0, z1);
+		CalculateAABB();
+		SetCollisionBBox(m_minBox + m_origin, m_maxBox + m_origin);
+	}
+}
+
+void dgCollisionHeightField::SetOrigin (const dgVector& origin)
+{
+	dgAssert (origin.m_y == dgFloat32 (0.0f));
+	dgAssert (origin.m_w == dgFloat32 (0.0f));
+	m_origin = origin;
+	SetCollisionBBox(m_minBox + m_origin, m_maxBox + m_origin);
+}
+
+DG_INLINE void dgCollisionHeightField::GetBlockBox (dgInt32 level, dgInt32 blockX, dgInt32 blockZ, dgVector& boxP0, dgVector& boxP1) const
+{
+	const dgInt32 cells = DG_HEIGHTFIELD_PYRAMID_BLOCK << level;
+	const dgInt32 x0 = blockX * cells;
+	const dgInt32 z0 = blockZ * cells;
+	const dgInt32 x1 = dgMin (x0 + cells, m_width - 1);
+	const dgInt32 z1 = dgMin (z0 + cells, m_height - 1);
+	const dgElevationRange& block = m_elevationPyramid[m_pyramidStart[level] + blockZ * m_pyramidWidth[level] + blockX];
+	const dgFloat32 y0 = block.m_minHeight * m_verticalScale;
+	const dgFloat32 y1 = block.m_maxHeight * m_verticalScale;
+	boxP0 = dgVector (x0 * m_horizontalScale_x, dgMin (y0, y1), z0 * m_horizontalScale_z, dgFloat32 (0.0f));
+	boxP1 = dgVector (x1 * m_horizontalScale_x, dgMax (y0, y1), z1 * m_horizontalScale_z, dgFloat32 (0.0f));
 }
 
 void dgCollisionHeightField::GetCollisionInfo(dgCollisionInfo* const info) const
@@ -610,79 +719,160 @@ dgFloat32 dgCollisionHeightField::RayCastCell (const dgFastRayTest& ray, dgInt32
 	return t;
 }
 
-dgFloat32 dgCollisionHeightField::RayCast (const dgVector& q0, const dgVector& q1, dgFloat32 maxT, dgContactPoint& contactOut, const dgBody* const body, void* const userData, OnRayPrecastAction preFilter) const
+dgFloat32 dgCollisionHeightField::RayCastBlock (const dgFastRayTest& ray, dgInt32 level, dgInt32 blockX, dgInt32 blockZ, dgFloat32 entryT, dgVector& normalOut, dgInt32& xIndexOut, dgInt32& zIndexOut, dgFloat32 maxT) const
 {
-	dgVector boxP0;
-	dgVector boxP1;
-
-	// calculate the ray bounding box
-	CalculateMinExtend2d (q0, q1, boxP0, boxP1);
-
-	dgVector p0 (q0);
-	dgVector p1 (q1);
-
-	// clip the line against the bounding box
-	if (dgRayBoxClip (p0, p1, boxP0, boxP1)) { 
-		dgVector dp (p1 - p0);
-		dgVector normalOut (dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+	dgFloat32 hitT = dgFloat32 (1.2f);
+	if (level) {
+		// visit the children in the order the ray enters them, skipping the ones the ray passes above or below
+		dgInt32 count = 0;
+		dgInt32 childX[4];
+		dgInt32 childZ[4];
+		dgFloat32 childT[4];
+		const dgInt32 childLevel = level - 1;
+		for (dgInt32 z = blockZ * 2; z < dgMin (blockZ * 2 + 2, m_pyramidHeight[childLevel]); z ++) {
+			for (dgInt32 x = blockX * 2; x < dgMin (blockX * 2 + 2, m_pyramidWidth[childLevel]); x ++) {
+				dgVector boxP0;
+				dgVector boxP1;
+				GetBlockBox (childLevel, x, z, boxP0, boxP1);
+				const dgFloat32 t = ray.BoxIntersect (boxP0 - m_blockPadding, boxP1 + m_blockPadding);
+				if (t < maxT) {
+					dgInt32 i = count;
+					for (; i && (childT[i - 1] > t); i --) {
+						childX[i] = childX[i - 1];
+						childZ[i] = childZ[i - 1];
+						childT[i] = childT[i - 1];
+					}
+					childX[i] = x;
+					childZ[i] = z;
+					childT[i] = t;
+					count ++;
+				}
+			}
+		}
 
-		dgFloat32 scale_x = m_horizontalScale_x;
-		dgFloat32 invScale_x = m_horizontalScaleInv_x;
-		dgFloat32 scale_z = m_horizontalScale_z;
-		dgFloat32 invScale_z = m_horizontalScaleInv_z;
-		dgInt32 ix0 = dgFastInt (p0.m_x * invScale_x);
-		dgInt32 iz0 = dgFastInt (p0.m_z * invScale_z);
+		// the padded boxes overlap a little, so a farther child can still have a closer hit
+		for (dgInt32 i = 0; (i < count) && (childT[i] < maxT); i ++) {
+			const dgFloat32 t = RayCastBlock (ray, childLevel, childX[i], childZ[i], childT[i], normalOut, xIndexOut, zIndexOut, maxT);
+			if (t < maxT) {
+				maxT = t;
+				hitT = t;
+			}
+		}
+	} else {
+		// walk the cells with a 2d dda from the point the ray enters the padded block to the point it leaves it
+		const dgVector& p0 = ray.m_p0;
+		const dgVector& dp = ray.m_diff;
+		const dgVector p (p0 + dp.Scale4 (entryT));
+		const dgFloat32 scale_x = m_horizontalScale_x;
+		const dgFloat32 scale_z = m_horizontalScale_z;
+		const dgFloat32 blockMin_x = dgFloat32 (blockX * DG_HEIGHTFIELD_PYRAMID_BLOCK) * scale_x - m_blockPadding.m_x;
+		const dgFloat32 blockMax_x = dgFloat32 ((blockX + 1) * DG_HEIGHTFIELD_PYRAMID_BLOCK) * scale_x + m_blockPadding.m_x;
+		const dgFloat32 blockMin_z = dgFloat32 (blockZ * DG_HEIGHTFIELD_PYRAMID_BLOCK) * scale_z - m_blockPadding.m_z;
+		const dgFloat32 blockMax_z = dgFloat32 ((blockZ + 1) * DG_HEIGHTFIELD_PYRAMID_BLOCK) * scale_z + m_blockPadding.m_z;
+		dgInt32 xIndex = dgFastInt (p.m_x * m_horizontalScaleInv_x);
+		dgInt32 zIndex = dgFastInt (p.m_z * m_horizontalScaleInv_z);
 
-		// implement a 3ddda line algorithm 
 		dgInt32 xInc;
 		dgFloat32 tx;
 		dgFloat32 stepX;
+		dgFloat32 exitX;
 		if (dp.m_x > dgFloat32 (0.0f)) {
 			xInc = 1;
 			dgFloat32 val = dgFloat32 (1.0f) / dp.m_x;
 			stepX = scale_x * val;
-			tx = (scale_x * (ix0 + dgFloat32 (1.0f)) - p0.m_x) * val;
+			tx = (scale_x * (xIndex + dgFloat32 (1.0f)) - p0.m_x) * val;
+			exitX = (blockMax_x - p0.m_x) * val;
 		} else if (dp.m_x < dgFloat32 (0.0f)) {
 			xInc = -1;
 			dgFloat32 val = -dgFloat32 (1.0f) / dp.m_x;
 			stepX = scale_x * val;
-			tx = -(scale_x * ix0 - p0.m_x) * val;
+			tx = -(scale_x * xIndex - p0.m_x) * val;
+			exitX = -(blockMin_x - p0.m_x) * val;
 		} else {
 			xInc = 0;
 			stepX = dgFloat32 (0.0f);
 			tx = dgFloat32 (1.0e10f);
+			exitX = dgFloat32 (1.0e10f);
 		}
 
 		dgInt32 zInc;
 		dgFloat32 tz;
 		dgFloat32 stepZ;
+		dgFloat32 exitZ;
 		if (dp.m_z > dgFloat32 (0.0f)) {
 			zInc = 1;
 			dgFloat32 val = dgFloat32 (1.0f) / dp.m_z;
 			stepZ = scale_z * val;
-			tz = (scale_z * (iz0 + dgFloat32 (1.0f)) - p0.m_z) * val;
+			tz = (scale_z * (zIndex + dgFloat32 (1.0f)) - p0.m_z) * val;
+			exitZ = (blockMax_z - p0.m_z) * val;
 		} else if (dp.m_z < dgFloat32 (0.0f)) {
 			zInc = -1;
 			dgFloat32 val = -dgFloat32 (1.0f) / dp.m_z;
 			stepZ = scale_z * val;
-			tz = -(scale_z * iz0 - p0.m_z) * val;
+			tz = -(scale_z * zIndex - p0.m_z) * val;
+			exitZ = -(blockMin_z - p0.m_z) * val;
 		} else {
 			zInc = 0;
 			stepZ = dgFloat32 (0.0f);
 			tz = dgFloat32 (1.0e10f);
+			exitZ = dgFloat32 (1.0e10f);
 		}
 
-		dgFloat32 txAcc = tx;
-		dgFloat32 tzAcc = tz;
-		dgInt32 xIndex0 = ix0;
-		dgInt32 zIndex0 = iz0;
+		const dgFloat32 exitT = dgMin (dgMin (exitX, exitZ), maxT);
+		dgFloat32 crossT;
+		do {
+			const dgFloat32 t = RayCastCell (ray, xIndex, zIndex, normalOut, maxT);
+			if (t < maxT) {
+				xIndexOut = xIndex;
+				zIndexOut = zIndex;
+				return t;
+			}
+
+			if (tx < tz) {
+				xIndex += xInc;
+				crossT = tx;
+				tx += stepX;
+			} else {
+				zIndex += zInc;
+				crossT = tz;
+				tz += stepZ;
+			}
+		} while (crossT <= exitT);
+	}
+	return hitT;
+}
+
+dgFloat32 dgCollisionHeightField::RayCast (const dgVector& localP0, const dgVector& localP1, dgFloat32 maxT, dgContactPoint& contactOut, const dgBody* const body, void* const userData, OnRayPrecastAction preFilter) const
+{
+	dgVector boxP0;
+	dgVector boxP1;
+
+	// the grid starts at the origin, the ray parameter and the normal do not change with the translation
+	const dgVector q0 (localP0 - m_origin);
+	const dgVector q1 (localP1 - m_origin);
+
+	// calculate the ray bounding box
+	CalculateMinExtend2d (q0, q1, boxP0, boxP1);
+
+	dgVector p0 (q0);
+	dgVector p1 (q1);
+
+	// clip the line against the bounding box
+	if (dgRayBoxClip (p0, p1, boxP0, boxP1)) { 
 		dgFastRayTest ray (q0, q1); 
 
-		// for each cell touched by the line
-		do {
-			dgFloat32 t = RayCastCell (ray, xIndex0, zIndex0, normalOut, maxT);
+		// descend the elevation pyramid from the root block, only the cells of the 
+		// level zero blocks the ray passes through are tested
+		const dgInt32 rootLevel = m_pyramidLevels - 1;
+		GetBlockBox (rootLevel, 0, 0, boxP0, boxP1);
+		const dgFloat32 entryT = ray.BoxIntersect (boxP0 - m_blockPadding, boxP1 + m_blockPadding);
+		if (entryT < maxT) {
+			dgInt32 xIndex0 = 0;
+			dgInt32 zIndex0 = 0;
+			dgVector normalOut (dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+			dgFloat32 t = RayCastBlock (ray, rootLevel, 0, 0, entryT, normalOut, xIndex0, zIndex0, maxT);
 			if (t < maxT) {
-				// bail out at the first intersection and copy the data into the descriptor
+				// copy the data of the closest intersection into the descriptor
 				contactOut.m_normal = normalOut.Scale3 (dgRsqrt (normalOut.DotProduct3(normalOut)));
 				contactOut.m_shapeId0 = m_atributeMap[zIndex0 * m_width + xIndex0];
 				contactOut.m_shapeId1 = m_atributeMap[zIndex0 * m_width + xIndex0];
@@ -694,17 +884,7 @@ dgFloat32 dgCollisionHeightField::RayCast (const dgVector& q0, const dgVector& q
 
 				return t;
 			}
-
-			if (txAcc < tzAcc) {
-				xIndex0 += xInc;
-				tx = txAcc;
-				txAcc += stepX;
-			} else {
-				zIndex0 += zInc;
-				tz = tzAcc;
-				tzAcc += stepZ;
-			}
-		} while ((tx <= dgFloat32 (1.0f)) || (tz <= dgFloat32 (1.0f)));
+		}
 	}
 
 	// if no cell was hit, return a large value
@@ -759,7 +939,7 @@ dgVector dgCollisionHeightField::SupportVertex (const dgVector& dir, dgInt32* co
 			}
 		}
 	}
-	return support;
+	return support + m_origin;
 }
 
 dgVector dgCollisionHeightField::SupportVertexSpecial (const dgVector& dir, dgFloat32 skinThickness, dgInt32* const vertexIndex) const
@@ -768,10 +948,13 @@ dgVector dgCollisionHeightField::SupportVertexSpecial (const dgVector& dir, dgFl
 	return SupportVertex (dir, vertexIndex);
 }
 
-void dgCollisionHeightField::DebugCollision (const dgMatrix& matrix, dgCollision::OnDebugCollisionMeshCallback callback, void* const userData) const
+void dgCollisionHeightField::DebugCollision (const dgMatrix& matrixPtr, dgCollision::OnDebugCollisionMeshCallback callback, void* const userData) const
 {
 	dgVector points[4];
 
+	dgMatrix matrix (matrixPtr);
+	matrix.m_posit = matrixPtr.TransformVector(m_origin);
+
 	dgInt32 base = 0;
 	for (dgInt32 z = 0; z < m_height - 1; z ++) {
 		switch (m_elevationDataType) 
@@ -884,6 +1067,57 @@ void dgCollisionHeightField::DebugCollision (const dgMatrix& matrix, dgCollision
 	}
 }
 
+void dgCollisionHeightField::CalculateMinAndMaxElevation(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, dgFloat32& minHeight, dgFloat32& maxHeight) const
+{
+	CalculateMinAndMaxElevation(m_pyramidLevels - 1, 0, 0, x0, x1, z0, z1, minHeight, maxHeight);
+}
+
+void dgCollisionHeightField::CalculateMinAndMaxElevation(dgInt32 level, dgInt32 blockX, dgInt32 blockZ, dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, dgFloat32& minHeight, dgFloat32& maxHeight) const
+{
+	const dgInt32 cells = DG_HEIGHTFIELD_PYRAMID_BLOCK << level;
+	const dgInt32 blockX0 = blockX * cells;
+	const dgInt32 blockZ0 = blockZ * cells;
+	const dgInt32 blockX1 = dgMin (blockX0 + cells, m_width - 1);
+	const dgInt32 blockZ1 = dgMin (blockZ0 + cells, m_height - 1);
+	if ((x1 < blockX0) || (x0 > blockX1) || (z1 < blockZ0) || (z0 > blockZ1)) {
+		return;
+	}
+
+	if ((x0 <= blockX0) && (x1 >= blockX1) && (z0 <= blockZ0) && (z1 >= blockZ1)) {
+		// the block is inside the range, use its elevation range
+		const dgElevationRange& block = m_elevationPyramid[m_pyramidStart[level] + blockZ * m_pyramidWidth[level] + blockX];
+		minHeight = dgMin(block.m_minHeight, minHeight);
+		maxHeight = dgMax(block.m_maxHeight, maxHeight);
+	} else if (level) {
+		const dgInt32 childLevel = level - 1;
+		for (dgInt32 z = blockZ * 2; z < dgMin (blockZ * 2 + 2, m_pyramidHeight[childLevel]); z ++) {
+			for (dgInt32 x = blockX * 2; x < dgMin (blockX * 2 + 2, m_pyramidWidth[childLevel]); x ++) {
+				CalculateMinAndMaxElevation(childLevel, x, z, x0, x1, z0, z1, minHeight, maxHeight);
+			}
+		}
+	} else {
+		// scan the part of the block inside the range
+		const dgInt32 scanX0 = dgMax (x0, blockX0);
+		const dgInt32 scanX1 = dgMin (x1, blockX1);
+		const dgInt32 scanZ0 = dgMax (z0, blockZ0);
+		const dgInt32 scanZ1 = dgMin (z1, blockZ1);
+		switch (m_elevationDataType) 
+		{
+			case m_float32Bit:
+			{
+				CalculateMinAndMaxElevation(scanX0, scanX1, scanZ0, scanZ1, (dgFloat32*)m_elevationMap, minHeight, maxHeight);
+				break;
+			}
+
+			case m_unsigned16Bit:
+			{
+				CalculateMinAndMaxElevation(scanX0, scanX1, scanZ0, scanZ1, (dgUnsigned16*)m_elevationMap, minHeight, maxHeight);
+				break;
+			}
+		}
+	}
+}
+
 void dgCollisionHeightField::CalculateMinAndMaxElevation(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, const dgFloat32* const elevation, dgFloat32& minHeight, dgFloat32& maxHeight) const
 {
 	dgInt32 base = z0 * m_width;
@@ -914,7 +1148,7 @@ void dgCollisionHeightField::CalculateMinAndMaxElevation(dgInt32 x0, dgInt32 x1,
 void dgCollisionHeightField::GetLocalAABB (const dgVector& q0, const dgVector& q1, dgVector& boxP0, dgVector& boxP1) const
 {
 	// the user data is the pointer to the collision geometry
-	CalculateMinExtend3d (q0, q1, boxP0, boxP1);
+	CalculateMinExtend3d (q0 - m_origin, q1 - m_origin, boxP0, boxP1);
 
 	dgVector p0 (boxP0.Scale4(m_horizontalScaleInv_x).GetInt());
 	dgVector p1 (boxP1.Scale4(m_horizontalScaleInv_x).GetInt());
@@ -931,24 +1165,12 @@ void dgCollisionHeightField::GetLocalAABB (const dgVector& q0, const dgVector& q
 
 	dgFloat32 minHeight = dgFloat32 (1.0e10f);
 	dgFloat32 maxHeight = dgFloat32 (-1.0e10f);
-	//dgInt32 base = z0 * m_width;
-	switch (m_elevationDataType) 
-	{
-		case m_float32Bit:
-		{
-			CalculateMinAndMaxElevation(x0, x1, z0, z1, (dgFloat32*)m_elevationMap, minHeight, maxHeight);
-			break;
-		}
-
-		case m_unsigned16Bit:
-		{
-			CalculateMinAndMaxElevation(x0, x1, z0, z1, (dgUnsigned16*)m_elevationMap, minHeight, maxHeight);
-			break;
-		}
-	}
+	CalculateMinAndMaxElevation(x0, x1, z0, z1, minHeight, maxHeight);
 
 	boxP0.m_y = m_verticalScale * minHeight;
 	boxP1.m_y = m_verticalScale * maxHeight;
+	boxP0 += m_origin;
+	boxP1 += m_origin;
 }
 
 void dgCollisionHeightField::AddDisplacement (dgVector* const vertex, dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1) const
@@ -976,7 +1198,7 @@ void dgCollisionHeightField::GetCollidingFaces (dgPolygonMeshDesc* const data) c
 	dgWorld* const world = data->m_objBody->GetWorld();
 
 	// the user data is the pointer to the collision geometry
-	CalculateMinExtend3d (data->m_p0, data->m_p1, boxP0, boxP1);
+	CalculateMinExtend3d (data->m_p0 - m_origin, data->m_p1 - m_origin, boxP0, boxP1);
 	boxP0 += data->m_boxDistanceTravelInMeshSpace & (data->m_boxDistanceTravelInMeshSpace < dgVector (dgFloat32 (0.0f)));  
 	boxP1 += data->m_boxDistanceTravelInMeshSpace & (data->m_boxDistanceTravelInMeshSpace > dgVector (dgFloat32 (0.0f)));  
 
@@ -999,21 +1221,7 @@ void dgCollisionHeightField::GetCollidingFaces (dgPolygonMeshDesc* const data) c
 	data->m_separationDistance = dgFloat32 (0.0f);
 	dgFloat32 minHeight = dgFloat32 (1.0e10f);
 	dgFloat32 maxHeight = dgFloat32 (-1.0e10f);
-//	dgInt32 base = z0 * m_width;
-	switch (m_elevationDataType) 
-	{
-		case m_float32Bit:
-		{
-			CalculateMinAndMaxElevation(x0, x1, z0, z1, (dgFloat32*)m_elevationMap, minHeight, maxHeight);
-			break;
-		}
-
-		case m_unsigned16Bit:
-		{
-			CalculateMinAndMaxElevation(x0, x1, z0, z1, (dgUnsigned16*)m_elevationMap, minHeight, maxHeight);
-			break;
-		}
-	}
+	CalculateMinAndMaxElevation(x0, x1, z0, z1, minHeight, maxHeight);
 
 	minHeight *= m_verticalScale;
 	maxHeight *= m_verticalScale;
@@ -1037,7 +1245,7 @@ void dgCollisionHeightField::GetCollidingFaces (dgPolygonMeshDesc* const data) c
 				for (dgInt32 z = z0; z <= z1; z ++) {
 					dgFloat32 zVal = m_horizontalScale_z * z;
 					for (dgInt32 x = x0; x <= x1; x ++) {
-						vertex[vertexIndex] = dgVector(m_horizontalScale_x * x, m_verticalScale * elevation[base + x], zVal, dgFloat32 (0.0f));
+						vertex[vertexIndex] = dgVector(m_horizontalScale_x * x, m_verticalScale * elevation[base + x], zVal, dgFloat32 (0.0f)) + m_origin;
 						vertexIndex ++;
 						dgAssert (vertexIndex <= m_instanceData->m_vertexCount[data->m_threadNumber]); 
 					}
@@ -1055,7 +1263,7 @@ void dgCollisionHeightField::GetCollidingFaces (dgPolygonMeshDesc* const data) c
 				for (dgInt32 z = z0; z <= z1; z ++) {
 					dgFloat32 zVal = m_horizontalScale_z * z;
 					for (dgInt32 x = x0; x <= x1; x ++) {
-						vertex[vertexIndex] = dgVector(m_horizontalScale_x * x, m_verticalScale * dgFloat32 (elevation[base + x]), zVal, dgFloat32 (0.0f));
+						vertex[vertexIndex] = dgVector(m_horizontalScale_x * x, m_verticalScale * dgFloat32 (elevation[base + x]), zVal, dgFloat32 (0.0f)) + m_origin;
 						vertexIndex ++;
 						dgAssert (vertexIndex <= m_instanceData->m_vertexCount[data->m_threadNumber]); 
 					}
@@ -25,6 +25,9 @@
 #include "dgCollision.h"
 #include "dgCollisionMesh.h"
 
+#define DG_HEIGHTFIELD_PYRAMID_BLOCK		8
+#define DG_HEIGHTFIELD_PYRAMID_MAX_LEVELS	24
+
 class dgCollisionHeightField;
 typedef dgFloat32 (*dgCollisionHeightFieldRayCastCallback) (const dgBody* const body, const dgCollisionHeightField* const heightFieldCollision, dgFloat32 interception, dgInt32 row, dgInt32 col, dgVector* const normal, int faceId, void* const usedData);
 
@@ -62,6 +65,9 @@ class dgCollisionHeightField: public dgCollisionMesh
 
 	void SetHorizontalDisplacement (const dgUnsigned16* const displacemnet, dgFloat32 scale);
 
+	// call after editing the elevation map in place, the range is in grid vertices and inclusive
+	void UpdateElevations (dgInt32 x0, dgInt32 z0, dgInt32 x1, dgInt32 z1);
+
 	private:
 	class dgPerIntanceData
 	{
@@ -72,14 +78,35 @@ class dgCollisionHeightField: public dgCollisionMesh
 		dgArray<dgVector> m_vertex[DG_MAX_THREADS_HIVE_COUNT];
 	};
 
+	// elevation range of a square block of cells, level zero blocks are DG_HEIGHTFIELD_PYRAMID_BLOCK 
+	// cells wide and each level above merges two by two blocks of the level below.
+	class dgElevationRange
+	{
+		public:
+		dgFloat32 m_minHeight;
+		dgFloat32 m_maxHeight;
+	};
+
+	static dgPerIntanceData* AddInstanceDataRef (dgWorld* const world);
+	static void ReleaseInstanceDataRef (dgPerIntanceData* const instanceData);
+
+	// places the grid in the local space of the shape, the tiles of a tiled height field are moved to their corner
+	void SetOrigin (const dgVector& origin);
+
 	void CalculateAABB();
+	void BuildElevationPyramid();
+	void UpdateElevationPyramid(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1);
+	void CalculateMinAndMaxElevation(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, dgFloat32& minHeight, dgFloat32& maxHeight) const;
+	void CalculateMinAndMaxElevation(dgInt32 level, dgInt32 blockX, dgInt32 blockZ, dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, dgFloat32& minHeight, dgFloat32& maxHeight) const;
 	void CalculateMinAndMaxElevation(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, const dgUnsigned16* const elevation, dgFloat32& minHeight, dgFloat32& maxHeight) const;
 	void CalculateMinAndMaxElevation(dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, const dgFloat32* const elevation, dgFloat32& minHeight, dgFloat32& maxHeight) const;
+	DG_INLINE void GetBlockBox (dgInt32 level, dgInt32 blockX, dgInt32 blockZ, dgVector& boxP0, dgVector& boxP1) const;
 		
 	void AllocateVertex(dgWorld* const world, dgInt32 thread) const;
 	void CalculateMinExtend2d (const dgVector& p0, const dgVector& p1, dgVector& boxP0, dgVector& boxP1) const;
 	void CalculateMinExtend3d (const dgVector& p0, const dgVector& p1, dgVector& boxP0, dgVector& boxP1) const;
 	dgFloat32 RayCastCell (const dgFastRayTest& ray, dgInt32 xIndex0, dgInt32 zIndex0, dgVector& normalOut, dgFloat32 maxT) const;
+	dgFloat32 RayCastBlock (const dgFastRayTest& ray, dgInt32 level, dgInt32 blockX, dgInt32 blockZ, dgFloat32 entryT, dgVector& normalOut, dgInt32& xIndexOut, dgInt32& zIndexOut, dgFloat32 maxT) const;
 
 	virtual void Serialize(dgSerialize callback, void* const userData) const;
 	virtual dgFloat32 RayCast (const dgVector& localP0, const dgVector& localP1, dgFloat32 maxT, dgContactPoint& contactOut, const dgBody* const body, void* const userData, OnRayPrecastAction preFilter) const;
@@ -107,6 +134,7 @@ class dgCollisionHeightField: public dgCollisionMesh
 
 	dgVector m_minBox;
 	dgVector m_maxBox;
+	dgVector m_origin;
 
 	dgInt32 m_width;
 	dgInt32 m_height;
@@ -115,6 +143,11 @@ class dgCollisionHeightField: public dgCollisionMesh
 	dgInt8* m_diagonals;
 	void* m_elevationMap;
 	dgUnsigned16* m_horizontalDisplacement;
+	dgElevationRange* m_elevationPyramid;
+	dgInt32 m_pyramidLevels;
+	dgInt32 m_pyramidWidth[DG_HEIGHTFIELD_PYRAMID_MAX_LEVELS];
+	dgInt32 m_pyramidHeight[DG_HEIGHTFIELD_PYRAMID_MAX_LEVELS];
+	dgInt32 m_pyramidStart[DG_HEIGHTFIELD_PYRAMID_MAX_LEVELS];
 	dgFloat32 m_verticalScale;
 	dgFloat32 m_horizontalScale_x;
 	dgFloat32 m_horizontalScaleInv_x;
@@ -128,6 +161,7 @@ class dgCollisionHeightField: public dgCollisionMesh
 	
 	static dgVector m_yMask;
 	static dgVector m_padding;
+	static dgVector m_blockPadding;
 	static dgVector m_elevationPadding;
 	static dgInt32 m_cellIndices[][4];
 	static dgInt32 m_verticalEdgeMap[][7];
@@ -135,6 +169,7 @@ class dgCollisionHeightField: public dgCollisionMesh
 	
 	dgPerIntanceData* m_instanceData;
 	friend class dgCollisionCompound;
+	friend class dgCollisionTiledHeightField;
 };
 
 
@@ -0,0 +1,560 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgCollisionTiledHeightField.h"
+
+
+dgVector dgCollisionTiledHeightField::m_tilePadding (dgFloat32 (1.0e-3f), dgFloat32 (1.0e-3f), dgFloat32 (1.0e-3f), dgFloat32 (0.0f));
+
+dgCollisionTiledHeightField::dgCollisionTiledHeightField (
+	dgWorld* const world, dgInt32 width, dgInt32 height, dgInt32 tileSize, dgInt32 contructionMode,
+	dgCollisionHeightField::dgElevationType elevationDataType, dgFloat32 verticalScale, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z,
+	dgFloat32 minElevation, dgFloat32 maxElevation, dgInt32 maxResidentTiles, OnTiledHeightFieldPageCallback pageCallback, void* const pageUserData)
+	:dgCollisionMesh (world, m_tiledHeightField)
+	,m_world(world)
+	,m_pageUserData(pageUserData)
+	,m_pageCallback(pageCallback)
+	,m_width(width)
+	,m_height(height)
+	// the alternate diagonal patterns start at the corner of each tile, an even tile size keeps them in step
+	,m_tileSize(dgMax (tileSize & -2, 2))
+	,m_diagonalMode(dgClamp (contructionMode, dgInt32 (dgCollisionHeightField::m_normalDiagonals), dgInt32 (dgCollisionHeightField::m_starInvertexDiagonals)))
+	,m_maxResidentTiles(dgMax (maxResidentTiles, 1))
+	,m_residentCount(0)
+	,m_lruClock(0)
+	,m_minElevation(minElevation)
+	,m_maxElevation(maxElevation)
+	,m_verticalScale(verticalScale)
+	,m_horizontalScale_x(horizontalScale_x)
+	,m_horizontalScaleInv_x(dgFloat32 (1.0f) / horizontalScale_x)
+	,m_horizontalScale_z(horizontalScale_z)
+	,m_horizontalScaleInv_z(dgFloat32 (1.0f) / horizontalScale_z)
+	,m_elevationDataType(elevationDataType)
+{
+	m_rtti |= dgCollisionTiledHeightField_RTTI;
+	dgAssert (m_width >= 2);
+	dgAssert (m_height >= 2);
+	dgAssert (m_pageCallback);
+	InitTiles ();
+}
+
+dgCollisionTiledHeightField::dgCollisionTiledHeightField (dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber)
+	:dgCollisionMesh (world, deserialization, userData, revisionNumber)
+	,m_world(world)
+	,m_pageUserData(NULL)
+	,m_pageCallback(NULL)
+	,m_residentCount(0)
+	,m_lruClock(0)
+{
+	dgAssert (m_rtti & dgCollisionTiledHeightField_RTTI);
+
+	dgInt32 elevationDataType;
+	deserialization (userData, &m_width, sizeof (dgInt32));
+	deserialization (userData, &m_height, sizeof (dgInt32));
+	deserialization (userData, &m_tileSize, sizeof (dgInt32));
+	deserialization (userData, &m_diagonalMode, sizeof (dgInt32));
+	deserialization (userData, &elevationDataType, sizeof (dgInt32));
+	deserialization (userData, &m_maxResidentTiles, sizeof (dgInt32));
+	deserialization (userData, &m_minElevation, sizeof (dgFloat32));
+	deserialization (userData, &m_maxElevation, sizeof (dgFloat32));
+	deserialization (userData, &m_verticalScale, sizeof (dgFloat32));
+	deserialization (userData, &m_horizontalScale_x, sizeof (dgFloat32));
+	deserialization (userData, &m_horizontalScale_z, sizeof (dgFloat32));
+
+	m_elevationDataType = dgCollisionHeightField::dgElevationType (elevationDataType);
+	m_horizontalScaleInv_x = dgFloat32 (1.0f) / m_horizontalScale_x;
+	m_horizontalScaleInv_z = dgFloat32 (1.0f) / m_horizontalScale_z;
+	InitTiles ();
+
+	const dgInt32 tileCount = m_tileCount_x * m_tileCount_z;
+	for (dgInt32 i = 0; i < tileCount; i ++) {
+		deserialization (userData, &m_tiles[i].m_minHeight, sizeof (dgFloat32));
+		deserialization (userData, &m_tiles[i].m_maxHeight, sizeof (dgFloat32));
+	}
+}
+
+dgCollisionTiledHeightField::~dgCollisionTiledHeightField(void)
+{
+	for (dgInt32 i = 0; i < m_residentCount; i ++) {
+		dgTile& tile = m_tiles[m_residentTiles[i]];
+		tile.m_shape->Release();
+		tile.m_shape = NULL;
+	}
+	dgCollisionHeightField::ReleaseInstanceDataRef (m_instanceData);
+
+	dgFreeStack (m_residentTiles);
+	dgFreeStack (m_tiles);
+}
+
+void dgCollisionTiledHeightField::InitTiles ()
+{
+	m_tileCount_x = (m_width - 1 + m_tileSize - 1) / m_tileSize;
+	m_tileCount_z = (m_height - 1 + m_tileSize - 1) / m_tileSize;
+
+	const dgInt32 tileCount = m_tileCount_x * m_tileCount_z;
+	m_tiles = (dgTile*) dgMallocStack (tileCount * sizeof (dgTile));
+	for (dgInt32 i = 0; i < tileCount; i ++) {
+		m_tiles[i].m_shape = NULL;
+		m_tiles[i].m_lastUsed = 0;
+		m_tiles[i].m_minHeight = m_minElevation;
+		m_tiles[i].m_maxHeight = m_maxElevation;
+		m_tiles[i].m_state = m_unloaded;
+	}
+	m_residentTiles = (dgInt32*) dgMallocStack (m_maxResidentTiles * sizeof (dgInt32));
+
+	// the tiles are created by the worker threads, holding a reference here keeps the
+	// shared vertex buffers alive and out of the world container while they run
+	m_instanceData = dgCollisionHeightField::AddInstanceDataRef (m_world);
+
+	const dgFloat32 y0 = m_minElevation * m_verticalScale;
+	const dgFloat32 y1 = m_maxElevation * m_verticalScale;
+	m_minBox = dgVector (dgFloat32 (0.0f),                                 dgMin (y0, y1), dgFloat32 (0.0f),                                  dgFloat32 (0.0f));
+	m_maxBox = dgVector (dgFloat32 (m_width - 1) * m_horizontalScale_x, dgMax (y0, y1), dgFloat32 (m_height - 1) * m_horizontalScale_z, dgFloat32 (0.0f));
+	SetCollisionBBox(m_minBox, m_maxBox);
+}
+
+void dgCollisionTiledHeightField::Serialize(dgSerialize callback, void* const userData) const
+{
+	SerializeLow(callback, userData);
+
+	dgInt32 elevationDataType = m_elevationDataType;
+	callback (userData, &m_width, sizeof (dgInt32));
+	callback (userData, &m_height, sizeof (dgInt32));
+	callback (userData, &m_tileSize, sizeof (dgInt32));
+	callback (userData, &m_diagonalMode, sizeof (dgInt32));
+	callback (userData, &elevationDataType, sizeof (dgInt32));
+	callback (userData, &m_maxResidentTiles, sizeof (dgInt32));
+	callback (userData, &m_minElevation, sizeof (dgFloat32));
+	callback (userData, &m_maxElevation, sizeof (dgFloat32));
+	callback (userData, &m_verticalScale, sizeof (dgFloat32));
+	callback (userData, &m_horizontalScale_x, sizeof (dgFloat32));
+	callback (userData, &m_horizontalScale_z, sizeof (dgFloat32));
+
+	// the tiles already read have their exact elevation range, saving it keeps the bounds tight after loading
+	const dgInt32 tileCount = m_tileCount_x * m_tileCount_z;
+	for (dgInt32 i = 0; i < tileCount; i ++) {
+		callback (userData, &m_tiles[i].m_minHeight, sizeof (dgFloat32));
+		callback (userData, &m_tiles[i].m_maxHeight, sizeof (dgFloat32));
+	}
+}
+
+void dgCollisionTiledHeightField::GetCollisionInfo(dgCollisionInfo* const info) const
+{
+	dgCollision::GetCollisionInfo(info);
+
+	dgCollisionInfo::dgTiledHeightMapCollisionData& data = info->m_tiledHeightFieldCollision;
+	data.m_width = m_width;
+	data.m_height = m_height;
+	data.m_tileSize = m_tileSize;
+	data.m_gridsDiagonals = m_diagonalMode;
+	data.m_elevationDataType = m_elevationDataType;
+	data.m_maxResidentTiles = m_maxResidentTiles;
+	data.m_residentTileCount = m_residentCount;
+	data.m_verticalScale = m_verticalScale;
+	data.m_horizonalScale_x = m_horizontalScale_x;
+	data.m_horizonalScale_z = m_horizontalScale_z;
+	data.m_minElevation = m_minElevation;
+	data.m_maxElevation = m_maxElevation;
+	data.m_pageUserData = m_pageUserData;
+}
+
+dgInt32 dgCollisionTiledHeightField::GetResidentTileCount () const
+{
+	return m_residentCount;
+}
+
+void dgCollisionTiledHeightField::SetPageCallback (OnTiledHeightFieldPageCallback pageCallback, void* const pageUserData)
+{
+	m_pageCallback = pageCallback;
+	m_pageUserData = pageUserData;
+}
+
+dgCollisionHeightField* dgCollisionTiledHeightField::LoadTile (dgInt32 tileX, dgInt32 tileZ) const
+{
+	// each load has its own page, several tiles can be read at the same time
+	const dgInt32 x0 = tileX * m_tileSize;
+	const dgInt32 z0 = tileZ * m_tileSize;
+	const dgInt32 width = dgMin (m_tileSize, m_width - 1 - x0) + 1;
+	const dgInt32 height = dgMin (m_tileSize, m_height - 1 - z0) + 1;
+	const dgInt32 elevationSize = (m_elevationDataType == dgCollisionHeightField::m_float32Bit) ? sizeof (dgFloat32) : sizeof (dgUnsigned16);
+	dgInt8* const elevation = (dgInt8*) dgMallocStack (width * height * elevationSize);
+	dgInt8* const atributes = (dgInt8*) dgMallocStack (((width * height + 4) & -4) * sizeof (dgInt8));
+	m_pageCallback (m_pageUserData, x0, z0, width, height, elevation, atributes);
+
+	dgCollisionHeightField* const shape = new (m_allocator) dgCollisionHeightField (m_world, width, height, m_diagonalMode, elevation, m_elevationDataType,
+																					 m_verticalScale, atributes, m_horizontalScale_x, m_horizontalScale_z);
+	shape->SetOrigin (dgVector (x0 * m_horizontalScale_x, dgFloat32 (0.0f), z0 * m_horizontalScale_z, dgFloat32 (0.0f)));
+	// set while the tile is still private, the resident tiles are read by all threads
+	shape->SetDebugCollisionCallback (m_debugCallback);
+
+	dgFreeStack (atributes);
+	dgFreeStack (elevation);
+	return shape;
+}
+
+dgCollisionHeightField* dgCollisionTiledHeightField::AcquireTile (dgInt32 tileX, dgInt32 tileZ) const
+{
+	dgAssert ((tileX >= 0) && (tileX < m_tileCount_x));
+	dgAssert ((tileZ >= 0) && (tileZ < m_tileCount_z));
+
+	const dgInt32 tileIndex = tileZ * m_tileCount_x + tileX;
+	dgTile& tile = m_tiles[tileIndex];
+	for (bool loading = false; !loading; ) {
+		{
+			dgThreadHiveScopeLock lock (m_world, &m_lock, true);
+			if (tile.m_state == m_resident) {
+				m_lruClock ++;
+				tile.m_lastUsed = m_lruClock;
+				tile.m_shape->AddRef();
+				return tile.m_shape;
+			}
+			if (tile.m_state == m_unloaded) {
+				// this thread reads the tile, the others asking for it wait until it is published
+				tile.m_state = m_loading;
+				loading = true;
+			}
+		}
+		if (!loading) {
+			dgThreadYield();
+		}
+	}
+
+	// the page callback can be slow, it runs outside the lock so that the queries on the other tiles are not stalled
+	dgCollisionHeightField* const shape = LoadTile (tileX, tileZ);
+
+	dgThreadHiveScopeLock lock (m_world, &m_lock, true);
+	if (m_residentCount == m_maxResidentTiles) {
+		// evict the least recently used tile, a query still using it keeps it alive until it releases it
+		dgInt32 oldest = 0;
+		for (dgInt32 i = 1; i < m_residentCount; i ++) {
+			if (m_tiles[m_residentTiles[i]].m_lastUsed < m_tiles[m_residentTiles[oldest]].m_lastUsed) {
+				oldest = i;
+			}
+		}
+		dgTile& victim = m_tiles[m_residentTiles[oldest]];
+		victim.m_shape->Release();
+		victim.m_shape = NULL;
+		victim.m_state = m_unloaded;
+		m_residentCount --;
+		m_residentTiles[oldest] = m_residentTiles[m_residentCount];
+	}
+
+	// from now on the exact elevation range of the tile bounds the queries, even after it is evicted
+	const dgCollisionHeightField::dgElevationRange& range = shape->m_elevationPyramid[shape->m_pyramidStart[shape->m_pyramidLevels - 1]];
+	dgAssert (range.m_minHeight >= tile.m_minHeight);
+	dgAssert (range.m_maxHeight <= tile.m_maxHeight);
+	tile.m_minHeight = range.m_minHeight;
+	tile.m_maxHeight = range.m_maxHeight;
+	tile.m_shape = shape;
+	tile.m_state = m_resident;
+
+	m_residentTiles[m_residentCount] = tileIndex;
+	m_residentCount ++;
+
+	m_lruClock ++;
+	tile.m_lastUsed = m_lruClock;
+	shape->AddRef();
+	return shape;
+}
+
+dgCollisionHeightField* dgCollisionTiledHeightField::GetResidentTile (dgInt32 tileX, dgInt32 tileZ) const
+{
+	dgThreadHiveScopeLock lock (m_world, &m_lock, true);
+	dgCollisionHeightField* const shape = m_tiles[tileZ * m_tileCount_x + tileX].m_shape;
+	if (shape) {
+		shape->AddRef();
+	}
+	return shape;
+}
+
+void dgCollisionTiledHeightField::GetTileBox (dgInt32 tileX, dgInt32 tileZ, dgVector& boxP0, dgVector& boxP1) const
+{
+	const dgInt32 x0 = tileX * m_tileSize;
+	const dgInt32 z0 = tileZ * m_tileSize;
+	const dgInt32 x1 = dgMin (x0 + m_tileSize, m_width - 1);
+	const dgInt32 z1 = dgMin (z0 + m_tileSize, m_height - 1);
+	const dgTile& tile = m_tiles[tileZ * m_tileCount_x + tileX];
+	const dgFloat32 y0 = tile.m_minHeight * m_verticalScale;
+	const dgFloat32 y1 = tile.m_maxHeight * m_verticalScale;
+	boxP0 = dgVector (x0 * m_horizontalScale_x, dgMin (y0, y1), z0 * m_horizontalScale_z, dgFloat32 (0.0f));
+	boxP1 = dgVector (x1 * m_horizontalScale_x, dgMax (y0, y1), z1 * m_horizontalScale_z, dgFloat32 (0.0f));
+}
+
+void dgCollisionTiledHeightField::GetTileRange (dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, dgInt32& tileX0, dgInt32& tileX1, dgInt32& tileZ0, dgInt32& tileZ1) const
+{
+	// the range is in grid vertices, the last vertex is taken from the tile before it when it is on a tile border
+	tileX0 = dgMin (x0 / m_tileSize, m_tileCount_x - 1);
+	tileZ0 = dgMin (z0 / m_tileSize, m_tileCount_z - 1);
+	tileX1 = dgClamp ((x1 - 1) / m_tileSize, tileX0, m_tileCount_x - 1);
+	tileZ1 = dgClamp ((z1 - 1) / m_tileSize, tileZ0, m_tileCount_z - 1);
+}
+
+dgCollisionHeightField* dgCollisionTiledHeightField::CreateWindow (dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1) const
+{
+	// the alternate diagonal patterns start at the corner of the window
+	dgAssert (!(x0 & 1));
+	dgAssert (!(z0 & 1));
+
+	const dgInt32 width = x1 - x0 + 1;
+	const dgInt32 height = z1 - z0 + 1;
+	const dgInt32 elevationSize = (m_elevationDataType == dgCollisionHeightField::m_float32Bit) ? sizeof (dgFloat32) : sizeof (dgUnsigned16);
+	dgInt8* const elevation = (dgInt8*) dgMallocStack (width * height * elevationSize);
+	dgInt8* const atributes = (dgInt8*) dgMallocStack (width * height * sizeof (dgInt8));
+
+	// copy the part of each tile inside the window, the vertices on the tile borders are copied twice
+	dgInt32 tileX0;
+	dgInt32 tileX1;
+	dgInt32 tileZ0;
+	dgInt32 tileZ1;
+	GetTileRange (x0, x1, z0, z1, tileX0, tileX1, tileZ0, tileZ1);
+	for (dgInt32 tileZ = tileZ0; tileZ <= tileZ1; tileZ ++) {
+		for (dgInt32 tileX = tileX0; tileX <= tileX1; tileX ++) {
+			dgCollisionHeightField* const tile = AcquireTile (tileX, tileZ);
+			const dgInt32 originX = tileX * m_tileSize;
+			const dgInt32 originZ = tileZ * m_tileSize;
+			const dgInt32 copyX0 = dgMax (x0, originX);
+			const dgInt32 copyX1 = dgMin (x1, originX + tile->m_width - 1);
+			const dgInt32 copyZ0 = dgMax (z0, originZ);
+			const dgInt32 copyZ1 = dgMin (z1, originZ + tile->m_height - 1);
+			const dgInt32 count = copyX1 - copyX0 + 1;
+			for (dgInt32 z = copyZ0; z <= copyZ1; z ++) {
+				const dgInt32 src = (z - originZ) * tile->m_width + copyX0 - originX;
+				const dgInt32 dst = (z - z0) * width + copyX0 - x0;
+				memcpy (&elevation[dst * elevationSize], &((dgInt8*)tile->m_elevationMap)[src * elevationSize], count * elevationSize);
+				memcpy (&atributes[dst], &tile->m_atributeMap[src], count * sizeof (dgInt8));
+			}
+			tile->Release();
+		}
+	}
+
+	dgCollisionHeightField* const window = new (m_allocator) dgCollisionHeightField (m_world, width, height, m_diagonalMode, elevation, m_elevationDataType,
+																					  m_verticalScale, atributes, m_horizontalScale_x, m_horizontalScale_z);
+	window->SetOrigin (dgVector (x0 * m_horizontalScale_x, dgFloat32 (0.0f), z0 * m_horizontalScale_z, dgFloat32 (0.0f)));
+	window->SetDebugCollisionCallback (m_debugCallback);
+
+	dgFreeStack (atributes);
+	dgFreeStack (elevation);
+	return window;
+}
+
+void dgCollisionTiledHeightField::GetCollidingFaces (dgPolygonMeshDesc* const data) const
+{
+	// like the height field the separation is not estimated, the pair is tested again next step even when no face is returned
+	data->m_separationDistance = dgFloat32 (0.0f);
+	if (!m_pageCallback) {
+		// a loaded shape has no tiles until the page callback is set again
+		return;
+	}
+
+	const dgVector travel (data->m_boxDistanceTravelInMeshSpace);
+	const dgVector p0 (data->m_p0 + (travel & (travel < dgVector (dgFloat32 (0.0f)))));
+	const dgVector p1 (data->m_p1 + (travel & (travel > dgVector (dgFloat32 (0.0f)))));
+	if ((p1.m_x < m_minBox.m_x) || (p0.m_x > m_maxBox.m_x) || (p1.m_z < m_minBox.m_z) || (p0.m_z > m_maxBox.m_z)) {
+		return;
+	}
+
+	// the grid vertices a height field scans for this box, plus one cell at each side so that the
+	// rounding in the tile never reaches past the vertices selected here
+	const dgFloat32 padding = dgCollisionHeightField::m_padding.m_x;
+	const dgInt32 x0 = dgClamp (dgInt32 (dgFloor ((p0.m_x - padding) * m_horizontalScaleInv_x)) - 1, dgInt32 (0), m_width - 1);
+	const dgInt32 z0 = dgClamp (dgInt32 (dgFloor ((p0.m_z - padding) * m_horizontalScaleInv_z)) - 1, dgInt32 (0), m_height - 1);
+	const dgInt32 x1 = dgClamp (dgInt32 (dgFloor ((p1.m_x + padding) * m_horizontalScaleInv_x)) + 3, dgInt32 (0), m_width - 1);
+	const dgInt32 z1 = dgClamp (dgInt32 (dgFloor ((p1.m_z + padding) * m_horizontalScaleInv_z)) + 3, dgInt32 (0), m_height - 1);
+
+	dgInt32 tileX0;
+	dgInt32 tileX1;
+	dgInt32 tileZ0;
+	dgInt32 tileZ1;
+	GetTileRange (x0, x1, z0, z1, tileX0, tileX1, tileZ0, tileZ1);
+	if ((tileX0 == tileX1) && (tileZ0 == tileZ1)) {
+		// the box is inside one tile, that is most queries when the tiles are much larger than the bodies
+		dgCollisionHeightField* const tile = AcquireTile (tileX0, tileZ0);
+		tile->GetCollidingFaces (data);
+		tile->Release();
+	} else {
+		// the box crosses a tile border, build a temporary height field over the vertices of the box.
+		// the faces are in the per thread vertex buffers of the height fields, not in the window.
+		dgCollisionHeightField* const window = CreateWindow (x0 & -2, x1, z0 & -2, z1);
+		window->GetCollidingFaces (data);
+		window->Release();
+	}
+}
+
+dgFloat32 dgCollisionTiledHeightField::RayCast (const dgVector& localP0, const dgVector& localP1, dgFloat32 maxT, dgContactPoint& contactOut, const dgBody* const body, void* const userData, OnRayPrecastAction preFilter) const
+{
+	if (!m_pageCallback) {
+		return dgFloat32 (1.2f);
+	}
+
+	dgFastRayTest ray (localP0, localP1);
+	const dgFloat32 entryT = ray.BoxIntersect (m_minBox - m_tilePadding, m_maxBox + m_tilePadding);
+	if (entryT >= maxT) {
+		return dgFloat32 (1.2f);
+	}
+
+	// walk the tiles with a 2d dda from the point the ray enters the bounding box, only the tiles
+	// whose elevation range the ray crosses are loaded. the tiles do not overlap, so the walk stops
+	// at the first tile boundary past the closest hit
+	const dgVector& p0 = ray.m_p0;
+	const dgVector& dp = ray.m_diff;
+	const dgVector p (p0 + dp.Scale4 (entryT));
+	const dgFloat32 scale_x = m_horizontalScale_x * m_tileSize;
+	const dgFloat32 scale_z = m_horizontalScale_z * m_tileSize;
+	dgInt32 xIndex = dgClamp (dgInt32 (dgFloor (p.m_x / scale_x)), dgInt32 (0), m_tileCount_x - 1);
+	dgInt32 zIndex = dgClamp (dgInt32 (dgFloor (p.m_z / scale_z)), dgInt32 (0), m_tileCount_z - 1);
+
+	dgInt32 xInc;
+	dgFloat32 tx;
+	dgFloat32 stepX;
+	if (dp.m_x > dgFloat32 (0.0f)) {
+		xInc = 1;
+		dgFloat32 val = dgFloat32 (1.0f) / dp.m_x;
+		stepX = scale_x * val;
+		tx = (scale_x * (xIndex + dgFloat32 (1.0f)) - p0.m_x) * val;
+	} else if (dp.m_x < dgFloat32 (0.0f)) {
+		xInc = -1;
+		dgFloat32 val = -dgFloat32 (1.0f) / dp.m_x;
+		stepX = scale_x * val;
+		tx = -(scale_x * xIndex - p0.m_x) * val;
+	} else {
+		xInc = 0;
+		stepX = dgFloat32 (0.0f);
+		tx = dgFloat32 (1.0e10f);
+	}
+
+	dgInt32 zInc;
+	dgFloat32 tz;
+	dgFloat32 stepZ;
+	if (dp.m_z > dgFloat32 (0.0f)) {
+		zInc = 1;
+		dgFloat32 val = dgFloat32 (1.0f) / dp.m_z;
+		stepZ = scale_z * val;
+		tz = (scale_z * (zIndex + dgFloat32 (1.0f)) - p0.m_z) * val;
+	} else if (dp.m_z < dgFloat32 (0.0f)) {
+		zInc = -1;
+		dgFloat32 val = -dgFloat32 (1.0f) / dp.m_z;
+		stepZ = scale_z * val;
+		tz = -(scale_z * zIndex - p0.m_z) * val;
+	} else {
+		zInc = 0;
+		stepZ = dgFloat32 (0.0f);
+		tz = dgFloat32 (1.0e10f);
+	}
+
+	dgFloat32 hitT = dgFloat32 (1.2f);
+	dgFloat32 crossT = entryT;
+	while ((crossT < maxT) && (xIndex >= 0) && (xIndex < m_tileCount_x) && (zIndex >= 0) && (zIndex < m_tileCount_z)) {
+		dgVector boxP0;
+		dgVector boxP1;
+		GetTileBox (xIndex, zIndex, boxP0, boxP1);
+		if (ray.BoxIntersect (boxP0 - m_tilePadding, boxP1 + m_tilePadding) < maxT) {
+			dgCollisionHeightField* const tile = AcquireTile (xIndex, zIndex);
+			const dgFloat32 t = tile->RayCast (localP0, localP1, maxT, contactOut, body, userData, preFilter);
+			tile->Release();
+			if (t < maxT) {
+				maxT = t;
+				hitT = t;
+			}
+		}
+
+		if (tx < tz) {
+			xIndex += xInc;
+			crossT = tx;
+			tx += stepX;
+		} else {
+			zIndex += zInc;
+			crossT = tz;
+			tz += stepZ;
+		}
+	}
+	return hitT;
+}
+
+void dgCollisionTiledHeightField::GetLocalAABB (const dgVector& q0, const dgVector& q1, dgVector& boxP0, dgVector& boxP1) const
+{
+	// the resident tiles refine the box with their elevation pyramids, the others use their elevation range
+	const dgFloat32 padding = dgCollisionHeightField::m_padding.m_x;
+	const dgVector p0 (q0.GetMin (q1));
+	const dgVector p1 (q0.GetMax (q1));
+	const dgInt32 x0 = dgClamp (dgInt32 (dgFloor ((p0.m_x - padding) * m_horizontalScaleInv_x)), dgInt32 (0), m_width - 1);
+	const dgInt32 z0 = dgClamp (dgInt32 (dgFloor ((p0.m_z - padding) * m_horizontalScaleInv_z)), dgInt32 (0), m_height - 1);
+	const dgInt32 x1 = dgClamp (dgInt32 (dgFloor ((p1.m_x + padding) * m_horizontalScaleInv_x)) + 1, dgInt32 (0), m_width - 1);
+	const dgInt32 z1 = dgClamp (dgInt32 (dgFloor ((p1.m_z + padding) * m_horizontalScaleInv_z)) + 1, dgInt32 (0), m_height - 1);
+
+	dgInt32 tileX0;
+	dgInt32 tileX1;
+	dgInt32 tileZ0;
+	dgInt32 tileZ1;
+	GetTileRange (x0, x1, z0, z1, tileX0, tileX1, tileZ0, tileZ1);
+
+	const dgVector queryP0 (x0 * m_horizontalScale_x, dgFloat32 (0.0f), z0 * m_horizontalScale_z, dgFloat32 (0.0f));
+	const dgVector queryP1 (x1 * m_horizontalScale_x, dgFloat32 (0.0f), z1 * m_horizontalScale_z, dgFloat32 (0.0f));
+	boxP0 = dgVector (dgFloat32 (1.0e10f), dgFloat32 (1.0e10f), dgFloat32 (1.0e10f), dgFloat32 (0.0f));
+	boxP1 = dgVector (dgFloat32 (-1.0e10f), dgFloat32 (-1.0e10f), dgFloat32 (-1.0e10f), dgFloat32 (0.0f));
+	for (dgInt32 tileZ = tileZ0; tileZ <= tileZ1; tileZ ++) {
+		for (dgInt32 tileX = tileX0; tileX <= tileX1; tileX ++) {
+			dgVector tileP0;
+			dgVector tileP1;
+			dgCollisionHeightField* const tile = GetResidentTile (tileX, tileZ);
+			if (tile) {
+				tile->GetLocalAABB (p0, p1, tileP0, tileP1);
+				tile->Release();
+			} else {
+				GetTileBox (tileX, tileZ, tileP0, tileP1);
+				tileP0 = (tileP0.GetMax (queryP0) & dgCollisionHeightField::m_yMask) + tileP0.AndNot (dgCollisionHeightField::m_yMask);
+				tileP1 = (tileP1.GetMin (queryP1) & dgCollisionHeightField::m_yMask) + tileP1.AndNot (dgCollisionHeightField::m_yMask);
+			}
+			boxP0 = boxP0.GetMin (tileP0);
+			boxP1 = boxP1.GetMax (tileP1);
+		}
+	}
+}
+
+dgVector dgCollisionTiledHeightField::SupportVertex (const dgVector& dir, dgInt32* const vertexIndex) const
+{
+	// the grid is not in memory, use the bounding box
+	const dgVector mask (dir > dgVector (dgFloat32 (0.0f)));
+	return (m_maxBox & mask) + m_minBox.AndNot (mask);
+}
+
+dgVector dgCollisionTiledHeightField::SupportVertexSpecial (const dgVector& dir, dgFloat32 skinThickness, dgInt32* const vertexIndex) const
+{
+	dgAssert (0);
+	return SupportVertex (dir, vertexIndex);
+}
+
+void dgCollisionTiledHeightField::GetVertexListIndexList (const dgVector& p0, const dgVector& p1, dgMeshVertexListIndexList &data) const
+{
+	dgAssert (0);
+	data.m_vertexCount = 0;
+}
+
+void dgCollisionTiledHeightField::DebugCollision (const dgMatrix& matrixPtr, dgCollision::OnDebugCollisionMeshCallback callback, void* const userData) const
+{
+	// only the resident tiles, drawing the whole grid would load all of it
+	dgThreadHiveScopeLock lock (m_world, &m_lock, true);
+	for (dgInt32 i = 0; i < m_residentCount; i ++) {
+		m_tiles[m_residentTiles[i]].m_shape->DebugCollision (matrixPtr, callback, userData);
+	}
+}
@@ -0,0 +1,124 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef __DGCOLLISION_TILED_HEIGHT_FIELD__
+#define __DGCOLLISION_TILED_HEIGHT_FIELD__
+
+#include "dgCollision.h"
+#include "dgCollisionMesh.h"
+#include "dgCollisionHeightField.h"
+
+
+// a height field that does not keep its grid in memory. the grid is split in square tiles that are read
+// on demand with a page callback and kept in a least recently used cache, each resident tile is a
+// regular height field moved to its corner of the grid.
+class dgCollisionTiledHeightField: public dgCollisionMesh
+{
+	public:
+	// copies the elevations and attributes of the grid vertices [x0, x0 + width) x [z0, z0 + height) to the page,
+	// rows are width entries apart. it is called from the worker threads, different tiles can be read at the same time.
+	typedef void (dgApi *OnTiledHeightFieldPageCallback) (void* const userData, dgInt32 x0, dgInt32 z0, dgInt32 width, dgInt32 height, void* const elevation, dgInt8* const atributes);
+
+	// the elevation range must contain all the elevations of the grid, it is the bounding box of the tiles never loaded
+	dgCollisionTiledHeightField (dgWorld* const world, dgInt32 width, dgInt32 height, dgInt32 tileSize, dgInt32 contructionMode,
+								 dgCollisionHeightField::dgElevationType elevationDataType, dgFloat32 verticalScale, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z,
+								 dgFloat32 minElevation, dgFloat32 maxElevation, dgInt32 maxResidentTiles, OnTiledHeightFieldPageCallback pageCallback, void* const pageUserData);
+	// the page callback is not saved, the shape has no tiles until it is set again with SetPageCallback
+	dgCollisionTiledHeightField (dgWorld* const world, dgDeserialize deserialization, void* const userData, dgInt32 revisionNumber);
+
+	virtual ~dgCollisionTiledHeightField(void);
+
+	dgInt32 GetResidentTileCount () const;
+	void SetPageCallback (OnTiledHeightFieldPageCallback pageCallback, void* const pageUserData);
+
+	private:
+	enum dgTileState
+	{
+		m_unloaded,
+		m_loading,
+		m_resident,
+	};
+
+	class dgTile
+	{
+		public:
+		dgCollisionHeightField* m_shape;
+		dgUnsigned64 m_lastUsed;
+		dgFloat32 m_minHeight;
+		dgFloat32 m_maxHeight;
+		dgInt32 m_state;
+	};
+
+	void InitTiles ();
+	dgCollisionHeightField* AcquireTile (dgInt32 tileX, dgInt32 tileZ) const;
+	dgCollisionHeightField* GetResidentTile (dgInt32 tileX, dgInt32 tileZ) const;
+	dgCollisionHeightField* LoadTile (dgInt32 tileX, dgInt32 tileZ) const;
+	void GetTileBox (dgInt32 tileX, dgInt32 tileZ, dgVector& boxP0, dgVector& boxP1) const;
+	void GetTileRange (dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1, dgInt32& tileX0, dgInt32& tileX1, dgInt32& tileZ0, dgInt32& tileZ1) const;
+	dgCollisionHeightField* CreateWindow (dgInt32 x0, dgInt32 x1, dgInt32 z0, dgInt32 z1) const;
+
+	virtual void Serialize(dgSerialize callback, void* const userData) const;
+	virtual void GetCollisionInfo(dgCollisionInfo* const info) const;
+
+	virtual dgFloat32 RayCast (const dgVector& localP0, const dgVector& localP1, dgFloat32 maxT, dgContactPoint& contactOut, const dgBody* const body, void* const userData, OnRayPrecastAction preFilter) const;
+	virtual void GetCollidingFaces (dgPolygonMeshDesc* const data) const;
+
+	virtual dgVector SupportVertex (const dgVector& dir, dgInt32* const vertexIndex) const;
+	virtual dgVector SupportVertexSpecial (const dgVector& dir, dgFloat32 skinThickness, dgInt32* const vertexIndex) const;
+	virtual dgVector SupportVertexSpecialProjectPoint (const dgVector& point, const dgVector& dir) const {return point;};
+
+	virtual void DebugCollision (const dgMatrix& matrixPtr, dgCollision::OnDebugCollisionMeshCallback callback, void* const userData) const;
+	void GetVertexListIndexList (const dgVector& p0, const dgVector& p1, dgMeshVertexListIndexList &data) const;
+	void GetLocalAABB (const dgVector& p0, const dgVector& p1, dgVector& boxP0, dgVector& boxP1) const;
+
+	dgVector m_minBox;
+	dgVector m_maxBox;
+
+	dgWorld* m_world;
+	dgTile* m_tiles;
+	dgInt32* m_residentTiles;
+	void* m_pageUserData;
+	OnTiledHeightFieldPageCallback m_pageCallback;
+	dgCollisionHeightField::dgPerIntanceData* m_instanceData;
+	dgInt32 m_width;
+	dgInt32 m_height;
+	dgInt32 m_tileSize;
+	dgInt32 m_tileCount_x;
+	dgInt32 m_tileCount_z;
+	dgInt32 m_diagonalMode;
+	dgInt32 m_maxResidentTiles;
+	mutable dgInt32 m_residentCount;
+	mutable dgUnsigned64 m_lruClock;
+	dgFloat32 m_minElevation;
+	dgFloat32 m_maxElevation;
+	dgFloat32 m_verticalScale;
+	dgFloat32 m_horizontalScale_x;
+	dgFloat32 m_horizontalScaleInv_x;
+	dgFloat32 m_horizontalScale_z;
+	dgFloat32 m_horizontalScaleInv_z;
+	dgCollisionHeightField::dgElevationType m_elevationDataType;
+	mutable dgThread::dgCriticalSection m_lock;
+
+	static dgVector m_tilePadding;
+	friend class dgCollisionCompound;
+};
+
+#endif
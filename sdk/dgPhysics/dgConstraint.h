@@ -105,6 +105,10 @@ class dgJointAccelerationDecriptor
 	dgFloat32 m_invTimeStep;
 	dgFloat32 m_firstPassCoefFlag;
 	dgJacobianMatrixElement *m_rowMatrix;
+	const dgVector* m_bodyVeloc0;
+	const dgVector* m_bodyOmega0;
+	const dgVector* m_bodyVeloc1;
+	const dgVector* m_bodyOmega1;
 };
 
 
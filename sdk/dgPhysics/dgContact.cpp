@@ -66,7 +66,7 @@ dgContactMaterial::dgContactMaterial()
 }
 
 dgContact::dgContact(dgWorld* const world, const dgContactMaterial* const material)
-	:dgConstraint(), dgList<dgContactMaterial>(world->GetAllocator())
+	:dgConstraint(), dgContactPointList()
 	,m_positAcc (dgFloat32(0.0f))
 	,m_rotationAcc (dgFloat32(1.0f), dgFloat32(0.0f), dgFloat32(0.0f), dgFloat32(0.0f))
 	,m_closestDistance (dgFloat32 (0.0f))
@@ -77,6 +77,7 @@ dgContact::dgContact(dgWorld* const world, const dgContactMaterial* const materi
 	,m_contactNode(NULL)
 	,m_contactPruningTolereance(world->GetContactMergeTolerance())
 	,m_broadphaseLru(0)
+	,m_simplexCount(0)
 	,m_isNewContact(1)
 	,m_skeletonSelfCollision(1)
 {
@@ -87,7 +88,7 @@ dgContact::dgContact(dgWorld* const world, const dgContactMaterial* const materi
 }
 
 dgContact::dgContact(dgContact* const clone)
-	:dgConstraint(*clone), dgList<dgContactMaterial>(clone->GetAllocator())
+	:dgConstraint(*clone), dgContactPointList()
 	,m_positAcc(clone->m_positAcc)
 	,m_rotationAcc(clone->m_rotationAcc)
 	,m_separtingVector (clone->m_separtingVector)
@@ -99,6 +100,7 @@ dgContact::dgContact(dgContact* const clone)
 	,m_contactNode(clone->m_contactNode)
 	,m_contactPruningTolereance(clone->m_contactPruningTolereance)
 	,m_broadphaseLru(clone->m_broadphaseLru)
+	,m_simplexCount(clone->m_simplexCount)
 	,m_isNewContact(clone->m_isNewContact)
 	,m_skeletonSelfCollision(0)
 {
@@ -109,12 +111,16 @@ dgContact::dgContact(dgContact* const clone)
 	m_constId = m_contactConstraint;
 	m_contactActive = clone->m_contactActive;
 	m_enableCollision = clone->m_enableCollision;
-	Merge (*clone);
+	for (dgInt32 i = 0; i < m_simplexCount; i ++) {
+		m_simplex0[i] = clone->m_simplex0[i];
+		m_simplex1[i] = clone->m_simplex1[i];
+	}
+	Copy (*clone);
 }
 
 dgContact::~dgContact()
 {
-	dgList<dgContactMaterial>::RemoveAll();
+	dgContactPointList::RemoveAll();
 
 	if (m_contactNode) {
 		dgActiveContacts* const activeContacts = m_world;
@@ -133,6 +139,7 @@ void dgContact::SwapBodies()
 {
 	dgSwap (m_body0, m_body1);
 	dgSwap (m_link0, m_link1);
+	m_simplexCount = 0;
 }
 
 
@@ -180,7 +187,7 @@ dgUnsigned32 dgContact::JacobianDerivative (dgContraintDescritor& params)
 	if (m_maxDOF) {
 		dgInt32 i = 0;
 		frictionIndex = GetCount();
-		for (dgList<dgContactMaterial>::dgListNode* node = GetFirst(); node; node = node->GetNext()) {
+		for (dgContactPointList::dgListNode* node = GetFirst(); node; node = node->GetNext()) {
 			const dgContactMaterial& contact = node->GetInfo(); 
 			JacobianContactDerivative (params, contact, i, frictionIndex);
 			i ++;
@@ -303,10 +310,10 @@ void dgContact::JacobianContactDerivative (dgContraintDescritor& params, const d
 void dgContact::JointAccelerations(dgJointAccelerationDecriptor* const params)
 {
 	dgJacobianMatrixElement* const rowMatrix = params->m_rowMatrix;
-	const dgVector& bodyVeloc0 = m_body0->m_veloc;
-	const dgVector& bodyOmega0 = m_body0->m_omega;
-	const dgVector& bodyVeloc1 = m_body1->m_veloc;
-	const dgVector& bodyOmega1 = m_body1->m_omega;
+	const dgVector& bodyVeloc0 = *params->m_bodyVeloc0;
+	const dgVector& bodyOmega0 = *params->m_bodyOmega0;
+	const dgVector& bodyVeloc1 = *params->m_bodyVeloc1;
+	const dgVector& bodyOmega1 = *params->m_bodyOmega1;
 
 	const dgInt32 count = params->m_rowsCount;
 
@@ -35,6 +35,7 @@ class dgCollisionInstance;
 
 
 #define DG_MAX_CONTATCS					128
+#define DG_MAX_CONTACT_POINTS			(DG_CONSTRAINT_MAX_ROWS / 3)
 #define DG_RESTING_CONTACT_PENETRATION	(DG_PENETRATION_TOL + dgFloat32 (1.0f / 1024.0f))
 
 class dgActiveContacts: public dgList<dgContact*>
@@ -174,8 +175,49 @@ class dgContactMaterial: public dgContactPoint
 }DG_GCC_VECTOR_ALIGMENT;
 
 
+// fixed capacity list of contact points stored inside the contact joint, 
+// it has the dgList interface so that node pointers given to the application stay valid
+class dgContactPointList
+{
+	public:
+	DG_MSC_VECTOR_ALIGMENT 
+	class dgListNode
+	{
+		public:
+		dgContactMaterial& GetInfo();
+		const dgContactMaterial& GetInfo() const;
+		dgListNode* GetNext() const;
+		dgListNode* GetPrev() const;
+
+		private:
+		dgContactMaterial m_info;
+		dgListNode* m_next;
+		dgListNode* m_prev;
+		friend class dgContactPointList;
+	} DG_GCC_VECTOR_ALIGMENT;
+
+	dgContactPointList();
+
+	dgInt32 GetCount() const;
+	dgListNode* GetFirst() const;
+	dgListNode* GetLast() const;
+
+	dgListNode* Append ();
+	void Remove (dgListNode* const node);
+	void RemoveAll ();
+	void Copy (const dgContactPointList& src);
+
+	private:
+	dgListNode* m_first;
+	dgListNode* m_last;
+	dgListNode* m_freeList;
+	dgInt32 m_count;
+	dgListNode m_pool[DG_MAX_CONTACT_POINTS];
+};
+
+
 DG_MSC_VECTOR_ALIGMENT 
-class dgContact: public dgConstraint, public dgList<dgContactMaterial>
+class dgContact: public dgConstraint, public dgContactPointList
 {
 	public:
     dgFloat32 GetClosestDistance() const;
@@ -211,6 +253,10 @@ class dgContact: public dgConstraint, public dgList<dgContactMaterial>
 	dgVector m_positAcc;
 	dgQuaternion m_rotationAcc;
 	dgVector m_separtingVector;
+	// last separating simplex of the closest distance solver, saved as the support point
+	// of each shape in its local space, it seeds the solver on the next update.
+	dgVector m_simplex0[3];
+	dgVector m_simplex1[3];
 	dgFloat32 m_closestDistance;
 	dgFloat32 m_separationDistance;
 	dgFloat32 m_timeOfImpact;
@@ -219,6 +265,7 @@ class dgContact: public dgConstraint, public dgList<dgContactMaterial>
 	dgActiveContacts::dgListNode* m_contactNode;
 	dgFloat32 m_contactPruningTolereance;
 	dgUnsigned32 m_broadphaseLru;
+	dgInt32 m_simplexCount;
 	dgUnsigned32 m_isNewContact				: 1;
 	dgUnsigned32 m_skeletonSelfCollision	: 1;
 
@@ -236,6 +283,105 @@ class dgContact: public dgConstraint, public dgList<dgContactMaterial>
 	friend class dgCollidingPairCollector;
 }DG_GCC_VECTOR_ALIGMENT;
 
+inline dgContactMaterial& dgContactPointList::dgListNode::GetInfo()
+{
+	return m_info;
+}
+
+inline const dgContactMaterial& dgContactPointList::dgListNode::GetInfo() const
+{
+	return m_info;
+}
+
+inline dgContactPointList::dgListNode* dgContactPointList::dgListNode::GetNext() const
+{
+	return m_next;
+}
+
+inline dgContactPointList::dgListNode* dgContactPointList::dgListNode::GetPrev() const
+{
+	return m_prev;
+}
+
+inline dgContactPointList::dgContactPointList()
+{
+	RemoveAll();
+}
+
+inline dgInt32 dgContactPointList::GetCount() const
+{
+	return m_count;
+}
+
+inline dgContactPointList::dgListNode* dgContactPointList::GetFirst() const
+{
+	return m_first;
+}
+
+inline dgContactPointList::dgListNode* dgContactPointList::GetLast() const
+{
+	return m_last;
+}
+
+inline dgContactPointList::dgListNode* dgContactPointList::Append ()
+{
+	dgAssert (m_freeList);
+	dgListNode* const node = m_freeList;
+	m_freeList = node->m_next;
+
+	new (&node->m_info) dgContactMaterial();
+	node->m_next = NULL;
+	node->m_prev = m_last;
+	if (m_last) {
+		m_last->m_next = node;
+	} else {
+		m_first = node;
+	}
+	m_last = node;
+	m_count ++;
+	return node;
+}
+
+inline void dgContactPointList::Remove (dgListNode* const node)
+{
+	dgAssert (m_count);
+	dgAssert ((node >= m_pool) && (node < &m_pool[DG_MAX_CONTACT_POINTS]));
+	if (node->m_prev) {
+		node->m_prev->m_next = node->m_next;
+	} else {
+		m_first = node->m_next;
+	}
+	if (node->m_next) {
+		node->m_next->m_prev = node->m_prev;
+	} else {
+		m_last = node->m_prev;
+	}
+	node->m_prev = NULL;
+	node->m_next = m_freeList;
+	m_freeList = node;
+	m_count --;
+}
+
+inline void dgContactPointList::RemoveAll ()
+{
+	m_first = NULL;
+	m_last = NULL;
+	m_count = 0;
+	m_freeList = m_pool;
+	for (dgInt32 i = 0; i < DG_MAX_CONTACT_POINTS - 1; i ++) {
+		m_pool[i].m_next = &m_pool[i + 1];
+	}
+	m_pool[DG_MAX_CONTACT_POINTS - 1].m_next = NULL;
+}
+
+inline void dgContactPointList::Copy (const dgContactPointList& src)
+{
+	RemoveAll();
+	for (dgListNode* node = src.GetFirst(); node; node = node->GetNext()) {
+		Append()->m_info = node->m_info;
+	}
+}
+
 inline void dgContactMaterial::SetCollisionCallback (OnAABBOverlap aabbOverlap, OnContactCallback contact) 
 {
 	m_aabbOverlap = aabbOverlap;
@@ -1404,17 +1404,86 @@ dgInt32 dgContactSolver::CalculateConvexCastContacts()
 }
 
 
-dgInt32 dgContactSolver::CalculateConvexToConvexContacts ()
+DG_INLINE void dgContactSolver::LoadSimplex()
+{
+	// the saved points are still points of each shape, so the simplex is still inside the minkowski 
+	// difference and it is a valid starting point, but some may have collapsed after the bodies moved.
+	const dgContact* const contact = m_proxy->m_contactJoint;
+	const dgMatrix& matrix0 = m_instance0->m_globalMatrix;
+	const dgMatrix& matrix1 = m_instance1->m_globalMatrix;
+	m_vertexIndex = 0;
+	for (dgInt32 i = 0; i < contact->m_simplexCount; i ++) {
+		const dgVector p (matrix0.TransformVector(contact->m_simplex0[i]) & dgVector::m_triplexMask);
+		const dgVector q (matrix1.TransformVector(contact->m_simplex1[i]) & dgVector::m_triplexMask);
+		const dgVector diff (p - q);
+		bool isDegenerated = false;
+		if (m_vertexIndex == 1) {
+			const dgVector e10 (diff - m_hullDiff[0]);
+			isDegenerated = e10.DotProduct3(e10) < DG_MINK_VERTEX_ERR2;
+		} else if (m_vertexIndex == 2) {
+			const dgVector normal ((m_hullDiff[1] - m_hullDiff[0]).CrossProduct3(diff - m_hullDiff[0]));
+			isDegenerated = normal.DotProduct3(normal) < (DG_MINK_VERTEX_ERR2 * DG_MINK_VERTEX_ERR2);
+		}
+		if (!isDegenerated) {
+			m_hullDiff[m_vertexIndex] = diff;
+			m_hullSum[m_vertexIndex] = p + q;
+			m_vertexIndex ++;
+		}
+	}
+}
+
+DG_INLINE void dgContactSolver::SaveSimplex(bool colliding) const
+{
+	dgContact* const contact = m_proxy->m_contactJoint;
+	contact->m_simplexCount = 0;
+	if (colliding) {
+		dgAssert ((m_vertexIndex > 0) && (m_vertexIndex <= 3));
+		const dgMatrix& matrix0 = m_instance0->m_globalMatrix;
+		const dgMatrix& matrix1 = m_instance1->m_globalMatrix;
+		for (dgInt32 i = 0; i < m_vertexIndex; i ++) {
+			const dgVector p ((m_hullSum[i] + m_hullDiff[i]).Scale4 (dgFloat32 (0.5f)));
+			const dgVector q ((m_hullSum[i] - m_hullDiff[i]).Scale4 (dgFloat32 (0.5f)));
+			contact->m_simplex0[i] = matrix0.UntransformVector(p);
+			contact->m_simplex1[i] = matrix1.UntransformVector(q);
+		}
+		contact->m_simplexCount = m_vertexIndex;
+	}
+}
+
+dgInt32 dgContactSolver::CalculateConvexToConvexContacts (bool warmStart)
+{
+	// a warm start reuses the simplex of the last update, the contact must be for the same two shapes
+	if (warmStart) {
+		LoadSimplex();
+	}
+	bool colliding = CalculateClosestPoints();
+	if (warmStart) {
+		SaveSimplex(colliding);
+	}
+	return CalculateContactsFromClosestPoints (colliding);
+}
+
+dgInt32 dgContactSolver::CalculatePrimitiveContacts (const dgVector& point0, const dgVector& point1, const dgVector& normal)
+{
+	// the closest features were found in closed form, only the contact manifold is left to calculate
+	dgAssert (normal.m_w == dgFloat32 (0.0f));
+	dgAssert (dgAbs (normal.DotProduct4(normal).GetScalar() - dgFloat32 (1.0f)) < dgFloat32 (1.0e-3f));
+	m_normal = normal;
+	m_closestPoint0 = point0;
+	m_closestPoint1 = point1;
+	m_proxy->m_contactJoint->m_separtingVector = normal;
+	return CalculateContactsFromClosestPoints (true);
+}
+
+dgInt32 dgContactSolver::CalculateContactsFromClosestPoints (bool colliding)
 {
 	dgInt32 count = 0;
 	if (m_proxy->m_intersectionTestOnly) {
-		CalculateClosestPoints();
 		dgFloat32 penetration = m_normal.DotProduct4(m_closestPoint1 - m_closestPoint0).GetScalar() - m_proxy->m_skinThickness - DG_PENETRATION_TOL;
 		dgInt32 retVal = (penetration <= dgFloat32(0.0f)) ? -1 : 0;
 		m_proxy->m_contactJoint->m_contactActive = retVal;
 		return retVal;
 	} else {
-		bool colliding = CalculateClosestPoints();
 		if (colliding) { 
 			dgFloat32 penetration = m_normal.DotProduct4(m_closestPoint1 - m_closestPoint0).GetScalar() - m_proxy->m_skinThickness - DG_PENETRATION_TOL;
 			if (penetration <= dgFloat32(1.0e-5f)) {
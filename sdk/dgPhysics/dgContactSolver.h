@@ -58,7 +58,8 @@ class dgContactSolver: public dgDownHeap<dgMinkFace *, dgFloat32>
 
 	bool CalculateClosestPoints();
 	dgInt32 CalculateConvexCastContacts();
-	dgInt32 CalculateConvexToConvexContacts();
+	dgInt32 CalculateConvexToConvexContacts(bool warmStart = false);
+	dgInt32 CalculatePrimitiveContacts(const dgVector& point0, const dgVector& point1, const dgVector& normal);
 	dgFloat32 RayCast (const dgVector& localP0, const dgVector& localP1, dgFloat32 maxT, dgContactPoint& contactOut);
 
 	const dgVector& GetNormal() const {return m_normal;}
@@ -87,6 +88,8 @@ class dgContactSolver: public dgDownHeap<dgMinkFace *, dgFloat32>
 	DG_INLINE void SupportVertex(const dgVector& dir, dgInt32 vertexIndex);
 	
 	DG_INLINE void TranslateSimplex(const dgVector& step);
+	DG_INLINE void LoadSimplex();
+	DG_INLINE void SaveSimplex(bool colliding) const;
 	
 	DG_INLINE void CalculateContactFromFeacture(dgInt32 featureType);
 	DG_INLINE dgPerimenterEdge* ReduceContacts(dgPerimenterEdge* poly, dgInt32 maxCount) const;
@@ -99,6 +102,7 @@ class dgContactSolver: public dgDownHeap<dgMinkFace *, dgFloat32>
 	dgInt32 ConvexPolygonsIntersection(const dgVector& normal, dgInt32 count1, dgVector* const shape1, dgInt32 count2, dgVector* const shape2, dgVector* const contactOut, dgInt32 maxContacts) const;
 	dgInt32 ConvexPolygonToLineIntersection(const dgVector& normal, dgInt32 count1, dgVector* const shape1, dgInt32 count2, dgVector* const shape2, dgVector* const contactOut, dgVector* const mem) const;
 	dgInt32 CalculateContacts (const dgVector& point0, const dgVector& point1, const dgVector& normal);
+	dgInt32 CalculateContactsFromClosestPoints (bool colliding);
 	dgInt32 CalculateClosestSimplex ();
 	dgInt32 CalculateIntersectingPlane(dgInt32 count);
 
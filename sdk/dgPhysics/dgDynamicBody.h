@@ -197,11 +197,22 @@ DG_INLINE void dgDynamicBody::AddTorque (const dgVector& torque)
 DG_INLINE void dgDynamicBody::SetForce (const dgVector& force)
 {
 	m_externalForce = force;
+	if (m_activeIndex < 0) {
+		// a body out of the active list does not get its force callback, so a force set from outside wakes it up
+		m_sleeping = false;
+		m_equilibrium = false;
+		Activate();
+	}
 }
 
 DG_INLINE void dgDynamicBody::SetTorque (const dgVector& torque)
 {
 	m_externalTorque = torque;
+	if (m_activeIndex < 0) {
+		m_sleeping = false;
+		m_equilibrium = false;
+		Activate();
+	}
 }
 
 
@@ -224,6 +235,7 @@ DG_INLINE dgBody::OnApplyExtForceAndTorque dgDynamicBody::GetExtForceAndTorqueCa
 DG_INLINE void dgDynamicBody::SetExtForceAndTorqueCallback (OnApplyExtForceAndTorque callback)
 {
 	m_applyExtForces = callback;
+	Activate();
 }
 
 DG_INLINE dgSkeletonContainer* dgDynamicBody::GetSkeleton() const
@@ -45,6 +45,7 @@
 #include "dgCollisionConvexPolygon.h"
 #include "dgCollisionDeformableMesh.h"
 #include "dgCollisionChamferCylinder.h"
+#include "dgCollisionTiledHeightField.h"
 #include "dgCollisionCompoundFractured.h"
 #include "dgCollisionDeformableSolidMesh.h"
 #include "dgCollisionMassSpringDamperSystem.h"
@@ -315,6 +316,20 @@ dgCollisionInstance* dgWorld::CreateHeightField(
 	return instance;
 }
 
+dgCollisionInstance* dgWorld::CreateTiledHeightField(
+	dgInt32 width, dgInt32 height, dgInt32 tileSize, dgInt32 contructionMode, dgInt32 elevationDataType, 
+	dgFloat32 verticalScale, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z, dgFloat32 minElevation, dgFloat32 maxElevation, 
+	dgInt32 maxResidentTiles, dgCollisionTiledHeightField::OnTiledHeightFieldPageCallback pageCallback, void* const pageUserData)
+{
+	dgCollision* const collision = new  (m_allocator) dgCollisionTiledHeightField (this, width, height, tileSize, contructionMode, 
+																				   elevationDataType ? dgCollisionHeightField::m_unsigned16Bit : dgCollisionHeightField::m_float32Bit, 
+																				   verticalScale, horizontalScale_x, horizontalScale_z, minElevation, maxElevation, 
+																				   maxResidentTiles, pageCallback, pageUserData);
+	dgCollisionInstance* const instance = CreateInstance (collision, 0, dgGetIdentityMatrix()); 
+	collision->Release();
+	return instance;
+}
+
 dgCollisionInstance* dgWorld::CreateInstance (const dgCollision* const child, dgInt32 shapeID, const dgMatrix& offsetMatrix)
 {
 	dgAssert (dgAbs (offsetMatrix[0].DotProduct3(offsetMatrix[0]) - dgFloat32 (1.0f)) < dgFloat32 (1.0e-5f));
@@ -723,11 +738,11 @@ void dgWorld::ProcessCachedContacts (dgContact* const contact, dgFloat32 timeste
 	dgAssert (contact->m_material);
 	dgAssert (contact->m_body0 != contact->m_body1);
 
-	dgList<dgContactMaterial>& list = *contact;
+	dgContactPointList& list = *contact;
 	const dgContactMaterial* const material = contact->m_material;
 
-	dgList<dgContactMaterial>::dgListNode* nextContactNode;
-	for (dgList<dgContactMaterial>::dgListNode *contactNode = list.GetFirst(); contactNode; contactNode = nextContactNode) {
+	dgContact::dgListNode* nextContactNode;
+	for (dgContact::dgListNode *contactNode = list.GetFirst(); contactNode; contactNode = nextContactNode) {
 		nextContactNode = contactNode->GetNext();
 		dgContactMaterial& contactMaterial = contactNode->GetInfo();
 
@@ -775,15 +790,15 @@ void dgWorld::PopulateContacts (dgBroadPhase::dgPair* const pair, dgInt32 thread
 	const dgContactPoint* const contactArray = pair->m_contactBuffer;
 
 	dgInt32 contactCount = pair->m_contactCount;
-	dgList<dgContactMaterial>& list = *contact;
+	dgContactPointList& list = *contact;
 
 	contact->m_timeOfImpact = pair->m_timestep;
 
 	dgInt32 count = 0;
 	dgVector cachePosition [DG_MAX_CONTATCS];
-	dgList<dgContactMaterial>::dgListNode *nodes[DG_MAX_CONTATCS];
+	dgContact::dgListNode *nodes[DG_MAX_CONTATCS];
 
-	for (dgList<dgContactMaterial>::dgListNode *contactNode = list.GetFirst(); contactNode; contactNode = contactNode->GetNext()) {
+	for (dgContact::dgListNode *contactNode = list.GetFirst(); contactNode; contactNode = contactNode->GetNext()) {
 
 		nodes[count] = contactNode;
 		cachePosition[count] = contactNode->GetInfo().m_point;
@@ -827,7 +842,7 @@ void dgWorld::PopulateContacts (dgBroadPhase::dgPair* const pair, dgInt32 thread
 //	dgFloat32 breakImpulse1 = dgFloat32 (0.0f);
 	for (dgInt32 i = 0; i < contactCount; i ++) {
 
-		dgList<dgContactMaterial>::dgListNode* contactNode = NULL;
+		dgContact::dgListNode* contactNode = NULL;
 		dgFloat32 min = dgFloat32 (1.0e20f);
 		dgInt32 index = -1;
 		for (dgInt32 j = 0; j < count; j ++) {
@@ -846,9 +861,7 @@ void dgWorld::PopulateContacts (dgBroadPhase::dgPair* const pair, dgInt32 thread
 			nodes[index] = nodes[count];
 			cachePosition[index] = cachePosition[count];
 		} else {
-			GlobalLock(false);
 			contactNode = list.Append ();
-			GlobalUnlock();
 		}
 
 		dgContactMaterial* const contactMaterial = &contactNode->GetInfo();
@@ -942,11 +955,9 @@ void dgWorld::PopulateContacts (dgBroadPhase::dgPair* const pair, dgInt32 thread
 	}
 
 	if (count) {
-		GlobalLock(false);
 		for (dgInt32 i = 0; i < count; i ++) {
 			list.Remove(nodes[i]);
 		}
-		GlobalUnlock();
 	}
 
 	contact->m_maxDOF = dgUnsigned32 (3 * contact->GetCount());
@@ -1437,6 +1448,598 @@ dgInt32 dgWorld::CalculateUserContacts(dgCollisionParamProxy& proxy) const
 }
  
 
+// closed form closest features for the primitive pairs that make most of the dynamics shapes.
+// all functions return the points on each shape and the normal pointing from shape0 to shape1,
+// or false when the configuration is degenerated or separated in a way the closed form can not
+// measure exactly, in which case the pair is resolved by the generic solver.
+static bool CalculateSphereToSphereClosestPoints (const dgVector& center0, dgFloat32 radius0, const dgVector& center1, dgFloat32 radius1, dgVector& point0, dgVector& point1, dgVector& normal)
+{
+	const dgVector dir ((center1 - center0) & dgVector::m_triplexMask);
+	const dgFloat32 mag2 = dir.DotProduct4(dir).GetScalar();
+	if (mag2 < dgFloat32 (1.0e-12f)) {
+		return false;
+	}
+	normal = dir.Scale4 (dgRsqrt (mag2));
+	point0 = center0 + normal.Scale4 (radius0);
+	point1 = center1 - normal.Scale4 (radius1);
+	return true;
+}
+
+static bool CalculateSphereToCapsuleClosestPoints (const dgVector& center0, dgFloat32 radius0, const dgVector& p1, const dgVector& q1, dgFloat32 radius1, dgVector& point0, dgVector& point1, dgVector& normal)
+{
+	const dgVector segment ((q1 - p1) & dgVector::m_triplexMask);
+	const dgFloat32 den = segment.DotProduct4(segment).GetScalar();
+	dgAssert (den > dgFloat32 (0.0f));
+	const dgFloat32 t = dgClamp (segment.DotProduct4(center0 - p1).GetScalar() / den, dgFloat32 (0.0f), dgFloat32 (1.0f));
+	const dgVector center1 (p1 + segment.Scale4 (t));
+	return CalculateSphereToSphereClosestPoints (center0, radius0, center1, radius1, point0, point1, normal);
+}
+
+static bool CalculateCapsuleToCapsuleClosestPoints (const dgVector& p0, const dgVector& q0, dgFloat32 radius0, const dgVector& p1, const dgVector& q1, dgFloat32 radius1, dgVector& point0, dgVector& point1, dgVector& normal)
+{
+	dgVector center0;
+	dgVector center1;
+	dgRayToRayDistance (p0, q0, p1, q1, center0, center1);
+	return CalculateSphereToSphereClosestPoints (center0, radius0, center1, radius1, point0, point1, normal);
+}
+
+static bool CalculateSphereToBoxClosestPoints (const dgVector& center0, dgFloat32 radius0, const dgMatrix& matrix1, const dgVector& size1, dgVector& point0, dgVector& point1, dgVector& normal)
+{
+	const dgVector center (matrix1.UntransformVector (center0));
+	const dgVector clamped (center.GetMax (size1.Scale4 (dgFloat32 (-1.0f))).GetMin (size1));
+	const dgVector dir (clamped - center);
+	const dgFloat32 mag2 = dir.DotProduct4(dir).GetScalar();
+	if (mag2 > dgFloat32 (1.0e-12f)) {
+		// the center is outside the box, the closest feature is the clamped point
+		normal = matrix1.RotateVector (dir.Scale4 (dgRsqrt (mag2)));
+		point1 = matrix1.TransformVector (clamped);
+	} else {
+		// the center is inside the box, push it out through the closest face
+		dgInt32 index = 0;
+		dgFloat32 minDist = size1[0] - dgAbs (center[0]);
+		for (dgInt32 i = 1; i < 3; i ++) {
+			const dgFloat32 dist = size1[i] - dgAbs (center[i]);
+			if (dist < minDist) {
+				minDist = dist;
+				index = i;
+			}
+		}
+		dgVector faceNormal (dgVector::m_zero);
+		dgVector facePoint (center);
+		faceNormal[index] = (center[index] >= dgFloat32 (0.0f)) ? dgFloat32 (-1.0f) : dgFloat32 (1.0f);
+		facePoint[index] = - size1[index] * faceNormal[index];
+		normal = matrix1.RotateVector (faceNormal);
+		point1 = matrix1.TransformVector (facePoint);
+	}
+	point0 = center0 + normal.Scale4 (radius0);
+	point1 -= normal.Scale4 (DG_PENETRATION_TOL);
+	return true;
+}
+
+static bool CalculateCapsuleToBoxClosestPoints (const dgVector& p0, const dgVector& q0, dgFloat32 radius0, const dgMatrix& matrix1, const dgVector& size1, dgVector& point0, dgVector& point1, dgVector& normal)
+{
+	// separating axis test of the capsule segment against the box in the space of the box,
+	// the candidates are the box faces, the segment crossed with the box edges, the directions
+	// from the box to each end of the segment and from each box corner to the segment.
+	const dgVector p (matrix1.UntransformVector (p0));
+	const dgVector q (matrix1.UntransformVector (q0));
+	const dgVector segment (q - p);
+	const dgFloat32 segmentMag2 = segment.DotProduct4(segment).GetScalar();
+	dgAssert (segmentMag2 > dgFloat32 (0.0f));
+
+	dgVector axis[16];
+	axis[0] = dgVector (dgFloat32 (1.0f), dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+	axis[1] = dgVector (dgFloat32 (0.0f), dgFloat32 (1.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+	axis[2] = dgVector (dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (1.0f), dgFloat32 (0.0f));
+	dgInt32 axisCount = 3;
+	for (dgInt32 i = 0; i < 3; i ++) {
+		const dgVector dir (segment.CrossProduct3 (axis[i]));
+		const dgFloat32 mag2 = dir.DotProduct4(dir).GetScalar();
+		if (mag2 > (segmentMag2 * dgFloat32 (1.0e-12f))) {
+			axis[axisCount] = dir.Scale4 (dgRsqrt (mag2));
+			axisCount ++;
+		}
+	}
+	const dgVector* const ends[] = {&p, &q};
+	for (dgInt32 i = 0; i < 2; i ++) {
+		const dgVector& point = *ends[i];
+		const dgVector dir (point - point.GetMax (size1.Scale4 (dgFloat32 (-1.0f))).GetMin (size1));
+		const dgFloat32 mag2 = dir.DotProduct4(dir).GetScalar();
+		if (mag2 > dgFloat32 (1.0e-12f)) {
+			axis[axisCount] = dir.Scale4 (dgRsqrt (mag2));
+			axisCount ++;
+		}
+	}
+	for (dgInt32 i = 0; i < 8; i ++) {
+		const dgVector corner ((i & 1) ? size1.m_x : -size1.m_x, (i & 2) ? size1.m_y : -size1.m_y, (i & 4) ? size1.m_z : -size1.m_z, dgFloat32 (0.0f));
+		const dgFloat32 t = dgClamp (segment.DotProduct4(corner - p).GetScalar() / segmentMag2, dgFloat32 (0.0f), dgFloat32 (1.0f));
+		const dgVector dir (p + segment.Scale4 (t) - corner);
+		const dgFloat32 mag2 = dir.DotProduct4(dir).GetScalar();
+		if (mag2 > dgFloat32 (1.0e-12f)) {
+			axis[axisCount] = dir.Scale4 (dgRsqrt (mag2));
+			axisCount ++;
+		}
+	}
+
+	dgVector bestAxis (axis[0]);
+	dgFloat32 bestSeparation = dgFloat32 (-1.0e10f);
+	for (dgInt32 i = 0; i < axisCount; i ++) {
+		const dgVector& dir = axis[i];
+		const dgFloat32 boxRadius = size1.DotProduct4(dir.Abs()).GetScalar();
+		const dgFloat32 dist0 = dir.DotProduct4(p).GetScalar();
+		const dgFloat32 dist1 = dir.DotProduct4(q).GetScalar();
+		const dgFloat32 separation0 = - boxRadius - dgMax (dist0, dist1) - radius0 - DG_PENETRATION_TOL;
+		const dgFloat32 separation1 = dgMin (dist0, dist1) - radius0 - boxRadius - DG_PENETRATION_TOL;
+		if (separation0 > bestSeparation) {
+			bestSeparation = separation0;
+			bestAxis = dir;
+		}
+		if (separation1 > bestSeparation) {
+			bestSeparation = separation1;
+			bestAxis = dir.Scale4 (dgFloat32 (-1.0f));
+		}
+	}
+
+	if (bestSeparation > dgFloat32 (0.0f)) {
+		// the axis test only bounds the distance of separated shapes, let the generic solver find it
+		return false;
+	}
+
+	const dgVector& end = (bestAxis.DotProduct4(p).GetScalar() > bestAxis.DotProduct4(q).GetScalar()) ? p : q;
+	const dgVector support ((size1 & (bestAxis < dgVector::m_zero)) - (size1 & (bestAxis > dgVector::m_zero)));
+	normal = matrix1.RotateVector (bestAxis);
+	point0 = matrix1.TransformVector (end + bestAxis.Scale4 (radius0));
+	point1 = matrix1.TransformVector (support) - normal.Scale4 (DG_PENETRATION_TOL);
+	return true;
+}
+
+static bool CalculateBoxToBoxClosestPoints (const dgMatrix& matrix0, const dgVector& size0, const dgMatrix& matrix1, const dgVector& size1, dgVector& point0, dgVector& point1, dgVector& normal)
+{
+	// separating axis test in the space of box0, the candidates are the faces of each box
+	// and the cross product of each pair of edges.
+	const dgMatrix matrix (matrix1 * matrix0.Inverse());
+	const dgVector origin (matrix.m_posit & dgVector::m_triplexMask);
+
+	dgVector axis[15];
+	axis[0] = dgVector (dgFloat32 (1.0f), dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+	axis[1] = dgVector (dgFloat32 (0.0f), dgFloat32 (1.0f), dgFloat32 (0.0f), dgFloat32 (0.0f));
+	axis[2] = dgVector (dgFloat32 (0.0f), dgFloat32 (0.0f), dgFloat32 (1.0f), dgFloat32 (0.0f));
+	axis[3] = matrix[0];
+	axis[4] = matrix[1];
+	axis[5] = matrix[2];
+	dgInt32 axisCount = 6;
+	for (dgInt32 i = 0; i < 3; i ++) {
+		for (dgInt32 j = 0; j < 3; j ++) {
+			const dgVector dir (axis[i].CrossProduct3 (matrix[j]));
+			const dgFloat32 mag2 = dir.DotProduct4(dir).GetScalar();
+			if (mag2 > dgFloat32 (1.0e-12f)) {
+				axis[axisCount] = dir.Scale4 (dgRsqrt (mag2));
+				axisCount ++;
+			}
+		}
+	}
+
+	dgVector bestAxis (axis[0]);
+	dgFloat32 bestSeparation = dgFloat32 (-1.0e10f);
+	for (dgInt32 i = 0; i < axisCount; i ++) {
+		const dgVector& dir = axis[i];
+		const dgFloat32 radius0 = size0.DotProduct4(dir.Abs()).GetScalar();
+		const dgFloat32 radius1 = size1.DotProduct4(matrix.UnrotateVector (dir).Abs()).GetScalar();
+		const dgFloat32 dist = dir.DotProduct4(origin).GetScalar();
+		const dgFloat32 separation = dgAbs (dist) - radius0 - radius1 - DG_PENETRATION_TOL * dgFloat32 (2.0f);
+		if (separation > bestSeparation) {
+			bestSeparation = separation;
+			bestAxis = (dist >= dgFloat32 (0.0f)) ? dir : dir.Scale4 (dgFloat32 (-1.0f));
+		}
+	}
+
+	if (bestSeparation > dgFloat32 (0.0f)) {
+		// the axis test only bounds the distance of separated shapes, let the generic solver find it
+		return false;
+	}
+
+	const dgVector localAxis (matrix.UnrotateVector (bestAxis));
+	const dgVector support0 ((size0 & (bestAxis > dgVector::m_zero)) - (size0 & (bestAxis < dgVector::m_zero)));
+	const dgVector support1 ((size1 & (localAxis < dgVector::m_zero)) - (size1 & (localAxis > dgVector::m_zero)));
+	normal = matrix0.RotateVector (bestAxis);
+	point0 = matrix0.TransformVector (support0) + normal.Scale4 (DG_PENETRATION_TOL);
+	point1 = matrix1.TransformVector (support1) - normal.Scale4 (DG_PENETRATION_TOL);
+	return true;
+}
+
+bool dgWorld::CalculatePrimitiveClosestPoints (const dgCollisionInstance* const instance0, const dgCollisionInstance* const instance1, dgVector& point0, dgVector& point1, dgVector& normal) const
+{
+	if ((instance0->GetScaleType() > dgCollisionInstance::m_uniform) || (instance1->GetScaleType() > dgCollisionInstance::m_uniform)) {
+		return false;
+	}
+
+	const dgCollisionID type0 = instance0->GetCollisionPrimityType();
+	const dgCollisionID type1 = instance1->GetCollisionPrimityType();
+	if (type0 > type1) {
+		const bool found = CalculatePrimitiveClosestPoints (instance1, instance0, point1, point0, normal);
+		normal = normal.Scale4 (dgFloat32 (-1.0f));
+		return found;
+	}
+
+	// use the same shapes the generic solver sees, spheres and capsules lose the penetration
+	// tolerance from the radius and boxes are shrunk by it and rounded back along the normal.
+	const dgVector padding (dgVector (DG_PENETRATION_TOL) & dgVector::m_triplexMask);
+	const dgMatrix& matrix0 = instance0->GetGlobalMatrix();
+	const dgMatrix& matrix1 = instance1->GetGlobalMatrix();
+	const dgFloat32 scale0 = instance0->GetScale().m_x;
+	const dgFloat32 scale1 = instance1->GetScale().m_x;
+	switch (type0)
+	{
+		case m_sphereCollision:
+		{
+			const dgCollisionSphere* const sphere0 = (dgCollisionSphere*)instance0->GetChildShape();
+			const dgFloat32 radius0 = (sphere0->m_radius - DG_PENETRATION_TOL) * scale0;
+			switch (type1)
+			{
+				case m_sphereCollision:
+				{
+					const dgCollisionSphere* const sphere1 = (dgCollisionSphere*)instance1->GetChildShape();
+					const dgFloat32 radius1 = (sphere1->m_radius - DG_PENETRATION_TOL) * scale1;
+					return CalculateSphereToSphereClosestPoints (matrix0.m_posit, radius0, matrix1.m_posit, radius1, point0, point1, normal);
+				}
+
+				case m_capsuleCollision:
+				{
+					const dgCollisionCapsule* const capsule1 = (dgCollisionCapsule*)instance1->GetChildShape();
+					if (capsule1->m_radio0 == capsule1->m_radio1) {
+						const dgFloat32 radius1 = (capsule1->m_radio0 - DG_PENETRATION_TOL) * scale1;
+						const dgVector axis1 (matrix1.m_front.Scale4 (capsule1->m_height * scale1));
+						return CalculateSphereToCapsuleClosestPoints (matrix0.m_posit, radius0, matrix1.m_posit - axis1, matrix1.m_posit + axis1, radius1, point0, point1, normal);
+					}
+					break;
+				}
+
+				case m_boxCollision:
+				{
+					const dgCollisionBox* const box1 = (dgCollisionBox*)instance1->GetChildShape();
+					return CalculateSphereToBoxClosestPoints (matrix0.m_posit, radius0, matrix1, box1->m_size[0].Scale4 (scale1) - padding, point0, point1, normal);
+				}
+
+				default:
+					break;
+			}
+			break;
+		}
+
+		case m_capsuleCollision:
+		{
+			// tapered capsules are not swept spheres, they go to the generic solver
+			const dgCollisionCapsule* const capsule0 = (dgCollisionCapsule*)instance0->GetChildShape();
+			if (capsule0->m_radio0 != capsule0->m_radio1) {
+				break;
+			}
+			const dgFloat32 radius0 = (capsule0->m_radio0 - DG_PENETRATION_TOL) * scale0;
+			const dgVector axis0 (matrix0.m_front.Scale4 (capsule0->m_height * scale0));
+			switch (type1)
+			{
+				case m_capsuleCollision:
+				{
+					const dgCollisionCapsule* const capsule1 = (dgCollisionCapsule*)instance1->GetChildShape();
+					if (capsule1->m_radio0 == capsule1->m_radio1) {
+						const dgFloat32 radius1 = (capsule1->m_radio0 - DG_PENETRATION_TOL) * scale1;
+						const dgVector axis1 (matrix1.m_front.Scale4 (capsule1->m_height * scale1));
+						return CalculateCapsuleToCapsuleClosestPoints (matrix0.m_posit - axis0, matrix0.m_posit + axis0, radius0, matrix1.m_posit - axis1, matrix1.m_posit + axis1, radius1, point0, point1, normal);
+					}
+					break;
+				}
+
+				case m_boxCollision:
+				{
+					const dgCollisionBox* const box1 = (dgCollisionBox*)instance1->GetChildShape();
+					return CalculateCapsuleToBoxClosestPoints (matrix0.m_posit - axis0, matrix0.m_posit + axis0, radius0, matrix1, box1->m_size[0].Scale4 (scale1) - padding, point0, point1, normal);
+				}
+
+				default:
+					break;
+			}
+			break;
+		}
+
+		case m_boxCollision:
+		{
+			if (type1 == m_boxCollision) {
+				const dgCollisionBox* const box0 = (dgCollisionBox*)instance0->GetChildShape();
+				const dgCollisionBox* const box1 = (dgCollisionBox*)instance1->GetChildShape();
+				return CalculateBoxToBoxClosestPoints (matrix0, box0->m_size[0].Scale4 (scale0) - padding, matrix1, box1->m_size[0].Scale4 (scale1) - padding, point0, point1, normal);
+			}
+			break;
+		}
+
+		default:
+			break;
+	}
+	return false;
+}
+
+dgInt32 dgWorld::GetSpherePairKey (const dgContact* const contact) const
+{
+	// only the pairs of a sphere against a sphere, a capsule or a box are batched, the key is the 
+	// pair of primitive types with the sphere first, any other pair returns -1 and is collided 
+	// where it is found
+	if (contact->m_material->m_contactGeneration) {
+		return -1;
+	}
+
+	dgInt32 types[2];
+	const dgCollisionInstance* const instances[] = {contact->m_body0->m_collision, contact->m_body1->m_collision};
+	for (dgInt32 i = 0; i < 2; i ++) {
+		const dgCollisionInstance* const instance = instances[i];
+		if (instance->GetScaleType() > dgCollisionInstance::m_uniform) {
+			return -1;
+		}
+		types[i] = instance->GetCollisionPrimityType();
+		switch (types[i]) 
+		{
+			case m_sphereCollision:
+			case m_boxCollision:
+				break;
+
+			case m_capsuleCollision:
+			{
+				const dgCollisionCapsule* const capsule = (dgCollisionCapsule*)instance->GetChildShape();
+				if (capsule->m_radio0 != capsule->m_radio1) {
+					return -1;
+				}
+				break;
+			}
+
+			default:
+				return -1;
+		}
+	}
+	if (types[0] > types[1]) {
+		dgSwap (types[0], types[1]);
+	}
+	if (types[0] != m_sphereCollision) {
+		return -1;
+	}
+	return types[0] * m_nullCollision + types[1];
+}
+
+dgInt32 dgWorld::CalculateSpherePairsContacts (dgBroadPhase::dgPair* const pairs, dgInt32 count, dgInt32 key) const
+{
+	// only the pairs of a sphere against a sphere, a capsule or a box are batched, four at a time. the 
+	// shapes are transposed so that each lane of a vector holds one pair. the closest features and 
+	// the single contact are the same the generic path produces for these pairs. the returned mask 
+	// has a bit set for each resolved pair, the others must go through CalculateContacts.
+	dgAssert ((count > 0) && (count <= DG_SPHERE_PAIR_BATCH));
+	const dgInt32 type0 = key / m_nullCollision;
+	const dgInt32 type1 = key % m_nullCollision;
+	dgAssert (type0 == m_sphereCollision);
+
+	dgVector center0[DG_SPHERE_PAIR_BATCH];
+	dgVector origin1[DG_SPHERE_PAIR_BATCH];
+	dgVector front1[DG_SPHERE_PAIR_BATCH];
+	dgVector up1[DG_SPHERE_PAIR_BATCH];
+	dgVector right1[DG_SPHERE_PAIR_BATCH];
+	dgVector size1[DG_SPHERE_PAIR_BATCH];
+	dgFloat32 radius0[DG_SPHERE_PAIR_BATCH];
+	dgFloat32 radius1[DG_SPHERE_PAIR_BATCH];
+	dgFloat32 skin[DG_SPHERE_PAIR_BATCH];
+	bool flip[DG_SPHERE_PAIR_BATCH];
+
+	const dgVector padding (dgVector (DG_PENETRATION_TOL) & dgVector::m_triplexMask);
+	for (dgInt32 i = 0; i < DG_SPHERE_PAIR_BATCH; i ++) {
+		// the unused lanes repeat the first pair
+		const dgContact* const contact = pairs[(i < count) ? i : 0].m_contact;
+		const dgCollisionInstance* instance0 = contact->m_body0->m_collision;
+		const dgCollisionInstance* instance1 = contact->m_body1->m_collision;
+		flip[i] = (instance0->GetCollisionPrimityType() != type0);
+		if (flip[i]) {
+			dgSwap (instance0, instance1);
+		}
+		dgAssert (instance0->GetCollisionPrimityType() == type0);
+		dgAssert (instance1->GetCollisionPrimityType() == type1);
+
+		const dgCollisionSphere* const sphere0 = (dgCollisionSphere*)instance0->GetChildShape();
+		const dgMatrix& matrix1 = instance1->GetGlobalMatrix();
+		const dgFloat32 scale1 = instance1->GetScale().m_x;
+		center0[i] = instance0->GetGlobalMatrix().m_posit;
+		radius0[i] = (sphere0->m_radius - DG_PENETRATION_TOL) * instance0->GetScale().m_x;
+		skin[i] = contact->m_material->m_skinThickness;
+		origin1[i] = matrix1.m_posit;
+		switch (type1) 
+		{
+			case m_sphereCollision:
+			{
+				const dgCollisionSphere* const sphere1 = (dgCollisionSphere*)instance1->GetChildShape();
+				radius1[i] = (sphere1->m_radius - DG_PENETRATION_TOL) * scale1;
+				break;
+			}
+
+			case m_capsuleCollision:
+			{
+				// the segment goes from the origin along the front axis
+				const dgCollisionCapsule* const capsule1 = (dgCollisionCapsule*)instance1->GetChildShape();
+				const dgVector axis1 (matrix1.m_front.Scale4 (capsule1->m_height * scale1));
+				radius1[i] = (capsule1->m_radio0 - DG_PENETRATION_TOL) * scale1;
+				origin1[i] = matrix1.m_posit - axis1;
+				front1[i] = axis1.Scale4 (dgFloat32 (2.0f));
+				break;
+			}
+
+			case m_boxCollision:
+			{
+				const dgCollisionBox* const box1 = (dgCollisionBox*)instance1->GetChildShape();
+				radius1[i] = dgFloat32 (0.0f);
+				front1[i] = matrix1.m_front;
+				up1[i] = matrix1.m_up;
+				right1[i] = matrix1.m_right;
+				size1[i] = box1->m_size[0].Scale4 (scale1) - padding;
+				break;
+			}
+
+			default:
+				dgAssert (0);
+		}
+	}
+
+	dgVector unused;
+	dgVector x0;
+	dgVector y0;
+	dgVector z0;
+	dgVector x1;
+	dgVector y1;
+	dgVector z1;
+	dgVector::Transpose4x4 (x0, y0, z0, unused, center0[0], center0[1], center0[2], center0[3]);
+	dgVector::Transpose4x4 (x1, y1, z1, unused, origin1[0], origin1[1], origin1[2], origin1[3]);
+	const dgVector r0 (radius0[0], radius0[1], radius0[2], radius0[3]);
+	const dgVector r1 (radius1[0], radius1[1], radius1[2], radius1[3]);
+
+	dgVector nx;
+	dgVector ny;
+	dgVector nz;
+	dgInt32 validMask;
+	dgVector p0x;
+	dgVector p0y;
+	dgVector p0z;
+	dgVector p1x;
+	dgVector p1y;
+	dgVector p1z;
+	if (type1 == m_boxCollision) {
+		dgVector fx;
+		dgVector fy;
+		dgVector fz;
+		dgVector ux;
+		dgVector uy;
+		dgVector uz;
+		dgVector rx;
+		dgVector ry;
+		dgVector rz;
+		dgVector sx;
+		dgVector sy;
+		dgVector sz;
+		dgVector::Transpose4x4 (fx, fy, fz, unused, front1[0], front1[1], front1[2], front1[3]);
+		dgVector::Transpose4x4 (ux, uy, uz, unused, up1[0], up1[1], up1[2], up1[3]);
+		dgVector::Transpose4x4 (rx, ry, rz, unused, right1[0], right1[1], right1[2], right1[3]);
+		dgVector::Transpose4x4 (sx, sy, sz, unused, size1[0], size1[1], size1[2], size1[3]);
+
+		// the sphere center in the space of the box, and the closest point of the box
+		const dgVector dx (x0 - x1);
+		const dgVector dy (y0 - y1);
+		const dgVector dz (z0 - z1);
+		const dgVector lx (fx * dx + fy * dy + fz * dz);
+		const dgVector ly (ux * dx + uy * dy + uz * dz);
+		const dgVector lz (rx * dx + ry * dy + rz * dz);
+		const dgVector cx (lx.GetMax (sx * dgVector::m_negOne).GetMin (sx));
+		const dgVector cy (ly.GetMax (sy * dgVector::m_negOne).GetMin (sy));
+		const dgVector cz (lz.GetMax (sz * dgVector::m_negOne).GetMin (sz));
+		const dgVector ox (cx - lx);
+		const dgVector oy (cy - ly);
+		const dgVector oz (cz - lz);
+		const dgVector mag2 (ox * ox + oy * oy + oz * oz);
+		const dgVector outside (mag2 > dgVector (dgFloat32 (1.0e-12f)));
+		const dgVector invMag (mag2.GetMax (dgVector (dgFloat32 (1.0e-12f))).InvSqrt());
+
+		// a center inside the box is pushed out through the closest face
+		const dgVector distX (sx - lx.Abs());
+		const dgVector distY (sy - ly.Abs());
+		const dgVector distZ (sz - lz.Abs());
+		const dgVector faceX ((distX <= distY) & (distX <= distZ));
+		const dgVector faceY ((distY <= distZ).AndNot (faceX));
+		const dgVector faceZ ((distZ < distX) & (distZ < distY));
+		const dgVector signX ((dgVector::m_negOne & (lx >= dgVector::m_zero)) | (dgVector::m_one.AndNot (lx >= dgVector::m_zero)));
+		const dgVector signY ((dgVector::m_negOne & (ly >= dgVector::m_zero)) | (dgVector::m_one.AndNot (ly >= dgVector::m_zero)));
+		const dgVector signZ ((dgVector::m_negOne & (lz >= dgVector::m_zero)) | (dgVector::m_one.AndNot (lz >= dgVector::m_zero)));
+
+		const dgVector nlx (((ox * invMag) & outside) | ((signX & faceX).AndNot (outside)));
+		const dgVector nly (((oy * invMag) & outside) | ((signY & faceY).AndNot (outside)));
+		const dgVector nlz (((oz * invMag) & outside) | ((signZ & faceZ).AndNot (outside)));
+		const dgVector plx ((cx & outside) | (((sx * signX * dgVector::m_negOne) & faceX) | lx.AndNot (faceX)).AndNot (outside));
+		const dgVector ply ((cy & outside) | (((sy * signY * dgVector::m_negOne) & faceY) | ly.AndNot (faceY)).AndNot (outside));
+		const dgVector plz ((cz & outside) | (((sz * signZ * dgVector::m_negOne) & faceZ) | lz.AndNot (faceZ)).AndNot (outside));
+
+		// back to global space, the box point is rounded by the penetration tolerance
+		const dgVector tol (DG_PENETRATION_TOL);
+		nx = fx * nlx + ux * nly + rx * nlz;
+		ny = fy * nlx + uy * nly + ry * nlz;
+		nz = fz * nlx + uz * nly + rz * nlz;
+		p1x = x1 + fx * plx + ux * ply + rx * plz - nx * tol;
+		p1y = y1 + fy * plx + uy * ply + ry * plz - ny * tol;
+		p1z = z1 + fz * plx + uz * ply + rz * plz - nz * tol;
+		validMask = (1 << DG_SPHERE_PAIR_BATCH) - 1;
+	} else {
+		if (type1 == m_capsuleCollision) {
+			// move the capsule origin to the closest point of the segment
+			dgVector sx;
+			dgVector sy;
+			dgVector sz;
+			dgVector::Transpose4x4 (sx, sy, sz, unused, front1[0], front1[1], front1[2], front1[3]);
+			const dgVector den (sx * sx + sy * sy + sz * sz);
+			const dgVector num (sx * (x0 - x1) + sy * (y0 - y1) + sz * (z0 - z1));
+			const dgVector t ((num * den.Reciproc()).GetMax (dgVector::m_zero).GetMin (dgVector::m_one));
+			x1 += sx * t;
+			y1 += sy * t;
+			z1 += sz * t;
+		}
+		const dgVector dx (x1 - x0);
+		const dgVector dy (y1 - y0);
+		const dgVector dz (z1 - z0);
+		const dgVector mag2 (dx * dx + dy * dy + dz * dz);
+		const dgVector invMag (mag2.GetMax (dgVector (dgFloat32 (1.0e-12f))).InvSqrt());
+		validMask = (mag2 >= dgVector (dgFloat32 (1.0e-12f))).GetSignMask();
+		nx = dx * invMag;
+		ny = dy * invMag;
+		nz = dz * invMag;
+		p1x = x1 - nx * r1;
+		p1y = y1 - ny * r1;
+		p1z = z1 - nz * r1;
+	}
+	p0x = x0 + nx * r0;
+	p0y = y0 + ny * r0;
+	p0z = z0 + nz * r0;
+
+	const dgVector penetration (nx * (p1x - p0x) + ny * (p1y - p0y) + nz * (p1z - p0z) - dgVector (skin[0], skin[1], skin[2], skin[3]) - dgVector (DG_PENETRATION_TOL));
+	dgVector normal[DG_SPHERE_PAIR_BATCH];
+	dgVector point[DG_SPHERE_PAIR_BATCH];
+	dgVector::Transpose4x4 (normal[0], normal[1], normal[2], normal[3], nx, ny, nz, dgVector::m_zero);
+	dgVector::Transpose4x4 (point[0], point[1], point[2], point[3], (p0x + p1x) * dgVector::m_half, (p0y + p1y) * dgVector::m_half, (p0z + p1z) * dgVector::m_half, dgVector::m_zero);
+
+	dgInt32 mask = 0;
+	for (dgInt32 i = 0; i < count; i ++) {
+		if (validMask & (1 << i)) {
+			mask |= 1 << i;
+			dgBroadPhase::dgPair* const pair = &pairs[i];
+			dgContact* const contact = pair->m_contact;
+			const dgCollisionInstance* const collision0 = contact->m_body0->m_collision;
+			const dgCollisionInstance* const collision1 = contact->m_body1->m_collision;
+
+			// the normal goes from the sphere to the other shape, make it go from body0 to body1
+			const dgVector separatingVector (flip[i] ? normal[i].Scale4 (dgFloat32 (-1.0f)) : normal[i]);
+			const dgFloat32 dist = penetration[i];
+			contact->m_isNewContact = false;
+			contact->m_separtingVector = separatingVector;
+			contact->m_closestDistance = dist;
+			contact->m_separationDistance = dist;
+
+			pair->m_flipContacts = false;
+			pair->m_contactCount = 0;
+			if (dist <= dgFloat32 (1.0e-5f)) {
+				contact->m_contactActive = 1;
+				if (collision0->GetCollisionMode() & collision1->GetCollisionMode()) {
+					dgContactPoint& contactOut = pair->m_contactBuffer[0];
+					contactOut.m_point = point[i] | dgVector::m_wOne;
+					contactOut.m_normal = separatingVector.Scale4 (dgFloat32 (-1.0f));
+					contactOut.m_penetration = -dist;
+					contactOut.m_body0 = contact->m_body0;
+					contactOut.m_body1 = contact->m_body1;
+					contactOut.m_collision0 = collision0;
+					contactOut.m_collision1 = collision1;
+					contactOut.m_shapeId0 = collision0->GetUserDataID();
+					contactOut.m_shapeId1 = collision1->GetUserDataID();
+					pair->m_contactCount = 1;
+				}
+			}
+		}
+	}
+	return mask;
+}
+
 dgInt32 dgWorld::CalculateConvexToConvexContacts(dgCollisionParamProxy& proxy) const
 {
 	dgInt32 count = 0;
@@ -1506,6 +2109,8 @@ dgInt32 dgWorld::CalculateConvexToConvexContacts(dgCollisionParamProxy& proxy) c
 					}
 					break;
 				}
+				default:
+					break;
 			}
 		}
 		if (contactJoint->m_isNewContact) {
@@ -1523,7 +2128,16 @@ dgInt32 dgWorld::CalculateConvexToConvexContacts(dgCollisionParamProxy& proxy) c
 		if (proxy.m_continueCollision) {
 			count = contactSolver.CalculateConvexCastContacts();
 		} else {
-			count = contactSolver.CalculateConvexToConvexContacts();
+			dgVector point0;
+			dgVector point1;
+			dgVector normal;
+			if (CalculatePrimitiveClosestPoints (&instance0, &instance1, point0, point1, normal)) {
+				count = contactSolver.CalculatePrimitiveContacts(point0, point1, normal);
+			} else {
+				// compound children and other sub shapes share the contact joint, only the bodies own shapes keep a simplex
+				const bool warmStart = (collision0 == contactJoint->GetBody0()->m_collision) && (collision1 == contactJoint->GetBody1()->m_collision);
+				count = contactSolver.CalculateConvexToConvexContacts(warmStart);
+			}
 		}
 
 		proxy.m_closestPointBody0 += origin;
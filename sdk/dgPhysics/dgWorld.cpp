@@ -38,6 +38,8 @@
 #include "dgWorldDynamicUpdate.h"
 #include "dgCollisionConvexHull.h"
 #include "dgBroadPhasePersistent.h"
+#include "dgBroadPhaseSweepAndPrune.h"
+#include "dgBroadPhaseSpatialHash.h"
 #include "dgCollisionChamferCylinder.h"
 
 #include "dgUserConstraint.h"
@@ -51,6 +53,7 @@
 
 
 #define DG_DEFAULT_SOLVER_ITERATION_COUNT	4
+#define DG_TRANSFORMS_CHUNK_SIZE				16
 
 
 /*
@@ -213,8 +216,10 @@ dgWorld::dgWorld(dgMemoryAllocator* const allocator)
 	,m_jointsMemory (allocator, 64)
 	,m_solverJacobiansMemory (allocator, 64)
 	,m_solverForceAccumulatorMemory (allocator, 64)
+	,m_solverBodyStateMemory (allocator, 64)
 	,m_clusterMemory (allocator, 64)
 	,m_stack(allocator)
+	,m_profiler(allocator)
 	,m_postUpdateCallback(NULL)
 {
 	dgMutexThread* const mutexThread = this;
@@ -226,6 +231,10 @@ dgWorld::dgWorld(dgMemoryAllocator* const allocator)
 	m_clusterMemory.Resize(1024 * 32);
 	m_solverJacobiansMemory.Resize(1024 * 64);
 	m_solverForceAccumulatorMemory.Resize(1024 * 32);
+	m_solverBodyStateMemory.Resize(1024 * 64);
+	for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
+		m_solverWideRowsMemory[i].SetAllocator(allocator);
+	}
 
 	m_savetimestep = dgFloat32 (0.0f);
 	m_allocator = allocator;
@@ -291,7 +300,10 @@ dgWorld::dgWorld(dgMemoryAllocator* const allocator)
 	m_sleepTable[DG_SLEEP_ENTRIES - 1].m_maxOmega = 0.1f;
 	m_sleepTable[DG_SLEEP_ENTRIES - 1].m_steps = steps;
 
-	m_hardwaredIndex = 0;
+	m_cpuInstructionsSets = dgGetCpuInstructionsSets();
+	// the wide modes solve the joints in a different order, so the results would depend on the cpu. 
+	// they are only used when selected with SetCurrentHardwareMode
+	m_hardwaredIndex = m_hardwareModeSimd;
 	SetThreadsCount (0);
 
 	m_broadPhase = new (allocator) dgBroadPhaseDefault(this);
@@ -348,6 +360,9 @@ void dgWorld::DestroyAllBodies()
 		BodyEnableSimulation(body);
 	}
 
+	// every contact goes away, the pair cache is rebuilt by the next update instead of removing them one by one
+	m_broadPhase->m_pairCache.Invalidate();
+
 	dgAssert(dgBodyMasterList::GetFirst()->GetInfo().GetBody() == m_sentinelBody);
 	for (dgBodyMasterList::dgListNode* node = me.GetFirst()->GetNext(); node;) {
 		dgBody* const body = node->GetInfo().GetBody();
@@ -372,6 +387,29 @@ dgUnsigned32 dgWorld::GetPerformanceCount ()
 	return 0;
 }
 
+const char* dgWorld::GetProfilePhaseName (dgInt32 phase)
+{
+	static const char* const names[] = {
+		"worldUpdate",
+		"updateSkeletons",
+		"updateBroadphase",
+		"broadphaseApplyForces",
+		"forceAndTorque",
+		"sleepingState",
+		"broadphaseUpdateTree",
+		"broadphaseFindPairs",
+		"narrowPhase",
+		"updateDynamics",
+		"buildClusters",
+		"solveClusters",
+		"buildJacobianMatrix",
+		"solverPasses",
+		"updateTransforms",
+	};
+	dgAssert (sizeof (names) / sizeof (names[0]) == m_profilePhasesCount);
+	return ((phase >= 0) && (phase < m_profilePhasesCount)) ? names[phase] : NULL;
+}
+
 void dgWorld::AddSentinelBody()
 {
 	dgCollision* const collision = new  (m_allocator) dgCollisionNull (m_allocator, 0x4352fe67);
@@ -400,15 +438,32 @@ dgInt32 dgWorld::GetSolverMode() const
 
 dgInt32 dgWorld::EnumerateHardwareModes() const
 {
+	// avx512 capable cpus also support avx2, so the modes are always a prefix of the list
 	dgInt32 count = 1;
+	if (m_cpuInstructionsSets & DG_CPU_AVX2_INSTRUCTIONS_SET) {
+		count ++;
+		if (m_cpuInstructionsSets & DG_CPU_AVX512_INSTRUCTIONS_SET) {
+			count ++;
+		}
+	}
 	return count;
 }
 
 void dgWorld::GetHardwareVendorString (dgInt32 deviceIndex, char* const description, dgInt32 maxlength) const
 {
 	deviceIndex = dgClamp(deviceIndex, 0, EnumerateHardwareModes() - 1);
-	if (deviceIndex == 0) {
-		sprintf (description, "newton cpu");
+	switch (deviceIndex) 
+	{
+		case m_hardwareModeAvx2:
+			sprintf (description, "newton cpu avx2");
+			break;
+
+		case m_hardwareModeAvx512:
+			sprintf (description, "newton cpu avx512");
+			break;
+
+		default:
+			sprintf (description, "newton cpu");
 	}
 }
 
@@ -577,6 +632,9 @@ void dgWorld::DestroyBody(dgBody* const body)
 
 void dgWorld::DestroyConstraint(dgConstraint* const constraint)
 {
+	if ((constraint->GetId() == dgConstraint::m_contactConstraint) && m_broadPhase) {
+		m_broadPhase->m_pairCache.Remove ((dgContact*) constraint);
+	}
 	RemoveConstraint (constraint);
 	delete constraint;
 }
@@ -894,7 +952,8 @@ bool dgWorld::AreBodyConnectedByJoints (dgBody* const originSrc, dgBody* const t
 
 void dgWorld::FlushCache()
 {
-	// delete all contacts
+	// delete all contacts, the pair cache is rebuilt by the next update instead of removing them one by one
+	m_broadPhase->m_pairCache.Invalidate();
 	dgActiveContacts& contactList = *this;
 	for (dgActiveContacts::dgListNode* contactNode = contactList.GetFirst(); contactNode; ) {
 		dgContact* contact;
@@ -923,7 +982,11 @@ void dgWorld::StepDynamics (dgFloat32 timestep)
 
 	UpdateSkeletons();
 	UpdateBroadphase(timestep);
-	UpdateDynamics (timestep);
+	{
+		dgProfilerScope scope (&m_profiler, m_profileUpdateDynamics, DG_PROFILER_MAIN_THREAD);
+		UpdateDynamics (timestep);
+	}
+	m_broadPhase->RefitDirtyNodes();
 
 	if (m_listeners.GetCount()) {
 		for (dgListenerList::dgListNode* node = m_listeners.GetFirst(); node; node = node->GetNext()) {
@@ -932,6 +995,7 @@ void dgWorld::StepDynamics (dgFloat32 timestep)
 				listener.m_onPostUpdate(this, listener.m_userData, timestep);
 			}
 		}
+		m_broadPhase->RefitDirtyNodes();
 	}
 
 	m_inUpdate --;
@@ -964,31 +1028,24 @@ void dgWorld::Sync ()
 	}
 }
 
-void dgWorld::UpdateTransforms(dgBodyMasterList::dgListNode* node, dgInt32 threadID)
+void dgWorld::UpdateTransforms(dgInt32 start, dgInt32 end, dgInt32 threadID)
 {
-	const dgInt32 threadsCount = GetThreadCount();
-	while (node) {
-		dgBody* const body = node->GetInfo().GetBody();
+	dgProfilerScope scope (&m_profiler, m_profileUpdateTransforms, threadID);
+	dgBody** const bodies = &m_activeBodies[0];
+	for (dgInt32 i = start; i < end; i ++) {
+		dgBody* const body = bodies[i];
 		if (body->m_transformIsDirty && body->m_matrixUpdate) {
 			body->m_matrixUpdate (*body, body->m_matrix, threadID);
 		}
 		body->m_transformIsDirty = false;
-
-		for (dgInt32 i = 0; i < threadsCount; i++) {
-			node = node ? node->GetNext() : NULL;
-		}
 	}
 }
 
-void dgWorld::UpdateTransforms(void* const context, void* const nodePtr, dgInt32 threadID)
-{
-	dgWorld* const world = (dgWorld*)context;
-	dgBodyMasterList::dgListNode* node = (dgBodyMasterList::dgListNode*) nodePtr;
-	world->UpdateTransforms(node, threadID);
-}
-
 void dgWorld::RunStep ()
 {
+	m_profiler.NextFrame();
+	dgProfilerScope scope (&m_profiler, m_profileWorldUpdate, DG_PROFILER_MAIN_THREAD);
+
 	dgUnsigned64 timeAcc = m_getDebugTime ? m_getDebugTime() : 0;
 	dgFloat32 step = m_savetimestep / m_numberOfSubsteps;
 	for (dgUnsigned32 i = 0; i < m_numberOfSubsteps; i ++) {
@@ -1003,14 +1060,14 @@ void dgWorld::RunStep ()
 		bodyList.DestroyBodies (*this);
 	}
 
-	const dgBodyMasterList* const masterList = this;
-	dgBodyMasterList::dgListNode* node = masterList->GetFirst();
-	const dgInt32 threadsCount = GetThreadCount();
-	for (dgInt32 i = 0; i < threadsCount; i++) {
-		QueueJob(UpdateTransforms, this, node);
-		node = node ? node->GetNext() : NULL;
+	{
+		// every body that moved is in the active list, the ones that did not fit are added by the rebuild
+		dgProfilerScope transformsScope (&m_profiler, m_profileUpdateTransforms, DG_PROFILER_MAIN_THREAD);
+		if (m_activeBodiesOverflow) {
+			RebuildActiveBodies();
+		}
+		ParallelFor (dgUpdateTransformsKernel(this), 0, m_activeBodiesCount, DG_TRANSFORMS_CHUNK_SIZE);
 	}
-	SynchronizationBarrier();
 
 	if (m_postUpdateCallback) {
 		m_postUpdateCallback (this, m_savetimestep);
@@ -1077,23 +1134,29 @@ dgInt32 dgWorld::GetBroadPhaseType() const
 	return dgInt32 (m_broadPhase->GetType());
 }
 
-void dgWorld::SetBroadPhaseType(dgInt32 type)
+dgBroadPhase* dgWorld::CreateBroadPhase(dgInt32 type)
 {
-	if (type != GetBroadPhaseType()) {
-		dgBroadPhase* newBroadPhase = NULL;
-		
-		switch (type)
-		{
-			case m_persistentBroadphase:
-				newBroadPhase = new (m_allocator) dgBroadPhasePersistent(this);
-				break;
+	switch (type)
+	{
+		case m_persistentBroadphase:
+			return new (m_allocator) dgBroadPhasePersistent(this);
 
-			case m_defaultBroadphase:
-			default:
-				newBroadPhase = new (m_allocator) dgBroadPhaseDefault(this);
-				break;
-		}
+		case m_sweepAndPruneBroadphase:
+			return new (m_allocator) dgBroadPhaseSweepAndPrune(this);
+
+		case m_spatialHashBroadphase:
+			return new (m_allocator) dgBroadPhaseSpatialHash(this);
+
+		case m_defaultBroadphase:
+		default:
+			return new (m_allocator) dgBroadPhaseDefault(this);
+	}
+}
 
+void dgWorld::SetBroadPhaseType(dgInt32 type)
+{
+	if (type != GetBroadPhaseType()) {
+		dgBroadPhase* const newBroadPhase = CreateBroadPhase(type);
 		m_broadPhase->MoveNodes(newBroadPhase);
 		delete m_broadPhase;
 		m_broadPhase = newBroadPhase;
@@ -1102,20 +1165,7 @@ void dgWorld::SetBroadPhaseType(dgInt32 type)
 
 void dgWorld::ResetBroadPhase()
 {
-	dgBroadPhase* newBroadPhase = NULL;
-
-	switch (GetBroadPhaseType())
-	{
-		case m_persistentBroadphase:
-			newBroadPhase = new (m_allocator) dgBroadPhasePersistent(this);
-			break;
-
-		case m_defaultBroadphase:
-		default:
-			newBroadPhase = new (m_allocator) dgBroadPhaseDefault(this);
-			break;
-	}
-
+	dgBroadPhase* const newBroadPhase = CreateBroadPhase(GetBroadPhaseType());
 	m_broadPhase->MoveNodes(newBroadPhase);
 	delete m_broadPhase;
 	m_broadPhase = newBroadPhase;
@@ -1249,6 +1299,7 @@ void dgDeadBodies::DestroyBodies(dgWorld& world)
 
 void dgWorld::UpdateBroadphase(dgFloat32 timestep)
 {
+	dgProfilerScope scope (&m_profiler, m_profileUpdateBroadphase, DG_PROFILER_MAIN_THREAD);
 	m_broadPhase->UpdateContacts (timestep);
 }
 
@@ -1279,6 +1330,7 @@ dgInt32 dgWorld::CompareJointByInvMass(const dgBilateralConstraint* const jointA
 
 void dgWorld::UpdateSkeletons()
 {
+	dgProfilerScope scope (&m_profiler, m_profileUpdateSkeletons, DG_PROFILER_MAIN_THREAD);
 	dgSkeletonList& skelManager = *this;
 	if (skelManager.m_skelListIsDirty) {
 		skelManager.m_skelListIsDirty = false;
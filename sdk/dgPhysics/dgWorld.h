@@ -31,12 +31,15 @@
 #include "dgWorldDynamicUpdate.h"
 //#include "dgDeformableBodiesUpdate.h"
 #include "dgCollisionCompoundFractured.h"
+#include "dgCollisionTiledHeightField.h"
+#include "dgProfiler.h"
 
 #define DG_REDUCE_CONTACT_TOLERANCE			dgFloat32 (5.0e-2f)
 #define DG_PRUNE_CONTACT_TOLERANCE			dgFloat32 (5.0e-2f)
 
 #define DG_SLEEP_ENTRIES					8
 #define DG_MAX_DESTROYED_BODIES_BY_FORCE	8
+#define DG_SPHERE_PAIR_BATCH				4
 
 class dgBody;
 class dgDynamicBody;
@@ -98,6 +101,38 @@ class dgWorld;
 class dgCollisionInstance;
 class dgCollisionParamProxy;
 
+// the values must match the NEWTON_PROFILE_* defines in Newton.h
+enum dgWorldProfilePhase
+{
+	m_profileWorldUpdate = 0,
+	m_profileUpdateSkeletons,
+	m_profileUpdateBroadphase,
+	m_profileBroadphaseApplyForces,
+	m_profileForceAndTorque,
+	m_profileSleepingState,
+	m_profileBroadphaseUpdateTree,
+	m_profileBroadphaseFindPairs,
+	m_profileNarrowPhase,
+	m_profileUpdateDynamics,
+	m_profileBuildClusters,
+	m_profileSolveClusters,
+	m_profileBuildJacobianMatrix,
+	m_profileSolverPasses,
+	m_profileUpdateTransforms,
+	m_profilePhasesCount,
+};
+
+// hardware modes as enumerated by EnumerateHardwareModes, the wide modes only exist 
+// when the cpu supports them and select the matching joint solver kernels of the cluster solver.
+// the single island parallel solver always runs the simd kernels
+enum dgWorldHardwareMode
+{
+	m_hardwareModeSimd = 0,
+	m_hardwareModeAvx2,
+	m_hardwareModeAvx512,
+};
+
+
 class dgSolverProgressiveSleepEntry
 {
 	public:
@@ -190,6 +225,8 @@ class dgWorld
 	{
 		m_defaultBroadphase,
 		m_persistentBroadphase,
+		m_sweepAndPruneBroadphase,
+		m_spatialHashBroadphase,
 	};
 
 	class dgListener
@@ -345,6 +382,8 @@ class dgWorld
 	dgCollisionInstance* CreateBVH ();	
 	dgCollisionInstance* CreateStaticUserMesh (const dgVector& boxP0, const dgVector& boxP1, const dgUserMeshCreation& data);
 	dgCollisionInstance* CreateHeightField (dgInt32 width, dgInt32 height, dgInt32 contructionMode, dgInt32 elevationDataType, const void* const elevationMap, const dgInt8* const atributeMap, dgFloat32 verticalScale, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z);
+	dgCollisionInstance* CreateTiledHeightField (dgInt32 width, dgInt32 height, dgInt32 tileSize, dgInt32 contructionMode, dgInt32 elevationDataType, dgFloat32 verticalScale, dgFloat32 horizontalScale_x, dgFloat32 horizontalScale_z,
+												 dgFloat32 minElevation, dgFloat32 maxElevation, dgInt32 maxResidentTiles, dgCollisionTiledHeightField::OnTiledHeightFieldPageCallback pageCallback, void* const pageUserData);
 	dgCollisionInstance* CreateScene ();	
 
 	dgBroadPhaseAggregate* CreateAggreGate() const; 
@@ -425,6 +464,9 @@ class dgWorld
 
 	void SetSubsteps (dgInt32 subSteps);
 	dgInt32 GetSubsteps () const;
+
+	dgProfiler* GetProfiler();
+	static const char* GetProfilePhaseName (dgInt32 phase);
 	
 	private:
 	class dgAdressDistPair
@@ -482,6 +524,7 @@ class dgWorld
 	};
 
 	void RunStep ();
+	dgBroadPhase* CreateBroadPhase (dgInt32 type);
 	void CalculateContacts (dgBroadPhase::dgPair* const pair, dgInt32 threadIndex, bool ccdMode, bool intersectionTestOnly);
 	dgInt32 PruneContacts (dgInt32 count, dgContactPoint* const contact, dgFloat32 distTolerenace, dgInt32 maxCount = (DG_CONSTRAINT_MAX_ROWS / 3)) const;
 	dgInt32 ReduceContacts (dgInt32 count, dgContactPoint* const contact, dgInt32 maxCount, dgFloat32 tol, dgInt32 arrayIsSorted = 0) const;
@@ -491,6 +534,9 @@ class dgWorld
 	dgInt32 CalculateUserContacts (dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateConvexToNonConvexContacts (dgCollisionParamProxy& proxy) const;
 	dgInt32 CalculateConvexToConvexContacts (dgCollisionParamProxy& proxy) const;
+	bool CalculatePrimitiveClosestPoints (const dgCollisionInstance* const instance0, const dgCollisionInstance* const instance1, dgVector& point0, dgVector& point1, dgVector& normal) const;
+	dgInt32 GetSpherePairKey (const dgContact* const contact) const;
+	dgInt32 CalculateSpherePairsContacts (dgBroadPhase::dgPair* const pairs, dgInt32 count, dgInt32 key) const;
 	dgInt32 PruneContactsByRank(dgInt32 count, dgCollisionParamProxy& proxy, dgInt32 maxCount) const;
 	
 	void PopulateContacts (dgBroadPhase::dgPair* const pair, dgInt32 threadIndex);	
@@ -519,10 +565,25 @@ class dgWorld
 
 	virtual void Execute (dgInt32 threadID);
 	virtual void TickCallback (dgInt32 threadID);
-	void UpdateTransforms(dgBodyMasterList::dgListNode* node, dgInt32 threadID);
+
+	class dgUpdateTransformsKernel
+	{
+		public:
+		dgUpdateTransformsKernel (dgWorld* const world)
+			:m_world(world)
+		{
+		}
+
+		void operator() (dgInt32 start, dgInt32 end, dgInt32 threadID) const
+		{
+			m_world->UpdateTransforms(start, end, threadID);
+		}
+
+		dgWorld* m_world;
+	};
+	void UpdateTransforms(dgInt32 start, dgInt32 end, dgInt32 threadID);
 
 	static dgUnsigned32 dgApi GetPerformanceCount ();
-	static void UpdateTransforms(void* const context, void* const node, dgInt32 threadID);
 	static dgInt32 SortFaces (const dgAdressDistPair* const A, const dgAdressDistPair* const B, void* const context);
 	static dgInt32 CompareJointByInvMass (const dgBilateralConstraint* const jointA, const dgBilateralConstraint* const jointB, void* notUsed);
 
@@ -556,6 +617,7 @@ class dgWorld
 	void* m_userData;
 	dgMemoryAllocator* m_allocator;
 	dgInt32 m_hardwaredIndex;
+	dgUnsigned32 m_cpuInstructionsSets;
 	OnClusterUpdate m_clusterUpdate;
 	OnGetTimeInMicrosenconds m_getDebugTime;
 	OnCollisionInstanceDestroy	m_onCollisionInstanceDestruction;
@@ -569,8 +631,11 @@ class dgWorld
 	dgArray<dgUnsigned8> m_jointsMemory; 
 	dgArray<dgUnsigned8> m_solverJacobiansMemory;  
 	dgArray<dgUnsigned8> m_solverForceAccumulatorMemory;
+	dgArray<dgUnsigned8> m_solverBodyStateMemory;
+	dgArray<dgUnsigned8> m_solverWideRowsMemory[DG_MAX_THREADS_HIVE_COUNT];
 	dgArray<dgUnsigned8> m_clusterMemory;
 	dgStack m_stack;
+	dgProfiler m_profiler;
 
 	dgPostUpdateCallback m_postUpdateCallback;
 	
@@ -633,6 +698,11 @@ inline dgInt32 dgWorld::GetSubsteps () const
 	return m_numberOfSubsteps;
 }
 
+inline dgProfiler* dgWorld::GetProfiler()
+{
+	return &m_profiler;
+}
+
 inline dgFloat32 dgWorld::GetUpdateTime() const
 {
 	return m_lastExecutionTime;
@@ -51,6 +51,7 @@ class dgWorldDynamicUpdateSyncDescriptor
 	
 	dgInt32 m_clusterCount;
 	dgInt32 m_firstCluster;
+	dgInt32 m_softBodiesCount;
 	dgThread::dgCriticalSection* m_criticalSection;
 };
 
@@ -64,8 +65,33 @@ void dgJacobianMemory::Init(dgWorld* const world, dgInt32 rowsCount, dgInt32 bod
 	m_internalForcesBuffer = (dgJacobian*)&world->m_solverForceAccumulatorMemory[0];
 	dgAssert(bodyCount <= (((world->m_solverForceAccumulatorMemory.GetBytesCapacity() - 16) / dgInt32(sizeof(dgJacobian))) & (-8)));
 
+	// lay out the body state arrays back to back, each one starting on a 64 byte boundary
+	const dgInt32 stride = bodyCount + 8;
+	const dgInt32 vectorSize = (stride * sizeof (dgVector) + 63) & -64;
+	const dgInt32 matrixSize = (stride * sizeof (dgMatrix) + 63) & -64;
+	const dgInt32 scalarSize = (stride * sizeof (dgFloat32) + 63) & -64;
+	const dgInt32 flagSize = (stride * sizeof (dgInt32) + 63) & -64;
+	world->m_solverBodyStateMemory.ResizeIfNecessary(4 * vectorSize + matrixSize + scalarSize + flagSize);
+
+	dgUnsigned8* ptr = &world->m_solverBodyStateMemory[0];
+	m_bodyVeloc = (dgVector*)ptr;
+	ptr += vectorSize;
+	m_bodyOmega = (dgVector*)ptr;
+	ptr += vectorSize;
+	m_bodyExternalForce = (dgVector*)ptr;
+	ptr += vectorSize;
+	m_bodyExternalTorque = (dgVector*)ptr;
+	ptr += vectorSize;
+	m_bodyInvInertia = (dgMatrix*)ptr;
+	ptr += matrixSize;
+	m_bodyInvMass = (dgFloat32*)ptr;
+	ptr += scalarSize;
+	m_bodyResting = (dgInt32*)ptr;
+
 	dgAssert((dgUnsigned64(m_jacobianBuffer) & 0x01f) == 0);
 	dgAssert((dgUnsigned64(m_internalForcesBuffer) & 0x01f) == 0);
+	dgAssert((dgUnsigned64(m_bodyVeloc) & 0x01f) == 0);
+	dgAssert((dgUnsigned64(m_bodyInvInertia) & 0x01f) == 0);
 }
 
 //////////////////////////////////////////////////////////////////////
@@ -99,8 +125,11 @@ void dgWorldDynamicUpdate::UpdateDynamics(dgFloat32 timestep)
 	sentinelBody->m_equilibrium = 1;
 	sentinelBody->m_dynamicsLru = m_markLru;
 
-	BuildClusters(timestep);
-	SortClustersByCount();
+	{
+		dgProfilerScope scope (&world->m_profiler, m_profileBuildClusters, DG_PROFILER_MAIN_THREAD);
+		BuildClusters(timestep);
+		SortClustersByCount();
+	}
 
 	dgInt32 maxRowCount = 0;
 	dgInt32 blockMatrixSize = 0;
@@ -124,45 +153,53 @@ void dgWorldDynamicUpdate::UpdateDynamics(dgFloat32 timestep)
 	descriptor.m_firstCluster = index;
 	descriptor.m_clusterCount = m_clusters - index;
 
+	dgProfilerScope scope (&world->m_profiler, m_profileSolveClusters, DG_PROFILER_MAIN_THREAD);
 	dgInt32 useParallel = world->m_useParallelSolver && (threadCount > 1);
 	//useParallel = 1;
+	dgInt32 bigClustersEnd = index;
 	if (useParallel) {
+		// big clusters that would starve the other threads are solved one at the time by all threads
 		dgInt32 sum = m_joints;
-		useParallel = useParallel && m_joints && m_clusters;
-		useParallel = useParallel && ((threadCount * m_clusterMemory[0].m_jointCount) >= sum);
-		useParallel = useParallel && (m_clusterMemory[0].m_jointCount > DG_PARALLEL_JOINT_COUNT_CUT_OFF);
-		//useParallel = 1;
-		while (useParallel) {
-			CalculateReactionForcesParallel(&m_clusterMemory[index], timestep);
-			index ++;
-			sum -= m_clusterMemory[index].m_jointCount;
-			useParallel = useParallel && (index < m_clusters);
-			useParallel = useParallel && ((threadCount * m_clusterMemory[index].m_jointCount) >= m_joints);
-			useParallel = useParallel && (m_clusterMemory[index].m_jointCount > DG_PARALLEL_JOINT_COUNT_CUT_OFF);
+		while ((bigClustersEnd < m_clusters) && ((threadCount * m_clusterMemory[bigClustersEnd].m_jointCount) >= sum) && (m_clusterMemory[bigClustersEnd].m_jointCount > DG_PARALLEL_JOINT_COUNT_CUT_OFF)) {
+			sum -= m_clusterMemory[bigClustersEnd].m_jointCount;
+			bigClustersEnd ++;
 		}
 	}
 
-	if (index < m_clusters) {
-		descriptor.m_atomicCounter = 0;
-		descriptor.m_firstCluster = index;
-		descriptor.m_clusterCount = m_clusters - index;
-		for (dgInt32 i = 0; i < threadCount; i ++) {
-			world->QueueJob (CalculateClusterReactionForcesKernel, &descriptor, world);
+	// the small clusters are queued ahead of the big ones, so the threads that run out of work 
+	// in a stage of a big cluster pick them up instead of waiting at its barrier.
+	// soft bodies read the state of the rigid bodies they collide with, so they are integrated 
+	// by whichever thread finishes the last rigid cluster, the gate keeps them from being released 
+	// by the small clusters before they are queued.
+	dgThreadHive::dgThreadTask clusterTasks[DG_MAX_THREADS_HIVE_COUNT];
+	dgThreadHive::dgThreadTask bigClustersGateTask (BigClustersGateKernel, NULL, NULL);
+	dgThreadHive::dgThreadTask softBodiesTask (IntegrateSoftBodyClustersKernel, &descriptor, world);
+	descriptor.m_softBodiesCount = softBodiesCount;
+
+	const dgInt32 clusterTasksCount = (bigClustersEnd < m_clusters) ? threadCount : 0;
+	descriptor.m_atomicCounter = 0;
+	descriptor.m_firstCluster = bigClustersEnd;
+	descriptor.m_clusterCount = m_clusters - bigClustersEnd;
+	if (softBodiesCount) {
+		softBodiesTask.DependsOn(&bigClustersGateTask);
+	}
+	for (dgInt32 i = 0; i < clusterTasksCount; i ++) {
+		clusterTasks[i] = dgThreadHive::dgThreadTask(CalculateClusterReactionForcesKernel, &descriptor, world);
+		if (softBodiesCount) {
+			softBodiesTask.DependsOn(&clusterTasks[i]);
 		}
-		world->SynchronizationBarrier();
+		world->QueueTask (&clusterTasks[i]);
 	}
 
-	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
-	for (dgInt32 i = 0; i < softBodiesCount; i++) {
-		dgBodyCluster* const cluster = &m_clusterMemory[i];
-//		IntegrateExternalForce(cluster, timestep, 0);
-		dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
-		dgAssert (cluster->m_bodyCount == 2);
-		dgDynamicBody* const body = (dgDynamicBody*)bodyArray[1].m_body;
-		dgAssert (body->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI));
-		body->IntegrateOpenLoopExternalForce(timestep);
-		IntegrateVelocity(cluster, DG_SOLVER_MAX_ERROR, timestep, 0);
+	for (; index < bigClustersEnd; index ++) {
+		CalculateReactionForcesParallel(&m_clusterMemory[index], timestep);
+	}
+
+	if (softBodiesCount) {
+		world->QueueTask (&bigClustersGateTask);
+		world->QueueTask (&softBodiesTask);
 	}
+	world->SynchronizationBarrier();
 
 	m_clusterMemory = NULL;
 }
@@ -172,7 +209,52 @@ void dgWorldDynamicUpdate::SortClustersByCount ()
 	dgSort(m_clusterMemory, m_clusters, CompareClusters);
 }
 
-void dgWorldDynamicUpdate::BuildClusters(dgFloat32 timestep)
+void dgWorldDynamicUpdate::ClusterBuildFor (dgClusterBuildKernel::dgKernel kernel, dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 minChunkSize) const
+{
+	dgWorld* const world = (dgWorld*) this;
+	dgClusterBuildKernel parallelKernel (this, kernel, syncData);
+	world->ParallelFor (parallelKernel, start, end, minChunkSize);
+}
+
+bool dgWorldDynamicUpdate::IsClusterJoint (const dgBody* const body, const dgConstraint* const constraint)
+{
+	// a joint belongs to its dynamic body with the lowest slot, body0 can not be used because the body order 
+	// of a contact depends on the thread that made it. the joint links the cluster when any of its dynamic 
+	// bodies reaches a collidable body
+	const dgBody* const body0 = constraint->m_body0;
+	const dgBody* const body1 = constraint->m_body1;
+	const bool isDynamic0 = body0->GetInvMass().m_w > dgFloat32(0.0f);
+	const bool isDynamic1 = body1->GetInvMass().m_w > dgFloat32(0.0f);
+	const dgBody* const owner = (isDynamic0 && (!isDynamic1 || (body0->m_index < body1->m_index))) ? body0 : body1;
+	if (body != owner) {
+		return false;
+	}
+
+	bool isLinked = (isDynamic0 && body1->IsCollidable()) || (isDynamic1 && body0->IsCollidable());
+	if (isLinked && (constraint->GetId() == dgConstraint::m_contactConstraint)) {
+		const dgContact* const contact = (dgContact*)constraint;
+		isLinked = (contact->m_contactActive && contact->m_maxDOF) || (body0->m_continueCollisionMode | body1->m_continueCollisionMode);
+	}
+	return isLinked;
+}
+
+dgInt32 dgWorldDynamicUpdate::FindClusterRoot (dgInt32* const parent, dgInt32 index)
+{
+	// path halving, a lost race only leaves a longer path for the next search
+	dgInt32 node = index;
+	dgInt32 nodeParent = parent[node];
+	while (nodeParent != node) {
+		const dgInt32 grandParent = parent[nodeParent];
+		if (grandParent != nodeParent) {
+			dgAtomicCompareAndSwap (&parent[node], nodeParent, grandParent);
+		}
+		node = grandParent;
+		nodeParent = parent[node];
+	}
+	return node;
+}
+
+void dgWorldDynamicUpdate::BuildClustersSerial(dgFloat32 timestep)
 {
 	dgWorld* const world = (dgWorld*) this;
 	dgUnsigned32 lru = m_markLru - 1;
@@ -311,6 +393,10 @@ void dgWorldDynamicUpdate::SpanningTree (dgDynamicBody* const body, dgDynamicBod
 			body1->m_sleeping = globalAutoSleep;
 		}
 	} else {
+		for (dgInt32 i = 1; i < bodyCount; i++) {
+			WakeClusterBody (bodyArray[m_bodies + i].m_body, timestep, 0);
+		}
+
 		if (world->m_clusterUpdate) {
 			dgClusterCallbackStruct record;
 			record.m_world = world;
@@ -425,6 +511,397 @@ void dgWorldDynamicUpdate::SpanningTree (dgDynamicBody* const body, dgDynamicBod
 }
 
 
+void dgWorldDynamicUpdate::BuildClusters(dgFloat32 timestep)
+{
+	dgWorld* const world = (dgWorld*) this;
+	if (world->GetThreadCount() == 1) {
+		// the union find makes several passes over the bodies and only pays off when they are split 
+		// between threads, a single thread is faster walking each cluster once
+		BuildClustersSerial(timestep);
+		return;
+	}
+
+	const dgUnsigned32 lru = m_markLru - 1;
+
+	dgBodyMasterList& masterList = *world;
+	dgAssert (masterList.GetFirst()->GetInfo().GetBody() == world->m_sentinelBody);
+
+	dgInt32 bodyCount = 0;
+	dgBodyMasterList::dgListNode* node = masterList.GetLast();
+	for (; node && (node->GetInfo().GetBody()->GetInvMass().m_w != dgFloat32(0.0f)); node = node->GetPrev()) {
+		bodyCount ++;
+	}
+#ifdef _DEBUG
+	for (; node; node = node->GetPrev()) {
+		dgAssert(node->GetInfo().GetBody()->GetInvMass().m_w == dgFloat32(0.0f));
+	}
+#endif
+	if (!bodyCount) {
+		return;
+	}
+
+	const dgInt32 blockCount = (bodyCount + DG_CLUSTER_BUILD_BLOCK_SIZE - 1) / DG_CLUSTER_BUILD_BLOCK_SIZE;
+	const dgInt32 runsCount = blockCount * DG_CLUSTER_BUILD_BLOCK_SIZE;
+	world->m_solverJacobiansMemory.ResizeIfNecessary (bodyCount * (sizeof (dgBody*) + sizeof (dgClusterBuildSyncData::dgComponent) + 5 * sizeof (dgInt32)) + runsCount * sizeof (dgClusterBuildSyncData::dgBodyRun) + blockCount * sizeof (dgInt32));
+
+	dgClusterBuildSyncData syncData;
+	syncData.m_bodies = (dgBody**)&world->m_solverJacobiansMemory[0];
+	syncData.m_runs = (dgClusterBuildSyncData::dgBodyRun*)&syncData.m_bodies[bodyCount];
+	syncData.m_components = (dgClusterBuildSyncData::dgComponent*)&syncData.m_runs[runsCount];
+	syncData.m_parent = (dgInt32*)&syncData.m_components[bodyCount];
+	syncData.m_isSeed = &syncData.m_parent[bodyCount];
+	syncData.m_bodyJointCount = &syncData.m_isSeed[bodyCount];
+	syncData.m_bodyRowsCount = &syncData.m_bodyJointCount[bodyCount];
+	syncData.m_componentIndex = &syncData.m_bodyRowsCount[bodyCount];
+	syncData.m_blockRunCount = &syncData.m_componentIndex[bodyCount];
+	syncData.m_timestep = timestep;
+	syncData.m_bodyCount = bodyCount;
+	syncData.m_blockCount = blockCount;
+	syncData.m_clusterLRU = world->m_clusterLRU;
+	syncData.m_lruMark = lru;
+
+	// until the clusters are laid out the body index is the body slot in the union find arrays
+	dgInt32 index = 0;
+	for (node = masterList.GetLast(); index < bodyCount; node = node->GetPrev()) {
+		dgBody* const body = node->GetInfo().GetBody();
+		dgInt32 isSeed = 0;
+		if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
+			dgDynamicBody* const dynamicBody = (dgDynamicBody*)body;
+			isSeed = (dynamicBody->m_dynamicsLru < lru) && !(dynamicBody->m_freeze | dynamicBody->m_spawnnedFromCallback | dynamicBody->m_sleeping);
+			dynamicBody->m_spawnnedFromCallback = false;
+		}
+		body->m_index = index;
+		syncData.m_bodies[index] = body;
+		syncData.m_parent[index] = index;
+		syncData.m_isSeed[index] = isSeed;
+		syncData.m_componentIndex[index] = -2;
+		index ++;
+	}
+
+	ClusterBuildFor (&dgWorldDynamicUpdate::UnionClusterBodiesKernel, &syncData, 0, bodyCount, DG_CLUSTER_BUILD_BLOCK_SIZE);
+	ClusterBuildFor (&dgWorldDynamicUpdate::FindClusterRootsKernel, &syncData, 0, bodyCount, DG_CLUSTER_BUILD_BLOCK_SIZE);
+	ClusterBuildFor (&dgWorldDynamicUpdate::CountClusterRunsKernel, &syncData, 0, blockCount, 1);
+
+	// the runs are visited in body order, so the cluster numbering and the body offsets 
+	// inside each cluster are the same ones a serial walk of the master list would produce
+	dgInt32 componentCount = 0;
+	dgClusterBuildSyncData::dgComponent* const components = syncData.m_components;
+	for (dgInt32 i = 0; i < blockCount; i ++) {
+		dgClusterBuildSyncData::dgBodyRun* const runs = &syncData.m_runs[i * DG_CLUSTER_BUILD_BLOCK_SIZE];
+		for (dgInt32 j = 0; j < syncData.m_blockRunCount[i]; j ++) {
+			dgClusterBuildSyncData::dgBodyRun& run = runs[j];
+			dgInt32& componentIndex = syncData.m_componentIndex[run.m_root];
+			if (componentIndex < 0) {
+				componentIndex = componentCount;
+				memset (&components[componentCount], 0, sizeof (dgClusterBuildSyncData::dgComponent));
+				components[componentCount].m_bodyCount = 1;
+				componentCount ++;
+			}
+			dgClusterBuildSyncData::dgComponent& component = components[componentIndex];
+			run.m_bodyOffset = component.m_bodyCount;
+			run.m_jointOffset = component.m_jointCount;
+			component.m_bodyCount += run.m_bodyCount;
+			component.m_jointCount += run.m_jointCount;
+			component.m_rowsCount += run.m_rowsCount;
+			component.m_awakeCount += run.m_awakeCount;
+			component.m_hasSoftBodies |= run.m_hasSoftBodies;
+		}
+	}
+	if (!componentCount) {
+		return;
+	}
+
+	dgInt32 bodyStart = 0;
+	dgInt32 jointStart = 0;
+	for (dgInt32 i = 0; i < componentCount; i ++) {
+		components[i].m_bodyStart = bodyStart;
+		components[i].m_jointStart = jointStart;
+		bodyStart += components[i].m_bodyCount;
+		jointStart += components[i].m_jointCount;
+	}
+
+	world->m_bodiesMemory.ResizeIfNecessary (bodyStart * sizeof (dgBodyInfo));
+	world->m_jointsMemory.ResizeIfNecessary ((jointStart + 1) * sizeof (dgJointInfo));
+	syncData.m_bodyArray = (dgBodyInfo*)&world->m_bodiesMemory[0];
+	syncData.m_jointArray = (dgJointInfo*)&world->m_jointsMemory[0];
+	syncData.m_jointCount = jointStart;
+
+	dgAssert(world->m_sentinelBody->m_index == 0);
+	dgAssert(dgInt32(world->m_sentinelBody->m_dynamicsLru) == m_markLru);
+	for (dgInt32 i = 0; i < componentCount; i ++) {
+		syncData.m_bodyArray[components[i].m_bodyStart].m_body = world->m_sentinelBody;
+	}
+
+	ClusterBuildFor (&dgWorldDynamicUpdate::ScatterClusterRunsKernel, &syncData, 0, blockCount, 1);
+	ClusterBuildFor (&dgWorldDynamicUpdate::InitClusterJointsKernel, &syncData, 0, jointStart, DG_CLUSTER_BUILD_BLOCK_SIZE);
+
+	world->m_clusterLRU += componentCount;
+	world->m_clusterMemory.ResizeIfNecessary (componentCount * sizeof (dgBodyCluster));
+	m_clusterMemory = (dgBodyCluster*) &world->m_clusterMemory[0];
+
+	for (dgInt32 i = 0; i < componentCount; i ++) {
+		const dgClusterBuildSyncData::dgComponent& component = components[i];
+		if (!component.m_awakeCount) {
+			continue;
+		}
+
+		if (world->m_clusterUpdate) {
+			dgClusterCallbackStruct record;
+			record.m_world = world;
+			record.m_count = component.m_bodyCount;
+			record.m_strideInByte = sizeof (dgBodyInfo);
+			record.m_bodyArray = &syncData.m_bodyArray[component.m_bodyStart].m_body;
+			if (!world->m_clusterUpdate(world, &record, component.m_bodyCount)) {
+				continue;
+			}
+		}
+
+		dgBodyCluster& cluster = m_clusterMemory[m_clusters];
+		cluster.m_bodyStart = component.m_bodyStart;
+		cluster.m_jointStart = component.m_jointStart;
+		cluster.m_bodyCount = component.m_bodyCount;
+		cluster.m_clusterLRU = syncData.m_clusterLRU + i;
+		cluster.m_jointCount = component.m_jointCount;
+		cluster.m_rowsStart = 0;
+		cluster.m_rowsCount = component.m_isContinueCollision ? dgMax(component.m_rowsCount, 64) : component.m_rowsCount;
+		cluster.m_hasSoftBodies = dgInt16 (component.m_hasSoftBodies);
+		cluster.m_isContinueCollision = dgInt16 (component.m_isContinueCollision);
+		m_clusters ++;
+	}
+
+	// clusters that went to sleep or were rejected by the application leave their slots unused
+	m_bodies = bodyStart;
+	m_joints = jointStart;
+}
+
+void dgWorldDynamicUpdate::WakeClusterBody (dgBody* const body, dgFloat32 timestep, dgInt32 threadID) const
+{
+	const dgWorld* const world = (dgWorld*) this;
+	if ((body->m_activeIndex < 0) || (body->m_activeIndex >= world->m_activeBodiesUpdatedCount)) {
+		// sleeping bodies connected to awake ones are woken up here, they were not in the active 
+		// list when the forces were applied, and the solver may have left joint forces in theirs.
+		// the body is activated first so that setting its force from the callback does not wake it again
+		body->Activate();
+		if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
+			dgDynamicBody* const dynamicBody = (dgDynamicBody*)body;
+			dynamicBody->ApplyExtenalForces(timestep, threadID);
+			dynamicBody->m_savedExternalForce = dynamicBody->m_externalForce;
+			dynamicBody->m_savedExternalTorque = dynamicBody->m_externalTorque;
+		}
+	}
+}
+
+void dgWorldDynamicUpdate::UnionClusterBodiesKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
+{
+	dgInt32* const parent = syncData->m_parent;
+	const dgInt32 vectorStride = dgInt32 (sizeof (dgVector) / sizeof (dgFloat32));
+	for (dgInt32 i = start; i < end; i ++) {
+		dgInt32 jointCount = 0;
+		dgInt32 rowsCount = 0;
+		dgBody* const body = syncData->m_bodies[i];
+		dgAssert (body->m_index == i);
+		for (dgBodyMasterListRow::dgListNode* jointNode = body->m_masterNode->GetInfo().GetFirst(); jointNode; jointNode = jointNode->GetNext()) {
+			dgBodyMasterListCell* const cell = &jointNode->GetInfo();
+			dgConstraint* const constraint = cell->m_joint;
+			if (!IsClusterJoint(body, constraint)) {
+				continue;
+			}
+
+			// tag the joint with its owner slot so that the scatter pass does not have to test it again
+			constraint->m_index = i;
+			constraint->m_dynamicsLru = syncData->m_lruMark;
+			jointCount ++;
+			rowsCount += (constraint->m_maxDOF + vectorStride - 1) & (-vectorStride);
+
+			const dgBody* const linkBody = cell->m_bodyNode;
+			if (linkBody->GetInvMass().m_w > dgFloat32(0.0f)) {
+				// the smaller index always become the root, so that linking two roots can never make a cycle
+				dgInt32 root0 = FindClusterRoot (parent, i);
+				dgInt32 root1 = FindClusterRoot (parent, linkBody->m_index);
+				while (root0 != root1) {
+					const dgInt32 child = dgMax (root0, root1);
+					const dgInt32 root = dgMin (root0, root1);
+					if (dgAtomicCompareAndSwap (&parent[child], child, root)) {
+						break;
+					}
+					root0 = FindClusterRoot (parent, root0);
+					root1 = FindClusterRoot (parent, root1);
+				}
+			}
+		}
+		syncData->m_bodyJointCount[i] = jointCount;
+		syncData->m_bodyRowsCount[i] = rowsCount;
+	}
+}
+
+void dgWorldDynamicUpdate::FindClusterRootsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
+{
+	dgInt32* const parent = syncData->m_parent;
+	for (dgInt32 i = start; i < end; i ++) {
+		const dgInt32 root = FindClusterRoot (parent, i);
+		parent[i] = root;
+		if (syncData->m_isSeed[i]) {
+			syncData->m_componentIndex[root] = -1;
+		}
+	}
+}
+
+void dgWorldDynamicUpdate::CountClusterRunsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
+{
+	for (dgInt32 i = start; i < end; i ++) {
+		dgInt32 runCount = 0;
+		dgClusterBuildSyncData::dgBodyRun* const runs = &syncData->m_runs[i * DG_CLUSTER_BUILD_BLOCK_SIZE];
+		const dgInt32 bodyEnd = dgMin ((i + 1) * DG_CLUSTER_BUILD_BLOCK_SIZE, syncData->m_bodyCount);
+		for (dgInt32 j = i * DG_CLUSTER_BUILD_BLOCK_SIZE; j < bodyEnd; j ++) {
+			const dgInt32 root = syncData->m_parent[j];
+			if (syncData->m_componentIndex[root] == -2) {
+				continue;
+			}
+			if (!runCount || (runs[runCount - 1].m_root != root)) {
+				memset (&runs[runCount], 0, sizeof (dgClusterBuildSyncData::dgBodyRun));
+				runs[runCount].m_root = root;
+				runCount ++;
+			}
+
+			dgClusterBuildSyncData::dgBodyRun& run = runs[runCount - 1];
+			dgBody* const body = syncData->m_bodies[j];
+			run.m_bodyCount ++;
+			run.m_awakeCount += (body->m_autoSleep & body->m_equilibrium) ? 0 : 1;
+			run.m_hasSoftBodies |= (body->m_collision->IsType(dgCollision::dgCollisionDeformableMesh_RTTI) ? 1 : 0);
+			run.m_jointCount += syncData->m_bodyJointCount[j];
+			run.m_rowsCount += syncData->m_bodyRowsCount[j];
+		}
+		syncData->m_blockRunCount[i] = runCount;
+	}
+}
+
+void dgWorldDynamicUpdate::ScatterClusterRunsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
+{
+	const dgInt32 vectorStride = dgInt32 (sizeof (dgVector) / sizeof (dgFloat32));
+	for (dgInt32 i = start; i < end; i ++) {
+		dgInt32 runIndex = -1;
+		dgInt32 bodyIndex = 0;
+		dgInt32 jointIndex = 0;
+		dgInt32 clusterLRU = 0;
+		const dgClusterBuildSyncData::dgComponent* component = NULL;
+		const dgClusterBuildSyncData::dgBodyRun* const runs = &syncData->m_runs[i * DG_CLUSTER_BUILD_BLOCK_SIZE];
+		const dgInt32 bodyEnd = dgMin ((i + 1) * DG_CLUSTER_BUILD_BLOCK_SIZE, syncData->m_bodyCount);
+		for (dgInt32 j = i * DG_CLUSTER_BUILD_BLOCK_SIZE; j < bodyEnd; j ++) {
+			const dgInt32 root = syncData->m_parent[j];
+			const dgInt32 componentIndex = syncData->m_componentIndex[root];
+			if (componentIndex < 0) {
+				continue;
+			}
+			if ((runIndex < 0) || (runs[runIndex].m_root != root)) {
+				runIndex ++;
+				dgAssert (runIndex < syncData->m_blockRunCount[i]);
+				dgAssert (runs[runIndex].m_root == root);
+				component = &syncData->m_components[componentIndex];
+				bodyIndex = component->m_bodyStart + runs[runIndex].m_bodyOffset;
+				jointIndex = component->m_jointStart + runs[runIndex].m_jointOffset;
+				clusterLRU = syncData->m_clusterLRU + componentIndex;
+			}
+
+			// the joints were tagged by the union pass, so no other body is read here and the body can be updated in place
+			dgBody* const body = syncData->m_bodies[j];
+			syncData->m_bodyArray[bodyIndex].m_body = body;
+			body->m_index = bodyIndex - component->m_bodyStart;
+			body->m_dynamicsLru = m_markLru;
+			body->m_resting = body->m_equilibrium;
+			body->m_sleeping = component->m_awakeCount ? false : true;
+			if (component->m_awakeCount) {
+				WakeClusterBody (body, syncData->m_timestep, threadID);
+			}
+			bodyIndex ++;
+			for (dgBodyMasterListRow::dgListNode* jointNode = body->m_masterNode->GetInfo().GetFirst(); jointNode; jointNode = jointNode->GetNext()) {
+				dgConstraint* const constraint = jointNode->GetInfo().m_joint;
+				if ((constraint->m_dynamicsLru == syncData->m_lruMark) && (dgInt32 (constraint->m_index) == j)) {
+					dgJointInfo& jointInfo = syncData->m_jointArray[jointIndex];
+					jointInfo.m_joint = constraint;
+					jointInfo.m_pairCount = dgInt16 ((constraint->m_maxDOF + vectorStride - 1) & (-vectorStride));
+					constraint->m_clusterLRU = clusterLRU;
+					jointIndex ++;
+				}
+			}
+		}
+	}
+}
+
+void dgWorldDynamicUpdate::InitClusterJointsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
+{
+	dgWorld* const world = (dgWorld*) this;
+	const dgFloat32 timestep = syncData->m_timestep;
+	for (dgInt32 i = start; i < end; i ++) {
+		dgJointInfo* const jointInfo = &syncData->m_jointArray[i];
+		dgConstraint* const joint = jointInfo->m_joint;
+		dgClusterBuildSyncData::dgComponent& component = syncData->m_components[joint->m_clusterLRU - syncData->m_clusterLRU];
+		joint->m_index = i - component.m_jointStart;
+		if (!component.m_awakeCount) {
+			continue;
+		}
+
+		dgBody* const body0 = joint->m_body0;
+		dgBody* const body1 = joint->m_body1;
+
+		dgInt32 m0 = (body0->GetInvMass().m_w != dgFloat32(0.0f)) ? body0->m_index : 0;
+		dgInt32 m1 = (body1->GetInvMass().m_w != dgFloat32(0.0f)) ? body1->m_index : 0;
+
+		jointInfo->m_m0 = m0;
+		jointInfo->m_m1 = m1;
+
+		dgAssert (jointInfo->m_pairCount >= 0);
+		dgAssert (jointInfo->m_pairCount < 64);
+		if (joint->GetId() == dgConstraint::m_contactConstraint) {
+			if (body0->m_continueCollisionMode | body1->m_continueCollisionMode) {
+				dgInt32 ccdJoint = false;
+				const dgVector& veloc0 = body0->m_veloc;
+				const dgVector& veloc1 = body1->m_veloc;
+
+				const dgVector& omega0 = body0->m_omega;
+				const dgVector& omega1 = body1->m_omega;
+
+				const dgVector& com0 = body0->m_globalCentreOfMass;
+				const dgVector& com1 = body1->m_globalCentreOfMass;
+
+				const dgCollisionInstance* const collision0 = body0->m_collision;
+				const dgCollisionInstance* const collision1 = body1->m_collision;
+				dgFloat32 dist = dgMax(body0->m_collision->GetBoxMinRadius(), body1->m_collision->GetBoxMinRadius()) * dgFloat32(0.25f);
+
+				dgVector relVeloc(veloc1 - veloc0);
+				dgVector relOmega(omega1 - omega0);
+				dgVector relVelocMag2(relVeloc.DotProduct4(relVeloc));
+				dgVector relOmegaMag2(relOmega.DotProduct4(relOmega));
+
+				if ((relOmegaMag2.m_w > dgFloat32(1.0f)) || ((relVelocMag2.m_w * timestep * timestep) > (dist * dist))) {
+					dgTriplex normals[16];
+					dgTriplex points[16];
+					dgInt64 attrib0[16];
+					dgInt64 attrib1[16];
+					dgFloat32 penetrations[16];
+					dgFloat32 timeToImpact = timestep;
+					const dgInt32 ccdContactCount = world->CollideContinue(collision0, body0->m_matrix, veloc0, omega0, collision1, body1->m_matrix, veloc1, omega1,
+																		   timeToImpact, points, normals, penetrations, attrib0, attrib1, 6, threadID);
+
+					for (dgInt32 j = 0; j < ccdContactCount; j++) {
+						dgVector point(&points[j].m_x);
+						dgVector normal(&normals[j].m_x);
+						dgVector vel0(veloc0 + omega0.CrossProduct3(point - com0));
+						dgVector vel1(veloc1 + omega1.CrossProduct3(point - com1));
+						dgVector vRel(vel1 - vel0);
+						dgFloat32 contactDistTravel = vRel.DotProduct4(normal).m_w * timestep;
+						ccdJoint |= (contactDistTravel > dist);
+					}
+				}
+				if (ccdJoint) {
+					dgInterlockedExchange (&component.m_isContinueCollision, 1);
+				}
+				dgAtomicExchangeAndAdd (&component.m_rowsCount, DG_CCD_EXTRA_CONTACT_COUNT);
+			}
+		}
+	}
+}
+
+
 dgInt32 dgWorldDynamicUpdate::SortClusters(const dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 threadID) const
 {
 	dgWorld* const world = (dgWorld*) this;
@@ -587,12 +1064,38 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForcesKernel (void* const con
 	dgInt32 count = descriptor->m_clusterCount;
 	dgBodyCluster* const clusters = &((dgBodyCluster*)&world->m_clusterMemory[0])[descriptor->m_firstCluster];
 
+	dgProfilerScope scope (&world->m_profiler, m_profileSolveClusters, threadID);
 	for (dgInt32 i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1); i < count; i = dgAtomicExchangeAndAdd(&descriptor->m_atomicCounter, 1)) {
 		dgBodyCluster* const cluster = &clusters[i]; 
 		world->ResolveClusterForces (cluster, threadID, timestep);
 	}
 }
 
+void dgWorldDynamicUpdate::BigClustersGateKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	// nothing to do, the task only completes once the big clusters are solved
+}
+
+void dgWorldDynamicUpdate::IntegrateSoftBodyClustersKernel (void* const context, void* const worldContext, dgInt32 threadID)
+{
+	dgWorldDynamicUpdateSyncDescriptor* const descriptor = (dgWorldDynamicUpdateSyncDescriptor*) context;
+
+	dgFloat32 timestep = descriptor->m_timestep;
+	dgWorld* const world = (dgWorld*) worldContext;
+	dgBodyCluster* const clusters = (dgBodyCluster*)&world->m_clusterMemory[0];
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+
+	for (dgInt32 i = 0; i < descriptor->m_softBodiesCount; i++) {
+		dgBodyCluster* const cluster = &clusters[i];
+		dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+		dgAssert (cluster->m_bodyCount == 2);
+		dgDynamicBody* const body = (dgDynamicBody*)bodyArray[1].m_body;
+		dgAssert (body->m_collision->IsType(dgCollision::dgCollisionLumpedMass_RTTI));
+		body->IntegrateOpenLoopExternalForce(timestep);
+		world->IntegrateVelocity(cluster, DG_SOLVER_MAX_ERROR, timestep, threadID);
+	}
+}
+
 dgInt32 dgWorldDynamicUpdate::GetJacobianDerivatives (dgContraintDescritor& constraintParamOut, dgJointInfo* const jointInfo, dgConstraint* const constraint, dgJacobianMatrixElement* const matrixRow, dgInt32 rowCount) const
 {
 	dgInt32 dof = dgInt32(constraint->m_maxDOF);
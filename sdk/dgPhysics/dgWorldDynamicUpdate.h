@@ -39,6 +39,9 @@
 #define	DG_FREEZZING_VELOCITY_DRAG		dgFloat32 (0.9f)
 #define	DG_SOLVER_MAX_ERROR				(DG_FREEZE_ACCEL * dgFloat32 (0.5f))
 
+#define DG_PARALLEL_JOINT_OVERFLOW_COLOR	31
+#define DG_WIDE_SOLVER_MIN_JOINT_COUNT		32
+
 
 // the solver is a RK order 4, but instead of weighting the intermediate derivative by the usual 1/6, 1/3, 1/3, 1/6 coefficients
 // I am using 1/4, 1/4, 1/4, 1/4.
@@ -55,6 +58,7 @@
 
 class dgBody;
 class dgDynamicBody;
+class dgClusterBuildSyncData;
 class dgParallelSolverSyncData;
 class dgWorldDynamicUpdateSyncDescriptor;
 
@@ -135,18 +139,75 @@ class dgParallelSolverSyncData
 	dgInt32 m_jointCount;
 	dgInt32 m_rowCount;
 	dgInt32 m_atomicIndex;
-	dgInt32 m_lock0;
-	dgInt32 m_lock1;
 	dgInt32 m_jacobianMatrixRowAtomicIndex;
 
 	dgInt32* m_bodyLocks;  
 	const dgBodyCluster* m_cluster;
 	dgParallelJointMap* m_jointConflicts;
-	dgInt32 m_jointBatches[32];
+	dgInt32 m_jointBatches[DG_PARALLEL_JOINT_OVERFLOW_COLOR + 3];
 	dgInt32 m_hasJointFeeback[DG_MAX_THREADS_HIVE_COUNT];
 };
 
 
+// the clusters are found with a concurrent union find over the joints of the dynamic bodies, 
+// the bodies are then laid out in fixed size blocks of runs so that the body and joint order 
+// of each cluster does not depend on the number of worker threads.
+#define DG_CLUSTER_BUILD_BLOCK_SIZE		256
+
+class dgClusterBuildSyncData
+{
+	public:
+	class dgComponent
+	{
+		public:
+		dgInt32 m_bodyStart;
+		dgInt32 m_jointStart;
+		dgInt32 m_bodyCount;
+		dgInt32 m_jointCount;
+		dgInt32 m_rowsCount;
+		dgInt32 m_awakeCount;
+		dgInt32 m_hasSoftBodies;
+		dgInt32 m_isContinueCollision;
+	};
+
+	class dgBodyRun
+	{
+		public:
+		dgInt32 m_root;
+		dgInt32 m_bodyCount;
+		dgInt32 m_jointCount;
+		dgInt32 m_rowsCount;
+		dgInt32 m_awakeCount;
+		dgInt32 m_hasSoftBodies;
+		dgInt32 m_bodyOffset;
+		dgInt32 m_jointOffset;
+	};
+
+	dgClusterBuildSyncData()
+	{
+		memset (this, 0, sizeof (dgClusterBuildSyncData));
+	}
+
+	dgBody** m_bodies;
+	dgInt32* m_parent;
+	dgInt32* m_isSeed;
+	dgInt32* m_bodyJointCount;
+	dgInt32* m_bodyRowsCount;
+	dgInt32* m_componentIndex;
+	dgInt32* m_blockRunCount;
+	dgBodyRun* m_runs;
+	dgComponent* m_components;
+	dgBodyInfo* m_bodyArray;
+	dgJointInfo* m_jointArray;
+	dgFloat32 m_timestep;
+	dgInt32 m_bodyCount;
+	dgInt32 m_blockCount;
+	dgInt32 m_jointCount;
+	dgInt32 m_clusterLRU;
+	dgUnsigned32 m_lruMark;
+};
+
+
 template<class T>
 class dgQueue
 {
@@ -235,6 +296,17 @@ class dgJacobianMemory
 
 	dgJacobian* m_internalForcesBuffer;
 	dgJacobianMatrixElement* m_jacobianBuffer;
+
+	// per body solver state, indexed like m_internalForcesBuffer. it is gathered from the bodies 
+	// when the cluster jacobians are built and scattered back once the cluster forces are solved, 
+	// so that the solver passes stream through contiguous arrays instead of the body objects
+	dgVector* m_bodyVeloc;
+	dgVector* m_bodyOmega;
+	dgVector* m_bodyExternalForce;
+	dgVector* m_bodyExternalTorque;
+	dgMatrix* m_bodyInvInertia;
+	dgFloat32* m_bodyInvMass;
+	dgInt32* m_bodyResting;
 };
 
 class dgWorldDynamicUpdate
@@ -245,48 +317,112 @@ class dgWorldDynamicUpdate
 	dgBody* GetClusterBody (const void* const cluster, dgInt32 index) const;
 
 	private:
+	class dgParallelSolverKernel
+	{
+		public:
+		typedef void (dgWorldDynamicUpdate::*dgKernel) (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+
+		dgParallelSolverKernel (const dgWorldDynamicUpdate* const me, dgKernel kernel, dgParallelSolverSyncData* const syncData)
+			:m_me(me)
+			,m_kernel(kernel)
+			,m_syncData(syncData)
+		{
+		}
+
+		void operator() (dgInt32 start, dgInt32 end, dgInt32 threadID) const
+		{
+			(m_me->*m_kernel) (m_syncData, start, end, threadID);
+		}
+
+		const dgWorldDynamicUpdate* m_me;
+		dgKernel m_kernel;
+		dgParallelSolverSyncData* m_syncData;
+	};
+
+	class dgClusterBuildKernel
+	{
+		public:
+		typedef void (dgWorldDynamicUpdate::*dgKernel) (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+
+		dgClusterBuildKernel (const dgWorldDynamicUpdate* const me, dgKernel kernel, dgClusterBuildSyncData* const syncData)
+			:m_me(me)
+			,m_kernel(kernel)
+			,m_syncData(syncData)
+		{
+		}
+
+		void operator() (dgInt32 start, dgInt32 end, dgInt32 threadID) const
+		{
+			(m_me->*m_kernel) (m_syncData, start, end, threadID);
+		}
+
+		const dgWorldDynamicUpdate* m_me;
+		dgKernel m_kernel;
+		dgClusterBuildSyncData* m_syncData;
+	};
+
 	void BuildClusters(dgFloat32 timestep);
-	dgInt32 SortClusters(const dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 threadID) const;
+	void BuildClustersSerial(dgFloat32 timestep);
 	void SpanningTree (dgDynamicBody* const body, dgDynamicBody** const queueBuffer, dgFloat32 timestep);
+	void WakeClusterBody (dgBody* const body, dgFloat32 timestep, dgInt32 threadID) const;
+	dgInt32 SortClusters(const dgBodyCluster* const cluster, dgFloat32 timestep, dgInt32 threadID) const;
+
+	void ClusterBuildFor (dgClusterBuildKernel::dgKernel kernel, dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 minChunkSize) const;
+	void UnionClusterBodiesKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+	void FindClusterRootsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+	void CountClusterRunsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+	void ScatterClusterRunsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+	void InitClusterJointsKernel (dgClusterBuildSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const;
+
+	static dgInt32 FindClusterRoot (dgInt32* const parent, dgInt32 index);
+	static bool IsClusterJoint (const dgBody* const body, const dgConstraint* const constraint);
 	
 	static dgInt32 CompareClusters (const dgBodyCluster* const clusterA, const dgBodyCluster* const clusterB, void* notUsed);
 
 	static void CalculateClusterReactionForcesKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void IntegrateSoftBodyClustersKernel (void* const context, void* const worldContext, dgInt32 threadID);
+	static void BigClustersGateKernel (void* const context, void* const worldContext, dgInt32 threadID);
 
-	static void IntegrateInslandParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void InitializeBodyArrayParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void BuildJacobianMatrixParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void SolverInitInternalForcesParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void CalculateJointsForceParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void CalculateJointsAccelParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void CalculateJointsVelocParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void KinematicCallbackUpdateParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void UpdateFeedbackForcesParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
-	static void UpdateBodyVelocityParallelKernel (void* const context, void* const worldContext, dgInt32 threadID); 
 	static dgInt32 SortJointInfoByColor(const dgParallelSolverSyncData::dgParallelJointMap* const indirectIndexA, const dgParallelSolverSyncData::dgParallelJointMap* const indirectIndexB, void* const context);
 
+	void InitializeBodyArrayParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void BuildJacobianMatrixParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void CalculateJointsForceParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void CalculateJointsAccelParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void CalculateJointsVelocParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void KinematicCallbackUpdateParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void UpdateFeedbackForcesParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void UpdateBodyVelocityParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const; 
+	void ParallelSolverFor (dgParallelSolverKernel::dgKernel kernel, dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 minChunkSize) const;
+
 	void IntegrateClusterParallel(dgParallelSolverSyncData* const syncData) const; 
 	void InitilizeBodyArrayParallel (dgParallelSolverSyncData* const syncData) const; 
 	void BuildJacobianMatrixParallel (dgParallelSolverSyncData* const syncData) const; 
-	void SolverInitInternalForcesParallel (dgParallelSolverSyncData* const syncData) const; 
+	void CalculateJointsForceParallel (dgParallelSolverSyncData* const syncData) const; 
 	void CalculateForcesGameModeParallel (dgParallelSolverSyncData* const syncData) const; 
 
-	void CalculateReactionForcesParallel (const dgBodyCluster* const cluster, dgFloat32 timestep) const;
+	void CalculateReactionForcesParallel (dgBodyCluster* const cluster, dgFloat32 timestep) const;
 	void LinearizeJointParallelArray(dgParallelSolverSyncData* const solverSyncData, dgJointInfo* const constraintArray, const dgBodyCluster* const cluster) const;
 
 	void CalculateNetAcceleration (dgBody* const body, const dgVector& invTimeStep, const dgVector& accNorm) const;
+	void GatherBodyState (const dgBodyCluster* const cluster, dgInt32 start, dgInt32 end, dgFloat32 timestep) const;
+	void IntegrateBodyState (const dgBodyCluster* const cluster, dgInt32 start, dgInt32 end, dgFloat32 timestep) const;
+	void ScatterBodyState (const dgBodyCluster* const cluster, dgInt32 start, dgInt32 end) const;
+	void SetJointAccelerationBodies (dgJointAccelerationDecriptor* const desc, const dgJointInfo* const jointInfo, const dgVector* const veloc, const dgVector* const omega) const;
 	void BuildJacobianMatrix (dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
 	void ResolveClusterForces (dgBodyCluster* const cluste, dgInt32 threadID, dgFloat32 timestep) const;
 	void IntegrateReactionsForces(const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
 	void CalculateClusterReactionForces (const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
 	void CalculateSingleContactReactionForces (const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
-	void BuildJacobianMatrix (const dgBodyInfo* const bodyInfo, dgJointInfo* const jointInfo, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow, dgFloat32 forceImpulseScale) const;
+	void BuildJacobianMatrix (const dgBodyInfo* const bodyInfo, dgJointInfo* const jointInfo, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow, dgFloat32 forceImpulseScale, dgInt32* const bodyLocks = NULL) const;
 		
 	dgFloat32 CalculateJointForce____(const dgJointInfo* const jointInfo, const dgBodyInfo* const bodyArray, dgJacobianMatrixElement* const matrixRow) const;
 	void CalculateResidual____ (dgInt32 const bodyCount, dgInt32 const jointCount, const dgJointInfo* const jointArray, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const;
 	void CalculateClusterReactionForces____ (const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const;
 		
-	dgFloat32 CalculateJointForce(const dgJointInfo* const jointInfo, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const;
+	dgFloat32 CalculateJointForce(const dgJointInfo* const jointInfo, const dgInt32* const bodyResting, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const;
+	dgInt32 BuildJointGroupsWide (const dgBodyCluster* const cluster, dgInt32 threadID) const;
+	dgFloat32 CalculateJointForceWide (const dgBodyCluster* const cluster, dgInt32 threadID) const;
 	dgFloat32 CalculateJointForce_1_50(const dgJointInfo* const jointInfo, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const;
 	dgFloat32 CalculateJointForce_3_13(const dgJointInfo* const jointInfo, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const;
 
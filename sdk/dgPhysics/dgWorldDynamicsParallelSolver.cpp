@@ -27,32 +27,40 @@
 #include "dgDynamicBody.h"
 #include "dgWorldDynamicUpdate.h"
 
+#define DG_PARALLEL_BODY_CHUNK_SIZE		16
+#define DG_PARALLEL_JOINT_CHUNK_SIZE	4
 
 
-
-
-void dgWorldDynamicUpdate::CalculateReactionForcesParallel(const dgBodyCluster* const cluster, dgFloat32 timestep) const
+void dgWorldDynamicUpdate::CalculateReactionForcesParallel(dgBodyCluster* const cluster, dgFloat32 timestep) const
 {
-	dgAssert(0);
-	/*
-	dgParallelSolverSyncData syncData;
-
 	dgWorld* const world = (dgWorld*) this;
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
 
-	syncData.m_bodyLocks = dgAlloca (dgInt32, island->m_bodyCount + 1024);
-	syncData.m_jointConflicts = dgAlloca (dgParallelSolverSyncData::dgParallelJointMap, island->m_jointCount + 1024);
-	memset (syncData.m_bodyLocks, 0, island->m_bodyCount * sizeof (dgInt32));
+	// continue collision and skeleton clusters have serial only stages, let the cluster solver handle them
+	bool hasSkeletons = false;
+	for (dgInt32 i = 1; (i < cluster->m_bodyCount) && !hasSkeletons; i ++) {
+		hasSkeletons = bodyArray[i].m_body->GetSkeleton() ? true : false;
+	}
+	if (cluster->m_isContinueCollision || hasSkeletons || !cluster->m_jointCount) {
+		ResolveClusterForces(cluster, 0, timestep);
+		return;
+	}
 
-	dgInt32 bodyCount = island->m_bodyCount;
-	dgInt32 jointsCount = island->m_jointCount;
-	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
+	const dgInt32 activeJoint = SortClusters(cluster, timestep, 0);
+	if (!activeJoint) {
+		for (dgInt32 i = 1; i < cluster->m_bodyCount; i++) {
+			dgDynamicBody* const body = (dgDynamicBody*)bodyArray[i].m_body;
+			body->m_accel = dgVector::m_zero;
+			body->m_alpha = dgVector::m_zero;
+		}
+		IntegrateVelocity (cluster, DG_SOLVER_MAX_ERROR, timestep, 0); 
+		return;
+	}
 
-	LinearizeJointParallelArray (&syncData, constraintArray, island);
-	
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForcesBuffer[0];
-	internalForces[0].m_linear = dgVector::m_zero;
-	internalForces[0].m_angular = dgVector::m_zero;
+	dgParallelSolverSyncData syncData;
+	syncData.m_bodyLocks = dgAlloca (dgInt32, cluster->m_bodyCount + 1024);
+	memset (syncData.m_bodyLocks, 0, cluster->m_bodyCount * sizeof (dgInt32));
 
 	const dgInt32 maxPasses = 4;
 	syncData.m_timestep = timestep;
@@ -63,17 +71,25 @@ void dgWorldDynamicUpdate::CalculateReactionForcesParallel(const dgBodyCluster*
 	syncData.m_maxPasses = maxPasses;
 	syncData.m_passes = world->m_solverMode;
 
-	syncData.m_bodyCount = bodyCount;
-	syncData.m_jointCount = jointsCount;
-	syncData.m_atomicIndex = 0;
-	syncData.m_island = island;
+	syncData.m_bodyCount = cluster->m_bodyCount;
+	syncData.m_jointCount = cluster->m_jointCount;
+	syncData.m_cluster = cluster;
+
+	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	syncData.m_jointConflicts = dgAlloca (dgParallelSolverSyncData::dgParallelJointMap, cluster->m_jointCount + 1024);
+	LinearizeJointParallelArray (&syncData, constraintArray, cluster);
 
 	InitilizeBodyArrayParallel (&syncData);
-	BuildJacobianMatrixParallel (&syncData);
-	SolverInitInternalForcesParallel (&syncData);
-	CalculateForcesGameModeParallel (&syncData);
-	IntegrateIslandParallel(&syncData); 
-*/
+	{
+		dgProfilerScope scope (&world->m_profiler, m_profileBuildJacobianMatrix, DG_PROFILER_MAIN_THREAD);
+		BuildJacobianMatrixParallel (&syncData);
+	}
+	{
+		dgProfilerScope scope (&world->m_profiler, m_profileSolverPasses, DG_PROFILER_MAIN_THREAD);
+		CalculateForcesGameModeParallel (&syncData);
+	}
+	IntegrateClusterParallel(&syncData); 
 }
 
 
@@ -107,41 +123,33 @@ void dgWorldDynamicUpdate::LinearizeJointParallelArray(dgParallelSolverSyncData*
 	for (dgInt32 i = 0; i < count; i++) {
 		dgInt32 index = 0;
 		dgInt32 color = jointInfoMap[i].m_color;
-		for (dgInt32 n = 1; n & color; n <<= 1) {
+		for (dgInt32 n = 1; (n & color) && (index < DG_PARALLEL_JOINT_OVERFLOW_COLOR); n <<= 1) {
 			index++;
-			dgAssert(index < 32);
 		}
 		jointInfoMap[i].m_bashCount = index;
-		color = 1 << index;
 		dgAssert(jointInfoMap[i].m_jointIndex == i);
+		if (index == DG_PARALLEL_JOINT_OVERFLOW_COLOR) {
+			// out of colors, the last batch is solved one joint at the time so it does not block its neighbors
+			continue;
+		}
+		color = 1 << index;
 		dgJointInfo& jointInfo = constraintArray[i];
 
 		dgConstraint* const constraint = jointInfo.m_joint;
-		dgDynamicBody* const body0 = (dgDynamicBody*)constraint->m_body0;
-		dgAssert(body0->IsRTTIType(dgBody::m_dynamicBodyRTTI));
-
-		if (body0->m_invMass.m_w > dgFloat32(0.0f)) {
-			for (dgBodyMasterListRow::dgListNode* jointNode = body0->m_masterNode->GetInfo().GetFirst(); jointNode; jointNode = jointNode->GetNext()) {
-				dgBodyMasterListCell& cell = jointNode->GetInfo();
-
-				dgConstraint* const neiborgLink = cell.m_joint;
-				if ((neiborgLink != constraint) && (neiborgLink->m_maxDOF)) {
-					dgParallelSolverSyncData::dgParallelJointMap& info = jointInfoMap[neiborgLink->m_index];
-					info.m_color |= color;
-				}
-			}
-		}
-
-		dgDynamicBody* const body1 = (dgDynamicBody*)constraint->m_body1;
-		dgAssert(body1->IsRTTIType(dgBody::m_dynamicBodyRTTI));
-		if (body1->m_invMass.m_w > dgFloat32(0.0f)) {
-			for (dgBodyMasterListRow::dgListNode* jointNode = body1->m_masterNode->GetInfo().GetFirst(); jointNode; jointNode = jointNode->GetNext()) {
-				dgBodyMasterListCell& cell = jointNode->GetInfo();
-
-				dgConstraint* const neiborgLink = cell.m_joint;
-				if ((neiborgLink != constraint) && (neiborgLink->m_maxDOF)) {
-					dgParallelSolverSyncData::dgParallelJointMap& info = jointInfoMap[neiborgLink->m_index];
-					info.m_color |= color;
+		for (dgInt32 j = 0; j < 2; j ++) {
+			// static bodies do not constrain the coloring, the solver never writes their shared slot
+			dgBody* const body = j ? constraint->m_body1 : constraint->m_body0;
+			if (body->m_invMass.m_w > dgFloat32(0.0f)) {
+				for (dgBodyMasterListRow::dgListNode* jointNode = body->m_masterNode->GetInfo().GetFirst(); jointNode; jointNode = jointNode->GetNext()) {
+					dgBodyMasterListCell& cell = jointNode->GetInfo();
+
+					// joints that are not part of this cluster carry a stale index
+					dgConstraint* const neiborgLink = cell.m_joint;
+					const dgUnsigned32 neiborgIndex = neiborgLink->m_index;
+					if ((neiborgLink != constraint) && (neiborgLink->m_maxDOF) && (neiborgIndex < dgUnsigned32 (count)) && (constraintArray[neiborgIndex].m_joint == neiborgLink)) {
+						dgParallelSolverSyncData::dgParallelJointMap& info = jointInfoMap[neiborgIndex];
+						info.m_color |= color;
+					}
 				}
 			}
 		}
@@ -168,391 +176,228 @@ void dgWorldDynamicUpdate::LinearizeJointParallelArray(dgParallelSolverSyncData*
 }
 
 
-void dgWorldDynamicUpdate::InitilizeBodyArrayParallel (dgParallelSolverSyncData* const syncData) const
+void dgWorldDynamicUpdate::ParallelSolverFor (dgParallelSolverKernel::dgKernel kernel, dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 minChunkSize) const
 {
-	dgAssert (0);
-	/*
 	dgWorld* const world = (dgWorld*) this;
-	const dgInt32 threadCounts = world->GetThreadCount();	
+	dgParallelSolverKernel parallelKernel (this, kernel, syncData);
+	world->ParallelFor (parallelKernel, start, end, minChunkSize);
+}
 
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForcesBuffer[0];
-	internalForces[0].m_linear = dgVector(dgFloat32(0.0f));
-	internalForces[0].m_angular = dgVector(dgFloat32(0.0f));
 
-	syncData->m_atomicIndex = 1;
-	for (dgInt32 i = 0; i < threadCounts; i ++) {
-		world->QueueJob (InitializeBodyArrayParallelKernel, syncData, world);
-	}
-	world->SynchronizationBarrier();
-*/
+void dgWorldDynamicUpdate::InitilizeBodyArrayParallel (dgParallelSolverSyncData* const syncData) const
+{
+	const dgBodyCluster* const cluster = syncData->m_cluster;
+	dgJacobian* const internalForces = &m_solverMemory.m_internalForcesBuffer[cluster->m_bodyStart];
+	internalForces[0].m_linear = dgVector::m_zero;
+	internalForces[0].m_angular = dgVector::m_zero;
+	GatherBodyState (cluster, 0, 1, syncData->m_timestep);
+
+	ParallelSolverFor (&dgWorldDynamicUpdate::InitializeBodyArrayParallelKernel, syncData, 1, syncData->m_bodyCount, DG_PARALLEL_BODY_CHUNK_SIZE);
 }
 
-void dgWorldDynamicUpdate::InitializeBodyArrayParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+void dgWorldDynamicUpdate::InitializeBodyArrayParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
-	dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex; 
-
-	const dgIsland* const island = syncData->m_island;
+	dgWorld* const world = (dgWorld*) this;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
 	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-	dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForcesBuffer[0];
-
-	if (syncData->m_timestep != dgFloat32 (0.0f)) {
-		for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_bodyCount; i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-			dgAssert (bodyArray[0].m_body->IsRTTIType (dgBody::m_dynamicBodyRTTI) || (((dgDynamicBody*)bodyArray[0].m_body)->m_accel.DotProduct3(((dgDynamicBody*)bodyArray[0].m_body)->m_accel)) == dgFloat32 (0.0f));
-			dgAssert (bodyArray[0].m_body->IsRTTIType (dgBody::m_dynamicBodyRTTI) || (((dgDynamicBody*)bodyArray[0].m_body)->m_alpha.DotProduct3(((dgDynamicBody*)bodyArray[0].m_body)->m_alpha)) == dgFloat32 (0.0f));
-
-			dgBody* const body = bodyArray[i].m_body;
-			dgAssert (body->m_index == i);
-			if (!body->m_equilibrium) {
-				dgAssert (body->m_invMass.m_w > dgFloat32 (0.0f));
-				body->AddDampingAcceleration(syncData->m_timestep);
-				body->CalcInvInertiaMatrix ();
-			}
-
-			if (body->m_active) {
-				// re use these variables for temp storage 
-				body->m_netForce = body->m_veloc;
-				body->m_netTorque = body->m_omega;
-				internalForces[i].m_linear = dgVector::m_zero;
-				internalForces[i].m_angular = dgVector::m_zero;
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+	dgJacobian* const internalForces = &m_solverMemory.m_internalForcesBuffer[cluster->m_bodyStart];
+
+	const dgFloat32 timestep = syncData->m_timestep;
+	for (dgInt32 i = start; i < end; i ++) {
+		dgDynamicBody* const body = (dgDynamicBody*)bodyArray[i].m_body;
+		dgAssert(body->IsRTTIType(dgBody::m_dynamicBodyRTTI) || body->IsRTTIType(dgBody::m_kinematicBodyRTTI));
+		if (!body->m_equilibrium) {
+			dgAssert (body->m_invMass.m_w > dgFloat32 (0.0f));
+			if (timestep != dgFloat32 (0.0f)) {
+				body->AddDampingAcceleration(timestep);
 			}
+			body->CalcInvInertiaMatrix ();
 		}
-	} else {
-		for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_bodyCount; i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-			dgAssert(bodyArray[0].m_body->IsRTTIType(dgBody::m_dynamicBodyRTTI) || (((dgDynamicBody*)bodyArray[0].m_body)->m_accel.DotProduct3(((dgDynamicBody*)bodyArray[0].m_body)->m_accel)) == dgFloat32(0.0f));
-			dgAssert(bodyArray[0].m_body->IsRTTIType(dgBody::m_dynamicBodyRTTI) || (((dgDynamicBody*)bodyArray[0].m_body)->m_alpha.DotProduct3(((dgDynamicBody*)bodyArray[0].m_body)->m_alpha)) == dgFloat32(0.0f));
-
-			dgBody* const body = bodyArray[i].m_body;
-			if (!body->m_equilibrium) {
-				dgAssert(body->m_invMass.m_w > dgFloat32(0.0f));
-				body->CalcInvInertiaMatrix();
-			}
 
-			if (body->m_active) {
-				 //re use these variables for temp storage 
-				body->m_netForce = body->m_veloc;
-				body->m_netTorque = body->m_omega;
-				internalForces[i].m_linear = dgVector::m_zero;
-				internalForces[i].m_angular = dgVector::m_zero;
-			}
-		}
+		// re use these variables for temp storage 
+		body->m_accel = body->m_veloc;
+		body->m_alpha = body->m_omega;
+		internalForces[i].m_linear = dgVector::m_zero;
+		internalForces[i].m_angular = dgVector::m_zero;
 	}
-*/
+	GatherBodyState (cluster, start, end, timestep);
 }
 
 
 void dgWorldDynamicUpdate::BuildJacobianMatrixParallel (dgParallelSolverSyncData* const syncData) const
 {
-	dgWorld* const world = (dgWorld*) this;
-	const dgInt32 threadCounts = world->GetThreadCount();	
-
-	syncData->m_atomicIndex = 0;
-	for (dgInt32 i = 0; i < threadCounts; i ++) {
-		world->QueueJob (BuildJacobianMatrixParallelKernel, syncData, world);
-	}
-	world->SynchronizationBarrier();
+	syncData->m_jacobianMatrixRowAtomicIndex = 0;
+	ParallelSolverFor (&dgWorldDynamicUpdate::BuildJacobianMatrixParallelKernel, syncData, 0, syncData->m_jointCount, 1);
 }
 
-
-void dgWorldDynamicUpdate::BuildJacobianMatrixParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+void dgWorldDynamicUpdate::BuildJacobianMatrixParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
-	dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex; 
-	const dgIsland* const island = syncData->m_island;
+	dgWorld* const world = (dgWorld*) this;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
 	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-	dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
 	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
-	dgJacobianMatrixElement* const matrixRow = &world->m_solverMemory.m_jacobianBuffer[0];
-	dgAssert (syncData->m_jointCount);
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	dgJacobian* const internalForces = &m_solverMemory.m_internalForcesBuffer[cluster->m_bodyStart];
+	dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
 
 	dgContraintDescritor constraintParams;
 	constraintParams.m_world = world;
 	constraintParams.m_threadIndex = threadID;
 	constraintParams.m_timestep = syncData->m_timestep;
-	constraintParams.m_invTimestep = syncData->m_invTimestep;
+	constraintParams.m_invTimestep = (syncData->m_timestep > dgFloat32(1.0e-5f)) ? syncData->m_invTimestep : dgFloat32(0.0f);
+	const dgFloat32 forceOrImpulseScale = (syncData->m_timestep > dgFloat32 (0.0f)) ? dgFloat32 (1.0f) : dgFloat32 (0.0f);
 
-	dgFloat32 forceOrImpulseScale = (syncData->m_timestep > dgFloat32 (0.0f)) ? dgFloat32 (1.0f) : dgFloat32 (0.0f);
-	for (dgInt32 jointIndex = dgAtomicExchangeAndAdd(atomicIndex, 1); jointIndex < syncData->m_jointCount;  jointIndex = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgJointInfo* const jointInfo = &constraintArray[jointIndex];
+	for (dgInt32 i = start; i < end; i ++) {
+		dgJointInfo* const jointInfo = &constraintArray[i];
 		dgConstraint* const constraint = jointInfo->m_joint;
 
-		dgInt32 rowBase = dgAtomicExchangeAndAdd(&syncData->m_jacobianMatrixRowAtomicIndex, jointInfo->m_pairCount);
-
-		world->GetJacobianDerivatives(constraintParams, jointInfo, constraint, matrixRow, rowBase);
+		// m_pairCount still holds the padded max dof, reserve that many rows for this joint
+		const dgInt32 rowBase = dgAtomicExchangeAndAdd(&syncData->m_jacobianMatrixRowAtomicIndex, jointInfo->m_pairCount);
+		dgAssert ((rowBase + jointInfo->m_pairCount) <= cluster->m_rowsCount);
+		GetJacobianDerivatives(constraintParams, jointInfo, constraint, matrixRow, rowBase);
 
 		dgAssert (jointInfo->m_m0 >= 0);
 		dgAssert (jointInfo->m_m1 >= 0);
-		dgAssert (jointInfo->m_m0 != jointInfo->m_m1);
-		dgAssert (jointInfo->m_m0 < island->m_bodyCount);
-		dgAssert (jointInfo->m_m1 < island->m_bodyCount);
-		world->BuildJacobianMatrix (bodyArray, jointInfo, matrixRow, forceOrImpulseScale);
+		dgAssert (jointInfo->m_m0 < cluster->m_bodyCount);
+		dgAssert (jointInfo->m_m1 < cluster->m_bodyCount);
+		BuildJacobianMatrix (bodyArray, jointInfo, internalForces, matrixRow, forceOrImpulseScale, syncData->m_bodyLocks);
 	}
-*/
 }
 
 
-void dgWorldDynamicUpdate::SolverInitInternalForcesParallel (dgParallelSolverSyncData* const syncData) const
+void dgWorldDynamicUpdate::CalculateJointsAccelParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
 	dgWorld* const world = (dgWorld*) this;
-	const dgInt32 threadCounts = world->GetThreadCount();	
-
-	syncData->m_atomicIndex = 0;
-	for (dgInt32 i = 0; i < threadCounts; i ++) {
-		world->QueueJob (SolverInitInternalForcesParallelKernel, syncData, world);
-	}
-	world->SynchronizationBarrier();
-}
-
-
-void dgWorldDynamicUpdate::SolverInitInternalForcesParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
-{
-	dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-	const dgIsland* const island = syncData->m_island;
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForcesBuffer[0];
-	dgJacobianMatrixElement* const matrixRow = &world->m_solverMemory.m_jacobianBuffer[0];
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex; 
-	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
-	dgInt32* const bodyLocks = syncData->m_bodyLocks;
-
-	for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_jointCount;  i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgJointInfo* const jointInfo = &constraintArray[i];
-		if (jointInfo->m_joint->m_solverActive) {
-			dgJacobian y0;
-			dgJacobian y1;
-			world->InitJointForce (jointInfo, matrixRow, y0, y1);
-			const dgInt32 m0 = jointInfo->m_m0;
-			const dgInt32 m1 = jointInfo->m_m1;
-			dgAssert (m0 != m1);
-
-			if (m0) {
-				dgSpinLock(&bodyLocks[m0], false);
-				internalForces[m0].m_linear += y0.m_linear;
-				internalForces[m0].m_angular += y0.m_angular;
-				dgSpinUnlock(&bodyLocks[m0]);
-			}
-			if (m1) {
-				dgSpinLock(&bodyLocks[m1], false);
-				internalForces[m1].m_linear += y1.m_linear;
-				internalForces[m1].m_angular += y1.m_angular;
-				dgSpinUnlock(&bodyLocks[m1]);
-			}
-		}
-	}
-*/
-}
-
-
-void dgWorldDynamicUpdate::CalculateJointsAccelParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
-{
-	dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-	const dgIsland* const island = syncData->m_island;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
 	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
-	dgJacobianMatrixElement* const matrixRow = &world->m_solverMemory.m_jacobianBuffer[0];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
+	const dgVector* const bodyVeloc = &m_solverMemory.m_bodyVeloc[cluster->m_bodyStart];
+	const dgVector* const bodyOmega = &m_solverMemory.m_bodyOmega[cluster->m_bodyStart];
 
 	dgJointAccelerationDecriptor joindDesc;
 	joindDesc.m_timeStep = syncData->m_timestepRK;
 	joindDesc.m_invTimeStep = syncData->m_invTimestepRK;
 	joindDesc.m_firstPassCoefFlag = syncData->m_firstPassCoef;
 
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex; 
-	if (joindDesc.m_firstPassCoefFlag == dgFloat32 (0.0f)) {
-		for (dgInt32 curJoint = dgAtomicExchangeAndAdd(atomicIndex, 1); curJoint < syncData->m_jointCount;  curJoint = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-			dgJointInfo* const jointInfo = &constraintArray[curJoint];
-			dgConstraint* const constraint = jointInfo->m_joint;
-			if (constraint->m_solverActive) {
-				joindDesc.m_rowsCount = jointInfo->m_pairCount;
-				joindDesc.m_rowMatrix = &matrixRow[jointInfo->m_pairStart];
-				constraint->JointAccelerations(&joindDesc);
-			}
-		}
-	} else {
-		const dgIsland* const island = syncData->m_island;
-		dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-		const dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-
-		for (dgInt32 curJoint = dgAtomicExchangeAndAdd(atomicIndex, 1); curJoint < syncData->m_jointCount;  curJoint = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-			dgJointInfo* const jointInfo = &constraintArray[curJoint];
-			dgConstraint* const constraint = jointInfo->m_joint;
-			if (constraint->m_solverActive) {
-				const dgInt32 m0 = jointInfo->m_m0;
-				const dgInt32 m1 = jointInfo->m_m1;
-				const dgBody* const body0 = bodyArray[m0].m_body;
-				const dgBody* const body1 = bodyArray[m1].m_body;
-				if (!(body0->m_resting & body1->m_resting)) {
-					joindDesc.m_rowsCount = jointInfo->m_pairCount;
-					joindDesc.m_rowMatrix = &matrixRow[jointInfo->m_pairStart];
-					constraint->JointAccelerations(&joindDesc);
-				}
-			}
-		}
+	for (dgInt32 i = start; i < end; i ++) {
+		dgJointInfo* const jointInfo = &constraintArray[i];
+		dgConstraint* const constraint = jointInfo->m_joint;
+		joindDesc.m_rowsCount = jointInfo->m_pairCount;
+		joindDesc.m_rowMatrix = &matrixRow[jointInfo->m_pairStart];
+		SetJointAccelerationBodies (&joindDesc, jointInfo, bodyVeloc, bodyOmega);
+		constraint->JointAccelerations(&joindDesc);
 	}
-*/
 }
 
 
-void dgWorldDynamicUpdate::CalculateJointsVelocParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+void dgWorldDynamicUpdate::CalculateJointsForceParallel (dgParallelSolverSyncData* const syncData) const
 {
-dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-
-	const dgIsland* const island = syncData->m_island;
-	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-	dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForcesBuffer[0];
-
-	dgVector speedFreeze2 (world->m_freezeSpeed2 * dgFloat32 (0.1f));
-	dgVector freezeOmega2 (world->m_freezeOmega2 * dgFloat32 (0.1f));
-	dgVector forceActiveMask ((syncData->m_jointCount <= DG_SMALL_ISLAND_COUNT) ?  dgVector (-1, -1, -1, -1) : dgFloat32 (0.0f));
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex;
-
-	if (syncData->m_timestepRK != dgFloat32 (0.0f)) {
-		dgVector timestep4 (syncData->m_timestepRK);
-		for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_bodyCount;  i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-			dgDynamicBody* const body = (dgDynamicBody*) bodyArray[i].m_body;
-			dgAssert (body->m_index == i);
-			world->ApplyNetVelcAndOmega (body, internalForces[i], timestep4, speedFreeze2, forceActiveMask);
-		}
-	} else {
-		for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_bodyCount;  i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-			dgBody* const body = bodyArray[i].m_body;
-			if (body->m_active) {
-				const dgVector& linearMomentum = internalForces[i].m_linear;
-				const dgVector& angularMomentum = internalForces[i].m_angular;
-
-				body->m_veloc += linearMomentum.Scale4(body->m_invMass.m_w);
-				body->m_omega += body->m_invWorldInertiaMatrix.RotateVector(angularMomentum);
-			}
+	// joints of the same color never share a dynamic body, so the joints of a batch are solved 
+	// without body locks and the threads only synchronize between batches.
+	const dgParallelSolverSyncData::dgParallelJointMap* const jointInfoMap = syncData->m_jointConflicts;
+	for (dgInt32 i = 0; i < syncData->m_bachCount; i ++) {
+		const dgInt32 start = syncData->m_jointBatches[i];
+		const dgInt32 end = syncData->m_jointBatches[i + 1];
+		if (jointInfoMap[start].m_bashCount == DG_PARALLEL_JOINT_OVERFLOW_COLOR) {
+			CalculateJointsForceParallelKernel (syncData, start, end, 0);
+		} else {
+			ParallelSolverFor (&dgWorldDynamicUpdate::CalculateJointsForceParallelKernel, syncData, start, end, DG_PARALLEL_JOINT_CHUNK_SIZE);
 		}
 	}
-*/
 }
 
-/*
-void dgWorldDynamicUpdate::CalculateJointsImpulseVelocParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+void dgWorldDynamicUpdate::CalculateJointsForceParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-
-	const dgIsland* const island = syncData->m_island;
-	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-	dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForces[0];
-	//dgJacobian* const internalVeloc = &world->m_solverMemory.m_internalVeloc[0];
-
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex;
-	for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_bodyCount;  i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgInt32 index = i + 1;
-		dgAssert (index);
-		dgDynamicBody* const body = (dgDynamicBody*) bodyArray[index].m_body;
-		dgAssert (body->m_index == index);
+	dgWorld* const world = (dgWorld*) this;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
+	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	dgJacobian* const internalForces = &m_solverMemory.m_internalForcesBuffer[cluster->m_bodyStart];
+	dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
+	const dgInt32* const bodyResting = &m_solverMemory.m_bodyResting[cluster->m_bodyStart];
+	const dgParallelSolverSyncData::dgParallelJointMap* const jointInfoMap = syncData->m_jointConflicts;
 
-		const dgVector& linearMomentum = internalForces[index].m_linear;
-		const dgVector& angularMomentum = internalForces[index].m_angular;
+	dgFloat32 accNorm = dgFloat32(0.0f);
+	for (dgInt32 i = start; i < end; i ++) {
+		dgJointInfo* const jointInfo = &constraintArray[jointInfoMap[i].m_jointIndex];
+		dgAssert(jointInfo->m_m0 != jointInfo->m_m1);
+		accNorm += CalculateJointForce(jointInfo, bodyResting, internalForces, matrixRow);
+	}
+	syncData->m_accelNorm[threadID] += accNorm;
+}
 
-		body->m_veloc += linearMomentum.Scale4(body->m_invMass.m_w);
-		body->m_omega += body->m_invWorldInertiaMatrix.RotateVector (angularMomentum);
 
-		//internalVeloc[index].m_linear += body->m_veloc;
-		//internalVeloc[index].m_angular += body->m_omega;
-	}
+void dgWorldDynamicUpdate::CalculateJointsVelocParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
+{
+	IntegrateBodyState (syncData->m_cluster, start, end, syncData->m_timestepRK);
 }
-*/
 
-void dgWorldDynamicUpdate::UpdateFeedbackForcesParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+
+void dgWorldDynamicUpdate::UpdateFeedbackForcesParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
-dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-	const dgIsland* const island = syncData->m_island;
+	dgWorld* const world = (dgWorld*) this;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
 	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
-	dgJacobianMatrixElement* const matrixRow = &world->m_solverMemory.m_jacobianBuffer[0];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
 
 	dgInt32 hasJointFeeback = 0;
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex;
-	
-	for (dgInt32 curJoint = dgAtomicExchangeAndAdd(atomicIndex, 1); curJoint < syncData->m_jointCount;  curJoint = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgJointInfo* const jointInfo = &constraintArray[curJoint];
+	for (dgInt32 i = start; i < end; i ++) {
+		dgJointInfo* const jointInfo = &constraintArray[i];
 		dgConstraint* const constraint = jointInfo->m_joint;
-		if (constraint->m_solverActive) {
-			const dgInt32 first = jointInfo->m_pairStart;
-			const dgInt32 count = jointInfo->m_pairCount;
-
-			for (dgInt32 j = 0; j < count; j++) {
-				dgJacobianMatrixElement* const row = &matrixRow[j + first];
-				dgFloat32 val = row->m_force;
-				dgAssert(dgCheckFloat(val));
-				row->m_jointFeebackForce->m_force = val;
-				row->m_jointFeebackForce->m_impact = row->m_maxImpact * syncData->m_timestepRK;
-			}
-			hasJointFeeback |= (constraint->m_updaFeedbackCallback ? 1 : 0);
+		const dgInt32 first = jointInfo->m_pairStart;
+		const dgInt32 count = jointInfo->m_pairCount;
+
+		for (dgInt32 j = 0; j < count; j++) {
+			dgJacobianMatrixElement* const row = &matrixRow[j + first];
+			dgAssert(dgCheckFloat(row->m_force));
+			row->m_jointFeebackForce->m_force = row->m_force;
+			row->m_jointFeebackForce->m_impact = row->m_maxImpact * syncData->m_timestepRK;
 		}
+		hasJointFeeback |= (constraint->m_updaFeedbackCallback ? 1 : 0);
 	}
-	syncData->m_hasJointFeeback[threadID] = hasJointFeeback;
-*/
+	syncData->m_hasJointFeeback[threadID] |= hasJointFeeback;
 }
 
 
-void dgWorldDynamicUpdate::UpdateBodyVelocityParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+void dgWorldDynamicUpdate::UpdateBodyVelocityParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
-dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-
-	const dgBodyCluster* const island = syncData->m_cluster;
+	dgWorld* const world = (dgWorld*) this;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
 	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-	dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-
-	dgFloat32 maxAccNorm2 = DG_SOLVER_MAX_ERROR * DG_SOLVER_MAX_ERROR;
-
-	//dgFloat32 invTimestepSrc = dgFloat32 (1.0f) / syncData->m_timestep;
-	dgFloat32 invTimestepSrc = syncData->m_invTimestep;
+	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
 
-	dgVector invTime (invTimestepSrc);
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex;
-	for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_bodyCount; i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgDynamicBody* const body = (dgDynamicBody*) bodyArray[i].m_body;
-		world->CalculateNetAcceleration (body, invTime, maxAccNorm2);
+	ScatterBodyState (cluster, start, end);
+	if (syncData->m_timestepRK != dgFloat32 (0.0f)) {
+		const dgVector invTime (syncData->m_invTimestep);
+		const dgVector maxAccNorm2 (DG_SOLVER_MAX_ERROR * DG_SOLVER_MAX_ERROR);
+		for (dgInt32 i = start; i < end; i ++) {
+			CalculateNetAcceleration (bodyArray[i].m_body, invTime, maxAccNorm2);
+		}
+	} else {
+		for (dgInt32 i = start; i < end; i ++) {
+			dgBody* const body = bodyArray[i].m_body;
+			body->m_accel = dgVector::m_zero;
+			body->m_alpha = dgVector::m_zero;
+		}
 	}
-*/
 }
 
 
-void dgWorldDynamicUpdate::KinematicCallbackUpdateParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
+void dgWorldDynamicUpdate::KinematicCallbackUpdateParallelKernel (dgParallelSolverSyncData* const syncData, dgInt32 start, dgInt32 end, dgInt32 threadID) const
 {
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-	const dgBodyCluster* const island = syncData->m_cluster;
+	dgWorld* const world = (dgWorld*) this;
+	const dgBodyCluster* const cluster = syncData->m_cluster;
 	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
 
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex;
-	for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < syncData->m_jointCount;  i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgInt32 curJoint = i;
-		if (constraintArray[curJoint].m_joint->m_updaFeedbackCallback) {
-			constraintArray[curJoint].m_joint->m_updaFeedbackCallback (*constraintArray[curJoint].m_joint, syncData->m_timestep, threadID);
+	for (dgInt32 i = start; i < end; i ++) {
+		dgConstraint* const joint = constraintArray[i].m_joint;
+		if (joint->m_updaFeedbackCallback) {
+			joint->m_updaFeedbackCallback (*joint, syncData->m_timestep, threadID);
 		}
 	}
 }
@@ -560,181 +405,51 @@ void dgWorldDynamicUpdate::KinematicCallbackUpdateParallelKernel (void* const co
 
 void dgWorldDynamicUpdate::IntegrateClusterParallel(dgParallelSolverSyncData* const syncData) const
 {
-	dgAssert (0);
-/*
-	dgWorld* const world = (dgWorld*) this;
-//	dgWorldDynamicUpdate::IntegrateIslandParallelKernel (syncData, world, 0);
-	world->IntegrateVelocity (syncData->m_cluster, DG_SOLVER_MAX_ERROR, syncData->m_timestep, 0); 
-*/
+	IntegrateVelocity (syncData->m_cluster, DG_SOLVER_MAX_ERROR, syncData->m_timestep, 0); 
 }
 
 
 void dgWorldDynamicUpdate::CalculateForcesGameModeParallel (dgParallelSolverSyncData* const syncData) const
 {
-dgAssert (0);
-/*
-	dgWorld* const world = (dgWorld*) this;
-	const dgInt32 threadCounts = world->GetThreadCount();	
-
 	const dgInt32 passes = syncData->m_passes;
 	const dgInt32 maxPasses = syncData->m_maxPasses;
-//	const dgInt32 batchCount = syncData->m_bachCount;
-	syncData->m_firstPassCoef = dgFloat32 (0.0f);
+	const dgInt32 bodyCount = syncData->m_bodyCount;
+	const dgInt32 jointCount = syncData->m_jointCount;
 
+	syncData->m_firstPassCoef = dgFloat32 (0.0f);
 	for (dgInt32 step = 0; step < maxPasses; step++) {
-
-		syncData->m_atomicIndex = 0;
-		for (dgInt32 i = 0; i < threadCounts; i++) {
-			world->QueueJob(CalculateJointsAccelParallelKernel, syncData, world);
-		}
-		world->SynchronizationBarrier();
+		ParallelSolverFor (&dgWorldDynamicUpdate::CalculateJointsAccelParallelKernel, syncData, 0, jointCount, 1);
 		syncData->m_firstPassCoef = dgFloat32(1.0f);
 
-		dgFloat32 accNorm = DG_SOLVER_MAX_ERROR * dgFloat32(2.0f);
-		for (dgInt32 k = 0; (k < passes) && (accNorm > DG_SOLVER_MAX_ERROR); k++) {
-
-#if 0
-			dgInt32 batchIndex = 0;
-			dgInt32 count = syncData->m_jointBatches[batchIndex + 1];
-			while ((batchIndex < batchCount) && (count >= threadCounts * 8)) {
-				syncData->m_bachIndex = syncData->m_jointBatches[batchIndex + 1];
-				syncData->m_atomicIndex = syncData->m_jointBatches[batchIndex];
-				for (dgInt32 i = 0; i < threadCounts; i++) {
-					world->QueueJob(CalculateJointsForceParallelKernel, syncData, world);
-				}
-				world->SynchronizationBarrier();
-				accNorm = dgFloat32(0.0f);
-				for (dgInt32 i = 0; i < threadCounts; i++) {
-					accNorm = dgMax(accNorm, syncData->m_accelNorm[i]);
-				}
-
-				batchIndex++;
-				count = syncData->m_jointBatches[batchIndex + 1] - syncData->m_jointBatches[batchIndex];
-			}
-
-			if (batchIndex < batchCount) {
-				syncData->m_bachIndex = syncData->m_jointBatches[batchCount];
-				syncData->m_atomicIndex = syncData->m_jointBatches[batchIndex];
-				CalculateJointsForceParallelKernel(syncData, world, 0);
-				accNorm = dgMax(accNorm, syncData->m_accelNorm[0]);
-			}
-#endif
-
-			syncData->m_atomicIndex = 0;
-			for (dgInt32 i = 0; i < threadCounts; i++) {
-				world->QueueJob(CalculateJointsForceParallelKernel, syncData, world);
-			}
-			world->SynchronizationBarrier();
+		const dgFloat32 maxAccNorm = DG_SOLVER_MAX_ERROR * DG_SOLVER_MAX_ERROR;
+		dgFloat32 accNorm = maxAccNorm * dgFloat32(2.0f);
+		for (dgInt32 k = 0; (k < passes) && (accNorm > maxAccNorm); k++) {
+			memset (syncData->m_accelNorm, 0, sizeof (syncData->m_accelNorm));
+			CalculateJointsForceParallel (syncData);
 			accNorm = dgFloat32(0.0f);
-			for (dgInt32 i = 0; i < threadCounts; i++) {
-				accNorm = dgMax(accNorm, syncData->m_accelNorm[i]);
+			for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i++) {
+				accNorm += syncData->m_accelNorm[i];
 			}
 		}
 
-
-		syncData->m_atomicIndex = 1;
-		for (dgInt32 j = 0; j < threadCounts; j++) {
-			world->QueueJob(CalculateJointsVelocParallelKernel, syncData, world);
-		}
-		world->SynchronizationBarrier();
+		ParallelSolverFor (&dgWorldDynamicUpdate::CalculateJointsVelocParallelKernel, syncData, 1, bodyCount, DG_PARALLEL_BODY_CHUNK_SIZE);
 	}
 
 	if (syncData->m_timestepRK != dgFloat32 (0.0f)) {
-		syncData->m_atomicIndex = 0;
-		for (dgInt32 j = 0; j < threadCounts; j ++) {
-			world->QueueJob (UpdateFeedbackForcesParallelKernel, syncData, world);
-		}
-		world->SynchronizationBarrier();
+		memset (syncData->m_hasJointFeeback, 0, sizeof (syncData->m_hasJointFeeback));
+		ParallelSolverFor (&dgWorldDynamicUpdate::UpdateFeedbackForcesParallelKernel, syncData, 0, jointCount, DG_PARALLEL_BODY_CHUNK_SIZE);
 
 		dgInt32 hasJointFeeback = 0;
 		for (dgInt32 i = 0; i < DG_MAX_THREADS_HIVE_COUNT; i ++) {
 			hasJointFeeback |= syncData->m_hasJointFeeback[i];
 		}
 
-		syncData->m_atomicIndex = 1;
-		for (dgInt32 j = 0; j < threadCounts; j++) {
-			world->QueueJob(UpdateBodyVelocityParallelKernel, syncData, world);
-		}
-		world->SynchronizationBarrier();
+		ParallelSolverFor (&dgWorldDynamicUpdate::UpdateBodyVelocityParallelKernel, syncData, 1, bodyCount, DG_PARALLEL_BODY_CHUNK_SIZE);
 
 		if (hasJointFeeback) {
-			syncData->m_atomicIndex = 0;
-			for (dgInt32 j = 0; j < threadCounts; j++) {
-				world->QueueJob(KinematicCallbackUpdateParallelKernel, syncData, world);
-			}
-			world->SynchronizationBarrier();
+			ParallelSolverFor (&dgWorldDynamicUpdate::KinematicCallbackUpdateParallelKernel, syncData, 0, jointCount, 1);
 		}
-
 	} else {
-		const dgInt32 count = syncData->m_bodyCount;
-		const dgIsland* const island = syncData->m_island;
-		dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
-		dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-		for (dgInt32 i = 1; i < count; i++) {
-			dgBody* const body = bodyArray[i].m_body;
-			if (body->m_active) {
-				body->m_netForce = dgVector::m_zero;
-				body->m_netTorque = dgVector::m_zero;
-			}
-		}
+		ParallelSolverFor (&dgWorldDynamicUpdate::UpdateBodyVelocityParallelKernel, syncData, 1, bodyCount, DG_PARALLEL_BODY_CHUNK_SIZE);
 	}
-*/
-}
-
-
-void dgWorldDynamicUpdate::CalculateJointsForceParallelKernel (void* const context, void* const worldContext, dgInt32 threadID)
-{
-	dgAssert (0);
-/*
-	dgParallelSolverSyncData* const syncData = (dgParallelSolverSyncData*) context;
-	dgWorld* const world = (dgWorld*) worldContext;
-
-	const dgIsland* const island = syncData->m_island;
-	dgJacobianMatrixElement* const matrixRow = &world->m_solverMemory.m_jacobianBuffer[0];
-	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*) &world->m_bodiesMemory[0]; 
-	const dgBodyInfo* const bodyArray = &bodyArrayPtr[island->m_bodyStart];
-	dgJointInfo* const constraintArrayPtr = (dgJointInfo*) &world->m_jointsMemory[0];
-	dgJointInfo* const constraintArray = &constraintArrayPtr[island->m_jointStart];
-	dgJacobian* const internalForces = &world->m_solverMemory.m_internalForcesBuffer[0];
-//	const int jointCount = syncData->m_bachIndex;
-	const int jointCount = syncData->m_jointCount;
-
-	dgInt32* const bodyLocks = syncData->m_bodyLocks;
-	dgParallelSolverSyncData::dgParallelJointMap* const jointInfoMap = syncData->m_jointConflicts;
-
-	dgInt32* const atomicIndex = &syncData->m_atomicIndex;
-	dgFloat32 accNorm = dgFloat32(0.0f);
-	for (dgInt32 i = dgAtomicExchangeAndAdd(atomicIndex, 1); i < jointCount; i = dgAtomicExchangeAndAdd(atomicIndex, 1)) {
-		dgInt32 index = jointInfoMap[i].m_jointIndex;
-		dgJointInfo* const jointInfo = &constraintArray[index];
-
-		const dgInt32 m0 = jointInfo->m_m0;
-		const dgInt32 m1 = jointInfo->m_m1;
-		dgAssert(m0 != m1);
-
-		dgSpinLock(&syncData->m_lock0, false);
-			if (m0) {
-				dgSpinLock(&bodyLocks[m0], false);
-			}
-			if (m1) {
-				dgSpinLock(&bodyLocks[m1], false);
-			}
-		dgSpinUnlock(&syncData->m_lock0);
-
-		dgFloat32 accel = world->CalculateJointForce(jointInfo, bodyArray, internalForces, matrixRow);
-
-		dgSpinLock(&syncData->m_lock1, false);
-			if (m0) {
-				dgSpinUnlock(&bodyLocks[m0]);
-			}
-			if (m1) {
-				dgSpinUnlock(&bodyLocks[m1]);
-			}
-		dgSpinUnlock(&syncData->m_lock1);
-
-		accNorm = (accel > accNorm) ? accel : accNorm;
-	}
-
-	syncData->m_accelNorm[threadID] = accNorm;
-*/
 }
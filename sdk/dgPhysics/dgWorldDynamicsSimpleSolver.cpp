@@ -53,7 +53,10 @@ void dgWorldDynamicUpdate::ResolveClusterForces(dgBodyCluster* const cluster, dg
 			CalculateSingleContactReactionForces(cluster, threadID, timestep);
 			//CalculateClusterReactionForces____(cluster, threadID, timestep);
 		} else if (activeJoint >= 1) {
-			BuildJacobianMatrix(cluster, threadID, timestep);
+			{
+				dgProfilerScope scope (&world->m_profiler, m_profileBuildJacobianMatrix, threadID);
+				BuildJacobianMatrix(cluster, threadID, timestep);
+			}
 			CalculateClusterReactionForces(cluster, threadID, timestep);
 			//CalculateClusterReactionForces____(cluster, threadID, timestep);
 		} else if (cluster->m_jointCount == 0) {
@@ -275,7 +278,7 @@ void dgWorldDynamicUpdate::ResolveClusterForces(dgBodyCluster* const cluster, dg
 									const dgVector& com0 = body0->m_globalCentreOfMass;
 									const dgVector& com1 = body1->m_globalCentreOfMass;
 									
-									for (dgList<dgContactMaterial>::dgListNode* node = contact->GetFirst(); node; node = node->GetNext()) {
+									for (dgContact::dgListNode* node = contact->GetFirst(); node; node = node->GetNext()) {
 										const dgContactMaterial* const contactMaterial = &node->GetInfo();
 										dgVector vel0 (veloc0 + omega0.CrossProduct3(contactMaterial->m_point - com0));
 										dgVector vel1 (veloc1 + omega1.CrossProduct3(contactMaterial->m_point - com1));
@@ -350,7 +353,7 @@ void dgWorldDynamicUpdate::CalculateClusterContacts(dgBodyCluster* const cluster
 	}
 }
 
-void dgWorldDynamicUpdate::BuildJacobianMatrix (const dgBodyInfo* const bodyInfoArray, dgJointInfo* const jointInfo, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow, dgFloat32 forceImpulseScale) const 
+void dgWorldDynamicUpdate::BuildJacobianMatrix (const dgBodyInfo* const bodyInfoArray, dgJointInfo* const jointInfo, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow, dgFloat32 forceImpulseScale, dgInt32* const bodyLocks) const 
 {
 	const dgInt32 index = jointInfo->m_pairStart;
 	const dgInt32 count = jointInfo->m_pairCount;
@@ -456,10 +459,26 @@ void dgWorldDynamicUpdate::BuildJacobianMatrix (const dgBodyInfo* const bodyInfo
 	forceAcc1.m_linear = forceAcc1.m_linear * scale1;
 	forceAcc1.m_angular = forceAcc1.m_angular * scale1;
 
-	internalForces[m0].m_linear += forceAcc0.m_linear;
-	internalForces[m0].m_angular += forceAcc0.m_angular;
-	internalForces[m1].m_linear += forceAcc1.m_linear;
-	internalForces[m1].m_angular += forceAcc1.m_angular;
+	if (!bodyLocks) {
+		internalForces[m0].m_linear += forceAcc0.m_linear;
+		internalForces[m0].m_angular += forceAcc0.m_angular;
+		internalForces[m1].m_linear += forceAcc1.m_linear;
+		internalForces[m1].m_angular += forceAcc1.m_angular;
+	} else {
+		// other threads may be adding to the same bodies, the sentinel body at index zero is never read
+		if (m0) {
+			dgSpinLock(&bodyLocks[m0], true);
+			internalForces[m0].m_linear += forceAcc0.m_linear;
+			internalForces[m0].m_angular += forceAcc0.m_angular;
+			dgSpinUnlock(&bodyLocks[m0]);
+		}
+		if (m1) {
+			dgSpinLock(&bodyLocks[m1], true);
+			internalForces[m1].m_linear += forceAcc1.m_linear;
+			internalForces[m1].m_angular += forceAcc1.m_angular;
+			dgSpinUnlock(&bodyLocks[m1]);
+		}
+	}
 }
 
 
@@ -517,6 +536,7 @@ void dgWorldDynamicUpdate::BuildJacobianMatrix(dgBodyCluster* const cluster, dgI
 			internalForces[i].m_angular = dgVector::m_zero;
 		}
 	}
+	GatherBodyState(cluster, 0, bodyCount, timestep);
 
 	dgContraintDescritor constraintParams;
 
@@ -584,6 +604,126 @@ void dgWorldDynamicUpdate::CalculateNetAcceleration(dgBody* const body, const dg
 }
 
 
+void dgWorldDynamicUpdate::GatherBodyState(const dgBodyCluster* const cluster, dgInt32 start, dgInt32 end, dgFloat32 timestep) const
+{
+	dgWorld* const world = (dgWorld*) this;
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+	const dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+
+	const dgInt32 base = cluster->m_bodyStart;
+	dgVector* const veloc = &m_solverMemory.m_bodyVeloc[base];
+	dgVector* const omega = &m_solverMemory.m_bodyOmega[base];
+	dgVector* const externalForce = &m_solverMemory.m_bodyExternalForce[base];
+	dgVector* const externalTorque = &m_solverMemory.m_bodyExternalTorque[base];
+	dgMatrix* const invInertia = &m_solverMemory.m_bodyInvInertia[base];
+	dgFloat32* const invMass = &m_solverMemory.m_bodyInvMass[base];
+	dgInt32* const resting = &m_solverMemory.m_bodyResting[base];
+
+	for (dgInt32 i = start; i < end; i ++) {
+		const dgBody* const body = bodyArray[i].m_body;
+		veloc[i] = body->m_veloc;
+		omega[i] = body->m_omega;
+		resting[i] = body->m_resting;
+		if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
+			const dgDynamicBody* const dynBody = (dgDynamicBody*)body;
+			externalForce[i] = dynBody->m_externalForce;
+			externalTorque[i] = dynBody->m_externalTorque;
+			invInertia[i] = dynBody->m_invWorldInertiaMatrix;
+			invMass[i] = dynBody->m_invMass.m_w;
+		} else {
+			// only dynamic bodies integrate forces, impulses are applied to every body
+			externalForce[i] = dgVector::m_zero;
+			externalTorque[i] = dgVector::m_zero;
+			if (timestep != dgFloat32 (0.0f)) {
+				invInertia[i] = dgGetZeroMatrix();
+				invMass[i] = dgFloat32 (0.0f);
+			} else {
+				invInertia[i] = body->m_invWorldInertiaMatrix;
+				invMass[i] = body->m_invMass.m_w;
+			}
+		}
+	}
+}
+
+
+void dgWorldDynamicUpdate::IntegrateBodyState(const dgBodyCluster* const cluster, dgInt32 start, dgInt32 end, dgFloat32 timestep) const
+{
+	const dgInt32 base = cluster->m_bodyStart;
+	const dgJacobian* const internalForces = &m_solverMemory.m_internalForcesBuffer[base];
+	dgVector* const veloc = &m_solverMemory.m_bodyVeloc[base];
+	dgVector* const omega = &m_solverMemory.m_bodyOmega[base];
+	const dgVector* const externalForce = &m_solverMemory.m_bodyExternalForce[base];
+	const dgVector* const externalTorque = &m_solverMemory.m_bodyExternalTorque[base];
+	const dgMatrix* const invInertia = &m_solverMemory.m_bodyInvInertia[base];
+	const dgFloat32* const invMass = &m_solverMemory.m_bodyInvMass[base];
+	dgInt32* const resting = &m_solverMemory.m_bodyResting[base];
+
+	if (timestep != dgFloat32 (0.0f)) {
+		const dgWorld* const world = (dgWorld*) this;
+		const dgVector speedFreeze2 (world->m_freezeSpeed2 * dgFloat32 (0.1f));
+		const dgVector timestep4 (timestep);
+		for (dgInt32 i = start; i < end; i ++) {
+			const dgVector force (externalForce[i] + internalForces[i].m_linear);
+			const dgVector torque (externalTorque[i] + internalForces[i].m_angular);
+
+			const dgVector velocStep ((force.Scale4(invMass[i])) * timestep4);
+			const dgVector omegaStep ((invInertia[i].RotateVector(torque)) * timestep4);
+
+			if (!resting[i]) {
+				veloc[i] += velocStep;
+				omega[i] += omegaStep;
+			} else {
+				const dgVector velocStep2 (velocStep.DotProduct4(velocStep));
+				const dgVector omegaStep2 (omegaStep.DotProduct4(omegaStep));
+				const dgVector test (((velocStep2 > speedFreeze2) | (omegaStep2 > speedFreeze2)) & dgVector::m_negOne);
+				const dgInt32 equilibrium = test.GetSignMask() ? 0 : 1;
+				resting[i] &= equilibrium;
+			}
+
+			dgAssert (veloc[i].m_w == dgFloat32 (0.0f));
+			dgAssert (omega[i].m_w == dgFloat32 (0.0f));
+		}
+	} else {
+		for (dgInt32 i = start; i < end; i ++) {
+			veloc[i] += internalForces[i].m_linear.Scale4(invMass[i]);
+			omega[i] += invInertia[i].RotateVector(internalForces[i].m_angular);
+		}
+	}
+}
+
+
+void dgWorldDynamicUpdate::ScatterBodyState(const dgBodyCluster* const cluster, dgInt32 start, dgInt32 end) const
+{
+	dgWorld* const world = (dgWorld*) this;
+	dgBodyInfo* const bodyArrayPtr = (dgBodyInfo*)&world->m_bodiesMemory[0];
+	const dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
+
+	const dgInt32 base = cluster->m_bodyStart;
+	const dgVector* const veloc = &m_solverMemory.m_bodyVeloc[base];
+	const dgVector* const omega = &m_solverMemory.m_bodyOmega[base];
+	const dgInt32* const resting = &m_solverMemory.m_bodyResting[base];
+	for (dgInt32 i = start; i < end; i ++) {
+		dgBody* const body = bodyArray[i].m_body;
+		body->m_veloc = veloc[i];
+		body->m_omega = omega[i];
+		body->m_resting = resting[i];
+	}
+}
+
+
+void dgWorldDynamicUpdate::SetJointAccelerationBodies(dgJointAccelerationDecriptor* const desc, const dgJointInfo* const jointInfo, const dgVector* const veloc, const dgVector* const omega) const
+{
+	// static bodies all map to the cluster sentinel, so they and the legacy solvers (veloc == NULL) read the body itself
+	const dgConstraint* const constraint = jointInfo->m_joint;
+	const dgInt32 m0 = veloc ? jointInfo->m_m0 : 0;
+	const dgInt32 m1 = veloc ? jointInfo->m_m1 : 0;
+	desc->m_bodyVeloc0 = m0 ? &veloc[m0] : &constraint->m_body0->m_veloc;
+	desc->m_bodyOmega0 = m0 ? &omega[m0] : &constraint->m_body0->m_omega;
+	desc->m_bodyVeloc1 = m1 ? &veloc[m1] : &constraint->m_body1->m_veloc;
+	desc->m_bodyOmega1 = m1 ? &omega[m1] : &constraint->m_body1->m_omega;
+}
+
+
 void dgWorldDynamicUpdate::IntegrateReactionsForces(const dgBodyCluster* const cluster, dgInt32 threadID, dgFloat32 timestep) const
 {
 	if (cluster->m_jointCount == 0) {
@@ -761,14 +901,12 @@ dgFloat32 dgWorldDynamicUpdate::CalculateJointForce_1_50(const dgJointInfo* cons
 }
 
 
-dgFloat32 dgWorldDynamicUpdate::CalculateJointForce(const dgJointInfo* const jointInfo, const dgBodyInfo* const bodyArray, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const
+dgFloat32 dgWorldDynamicUpdate::CalculateJointForce(const dgJointInfo* const jointInfo, const dgInt32* const bodyResting, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow) const
 {
 	dgFloat32 accNorm = dgFloat32(0.0f);
 	const dgInt32 m0 = jointInfo->m_m0;
 	const dgInt32 m1 = jointInfo->m_m1;
-	const dgBody* const body0 = bodyArray[m0].m_body;
-	const dgBody* const body1 = bodyArray[m1].m_body;
-	if (!(body0->m_resting & body1->m_resting)) {
+	if (!(bodyResting[m0] & bodyResting[m1])) {
 		dgVector b[DG_CONSTRAINT_MAX_ROWS];
 		dgVector x[DG_CONSTRAINT_MAX_ROWS + 1];
 		dgVector low[DG_CONSTRAINT_MAX_ROWS];
@@ -1009,10 +1147,16 @@ dgFloat32 dgWorldDynamicUpdate::CalculateJointForce(const dgJointInfo* const joi
 			row->m_maxImpact = dgMax(dgAbs(row->m_force), row->m_maxImpact);
 		}
 
-		internalForces[m0].m_linear = linearM0;
-		internalForces[m0].m_angular = angularM0;
-		internalForces[m1].m_linear = linearM1;
-		internalForces[m1].m_angular = angularM1;
+		// the static bodies share slot zero, it is never written so that the parallel solver can run 
+		// joints of the same color that all touch static bodies without racing on it
+		if (m0) {
+			internalForces[m0].m_linear = linearM0;
+			internalForces[m0].m_angular = angularM0;
+		}
+		if (m1) {
+			internalForces[m1].m_linear = linearM1;
+			internalForces[m1].m_angular = angularM1;
+		}
 	}
 
 	return accNorm;
@@ -1048,9 +1192,10 @@ void dgWorldDynamicUpdate::CalculateSingleContactReactionForces(const dgBodyClus
 	dgConstraint* const constraint = jointInfo->m_joint;
 	joindDesc.m_rowsCount = jointInfo->m_pairCount;
 	joindDesc.m_rowMatrix = &matrixRow[jointInfo->m_pairStart];
+	SetJointAccelerationBodies(&joindDesc, jointInfo, NULL, NULL);
 	constraint->JointAccelerations(&joindDesc);
 //	CalculateJointForce_3_13(jointInfo, bodyArray, internalForces, matrixRow);
-	CalculateJointForce(jointInfo, bodyArray, internalForces, matrixRow);
+	CalculateJointForce(jointInfo, &m_solverMemory.m_bodyResting[cluster->m_bodyStart], internalForces, matrixRow);
 
 	if (timestep != dgFloat32(0.0f)) {
 		dgVector timestep4(timestep);
@@ -1141,6 +1286,9 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 	dgBodyInfo* const bodyArray = &bodyArrayPtr[cluster->m_bodyStart];
 	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
 	dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
+	const dgVector* const bodyVeloc = &m_solverMemory.m_bodyVeloc[cluster->m_bodyStart];
+	const dgVector* const bodyOmega = &m_solverMemory.m_bodyOmega[cluster->m_bodyStart];
+	const dgInt32* const bodyResting = &m_solverMemory.m_bodyResting[cluster->m_bodyStart];
 
 	const dgInt32 derivativesEvaluationsRK4 = 4;
 	dgFloat32 invTimestep = (timestep > dgFloat32(0.0f)) ? dgFloat32(1.0f) / timestep : dgFloat32(0.0f);
@@ -1149,7 +1297,6 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 	dgFloat32 invTimestepRK = invTimestep * dgFloat32(derivativesEvaluationsRK4);
 	dgAssert(bodyArray[0].m_body == world->m_sentinelBody);
 
-	dgVector speedFreeze2(world->m_freezeSpeed2 * dgFloat32(0.1f));
 	dgVector freezeOmega2(world->m_freezeOmega2 * dgFloat32(0.1f));
 
 	dgJointAccelerationDecriptor joindDesc;
@@ -1173,7 +1320,9 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 		}
 	}
 
+	dgProfilerScope scope (&world->m_profiler, m_profileSolverPasses, threadID);
 	const dgInt32 passes = world->m_solverMode;
+	const dgInt32 wideJointGroups = BuildJointGroupsWide(cluster, threadID);
 	for (dgInt32 step = 0; step < derivativesEvaluationsRK4; step++) {
 
 		for (dgInt32 i = 0; i < jointCount; i++) {
@@ -1181,6 +1330,7 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 			dgConstraint* const constraint = jointInfo->m_joint;
 			joindDesc.m_rowsCount = jointInfo->m_pairCount;
 			joindDesc.m_rowMatrix = &matrixRow[jointInfo->m_pairStart];
+			SetJointAccelerationBodies(&joindDesc, jointInfo, bodyVeloc, bodyOmega);
 			constraint->JointAccelerations(&joindDesc);
 		}
 		joindDesc.m_firstPassCoefFlag = dgFloat32(1.0f);
@@ -1189,13 +1339,17 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 		dgFloat32 accNorm = maxAccNorm * dgFloat32(2.0f);
 
 		for (dgInt32 i = 0; (i < passes) && (accNorm > maxAccNorm); i++) {
-			accNorm = dgFloat32(0.0f);
-			for (dgInt32 j = 0; j < jointCount; j++) {
-				dgJointInfo* const jointInfo = &constraintArray[j];
-				if (!jointInfo->m_joint->IsSkeleton()) {
-					//dgFloat32 accel2 = CalculateJointForce_3_13(jointInfo, bodyArray, internalForces, matrixRow);
-					dgFloat32 accel2 = CalculateJointForce(jointInfo, bodyArray, internalForces, matrixRow);
-					accNorm += accel2;
+			if (wideJointGroups) {
+				accNorm = CalculateJointForceWide(cluster, threadID);
+			} else {
+				accNorm = dgFloat32(0.0f);
+				for (dgInt32 j = 0; j < jointCount; j++) {
+					dgJointInfo* const jointInfo = &constraintArray[j];
+					if (!jointInfo->m_joint->IsSkeleton()) {
+						//dgFloat32 accel2 = CalculateJointForce_3_13(jointInfo, bodyArray, internalForces, matrixRow);
+						dgFloat32 accel2 = CalculateJointForce(jointInfo, bodyResting, internalForces, matrixRow);
+						accNorm += accel2;
+					}
 				}
 			}
 			for (dgInt32 j = 0; j < skeletonCount; j++) {
@@ -1203,46 +1357,9 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces(const dgBodyCluster* c
 			}
 		}
 
-
-		if (timestepRK != dgFloat32(0.0f)) {
-			dgVector timestep4(timestepRK);
-			for (dgInt32 i = 1; i < bodyCount; i++) {
-				dgDynamicBody* const body = (dgDynamicBody*)bodyArray[i].m_body;
-				dgAssert(body->m_index == i);
-				if (body->IsRTTIType(dgBody::m_dynamicBodyRTTI)) {
-					const dgJacobian& forceAndTorque = internalForces[i];
-					const dgVector force(body->m_externalForce + forceAndTorque.m_linear);
-					const dgVector torque(body->m_externalTorque + forceAndTorque.m_angular);
-
-					const dgVector velocStep((force.Scale4(body->m_invMass.m_w)) * timestep4);
-					const dgVector omegaStep((body->m_invWorldInertiaMatrix.RotateVector(torque)) * timestep4);
-
-					if (!body->m_resting) {
-						body->m_veloc += velocStep;
-						body->m_omega += omegaStep;
-					} else {
-						const dgVector velocStep2(velocStep.DotProduct4(velocStep));
-						const dgVector omegaStep2(omegaStep.DotProduct4(omegaStep));
-						const dgVector test(((velocStep2 > speedFreeze2) | (omegaStep2 > speedFreeze2)) & dgVector::m_negOne);
-						const dgInt32 equilibrium = test.GetSignMask() ? 0 : 1;
-						body->m_resting &= equilibrium;
-					}
-
-					dgAssert(body->m_veloc.m_w == dgFloat32(0.0f));
-					dgAssert(body->m_omega.m_w == dgFloat32(0.0f));
-				}
-			}
-		} else {
-			for (dgInt32 i = 1; i < bodyCount; i++) {
-				dgDynamicBody* const body = (dgDynamicBody*)bodyArray[i].m_body;
-				const dgVector& linearMomentum = internalForces[i].m_linear;
-				const dgVector& angularMomentum = internalForces[i].m_angular;
-
-				body->m_veloc += linearMomentum.Scale4(body->m_invMass.m_w);
-				body->m_omega += body->m_invWorldInertiaMatrix.RotateVector(angularMomentum);
-			}
-		}
+		IntegrateBodyState(cluster, 1, bodyCount, timestepRK);
 	}
+	ScatterBodyState(cluster, 1, bodyCount);
 
 	dgInt32 hasJointFeeback = 0;
 	if (timestepRK != dgFloat32(0.0f)) {
@@ -1691,6 +1808,7 @@ void dgWorldDynamicUpdate::CalculateClusterReactionForces____(const dgBodyCluste
 			dgConstraint* const constraint = jointInfo->m_joint;
 			joindDesc.m_rowsCount = jointInfo->m_pairCount;
 			joindDesc.m_rowMatrix = &matrixRow[jointInfo->m_pairStart];
+			SetJointAccelerationBodies(&joindDesc, jointInfo, NULL, NULL);
 			constraint->JointAccelerations(&joindDesc);
 		}
 		joindDesc.m_firstPassCoefFlag = dgFloat32(1.0f);
@@ -0,0 +1,463 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "dgPhysicsStdafx.h"
+#include "dgBody.h"
+#include "dgWorld.h"
+#include "dgConstraint.h"
+#include "dgWorldDynamicUpdate.h"
+
+#ifdef DG_AVX_RUNTIME_DISPATCH
+#include <immintrin.h>
+
+// the wide kernels are compiled for the extended instruction sets only, the world selects
+// them at run time after checking the cpu, so the rest of the library still runs on any sse2 cpu
+
+#if defined (__clang__)
+	#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined (__GNUC__)
+	#pragma GCC push_options
+	#pragma GCC target ("avx2,fma")
+#endif
+
+namespace dgWideAvx2
+{
+	#define DG_WIDE_LANES	8
+
+	DG_MSC_AVX2_ALIGMENT
+	class dgWideMask
+	{
+		public:
+		DG_INLINE dgWideMask (const __m256& type)
+			:m_type(type)
+		{
+		}
+
+		DG_INLINE dgWideMask operator& (const dgWideMask& data) const
+		{
+			return _mm256_and_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideMask operator| (const dgWideMask& data) const
+		{
+			return _mm256_or_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideMask AndNot (const dgWideMask& data) const
+		{
+			return _mm256_andnot_ps (data.m_type, m_type);
+		}
+
+		DG_INLINE dgInt32 GetSignMask() const
+		{
+			return _mm256_movemask_ps (m_type);
+		}
+
+		__m256 m_type;
+	} DG_GCC_AVX2_ALIGMENT;
+
+	DG_MSC_AVX2_ALIGMENT
+	class dgWideInt
+	{
+		public:
+		DG_INLINE dgWideInt ()
+		{
+		}
+
+		DG_INLINE dgWideInt (dgInt32 value)
+			:m_type(_mm256_set1_epi32 (value))
+		{
+		}
+
+		DG_INLINE dgWideInt (const __m256i& type)
+			:m_type(type)
+		{
+		}
+
+		DG_INLINE dgWideInt operator+ (const dgWideInt& data) const
+		{
+			return _mm256_add_epi32 (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideInt operator* (const dgWideInt& data) const
+		{
+			return _mm256_mullo_epi32 (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideInt And (const dgWideInt& data) const
+		{
+			return _mm256_and_si256 (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideMask operator> (const dgWideInt& data) const
+		{
+			return _mm256_castsi256_ps (_mm256_cmpgt_epi32 (m_type, data.m_type));
+		}
+
+		DG_INLINE static dgWideInt Gather (const dgInt32* const base, const dgWideInt& index)
+		{
+			return _mm256_i32gather_epi32 (base, index.m_type, 4);
+		}
+
+		__m256i m_type;
+	} DG_GCC_AVX2_ALIGMENT;
+
+	DG_MSC_AVX2_ALIGMENT
+	class dgWideFloat
+	{
+		public:
+		DG_INLINE dgWideFloat ()
+		{
+		}
+
+		DG_INLINE dgWideFloat (dgFloat32 value)
+			:m_type(_mm256_set1_ps (value))
+		{
+		}
+
+		DG_INLINE dgWideFloat (const __m256& type)
+			:m_type(type)
+		{
+		}
+
+		DG_INLINE dgWideFloat operator+ (const dgWideFloat& data) const
+		{
+			return _mm256_add_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideFloat operator- (const dgWideFloat& data) const
+		{
+			return _mm256_sub_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideFloat operator* (const dgWideFloat& data) const
+		{
+			return _mm256_mul_ps (m_type, data.m_type);
+		}
+
+		// return this + A * B
+		DG_INLINE dgWideFloat MulAdd (const dgWideFloat& A, const dgWideFloat& B) const
+		{
+			return _mm256_fmadd_ps (A.m_type, B.m_type, m_type);
+		}
+
+		DG_INLINE dgWideFloat GetMax (const dgWideFloat& data) const
+		{
+			return _mm256_max_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideFloat GetMin (const dgWideFloat& data) const
+		{
+			return _mm256_min_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideMask operator> (const dgWideFloat& data) const
+		{
+			return _mm256_cmp_ps (m_type, data.m_type, _CMP_GT_OQ);
+		}
+
+		DG_INLINE dgWideMask operator< (const dgWideFloat& data) const
+		{
+			return _mm256_cmp_ps (m_type, data.m_type, _CMP_LT_OQ);
+		}
+
+		DG_INLINE dgWideFloat And (const dgWideMask& mask) const
+		{
+			return _mm256_and_ps (m_type, mask.m_type);
+		}
+
+		DG_INLINE dgWideFloat AndNot (const dgWideMask& mask) const
+		{
+			return _mm256_andnot_ps (mask.m_type, m_type);
+		}
+
+		// return this where the mask is set, and data elsewhere
+		DG_INLINE dgWideFloat Select (const dgWideFloat& data, const dgWideMask& mask) const
+		{
+			return _mm256_blendv_ps (data.m_type, m_type, mask.m_type);
+		}
+
+		DG_INLINE static dgWideFloat Gather (const dgFloat32* const base, const dgWideInt& index)
+		{
+			return _mm256_i32gather_ps (base, index.m_type, 4);
+		}
+
+		DG_INLINE static dgWideFloat Gather (const dgFloat32* const base, const dgWideInt& index, const dgWideMask& mask)
+		{
+			return _mm256_mask_i32gather_ps (_mm256_setzero_ps(), base, index.m_type, mask.m_type, 4);
+		}
+
+		__m256 m_type;
+	} DG_GCC_AVX2_ALIGMENT;
+
+	#include "dgWorldDynamicsWideSolver.h"
+	#undef DG_WIDE_LANES
+}
+
+#if defined (__clang__)
+	#pragma clang attribute pop
+	#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#elif defined (__GNUC__)
+	#pragma GCC pop_options
+	#pragma GCC push_options
+	#pragma GCC target ("avx512f")
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"	// gcc flags the undefined registers inside its own avx512 intrinsics
+#endif
+
+namespace dgWideAvx512
+{
+	#define DG_WIDE_LANES	16
+
+	class dgWideMask
+	{
+		public:
+		DG_INLINE dgWideMask (__mmask16 type)
+			:m_type(type)
+		{
+		}
+
+		DG_INLINE dgWideMask operator& (const dgWideMask& data) const
+		{
+			return __mmask16 (m_type & data.m_type);
+		}
+
+		DG_INLINE dgWideMask operator| (const dgWideMask& data) const
+		{
+			return __mmask16 (m_type | data.m_type);
+		}
+
+		DG_INLINE dgWideMask AndNot (const dgWideMask& data) const
+		{
+			return __mmask16 (m_type & ~data.m_type);
+		}
+
+		DG_INLINE dgInt32 GetSignMask() const
+		{
+			return dgInt32 (m_type);
+		}
+
+		__mmask16 m_type;
+	};
+
+	DG_MSC_AVX512_ALIGMENT
+	class dgWideInt
+	{
+		public:
+		DG_INLINE dgWideInt ()
+		{
+		}
+
+		DG_INLINE dgWideInt (dgInt32 value)
+			:m_type(_mm512_set1_epi32 (value))
+		{
+		}
+
+		DG_INLINE dgWideInt (const __m512i& type)
+			:m_type(type)
+		{
+		}
+
+		DG_INLINE dgWideInt operator+ (const dgWideInt& data) const
+		{
+			return _mm512_add_epi32 (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideInt operator* (const dgWideInt& data) const
+		{
+			return _mm512_mullo_epi32 (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideInt And (const dgWideInt& data) const
+		{
+			return _mm512_and_si512 (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideMask operator> (const dgWideInt& data) const
+		{
+			return _mm512_cmpgt_epi32_mask (m_type, data.m_type);
+		}
+
+		DG_INLINE static dgWideInt Gather (const dgInt32* const base, const dgWideInt& index)
+		{
+			return _mm512_i32gather_epi32 (index.m_type, base, 4);
+		}
+
+		__m512i m_type;
+	} DG_GCC_AVX512_ALIGMENT;
+
+	DG_MSC_AVX512_ALIGMENT
+	class dgWideFloat
+	{
+		public:
+		DG_INLINE dgWideFloat ()
+		{
+		}
+
+		DG_INLINE dgWideFloat (dgFloat32 value)
+			:m_type(_mm512_set1_ps (value))
+		{
+		}
+
+		DG_INLINE dgWideFloat (const __m512& type)
+			:m_type(type)
+		{
+		}
+
+		DG_INLINE dgWideFloat operator+ (const dgWideFloat& data) const
+		{
+			return _mm512_add_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideFloat operator- (const dgWideFloat& data) const
+		{
+			return _mm512_sub_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideFloat operator* (const dgWideFloat& data) const
+		{
+			return _mm512_mul_ps (m_type, data.m_type);
+		}
+
+		// return this + A * B
+		DG_INLINE dgWideFloat MulAdd (const dgWideFloat& A, const dgWideFloat& B) const
+		{
+			return _mm512_fmadd_ps (A.m_type, B.m_type, m_type);
+		}
+
+		DG_INLINE dgWideFloat GetMax (const dgWideFloat& data) const
+		{
+			return _mm512_max_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideFloat GetMin (const dgWideFloat& data) const
+		{
+			return _mm512_min_ps (m_type, data.m_type);
+		}
+
+		DG_INLINE dgWideMask operator> (const dgWideFloat& data) const
+		{
+			return _mm512_cmp_ps_mask (m_type, data.m_type, _CMP_GT_OQ);
+		}
+
+		DG_INLINE dgWideMask operator< (const dgWideFloat& data) const
+		{
+			return _mm512_cmp_ps_mask (m_type, data.m_type, _CMP_LT_OQ);
+		}
+
+		DG_INLINE dgWideFloat And (const dgWideMask& mask) const
+		{
+			return _mm512_maskz_mov_ps (mask.m_type, m_type);
+		}
+
+		DG_INLINE dgWideFloat AndNot (const dgWideMask& mask) const
+		{
+			return _mm512_maskz_mov_ps (__mmask16 (~mask.m_type), m_type);
+		}
+
+		// return this where the mask is set, and data elsewhere
+		DG_INLINE dgWideFloat Select (const dgWideFloat& data, const dgWideMask& mask) const
+		{
+			return _mm512_mask_blend_ps (mask.m_type, data.m_type, m_type);
+		}
+
+		DG_INLINE static dgWideFloat Gather (const dgFloat32* const base, const dgWideInt& index)
+		{
+			return _mm512_i32gather_ps (index.m_type, base, 4);
+		}
+
+		DG_INLINE static dgWideFloat Gather (const dgFloat32* const base, const dgWideInt& index, const dgWideMask& mask)
+		{
+			return _mm512_mask_i32gather_ps (_mm512_setzero_ps(), mask.m_type, index.m_type, base, 4);
+		}
+
+		__m512 m_type;
+	} DG_GCC_AVX512_ALIGMENT;
+
+	#include "dgWorldDynamicsWideSolver.h"
+	#undef DG_WIDE_LANES
+}
+
+#if defined (__clang__)
+	#pragma clang attribute pop
+#elif defined (__GNUC__)
+	#pragma GCC diagnostic pop
+	#pragma GCC pop_options
+#endif
+
+#endif
+
+
+dgInt32 dgWorldDynamicUpdate::BuildJointGroupsWide (const dgBodyCluster* const cluster, dgInt32 threadID) const
+{
+#ifdef DG_AVX_RUNTIME_DISPATCH
+	dgWorld* const world = (dgWorld*) this;
+	const dgInt32 hardwareMode = world->m_hardwaredIndex;
+	if ((hardwareMode == m_hardwareModeSimd) || (cluster->m_jointCount < DG_WIDE_SOLVER_MIN_JOINT_COUNT)) {
+		return 0;
+	}
+
+	dgJointInfo* const constraintArrayPtr = (dgJointInfo*)&world->m_jointsMemory[0];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	const dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
+
+	dgParallelSolverSyncData syncData;
+	syncData.m_cluster = cluster;
+	syncData.m_jointCount = cluster->m_jointCount;
+	syncData.m_jointConflicts = dgAlloca (dgParallelSolverSyncData::dgParallelJointMap, cluster->m_jointCount + 1);
+	LinearizeJointParallelArray (&syncData, constraintArray, cluster);
+
+	dgArray<dgUnsigned8>& memory = world->m_solverWideRowsMemory[threadID];
+	if (hardwareMode == m_hardwareModeAvx512) {
+		return dgWideAvx512::PackJointRows (memory, &syncData, constraintArray, matrixRow);
+	}
+	return dgWideAvx2::PackJointRows (memory, &syncData, constraintArray, matrixRow);
+#else
+	return 0;
+#endif
+}
+
+dgFloat32 dgWorldDynamicUpdate::CalculateJointForceWide (const dgBodyCluster* const cluster, dgInt32 threadID) const
+{
+	dgFloat32 accNorm = dgFloat32 (0.0f);
+#ifdef DG_AVX_RUNTIME_DISPATCH
+	dgWorld* const world = (dgWorld*) this;
+	dgJointInfo* const constraintArrayPtr = (dgJointInfo*)&world->m_jointsMemory[0];
+	dgJointInfo* const constraintArray = &constraintArrayPtr[cluster->m_jointStart];
+	dgJacobianMatrixElement* const matrixRow = &m_solverMemory.m_jacobianBuffer[cluster->m_rowsStart];
+	dgJacobian* const internalForces = &m_solverMemory.m_internalForcesBuffer[cluster->m_bodyStart];
+	const dgInt32* const bodyResting = &m_solverMemory.m_bodyResting[cluster->m_bodyStart];
+
+	dgInt32 unconvergedCount = 0;
+	dgArray<dgUnsigned8>& memory = world->m_solverWideRowsMemory[threadID];
+	if (world->m_hardwaredIndex == m_hardwareModeAvx512) {
+		accNorm = dgWideAvx512::CalculateJointForce (memory, constraintArray, bodyResting, internalForces, matrixRow, unconvergedCount);
+	} else {
+		accNorm = dgWideAvx2::CalculateJointForce (memory, constraintArray, bodyResting, internalForces, matrixRow, unconvergedCount);
+	}
+
+	const dgInt32* const unconverged = dgWideAvx2::GetSolverHeader (memory)->m_unconverged;
+	for (dgInt32 i = 0; i < unconvergedCount; i ++) {
+		CalculateJointForce (&constraintArray[unconverged[i]], bodyResting, internalForces, matrixRow);
+	}
+#endif
+	return accNorm;
+}
@@ -0,0 +1,400 @@
+/* Copyright (c) <2003-2016> <Julio Jerez, Newton Game Dynamics>
+*
+* This software is provided 'as-is', without any express or implied
+* warranty. In no event will the authors be held liable for any damages
+* arising from the use of this software.
+*
+* Permission is granted to anyone to use this software for any purpose,
+* including commercial applications, and to alter it and redistribute it
+* freely, subject to the following restrictions:
+*
+* 1. The origin of this software must not be misrepresented; you must not
+* claim that you wrote the original software. If you use this software
+* in a product, an acknowledgment in the product documentation would be
+* appreciated but is not required.
+*
+* 2. Altered source versions must be plainly marked as such, and must not be
+* misrepresented as being the original software.
+*
+* 3. This notice may not be removed or altered from any source distribution.
+*/
+
+// wide joint solver kernels, this file is included by dgWorldDynamicsWideSolver.cpp once for each
+// instruction set, inside a namespace that defines dgWideFloat, dgWideInt, dgWideMask and
+// DG_WIDE_LANES, so it does not have an include guard on purpose.
+// each wide row holds one row of up to DG_WIDE_LANES joints of the same color, so that no two lanes
+// ever touch the same dynamic body and the lanes are solved like a sequential Gauss Seidel sweep.
+
+class dgWideJacobianRow
+{
+	public:
+	dgWideFloat m_Jt[12];
+	dgWideFloat m_JMinv[12];
+	dgWideFloat m_diagDamp;
+	dgWideFloat m_invJinvMJt;
+	dgWideFloat m_lowerBoundFrictionCoefficent;
+	dgWideFloat m_upperBoundFrictionCoefficent;
+	dgWideInt m_normalForceIndex;
+	dgWideInt m_rowIndex;
+};
+
+class dgWideJointGroup
+{
+	public:
+	dgWideFloat m_scale0;
+	dgWideFloat m_scale1;
+	dgWideInt m_m0;
+	dgWideInt m_m1;
+	dgWideInt m_joint;
+	dgInt32 m_rowStart;
+	dgInt32 m_rowsCount;
+};
+
+class dgWideSolverHeader
+{
+	public:
+	dgWideJacobianRow* m_rows;
+	dgWideJointGroup* m_groups;
+	dgInt32* m_unconverged;
+	dgInt32 m_groupCount;
+	dgInt32 m_rowCount;
+};
+
+static DG_INLINE dgWideSolverHeader* GetSolverHeader (dgArray<dgUnsigned8>& memory)
+{
+	// the array alignment is only the memory granularity, align to the widest register so that
+	// all instruction sets find the header at the same address
+	const size_t base = size_t (&memory[0]);
+	return (dgWideSolverHeader*) ((base + DG_VECTOR_AVX512_SIZE - 1) & ~size_t (DG_VECTOR_AVX512_SIZE - 1));
+}
+
+static DG_INLINE void SetLane (dgWideFloat& wide, dgInt32 lane, dgFloat32 value)
+{
+	((dgFloat32*)&wide)[lane] = value;
+}
+
+static DG_INLINE void SetLane (dgWideInt& wide, dgInt32 lane, dgInt32 value)
+{
+	((dgInt32*)&wide)[lane] = value;
+}
+
+static DG_INLINE dgFloat32 GetLane (const dgWideFloat& wide, dgInt32 lane)
+{
+	return ((const dgFloat32*)&wide)[lane];
+}
+
+static DG_INLINE dgInt32 GetLane (const dgWideInt& wide, dgInt32 lane)
+{
+	return ((const dgInt32*)&wide)[lane];
+}
+
+static void ClearJointGroup (dgWideJointGroup* const group, dgWideJacobianRow* const rows, dgInt32 rowStart, dgInt32 rowsCount)
+{
+	const dgWideFloat zero (dgFloat32 (0.0f));
+	const dgWideInt invalid (-1);
+	group->m_scale0 = zero;
+	group->m_scale1 = zero;
+	group->m_m0 = dgWideInt (0);
+	group->m_m1 = dgWideInt (0);
+	group->m_joint = invalid;
+	group->m_rowStart = rowStart;
+	group->m_rowsCount = rowsCount;
+
+	for (dgInt32 i = 0; i < rowsCount; i ++) {
+		dgWideJacobianRow* const row = &rows[rowStart + i];
+		for (dgInt32 j = 0; j < 12; j ++) {
+			row->m_Jt[j] = zero;
+			row->m_JMinv[j] = zero;
+		}
+		row->m_diagDamp = zero;
+		row->m_invJinvMJt = zero;
+		row->m_lowerBoundFrictionCoefficent = zero;
+		row->m_upperBoundFrictionCoefficent = zero;
+		row->m_rowIndex = invalid;
+		for (dgInt32 j = 0; j < DG_WIDE_LANES; j ++) {
+			SetLane (row->m_normalForceIndex, j, j);
+		}
+	}
+}
+
+static void PackJointLane (dgWideJointGroup* const group, dgWideJacobianRow* const rows, dgInt32 lane, const dgJointInfo* const jointInfo, dgInt32 jointIndex, const dgJacobianMatrixElement* const matrixRow)
+{
+	SetLane (group->m_scale0, lane, jointInfo->m_scale0);
+	SetLane (group->m_scale1, lane, jointInfo->m_scale1);
+	SetLane (group->m_m0, lane, jointInfo->m_m0);
+	SetLane (group->m_m1, lane, jointInfo->m_m1);
+	SetLane (group->m_joint, lane, jointIndex);
+
+	const dgInt32 stride = sizeof (dgJacobianMatrixElement) / sizeof (dgFloat32);
+	const dgInt32 rowsCount = jointInfo->m_pairCount;
+	for (dgInt32 i = 0; i < rowsCount; i ++) {
+		const dgJacobianMatrixElement* const src = &matrixRow[jointInfo->m_pairStart + i];
+		dgWideJacobianRow* const row = &rows[group->m_rowStart + i];
+		const dgVector* const Jt = &src->m_Jt.m_jacobianM0.m_linear;
+		const dgVector* const JMinv = &src->m_JMinv.m_jacobianM0.m_linear;
+		for (dgInt32 j = 0; j < 4; j ++) {
+			for (dgInt32 k = 0; k < 3; k ++) {
+				SetLane (row->m_Jt[j * 3 + k], lane, Jt[j][k]);
+				SetLane (row->m_JMinv[j * 3 + k], lane, JMinv[j][k]);
+			}
+		}
+		SetLane (row->m_diagDamp, lane, src->m_diagDamp);
+		SetLane (row->m_invJinvMJt, lane, src->m_invJinvMJt);
+		SetLane (row->m_lowerBoundFrictionCoefficent, lane, src->m_lowerBoundFrictionCoefficent);
+		SetLane (row->m_upperBoundFrictionCoefficent, lane, src->m_upperBoundFrictionCoefficent);
+		SetLane (row->m_normalForceIndex, lane, src->m_normalForceIndex * DG_WIDE_LANES + lane);
+		SetLane (row->m_rowIndex, lane, (jointInfo->m_pairStart + i) * stride);
+	}
+}
+
+static dgInt32 PackJointRows (dgArray<dgUnsigned8>& memory, const dgParallelSolverSyncData* const syncData, const dgJointInfo* const constraintArray, const dgJacobianMatrixElement* const matrixRow)
+{
+	const dgParallelSolverSyncData::dgParallelJointMap* const jointInfoMap = syncData->m_jointConflicts;
+
+	dgInt32 groupCount = 0;
+	dgInt32 rowCount = 0;
+	for (dgInt32 i = 0; i < syncData->m_bachCount; i ++) {
+		const dgInt32 start = syncData->m_jointBatches[i];
+		const dgInt32 end = syncData->m_jointBatches[i + 1];
+		const dgInt32 lanes = (jointInfoMap[start].m_bashCount == DG_PARALLEL_JOINT_OVERFLOW_COLOR) ? 1 : DG_WIDE_LANES;
+		dgInt32 lane = 0;
+		dgInt32 maxRows = 0;
+		for (dgInt32 j = start; j < end; j ++) {
+			const dgJointInfo* const jointInfo = &constraintArray[jointInfoMap[j].m_jointIndex];
+			if (!jointInfo->m_joint->IsSkeleton()) {
+				maxRows = dgMax (maxRows, jointInfo->m_pairCount);
+				lane ++;
+				if (lane == lanes) {
+					groupCount ++;
+					rowCount += maxRows;
+					lane = 0;
+					maxRows = 0;
+				}
+			}
+		}
+		if (lane) {
+			groupCount ++;
+			rowCount += maxRows;
+		}
+	}
+
+	if (!groupCount) {
+		return 0;
+	}
+
+	const dgInt32 jointCount = syncData->m_jointCount;
+	const dgInt32 alignment = DG_WIDE_LANES * sizeof (dgFloat32);
+	const dgInt32 headerSize = (sizeof (dgWideSolverHeader) + alignment - 1) & -alignment;
+	const dgInt32 size = DG_VECTOR_AVX512_SIZE + headerSize + rowCount * sizeof (dgWideJacobianRow) + groupCount * sizeof (dgWideJointGroup) + jointCount * sizeof (dgInt32);
+	memory.ResizeIfNecessary (size);
+
+	dgWideSolverHeader* const header = GetSolverHeader (memory);
+	header->m_rows = (dgWideJacobianRow*) (((dgUnsigned8*)header) + headerSize);
+	header->m_groups = (dgWideJointGroup*) &header->m_rows[rowCount];
+	header->m_unconverged = (dgInt32*) &header->m_groups[groupCount];
+	header->m_groupCount = groupCount;
+	header->m_rowCount = rowCount;
+
+	dgWideJacobianRow* const rows = header->m_rows;
+	dgWideJointGroup* const groups = header->m_groups;
+
+	dgInt32 groupIndex = 0;
+	dgInt32 rowStart = 0;
+	for (dgInt32 i = 0; i < syncData->m_bachCount; i ++) {
+		const dgInt32 start = syncData->m_jointBatches[i];
+		const dgInt32 end = syncData->m_jointBatches[i + 1];
+		const dgInt32 lanes = (jointInfoMap[start].m_bashCount == DG_PARALLEL_JOINT_OVERFLOW_COLOR) ? 1 : DG_WIDE_LANES;
+		for (dgInt32 j = start; j < end;) {
+			dgInt32 lane = 0;
+			dgInt32 maxRows = 0;
+			dgInt32 laneJoints[DG_WIDE_LANES];
+			for (; (j < end) && (lane < lanes); j ++) {
+				const dgInt32 jointIndex = jointInfoMap[j].m_jointIndex;
+				const dgJointInfo* const jointInfo = &constraintArray[jointIndex];
+				if (!jointInfo->m_joint->IsSkeleton()) {
+					maxRows = dgMax (maxRows, jointInfo->m_pairCount);
+					laneJoints[lane] = jointIndex;
+					lane ++;
+				}
+			}
+			if (lane) {
+				dgWideJointGroup* const group = &groups[groupIndex];
+				ClearJointGroup (group, rows, rowStart, maxRows);
+				for (dgInt32 k = 0; k < lane; k ++) {
+					PackJointLane (group, rows, k, &constraintArray[laneJoints[k]], laneJoints[k], matrixRow);
+				}
+				groupIndex ++;
+				rowStart += maxRows;
+			}
+		}
+	}
+	dgAssert (groupIndex == groupCount);
+	dgAssert (rowStart == rowCount);
+	return groupCount;
+}
+
+static dgFloat32 CalculateJointForce (dgArray<dgUnsigned8>& memory, const dgJointInfo* const constraintArray, const dgInt32* const bodyResting, dgJacobian* const internalForces, dgJacobianMatrixElement* const matrixRow, dgInt32& unconvergedCount)
+{
+	dgWideSolverHeader* const header = GetSolverHeader (memory);
+	const dgWideJacobianRow* const rows = header->m_rows;
+	const dgWideJointGroup* const groups = header->m_groups;
+	dgInt32* const unconverged = header->m_unconverged;
+
+	const dgFloat32* const matrixRowBase = &matrixRow->m_Jt.m_jacobianM0.m_linear.m_x;
+	const dgInt32 forceOffset = dgInt32 (&matrixRow->m_force - matrixRowBase);
+	const dgInt32 coordenateAccelOffset = dgInt32 (&matrixRow->m_coordenateAccel - matrixRowBase);
+	const dgFloat32* const internalForcesBase = &internalForces->m_linear.m_x;
+
+	const dgWideFloat zero (dgFloat32 (0.0f));
+	const dgWideFloat one (dgFloat32 (1.0f));
+	const dgWideFloat tol2 (dgFloat32 (1.0e-4f));
+	const dgWideInt invalid (-1);
+	const dgWideInt stride (sizeof (dgJacobian) / sizeof (dgFloat32));
+
+	dgWideFloat accNorm (zero);
+	unconvergedCount = 0;
+
+	dgWideFloat b[DG_CONSTRAINT_MAX_ROWS];
+	dgWideFloat x[DG_CONSTRAINT_MAX_ROWS + 1];
+	const dgFloat32* const normalForce = (dgFloat32*) x;
+
+	const dgInt32 groupCount = header->m_groupCount;
+	for (dgInt32 i = 0; i < groupCount; i ++) {
+		const dgWideJointGroup* const group = &groups[i];
+		const dgWideInt m0 (group->m_m0);
+		const dgWideInt m1 (group->m_m1);
+		const dgWideMask resting (dgWideInt::Gather (bodyResting, m0).And (dgWideInt::Gather (bodyResting, m1)) > dgWideInt (0));
+		const dgWideMask active ((group->m_joint > invalid).AndNot (resting));
+		const dgInt32 activeLanes = active.GetSignMask();
+		if (!activeLanes) {
+			continue;
+		}
+
+		const dgWideInt index0 (m0 * stride);
+		const dgWideInt index1 (m1 * stride);
+		dgWideFloat accel0[12];
+		for (dgInt32 j = 0; j < 3; j ++) {
+			accel0[j] = dgWideFloat::Gather (internalForcesBase, index0 + dgWideInt (j));
+			accel0[j + 3] = dgWideFloat::Gather (internalForcesBase, index0 + dgWideInt (j + 4));
+			accel0[j + 6] = dgWideFloat::Gather (internalForcesBase, index1 + dgWideInt (j));
+			accel0[j + 9] = dgWideFloat::Gather (internalForcesBase, index1 + dgWideInt (j + 4));
+		}
+
+		const dgWideFloat scale0 (group->m_scale0);
+		const dgWideFloat scale1 (group->m_scale1);
+		const dgWideJacobianRow* const groupRows = &rows[group->m_rowStart];
+		const dgInt32 rowsCount = group->m_rowsCount;
+
+		for (dgInt32 j = 0; j <= rowsCount; j ++) {
+			x[j] = one;
+		}
+
+		dgWideFloat groupAccNorm (zero);
+		for (dgInt32 j = 0; j < rowsCount; j ++) {
+			const dgWideJacobianRow* const row = &groupRows[j];
+			const dgWideMask rowMask (active & (row->m_rowIndex > invalid));
+
+			const dgWideFloat force0 (dgWideFloat::Gather (matrixRowBase, row->m_rowIndex + dgWideInt (forceOffset), rowMask));
+			const dgWideFloat coordenateAccel (dgWideFloat::Gather (matrixRowBase, row->m_rowIndex + dgWideInt (coordenateAccelOffset), rowMask));
+
+			dgWideFloat diag (row->m_JMinv[0] * accel0[0]);
+			for (dgInt32 k = 1; k < 12; k ++) {
+				diag = diag.MulAdd (row->m_JMinv[k], accel0[k]);
+			}
+
+			dgWideFloat accel (coordenateAccel - force0 * row->m_diagDamp - diag);
+			dgWideFloat force (force0.MulAdd (row->m_invJinvMJt, accel));
+
+			const dgWideFloat frictionNormal (dgWideFloat::Gather (normalForce, row->m_normalForceIndex));
+			const dgWideFloat lowerFrictionForce (frictionNormal * row->m_lowerBoundFrictionCoefficent);
+			const dgWideFloat upperFrictionForce (frictionNormal * row->m_upperBoundFrictionCoefficent);
+
+			accel = accel.AndNot ((force > upperFrictionForce) | (force < lowerFrictionForce)).And (rowMask);
+			force = force.GetMax (lowerFrictionForce).GetMin (upperFrictionForce);
+			groupAccNorm = groupAccNorm.MulAdd (accel, accel);
+
+			const dgWideFloat deltaForce ((force - force0).And (rowMask));
+			x[j] = force.Select (x[j], rowMask);
+			b[j] = coordenateAccel;
+
+			const dgWideFloat deltaForce0 (scale0 * deltaForce);
+			const dgWideFloat deltaForce1 (scale1 * deltaForce);
+			for (dgInt32 k = 0; k < 6; k ++) {
+				accel0[k] = accel0[k].MulAdd (row->m_Jt[k], deltaForce0);
+				accel0[k + 6] = accel0[k + 6].MulAdd (row->m_Jt[k + 6], deltaForce1);
+			}
+		}
+		accNorm = accNorm + groupAccNorm;
+
+		dgWideMask iterate (active & (groupAccNorm > tol2));
+		for (dgInt32 n = 0; (n < 4) && iterate.GetSignMask(); n ++) {
+			dgWideFloat maxAccel (zero);
+			for (dgInt32 j = 0; j < rowsCount; j ++) {
+				const dgWideJacobianRow* const row = &groupRows[j];
+				const dgWideMask rowMask (iterate & (row->m_rowIndex > invalid));
+
+				dgWideFloat diag (row->m_JMinv[0] * accel0[0]);
+				for (dgInt32 k = 1; k < 12; k ++) {
+					diag = diag.MulAdd (row->m_JMinv[k], accel0[k]);
+				}
+
+				const dgWideFloat accel (b[j] - x[j] * row->m_diagDamp - diag);
+				const dgWideFloat force (x[j].MulAdd (row->m_invJinvMJt, accel));
+
+				const dgWideFloat frictionNormal (dgWideFloat::Gather (normalForce, row->m_normalForceIndex));
+				const dgWideFloat lowerFrictionForce (frictionNormal * row->m_lowerBoundFrictionCoefficent);
+				const dgWideFloat upperFrictionForce (frictionNormal * row->m_upperBoundFrictionCoefficent);
+				const dgWideFloat clampedForce (force.GetMax (lowerFrictionForce).GetMin (upperFrictionForce));
+
+				const dgWideFloat deltaForce ((clampedForce - x[j]).And (rowMask));
+				x[j] = clampedForce.Select (x[j], rowMask);
+
+				const dgWideFloat clampedAccel (accel.AndNot ((force > upperFrictionForce) | (force < lowerFrictionForce)).And (rowMask));
+				maxAccel = maxAccel.MulAdd (clampedAccel, clampedAccel);
+
+				const dgWideFloat deltaForce0 (scale0 * deltaForce);
+				const dgWideFloat deltaForce1 (scale1 * deltaForce);
+				for (dgInt32 k = 0; k < 6; k ++) {
+					accel0[k] = accel0[k].MulAdd (row->m_Jt[k], deltaForce0);
+					accel0[k + 6] = accel0[k + 6].MulAdd (row->m_Jt[k + 6], deltaForce1);
+				}
+			}
+			iterate = iterate & (maxAccel > tol2);
+		}
+
+		// lanes that did not converge go to the scalar solver for the conjugate gradient refinement
+		const dgInt32 unconvergedLanes = iterate.GetSignMask();
+		for (dgInt32 lane = 0; lane < DG_WIDE_LANES; lane ++) {
+			if (activeLanes & (1 << lane)) {
+				const dgInt32 jointIndex = GetLane (group->m_joint, lane);
+				const dgJointInfo* const jointInfo = &constraintArray[jointIndex];
+				const dgInt32 first = jointInfo->m_pairStart;
+				const dgInt32 count = jointInfo->m_pairCount;
+				for (dgInt32 j = 0; j < count; j ++) {
+					dgJacobianMatrixElement* const row = &matrixRow[first + j];
+					const dgFloat32 force = GetLane (x[j], lane);
+					row->m_force = force;
+					row->m_maxImpact = dgMax (dgAbs (force), row->m_maxImpact);
+				}
+
+				const dgInt32 body0 = jointInfo->m_m0;
+				const dgInt32 body1 = jointInfo->m_m1;
+				internalForces[body0].m_linear = dgVector (GetLane (accel0[0], lane), GetLane (accel0[1], lane), GetLane (accel0[2], lane), dgFloat32 (0.0f));
+				internalForces[body0].m_angular = dgVector (GetLane (accel0[3], lane), GetLane (accel0[4], lane), GetLane (accel0[5], lane), dgFloat32 (0.0f));
+				internalForces[body1].m_linear = dgVector (GetLane (accel0[6], lane), GetLane (accel0[7], lane), GetLane (accel0[8], lane), dgFloat32 (0.0f));
+				internalForces[body1].m_angular = dgVector (GetLane (accel0[9], lane), GetLane (accel0[10], lane), GetLane (accel0[11], lane), dgFloat32 (0.0f));
+
+				if (unconvergedLanes & (1 << lane)) {
+					unconverged[unconvergedCount] = jointIndex;
+					unconvergedCount ++;
+				}
+			}
+		}
+	}
+
+	dgFloat32 sum = dgFloat32 (0.0f);
+	for (dgInt32 i = 0; i < DG_WIDE_LANES; i ++) {
+		sum += GetLane (accNorm, i);
+	}
+	return sum;
+}